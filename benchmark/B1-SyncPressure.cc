@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <new>
 #include <string>
@@ -11,6 +12,7 @@
 #include <vector>
 
 #include "benchmark/common/BenchmarkConfig.h"
+#include "benchmark/common/MockBackend.h"
 #include "galay-mysql/sync/MysqlClient.h"
 
 using namespace galay::mysql;
@@ -344,6 +346,14 @@ int main(int argc, char* argv[])
         return 2;
     }
 
+    std::unique_ptr<mock::MysqlMockServer> mock_server;
+    if (cfg.mock) {
+        mock_server = mysql_benchmark::startMockBackend(cfg);
+        if (!mock_server) {
+            return 1;
+        }
+    }
+
     mysql_benchmark::printConfig(cfg);
     std::cout << "Running sync pressure benchmark..." << std::endl;
 
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <new>
 #include <span>
@@ -14,6 +15,7 @@
 #include <galay-kernel/kernel/Runtime.h>
 
 #include "benchmark/common/BenchmarkConfig.h"
+#include "benchmark/common/MockBackend.h"
 #include "galay-mysql/async/AsyncMysqlClient.h"
 
 using namespace galay::kernel;
@@ -246,6 +248,7 @@ Coroutine runWorker(IOScheduler* scheduler,
                     }
                 } else {
                     ++batch_success;
+                    client.recycle(std::move(**query_result));
                 }
 
                 if (cfg.alloc_stats) {
@@ -353,6 +356,14 @@ int main(int argc, char* argv[])
         return 2;
     }
 
+    std::unique_ptr<mock::MysqlMockServer> mock_server;
+    if (cfg.mock) {
+        mock_server = mysql_benchmark::startMockBackend(cfg);
+        if (!mock_server) {
+            return 1;
+        }
+    }
+
     mysql_benchmark::printConfig(cfg);
     std::cout << "Running async pressure benchmark..." << std::endl;
 
@@ -0,0 +1,172 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <spdlog/sinks/null_sink.h>
+
+#include "galay-mysql/base/MysqlLog.h"
+
+using namespace galay::mysql;
+
+namespace
+{
+
+struct LogBenchmarkConfig {
+    size_t threads = 4;
+    size_t iterations = 10000000;
+};
+
+bool parseArgs(LogBenchmarkConfig& cfg, int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return false;
+        }
+        const unsigned long long value = std::strtoull(argv[++i], nullptr, 10);
+        if (value == 0) {
+            std::cerr << "invalid value for " << arg << std::endl;
+            return false;
+        }
+        if (arg == "--threads") {
+            cfg.threads = static_cast<size_t>(value);
+        } else if (arg == "--iterations") {
+            cfg.iterations = static_cast<size_t>(value);
+        } else {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 旧实现：每次调用都加锁并复制shared_ptr，用作对照
+struct LegacyLogState {
+    std::mutex mutex;
+    MysqlLoggerPtr logger;
+
+    MysqlLoggerPtr resolve(const MysqlLoggerPtr& client_logger)
+    {
+        if (client_logger) {
+            return client_logger;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return logger;
+    }
+};
+
+LegacyLogState g_legacy;
+std::atomic<uint64_t> g_sink{0};
+
+double runScenario(const LogBenchmarkConfig& cfg, const std::function<void(uint64_t)>& body)
+{
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    workers.reserve(cfg.threads);
+
+    for (size_t t = 0; t < cfg.threads; ++t) {
+        workers.emplace_back([&]() {
+            ready.fetch_add(1, std::memory_order_release);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (uint64_t i = 0; i < cfg.iterations; ++i) {
+                body(i);
+            }
+        });
+    }
+
+    while (ready.load(std::memory_order_acquire) < cfg.threads) {
+        std::this_thread::yield();
+    }
+    const auto started = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const auto finished = std::chrono::steady_clock::now();
+
+    const auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started).count();
+    return static_cast<double>(elapsed_ns) / static_cast<double>(cfg.iterations);
+}
+
+void report(std::string_view name, double ns_per_call, double baseline)
+{
+    std::cout << name << ": " << ns_per_call << " ns/call"
+              << " (+" << (ns_per_call > baseline ? ns_per_call - baseline : 0.0) << " ns vs baseline)"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    LogBenchmarkConfig cfg;
+    if (!parseArgs(cfg, argc, argv)) {
+        std::cerr << "usage: " << argv[0] << " [--threads N] [--iterations N]" << std::endl;
+        return 2;
+    }
+
+    std::cout << "=== B3 Log Overhead ===\n"
+              << "threads: " << cfg.threads << '\n'
+              << "iterations_per_thread: " << cfg.iterations << '\n'
+              << "GALAY_MYSQL_LOG_LEVEL: " << GALAY_MYSQL_LOG_LEVEL << std::endl;
+
+    const MysqlLoggerPtr no_client_logger;
+    auto null_logger = std::make_shared<spdlog::logger>(
+        "MysqlLogBenchNull", std::make_shared<spdlog::sinks::null_sink_mt>());
+    null_logger->set_level(spdlog::level::info);
+
+    // 基准：只有循环与一次原子计数
+    const double baseline = runScenario(cfg, [](uint64_t i) {
+        if ((i & 0xFFFF) == 0) g_sink.fetch_add(1, std::memory_order_relaxed);
+    });
+    report("baseline", baseline, baseline);
+
+    // 日志关闭：旧实现仍需加锁复制shared_ptr
+    MysqlLog::disable();
+    const double legacy_off = runScenario(cfg, [&](uint64_t i) {
+        auto logger = g_legacy.resolve(no_client_logger);
+        if (logger) SPDLOG_LOGGER_DEBUG(logger, "query {}", i);
+        if ((i & 0xFFFF) == 0) g_sink.fetch_add(1, std::memory_order_relaxed);
+    });
+    report("legacy_resolve_logging_off", legacy_off, baseline);
+
+    const double debug_off = runScenario(cfg, [&](uint64_t i) {
+        MysqlLogDebug(no_client_logger, "query {}", i);
+        if ((i & 0xFFFF) == 0) g_sink.fetch_add(1, std::memory_order_relaxed);
+    });
+    report("debug_logging_off", debug_off, baseline);
+
+    // 全局logger为info级别，debug调用在运行期被过滤（或在编译期被移除）
+    MysqlLog::setLogger(null_logger);
+    const double debug_filtered = runScenario(cfg, [&](uint64_t i) {
+        MysqlLogDebug(no_client_logger, "query {}", i);
+        if ((i & 0xFFFF) == 0) g_sink.fetch_add(1, std::memory_order_relaxed);
+    });
+    report("debug_filtered_by_global_level", debug_filtered, baseline);
+
+    // 客户端logger级别高于调用级别，不触碰全局logger
+    auto client_logger = std::make_shared<spdlog::logger>(
+        "MysqlLogBenchClient", std::make_shared<spdlog::sinks::null_sink_mt>());
+    client_logger->set_level(spdlog::level::warn);
+    const double info_filtered = runScenario(cfg, [&](uint64_t i) {
+        MysqlLogInfo(client_logger, "query {}", i);
+        if ((i & 0xFFFF) == 0) g_sink.fetch_add(1, std::memory_order_relaxed);
+    });
+    report("info_filtered_by_client_level", info_filtered, baseline);
+
+    MysqlLog::disable();
+    return 0;
+}
@@ -0,0 +1,569 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <galay-kernel/kernel/Runtime.h>
+
+#include "benchmark/common/BenchmarkConfig.h"
+#include "benchmark/common/LatencyHistogram.h"
+#include "benchmark/common/MockBackend.h"
+#include "galay-mysql/async/AsyncMysqlClient.h"
+#include "galay-mysql/sync/MysqlClient.h"
+
+using namespace galay::kernel;
+using namespace galay::mysql;
+
+namespace
+{
+namespace alloc_stats
+{
+std::atomic<uint64_t> g_alloc_count{0};
+std::atomic<uint64_t> g_alloc_bytes{0};
+
+struct Snapshot
+{
+    uint64_t alloc_count = 0;
+    uint64_t alloc_bytes = 0;
+};
+
+inline Snapshot snapshot()
+{
+    return Snapshot{
+        g_alloc_count.load(std::memory_order_relaxed),
+        g_alloc_bytes.load(std::memory_order_relaxed)
+    };
+}
+} // namespace alloc_stats
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    if (size == 0) {
+        size = 1;
+    }
+    if (void* ptr = std::malloc(size)) {
+        alloc_stats::g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+        alloc_stats::g_alloc_bytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    ::operator delete[](ptr);
+}
+
+namespace
+{
+
+using mysql_benchmark::LatencyHistogram;
+
+enum class Scenario
+{
+    TextQuery,      // COM_QUERY + 文本协议结果（对照组）
+    StmtString,     // prepare一次，execute多次，参数以VAR_STRING发送
+    StmtTyped,      // prepare一次，execute多次，参数以LONGLONG二进制发送
+};
+
+const char* scenarioName(Scenario scenario)
+{
+    switch (scenario) {
+    case Scenario::TextQuery:
+        return "text_query";
+    case Scenario::StmtString:
+        return "stmt_string";
+    case Scenario::StmtTyped:
+        return "stmt_typed";
+    }
+    return "text_query";
+}
+
+std::optional<Scenario> parseScenario(std::string_view name)
+{
+    if (name == "text_query") return Scenario::TextQuery;
+    if (name == "stmt_string") return Scenario::StmtString;
+    if (name == "stmt_typed") return Scenario::StmtTyped;
+    return std::nullopt;
+}
+
+struct StmtBenchmarkConfig {
+    mysql_benchmark::MysqlBenchmarkConfig base;
+    bool async_client = true;
+    std::vector<size_t> widths{1, 8, 32, 64};
+    std::vector<Scenario> scenarios{Scenario::TextQuery, Scenario::StmtString, Scenario::StmtTyped};
+};
+
+struct BenchCase {
+    Scenario scenario;
+    size_t width;
+    std::string sql;
+};
+
+constexpr std::string_view kParamValue = "1234567";
+
+// 列类型按 整数 / 字符串 / 小数 轮换，与MysqlMockResult::generated一致
+std::string buildSql(size_t width, bool with_placeholder)
+{
+    std::string sql = "SELECT ";
+    for (size_t c = 0; c < width; ++c) {
+        if (c > 0) sql += ", ";
+        if (c == 0) {
+            sql += with_placeholder ? "?" : std::string(kParamValue);
+        } else if (c % 3 == 1) {
+            sql += "'abcdefghijklmnop'";
+        } else if (c % 3 == 2) {
+            sql += std::to_string(c) + ".5";
+        } else {
+            sql += std::to_string(c);
+        }
+        sql += " AS c" + std::to_string(c);
+    }
+    return sql;
+}
+
+bool parseSizeList(std::string_view text, std::vector<size_t>& out)
+{
+    out.clear();
+    while (!text.empty()) {
+        const size_t comma = text.find(',');
+        const std::string item(text.substr(0, comma));
+        const unsigned long long value = std::strtoull(item.c_str(), nullptr, 10);
+        if (value == 0 || value > 4096) return false;
+        out.push_back(static_cast<size_t>(value));
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+    }
+    return !out.empty();
+}
+
+bool parseScenarioList(std::string_view text, std::vector<Scenario>& out)
+{
+    out.clear();
+    while (!text.empty()) {
+        const size_t comma = text.find(',');
+        const auto scenario = parseScenario(text.substr(0, comma));
+        if (!scenario) return false;
+        out.push_back(*scenario);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+    }
+    return !out.empty();
+}
+
+bool parseArgs(StmtBenchmarkConfig& cfg, int argc, char* argv[])
+{
+    // 通用参数交给BenchmarkConfig解析，其余在这里处理
+    std::vector<char*> common_args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg == "--client" || arg == "--widths" || arg == "--scenarios") {
+            if (i + 1 >= argc) {
+                std::cerr << "missing " << arg << " value" << std::endl;
+                return false;
+            }
+            const std::string_view value(argv[++i]);
+            if (arg == "--client") {
+                if (value != "sync" && value != "async") {
+                    std::cerr << "invalid --client value, expected sync|async" << std::endl;
+                    return false;
+                }
+                cfg.async_client = value == "async";
+            } else if (arg == "--widths") {
+                if (!parseSizeList(value, cfg.widths)) {
+                    std::cerr << "invalid --widths value, expected e.g. 1,8,32,64" << std::endl;
+                    return false;
+                }
+            } else if (!parseScenarioList(value, cfg.scenarios)) {
+                std::cerr << "invalid --scenarios value, expected text_query,stmt_string,stmt_typed" << std::endl;
+                return false;
+            }
+            continue;
+        }
+        common_args.push_back(argv[i]);
+    }
+    return mysql_benchmark::parseArgs(cfg.base, static_cast<int>(common_args.size()), common_args.data(), std::cerr);
+}
+
+struct CaseState {
+    std::atomic<size_t> finished_clients{0};
+    std::atomic<uint64_t> success{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> alloc_count_delta{0};
+    std::atomic<uint64_t> alloc_bytes_delta{0};
+    std::mutex mutex;
+    LatencyHistogram histogram;
+    std::string first_error;
+
+    void recordError(std::string message)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first_error.empty()) {
+            first_error = std::move(message);
+        }
+    }
+
+    void finish(const LatencyHistogram& local, uint64_t allocs, uint64_t alloc_bytes)
+    {
+        alloc_count_delta.fetch_add(allocs, std::memory_order_relaxed);
+        alloc_bytes_delta.fetch_add(alloc_bytes, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            histogram.merge(local);
+        }
+        finished_clients.fetch_add(1, std::memory_order_release);
+    }
+};
+
+// 单个客户端的计时与分配统计
+struct OpRecorder {
+    explicit OpRecorder(const mysql_benchmark::MysqlBenchmarkConfig& config)
+        : cfg(config)
+    {
+    }
+
+    const mysql_benchmark::MysqlBenchmarkConfig& cfg;
+    LatencyHistogram histogram;
+    uint64_t alloc_count = 0;
+    uint64_t alloc_bytes = 0;
+    alloc_stats::Snapshot alloc_before{};
+    std::chrono::steady_clock::time_point started{};
+
+    void begin()
+    {
+        if (cfg.alloc_stats) alloc_before = alloc_stats::snapshot();
+        started = std::chrono::steady_clock::now();
+    }
+
+    void end()
+    {
+        const auto finished = std::chrono::steady_clock::now();
+        histogram.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started).count()));
+        if (cfg.alloc_stats) {
+            const auto alloc_after = alloc_stats::snapshot();
+            alloc_count += alloc_after.alloc_count - alloc_before.alloc_count;
+            alloc_bytes += alloc_after.alloc_bytes - alloc_before.alloc_bytes;
+        }
+    }
+};
+
+// ======================== 同步客户端 ========================
+
+void runSyncClient(const StmtBenchmarkConfig& cfg, const BenchCase& bench, CaseState* state)
+{
+    const auto& base = cfg.base;
+    OpRecorder recorder(base);
+    MysqlClient client;
+    auto connect_result = client.connect(base.host, base.port, base.user, base.password, base.database);
+    if (!connect_result) {
+        state->failed.fetch_add(base.queries_per_client, std::memory_order_relaxed);
+        state->recordError("connect failed: " + connect_result.error().message());
+        state->finish(recorder.histogram, 0, 0);
+        return;
+    }
+
+    const bool prepared = bench.scenario != Scenario::TextQuery;
+    uint32_t stmt_id = 0;
+    if (prepared) {
+        auto prepare_result = client.prepare(bench.sql);
+        if (!prepare_result) {
+            state->failed.fetch_add(base.queries_per_client, std::memory_order_relaxed);
+            state->recordError("prepare failed: " + prepare_result.error().message());
+            state->finish(recorder.histogram, 0, 0);
+            return;
+        }
+        stmt_id = prepare_result->statement_id;
+    }
+
+    const std::vector<std::optional<std::string>> params{std::string(kParamValue)};
+    const std::vector<uint8_t> typed{static_cast<uint8_t>(MysqlFieldType::LONGLONG)};
+    const std::vector<uint8_t> untyped;
+    const auto& param_types = bench.scenario == Scenario::StmtTyped ? typed : untyped;
+
+    auto runOnce = [&]() {
+        return prepared ? client.stmtExecute(stmt_id, params, param_types) : client.query(bench.sql);
+    };
+
+    for (size_t i = 0; i < base.warmup_queries; ++i) {
+        auto _ = runOnce();
+        (void)_;
+    }
+
+    uint64_t success = 0;
+    for (size_t i = 0; i < base.queries_per_client; ++i) {
+        recorder.begin();
+        auto result = runOnce();
+        recorder.end();
+        if (result && result->rowCount() > 0) {
+            ++success;
+        } else {
+            state->recordError(result ? "empty result set" : "execute failed: " + result.error().message());
+        }
+    }
+
+    if (prepared) {
+        auto _ = client.stmtClose(stmt_id);
+        (void)_;
+    }
+    client.close();
+
+    state->success.fetch_add(success, std::memory_order_relaxed);
+    state->failed.fetch_add(base.queries_per_client - success, std::memory_order_relaxed);
+    state->finish(recorder.histogram, recorder.alloc_count, recorder.alloc_bytes);
+}
+
+// ======================== 异步客户端 ========================
+
+Coroutine runAsyncClient(IOScheduler* scheduler, const StmtBenchmarkConfig* cfg, const BenchCase* bench, CaseState* state)
+{
+    const auto& base = cfg->base;
+    OpRecorder recorder(base);
+    auto client = AsyncMysqlClientBuilder()
+        .scheduler(scheduler)
+        .bufferSize(base.buffer_size)
+        .build();
+
+    auto connect_result = co_await client.connect(base.host, base.port, base.user, base.password, base.database);
+    if (!connect_result || !connect_result->has_value()) {
+        state->failed.fetch_add(base.queries_per_client, std::memory_order_relaxed);
+        state->recordError(connect_result ? "connect failed: awaitable resumed without value"
+                                          : "connect failed: " + connect_result.error().message());
+        state->finish(recorder.histogram, 0, 0);
+        co_return;
+    }
+
+    const bool prepared = bench->scenario != Scenario::TextQuery;
+    uint32_t stmt_id = 0;
+    if (prepared) {
+        auto prepare_result = co_await client.prepare(bench->sql);
+        if (!prepare_result || !prepare_result->has_value()) {
+            state->failed.fetch_add(base.queries_per_client, std::memory_order_relaxed);
+            state->recordError(prepare_result ? "prepare failed: awaitable resumed without value"
+                                              : "prepare failed: " + prepare_result.error().message());
+            state->finish(recorder.histogram, 0, 0);
+            co_return;
+        }
+        stmt_id = prepare_result->value().statement_id;
+    }
+
+    const std::optional<std::string_view> params[] = {kParamValue};
+    const uint8_t typed[] = {static_cast<uint8_t>(MysqlFieldType::LONGLONG)};
+    const std::span<const uint8_t> param_types =
+        bench->scenario == Scenario::StmtTyped ? std::span<const uint8_t>(typed) : std::span<const uint8_t>{};
+
+    const size_t total = base.warmup_queries + base.queries_per_client;
+    uint64_t success = 0;
+    for (size_t i = 0; i < total; ++i) {
+        const bool measured = i >= base.warmup_queries;
+        if (measured) recorder.begin();
+        bool ok = false;
+        if (prepared) {
+            auto result = co_await client.stmtExecute(stmt_id, std::span<const std::optional<std::string_view>>(params), param_types);
+            ok = result && result->has_value() && result->value().rowCount() > 0;
+            if (!ok && measured) {
+                state->recordError(result ? "execute returned no rows" : "execute failed: " + result.error().message());
+            }
+        } else {
+            auto result = co_await client.query(bench->sql);
+            ok = result && result->has_value() && result->value().rowCount() > 0;
+            if (!ok && measured) {
+                state->recordError(result ? "query returned no rows" : "query failed: " + result.error().message());
+            }
+        }
+        if (measured) {
+            recorder.end();
+            if (ok) ++success;
+        }
+    }
+
+    auto _ = co_await client.close();
+    (void)_;
+
+    state->success.fetch_add(success, std::memory_order_relaxed);
+    state->failed.fetch_add(base.queries_per_client - success, std::memory_order_relaxed);
+    state->finish(recorder.histogram, recorder.alloc_count, recorder.alloc_bytes);
+}
+
+// ======================== 汇总 ========================
+
+void printHeader()
+{
+    std::cout << std::left
+              << std::setw(8) << "client"
+              << std::setw(13) << "scenario"
+              << std::right
+              << std::setw(6) << "width"
+              << std::setw(10) << "ops"
+              << std::setw(8) << "failed"
+              << std::setw(12) << "qps"
+              << std::setw(10) << "p50_us"
+              << std::setw(10) << "p90_us"
+              << std::setw(10) << "p99_us"
+              << std::setw(10) << "p999_us"
+              << std::setw(10) << "max_us"
+              << std::setw(11) << "allocs/op"
+              << std::setw(11) << "bytes/op" << '\n';
+}
+
+void printCase(const StmtBenchmarkConfig& cfg, const BenchCase& bench, CaseState& state, double elapsed_sec)
+{
+    const uint64_t success = state.success.load(std::memory_order_relaxed);
+    const uint64_t failed = state.failed.load(std::memory_order_relaxed);
+    const uint64_t total = success + failed;
+    const auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1e3; };
+    const double qps = elapsed_sec > 0.0 ? static_cast<double>(success) / elapsed_sec : 0.0;
+
+    std::cout << std::left
+              << std::setw(8) << (cfg.async_client ? "async" : "sync")
+              << std::setw(13) << scenarioName(bench.scenario)
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(6) << bench.width
+              << std::setw(10) << total
+              << std::setw(8) << failed
+              << std::setw(12) << qps
+              << std::setw(10) << us(state.histogram.percentile(0.50))
+              << std::setw(10) << us(state.histogram.percentile(0.90))
+              << std::setw(10) << us(state.histogram.percentile(0.99))
+              << std::setw(10) << us(state.histogram.percentile(0.999))
+              << std::setw(10) << us(state.histogram.max());
+    if (cfg.base.alloc_stats && total > 0) {
+        std::cout << std::setw(11) << static_cast<double>(state.alloc_count_delta.load()) / static_cast<double>(total)
+                  << std::setw(11) << static_cast<double>(state.alloc_bytes_delta.load()) / static_cast<double>(total);
+    } else {
+        std::cout << std::setw(11) << "-" << std::setw(11) << "-";
+    }
+    std::cout << std::defaultfloat << std::endl;
+
+    if (!state.first_error.empty()) {
+        std::cout << "  first_error: " << state.first_error << std::endl;
+    }
+}
+
+void printUsage(const char* prog)
+{
+    mysql_benchmark::printUsage(prog);
+    std::cout << "B4 options: [--client sync|async] [--widths 1,8,32,64]"
+              << " [--scenarios text_query,stmt_string,stmt_typed]\n"
+              << "  --mock-rows N sets rows per result (default 1)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    StmtBenchmarkConfig cfg;
+    cfg.base = mysql_benchmark::loadMysqlBenchmarkConfig();
+    if (!parseArgs(cfg, argc, argv)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<BenchCase> cases;
+    for (size_t width : cfg.widths) {
+        for (Scenario scenario : cfg.scenarios) {
+            cases.push_back(BenchCase{scenario, width, buildSql(width, scenario != Scenario::TextQuery)});
+        }
+    }
+
+    std::unique_ptr<mock::MysqlMockServer> mock_server;
+    if (cfg.base.mock) {
+        mock_server = mysql_benchmark::startMockBackend(cfg.base);
+        if (!mock_server) {
+            return 1;
+        }
+        const size_t rows = cfg.base.mock_rows > 0 ? cfg.base.mock_rows : 1;
+        for (const auto& bench : cases) {
+            mock_server->script(bench.sql,
+                                mock::MysqlMockResult::generated(bench.width, rows, cfg.base.mock_value_bytes));
+        }
+    }
+
+    std::cout << "=== B4 Prepared Statement Pressure ===\n"
+              << "client: " << (cfg.async_client ? "async" : "sync")
+              << ", clients: " << cfg.base.clients
+              << ", queries_per_client: " << cfg.base.queries_per_client
+              << ", warmup: " << cfg.base.warmup_queries
+              << ", alloc_stats: " << (cfg.base.alloc_stats ? "on" : "off")
+              << ", target: " << (cfg.base.mock ? "mock" : cfg.base.host + ":" + std::to_string(cfg.base.port))
+              << std::endl;
+    printHeader();
+
+    std::unique_ptr<Runtime> runtime;
+    if (cfg.async_client) {
+        runtime = std::make_unique<Runtime>();
+        runtime->start();
+    }
+
+    bool all_ok = true;
+    for (const auto& bench : cases) {
+        CaseState state;
+        const auto started = std::chrono::steady_clock::now();
+        if (cfg.async_client) {
+            for (size_t i = 0; i < cfg.base.clients; ++i) {
+                auto* scheduler = runtime->getNextIOScheduler();
+                scheduler->spawn(runAsyncClient(scheduler, &cfg, &bench, &state));
+            }
+            const auto deadline = started + std::chrono::seconds(cfg.base.timeout_seconds);
+            while (state.finished_clients.load(std::memory_order_acquire) < cfg.base.clients &&
+                   std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (state.finished_clients.load(std::memory_order_acquire) < cfg.base.clients) {
+                std::cerr << "case timeout after " << cfg.base.timeout_seconds << "s" << std::endl;
+                runtime->stop();
+                return 1;
+            }
+        } else {
+            std::vector<std::thread> workers;
+            workers.reserve(cfg.base.clients);
+            for (size_t i = 0; i < cfg.base.clients; ++i) {
+                workers.emplace_back(runSyncClient, std::cref(cfg), std::cref(bench), &state);
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        const auto finished = std::chrono::steady_clock::now();
+        const double elapsed_sec = std::chrono::duration<double>(finished - started).count();
+
+        printCase(cfg, bench, state, elapsed_sec);
+        all_ok = all_ok && state.failed.load(std::memory_order_relaxed) == 0;
+    }
+
+    if (runtime) {
+        runtime->stop();
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,436 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <galay-kernel/kernel/Runtime.h>
+
+#include "benchmark/common/BenchmarkConfig.h"
+#include "benchmark/common/LatencyHistogram.h"
+#include "benchmark/common/MockBackend.h"
+#include "galay-mysql/async/AsyncMysqlClient.h"
+#include "galay-mysql/async/MysqlConnectionPool.h"
+
+using namespace galay::kernel;
+using namespace galay::mysql;
+
+namespace
+{
+
+using mysql_benchmark::LatencyHistogram;
+
+enum class ConnectionMode
+{
+    Dedicated,      // 每个协程独占一个AsyncMysqlClient
+    Pool,           // 每个调度器一个MysqlConnectionPool，每次查询acquire/release
+};
+
+const char* connectionModeName(ConnectionMode mode)
+{
+    return mode == ConnectionMode::Pool ? "pool" : "dedicated";
+}
+
+// IO后端在galay-kernel编译期决定，这里只负责在报告中标注
+constexpr const char* ioBackendName()
+{
+#if defined(USE_IOURING)
+    return "io_uring";
+#elif defined(USE_EPOLL)
+    return "epoll";
+#elif defined(USE_KQUEUE)
+    return "kqueue";
+#else
+    return "default";
+#endif
+}
+
+struct ScalingBenchmarkConfig {
+    mysql_benchmark::MysqlBenchmarkConfig base;
+    std::vector<size_t> schedulers{1, 2, 4, 8};
+    std::vector<size_t> clients_per_scheduler{1, 8, 32};
+    std::vector<ConnectionMode> modes{ConnectionMode::Dedicated, ConnectionMode::Pool};
+    size_t pool_size = 0;           // 每个调度器的连接池上限，0表示等于该调度器上的客户端数
+    std::string csv_path;           // 为空时CSV输出到stdout
+};
+
+template <typename T, typename Parse>
+bool parseList(std::string_view text, std::vector<T>& out, Parse parse)
+{
+    out.clear();
+    while (!text.empty()) {
+        const size_t comma = text.find(',');
+        const auto item = parse(text.substr(0, comma));
+        if (!item) return false;
+        out.push_back(*item);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+    }
+    return !out.empty();
+}
+
+std::optional<size_t> parseCount(std::string_view text)
+{
+    const std::string item(text);
+    char* end = nullptr;
+    const unsigned long long value = std::strtoull(item.c_str(), &end, 10);
+    if (end == item.c_str() || *end != '\0' || value == 0 || value > 4096) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(value);
+}
+
+std::optional<ConnectionMode> parseMode(std::string_view text)
+{
+    if (text == "dedicated") return ConnectionMode::Dedicated;
+    if (text == "pool") return ConnectionMode::Pool;
+    return std::nullopt;
+}
+
+bool parseArgs(ScalingBenchmarkConfig& cfg, int argc, char* argv[])
+{
+    // 通用参数交给BenchmarkConfig解析，其余在这里处理
+    std::vector<char*> common_args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg != "--schedulers" && arg != "--clients-per-scheduler" && arg != "--conn" &&
+            arg != "--pool-size" && arg != "--csv") {
+            common_args.push_back(argv[i]);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "missing " << arg << " value" << std::endl;
+            return false;
+        }
+        const std::string_view value(argv[++i]);
+        bool ok = true;
+        if (arg == "--schedulers") {
+            ok = parseList(value, cfg.schedulers, parseCount);
+        } else if (arg == "--clients-per-scheduler") {
+            ok = parseList(value, cfg.clients_per_scheduler, parseCount);
+        } else if (arg == "--conn") {
+            ok = parseList(value, cfg.modes, parseMode);
+        } else if (arg == "--pool-size") {
+            const auto size = parseCount(value);
+            ok = size.has_value();
+            cfg.pool_size = size.value_or(0);
+        } else {
+            cfg.csv_path = std::string(value);
+        }
+        if (!ok) {
+            std::cerr << "invalid " << arg << " value: " << value << std::endl;
+            return false;
+        }
+    }
+    return mysql_benchmark::parseArgs(cfg.base, static_cast<int>(common_args.size()), common_args.data(), std::cerr);
+}
+
+struct CaseState {
+    std::atomic<size_t> finished_clients{0};
+    std::atomic<uint64_t> success{0};
+    std::atomic<uint64_t> failed{0};
+    std::mutex mutex;
+    LatencyHistogram histogram;
+    std::string first_error;
+
+    void recordError(std::string message)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first_error.empty()) {
+            first_error = std::move(message);
+        }
+    }
+
+    void finish(const LatencyHistogram& local, uint64_t ok, uint64_t total)
+    {
+        success.fetch_add(ok, std::memory_order_relaxed);
+        failed.fetch_add(total - ok, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            histogram.merge(local);
+        }
+        finished_clients.fetch_add(1, std::memory_order_release);
+    }
+};
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point started)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started).count());
+}
+
+Coroutine runDedicatedClient(IOScheduler* scheduler,
+                             const mysql_benchmark::MysqlBenchmarkConfig* cfg,
+                             CaseState* state)
+{
+    LatencyHistogram histogram;
+    auto client = AsyncMysqlClientBuilder()
+        .scheduler(scheduler)
+        .bufferSize(cfg->buffer_size)
+        .build();
+
+    auto connect_result = co_await client.connect(cfg->host, cfg->port, cfg->user, cfg->password, cfg->database);
+    if (!connect_result || !connect_result->has_value()) {
+        state->recordError(connect_result ? "connect failed: awaitable resumed without value"
+                                          : "connect failed: " + connect_result.error().message());
+        state->finish(histogram, 0, cfg->queries_per_client);
+        co_return;
+    }
+
+    for (size_t i = 0; i < cfg->warmup_queries; ++i) {
+        auto _ = co_await client.query(cfg->sql);
+        (void)_;
+    }
+
+    uint64_t success = 0;
+    for (size_t i = 0; i < cfg->queries_per_client; ++i) {
+        const auto started = std::chrono::steady_clock::now();
+        auto result = co_await client.query(cfg->sql);
+        histogram.record(elapsedNs(started));
+        if (result && result->has_value()) {
+            ++success;
+        } else {
+            state->recordError(result ? "query failed: awaitable resumed without value"
+                                      : "query failed: " + result.error().message());
+        }
+    }
+
+    auto _ = co_await client.close();
+    (void)_;
+    state->finish(histogram, success, cfg->queries_per_client);
+}
+
+Coroutine runPooledClient(MysqlConnectionPool* pool,
+                          const mysql_benchmark::MysqlBenchmarkConfig* cfg,
+                          CaseState* state)
+{
+    LatencyHistogram histogram;
+    uint64_t success = 0;
+    const size_t total = cfg->warmup_queries + cfg->queries_per_client;
+    for (size_t i = 0; i < total; ++i) {
+        const bool measured = i >= cfg->warmup_queries;
+        // 计时包含acquire/release，池锁的争用会直接体现在延迟里
+        const auto started = std::chrono::steady_clock::now();
+        auto acquire_awaitable = pool->acquire();
+        std::expected<std::optional<AsyncMysqlClient*>, MysqlError> acquired;
+        do {
+            acquired = co_await acquire_awaitable;
+        } while (acquired && !acquired->has_value());
+        if (!acquired) {
+            if (measured) state->recordError("acquire failed: " + acquired.error().message());
+            continue;
+        }
+
+        AsyncMysqlClient* client = acquired->value();
+        auto result = co_await client->query(cfg->sql);
+        pool->release(client);
+        if (!measured) {
+            continue;
+        }
+        histogram.record(elapsedNs(started));
+        if (result && result->has_value()) {
+            ++success;
+        } else {
+            state->recordError(result ? "query failed: awaitable resumed without value"
+                                      : "query failed: " + result.error().message());
+        }
+    }
+    state->finish(histogram, success, cfg->queries_per_client);
+}
+
+double cpuSeconds()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    const auto seconds = [](const timeval& tv) {
+        return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+    };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+struct CaseResult {
+    size_t schedulers = 0;
+    size_t clients_per_scheduler = 0;
+    ConnectionMode mode = ConnectionMode::Dedicated;
+    uint64_t success = 0;
+    uint64_t failed = 0;
+    double elapsed_sec = 0.0;
+    double cpu_sec = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    bool timed_out = false;
+    std::string first_error;
+};
+
+CaseResult runCase(const ScalingBenchmarkConfig& cfg, size_t schedulers, size_t clients_per_scheduler, ConnectionMode mode)
+{
+    CaseResult result;
+    result.schedulers = schedulers;
+    result.clients_per_scheduler = clients_per_scheduler;
+    result.mode = mode;
+
+    RuntimeConfig runtime_config;
+    runtime_config.io_scheduler_count = schedulers;
+    runtime_config.compute_scheduler_count = 0;
+    Runtime runtime(runtime_config);
+    runtime.start();
+
+    std::vector<IOScheduler*> io_schedulers;
+    for (size_t i = 0; i < schedulers; ++i) {
+        io_schedulers.push_back(runtime.getNextIOScheduler());
+    }
+
+    // 连接池的连接绑定在其所属调度器上，因此每个调度器各建一个池
+    std::vector<std::unique_ptr<MysqlConnectionPool>> pools;
+    if (mode == ConnectionMode::Pool) {
+        MysqlConnectionPoolConfig pool_config;
+        pool_config.mysql_config = MysqlConfig::create(cfg.base.host, cfg.base.port, cfg.base.user,
+                                                       cfg.base.password, cfg.base.database);
+        pool_config.max_connections = cfg.pool_size == 0 ? clients_per_scheduler : cfg.pool_size;
+        pool_config.min_connections = std::min<size_t>(pool_config.min_connections, pool_config.max_connections);
+        for (auto* scheduler : io_schedulers) {
+            pools.push_back(std::make_unique<MysqlConnectionPool>(scheduler, pool_config));
+        }
+    }
+
+    CaseState state;
+    const size_t total_clients = schedulers * clients_per_scheduler;
+    const double cpu_before = cpuSeconds();
+    const auto started = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < schedulers; ++s) {
+        for (size_t c = 0; c < clients_per_scheduler; ++c) {
+            if (mode == ConnectionMode::Pool) {
+                io_schedulers[s]->spawn(runPooledClient(pools[s].get(), &cfg.base, &state));
+            } else {
+                io_schedulers[s]->spawn(runDedicatedClient(io_schedulers[s], &cfg.base, &state));
+            }
+        }
+    }
+
+    const auto deadline = started + std::chrono::seconds(cfg.base.timeout_seconds);
+    while (state.finished_clients.load(std::memory_order_acquire) < total_clients &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto finished = std::chrono::steady_clock::now();
+    result.cpu_sec = cpuSeconds() - cpu_before;
+    runtime.stop();
+
+    result.timed_out = state.finished_clients.load(std::memory_order_acquire) < total_clients;
+    result.elapsed_sec = std::chrono::duration<double>(finished - started).count();
+    result.success = state.success.load(std::memory_order_relaxed);
+    result.failed = state.failed.load(std::memory_order_relaxed);
+    result.p50_ns = state.histogram.percentile(0.50);
+    result.p99_ns = state.histogram.percentile(0.99);
+    result.p999_ns = state.histogram.percentile(0.999);
+    result.first_error = state.first_error;
+    return result;
+}
+
+void writeCsvHeader(std::ostream& out)
+{
+    out << "backend,schedulers,clients_per_scheduler,connection_mode,ops,failed,elapsed_s,"
+           "qps,qps_per_scheduler,p50_us,p99_us,p999_us,cpu_us_per_query,cpu_cores_busy\n";
+}
+
+void writeCsvRow(std::ostream& out, const CaseResult& r)
+{
+    const double qps = r.elapsed_sec > 0.0 ? static_cast<double>(r.success) / r.elapsed_sec : 0.0;
+    const double cpu_per_query = r.success > 0 ? r.cpu_sec * 1e6 / static_cast<double>(r.success) : 0.0;
+    const double cores_busy = r.elapsed_sec > 0.0 ? r.cpu_sec / r.elapsed_sec : 0.0;
+    out << ioBackendName() << ','
+        << r.schedulers << ','
+        << r.clients_per_scheduler << ','
+        << connectionModeName(r.mode) << ','
+        << (r.success + r.failed) << ','
+        << r.failed << ','
+        << std::fixed << std::setprecision(3) << r.elapsed_sec << ','
+        << std::setprecision(1) << qps << ','
+        << qps / static_cast<double>(r.schedulers) << ','
+        << static_cast<double>(r.p50_ns) / 1e3 << ','
+        << static_cast<double>(r.p99_ns) / 1e3 << ','
+        << static_cast<double>(r.p999_ns) / 1e3 << ','
+        << std::setprecision(2) << cpu_per_query << ','
+        << cores_busy << std::defaultfloat << '\n';
+    out.flush();
+}
+
+void printUsage(const char* prog)
+{
+    mysql_benchmark::printUsage(prog);
+    std::cout << "B5 options: [--schedulers 1,2,4,8] [--clients-per-scheduler 1,8,32]"
+              << " [--conn dedicated,pool] [--pool-size N] [--csv path]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    ScalingBenchmarkConfig cfg;
+    cfg.base = mysql_benchmark::loadMysqlBenchmarkConfig();
+    if (!parseArgs(cfg, argc, argv)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::unique_ptr<mock::MysqlMockServer> mock_server;
+    if (cfg.base.mock) {
+        mock_server = mysql_benchmark::startMockBackend(cfg.base);
+        if (!mock_server) {
+            return 1;
+        }
+    }
+
+    std::ofstream csv_file;
+    if (!cfg.csv_path.empty()) {
+        csv_file.open(cfg.csv_path, std::ios::out | std::ios::trunc);
+        if (!csv_file) {
+            std::cerr << "failed to open csv output: " << cfg.csv_path << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& csv = cfg.csv_path.empty() ? std::cout : csv_file;
+
+    std::cerr << "=== B5 Scheduler Scaling ===\n"
+              << "backend: " << ioBackendName()
+              << ", queries_per_client: " << cfg.base.queries_per_client
+              << ", warmup: " << cfg.base.warmup_queries
+              << ", sql: " << cfg.base.sql
+              << ", target: " << (cfg.base.mock ? "mock" : cfg.base.host + ":" + std::to_string(cfg.base.port))
+              << std::endl;
+    writeCsvHeader(csv);
+
+    bool all_ok = true;
+    for (ConnectionMode mode : cfg.modes) {
+        for (size_t schedulers : cfg.schedulers) {
+            for (size_t clients_per_scheduler : cfg.clients_per_scheduler) {
+                const auto result = runCase(cfg, schedulers, clients_per_scheduler, mode);
+                writeCsvRow(csv, result);
+                if (result.timed_out) {
+                    std::cerr << "case timeout after " << cfg.base.timeout_seconds << "s: schedulers="
+                              << schedulers << ", clients_per_scheduler=" << clients_per_scheduler
+                              << ", mode=" << connectionModeName(mode) << std::endl;
+                    return 1;
+                }
+                if (!result.first_error.empty()) {
+                    std::cerr << "first_error (" << connectionModeName(mode) << ", " << schedulers << "x"
+                              << clients_per_scheduler << "): " << result.first_error << std::endl;
+                }
+                all_ok = all_ok && result.failed == 0;
+            }
+        }
+    }
+    return all_ok ? 0 : 1;
+}
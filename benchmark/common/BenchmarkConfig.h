@@ -57,6 +57,13 @@ struct MysqlBenchmarkConfig {
     size_t batch_size = 16;
     size_t buffer_size = 16 * 1024;
     bool alloc_stats = false;
+
+    // 使用进程内模拟服务器代替真实MySQL（--mock）
+    bool mock = false;
+    size_t mock_rows = 0;           // >0时将--sql的响应替换为生成的结果集
+    size_t mock_columns = 4;
+    size_t mock_value_bytes = 16;
+    size_t mock_threads = 1;
 };
 
 inline const char* getEnvNonEmpty(const char* key)
@@ -157,6 +164,7 @@ inline MysqlBenchmarkConfig loadMysqlBenchmarkConfig()
     cfg.batch_size = getEnvSizeOrDefault("GALAY_MYSQL_BENCH_BATCH_SIZE", "MYSQL_BENCH_BATCH_SIZE", cfg.batch_size);
     cfg.buffer_size = getEnvSizeOrDefault("GALAY_MYSQL_BENCH_BUFFER_SIZE", "MYSQL_BENCH_BUFFER_SIZE", cfg.buffer_size);
     cfg.alloc_stats = parseBoolOrDefault(getEnvNonEmpty("GALAY_MYSQL_BENCH_ALLOC_STATS"), cfg.alloc_stats);
+    cfg.mock = parseBoolOrDefault(getEnvNonEmpty("GALAY_MYSQL_BENCH_MOCK"), cfg.mock);
 
     return cfg;
 }
@@ -264,6 +272,43 @@ inline bool parseArgs(MysqlBenchmarkConfig& cfg, int argc, char* argv[], std::os
             continue;
         }
 
+        if (arg == "--mock") {
+            cfg.mock = true;
+            continue;
+        }
+
+        if (arg == "--mock-rows") {
+            if (!parsePositiveSizeArg(argc, argv, i, cfg.mock_rows)) {
+                err << "invalid --mock-rows value" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        if (arg == "--mock-columns") {
+            if (!parsePositiveSizeArg(argc, argv, i, cfg.mock_columns)) {
+                err << "invalid --mock-columns value" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        if (arg == "--mock-value-bytes") {
+            if (!parsePositiveSizeArg(argc, argv, i, cfg.mock_value_bytes)) {
+                err << "invalid --mock-value-bytes value" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        if (arg == "--mock-threads") {
+            if (!parsePositiveSizeArg(argc, argv, i, cfg.mock_threads)) {
+                err << "invalid --mock-threads value" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
         err << "unknown argument: " << arg << std::endl;
         return false;
     }
@@ -278,12 +323,13 @@ inline void printUsage(const char* prog)
         << " [--clients N] [--queries N] [--warmup N] [--timeout-sec N]"
         << " [--sql \"SELECT 1\"] [--mode normal|batch|pipeline]"
         << " [--batch-size N] [--buffer-size N] [--alloc-stats]\n"
+        << "       [--mock] [--mock-rows N] [--mock-columns N] [--mock-value-bytes N] [--mock-threads N]\n"
         << "Environment overrides:\n"
         << "  GALAY_MYSQL_HOST / GALAY_MYSQL_PORT / GALAY_MYSQL_USER / GALAY_MYSQL_PASSWORD / GALAY_MYSQL_DB\n"
         << "  GALAY_MYSQL_BENCH_CLIENTS / GALAY_MYSQL_BENCH_QUERIES / GALAY_MYSQL_BENCH_WARMUP\n"
         << "  GALAY_MYSQL_BENCH_TIMEOUT / GALAY_MYSQL_BENCH_SQL / GALAY_MYSQL_BENCH_MODE\n"
         << "  GALAY_MYSQL_BENCH_BATCH_SIZE / GALAY_MYSQL_BENCH_BUFFER_SIZE\n"
-        << "  GALAY_MYSQL_BENCH_ALLOC_STATS\n";
+        << "  GALAY_MYSQL_BENCH_ALLOC_STATS / GALAY_MYSQL_BENCH_MOCK\n";
 }
 
 inline void printConfig(const MysqlBenchmarkConfig& cfg)
@@ -300,7 +346,8 @@ inline void printConfig(const MysqlBenchmarkConfig& cfg)
         << ", mode=" << modeToString(cfg.mode)
         << ", batch_size=" << cfg.batch_size
         << ", buffer_size=" << cfg.buffer_size
-        << ", alloc_stats=" << (cfg.alloc_stats ? "on" : "off") << '\n'
+        << ", alloc_stats=" << (cfg.alloc_stats ? "on" : "off")
+        << ", mock=" << (cfg.mock ? "on" : "off") << '\n'
         << "SQL: " << cfg.sql << std::endl;
 }
 
@@ -0,0 +1,103 @@
+#ifndef GALAY_MYSQL_BENCHMARK_LATENCY_HISTOGRAM_H
+#define GALAY_MYSQL_BENCHMARK_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace mysql_benchmark
+{
+
+/**
+ * @brief 对数-线性延迟直方图（纳秒）
+ * @details 每个2的幂区间再均分为32个子桶，相对误差约3%；记录为O(1)且无分配，
+ *          各工作线程各持一份，结束后merge，避免收集全部样本再排序。
+ */
+class LatencyHistogram
+{
+public:
+    void record(uint64_t value_ns)
+    {
+        ++m_buckets[bucketIndex(value_ns)];
+        ++m_count;
+        m_sum += value_ns;
+        m_min = std::min(m_min, value_ns);
+        m_max = std::max(m_max, value_ns);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            m_buckets[i] += other.m_buckets[i];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    uint64_t count() const { return m_count; }
+    uint64_t max() const { return m_count == 0 ? 0 : m_max; }
+    uint64_t min() const { return m_count == 0 ? 0 : m_min; }
+    double mean() const { return m_count == 0 ? 0.0 : static_cast<double>(m_sum) / static_cast<double>(m_count); }
+
+    /**
+     * @brief 分位数（p取值0~1），返回所在桶的中点，并截断到[min, max]
+     */
+    uint64_t percentile(double p) const
+    {
+        if (m_count == 0) {
+            return 0;
+        }
+        p = std::clamp(p, 0.0, 1.0);
+        const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(p * static_cast<double>(m_count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += m_buckets[i];
+            if (seen >= target) {
+                return std::clamp(bucketMidpoint(i), min(), max());
+            }
+        }
+        return max();
+    }
+
+private:
+    static constexpr unsigned kSubBits = 5;
+    static constexpr uint64_t kSubCount = uint64_t{1} << kSubBits;     // 32
+    static constexpr uint64_t kLinearLimit = kSubCount * 2;            // [0, 64)直接映射
+    static constexpr size_t kBucketCount = kLinearLimit + (64 - kSubBits - 1) * kSubCount;
+
+    static size_t bucketIndex(uint64_t value)
+    {
+        if (value < kLinearLimit) {
+            return static_cast<size_t>(value);
+        }
+        const unsigned msb = 63u - static_cast<unsigned>(std::countl_zero(value));
+        const unsigned shift = msb - kSubBits;
+        const uint64_t mantissa = value >> shift;                        // [32, 64)
+        return static_cast<size_t>(kLinearLimit + (shift - 1) * kSubCount + (mantissa - kSubCount));
+    }
+
+    static uint64_t bucketMidpoint(size_t index)
+    {
+        if (index < kLinearLimit) {
+            return index;
+        }
+        const uint64_t offset = index - kLinearLimit;
+        const unsigned shift = static_cast<unsigned>(offset / kSubCount) + 1;
+        const uint64_t mantissa = offset % kSubCount + kSubCount;
+        return (mantissa << shift) + ((uint64_t{1} << shift) >> 1);
+    }
+
+    std::array<uint64_t, kBucketCount> m_buckets{};
+    uint64_t m_count = 0;
+    uint64_t m_sum = 0;
+    uint64_t m_min = std::numeric_limits<uint64_t>::max();
+    uint64_t m_max = 0;
+};
+
+} // namespace mysql_benchmark
+
+#endif // GALAY_MYSQL_BENCHMARK_LATENCY_HISTOGRAM_H
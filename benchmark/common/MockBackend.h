@@ -0,0 +1,48 @@
+#ifndef GALAY_MYSQL_BENCHMARK_MOCK_BACKEND_H
+#define GALAY_MYSQL_BENCHMARK_MOCK_BACKEND_H
+
+#include <iostream>
+#include <memory>
+
+#include "benchmark/common/BenchmarkConfig.h"
+#include "galay-mysql/mock/MysqlMockServer.h"
+
+namespace mysql_benchmark
+{
+
+/**
+ * @brief 按--mock配置启动进程内模拟服务器，并把cfg的连接参数指向它
+ * @return 启动失败时返回nullptr
+ */
+inline std::unique_ptr<galay::mysql::mock::MysqlMockServer> startMockBackend(MysqlBenchmarkConfig& cfg)
+{
+    using namespace galay::mysql::mock;
+
+    MysqlMockServerConfig server_cfg;
+    server_cfg.username = cfg.user;
+    server_cfg.password = cfg.password;
+    server_cfg.worker_threads = cfg.mock_threads;
+
+    auto server = std::make_unique<MysqlMockServer>(server_cfg);
+    auto started = server->start();
+    if (!started) {
+        std::cerr << "mock server start failed: " << started.error().message() << std::endl;
+        return nullptr;
+    }
+    if (cfg.mock_rows > 0) {
+        server->script(cfg.sql, MysqlMockResult::generated(cfg.mock_columns, cfg.mock_rows, cfg.mock_value_bytes));
+    }
+
+    cfg.host = server_cfg.host;
+    cfg.port = server->port();
+    std::cout << "Mock server: port=" << cfg.port
+              << ", threads=" << cfg.mock_threads
+              << ", rows=" << cfg.mock_rows
+              << ", columns=" << (cfg.mock_rows > 0 ? cfg.mock_columns : 0)
+              << ", value_bytes=" << cfg.mock_value_bytes << std::endl;
+    return server;
+}
+
+} // namespace mysql_benchmark
+
+#endif // GALAY_MYSQL_BENCHMARK_MOCK_BACKEND_H
@@ -22,6 +22,10 @@ endif()
 set(GALAY_MYSQL_CXX_STANDARD "23" CACHE STRING "C++ standard for galay-mysql targets")
 set_property(CACHE GALAY_MYSQL_CXX_STANDARD PROPERTY STRINGS 20 23 26)
 
+# 编译期日志裁剪：低于该级别的MysqlLogXxx调用被完全移除；为空时沿用MysqlLog.h默认值
+set(GALAY_MYSQL_LOG_LEVEL "" CACHE STRING "Compile-time log level cut-off for galay-mysql")
+set_property(CACHE GALAY_MYSQL_LOG_LEVEL PROPERTY STRINGS "" trace debug info warn error off)
+
 if(GALAY_MYSQL_BUILD_SHARED_LIBS)
     set(GALAY_MYSQL_LIBRARY_TYPE SHARED)
 else()
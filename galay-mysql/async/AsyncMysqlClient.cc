@@ -1,7 +1,11 @@
 #include "AsyncMysqlClient.h"
 #include "galay-mysql/base/MysqlLog.h"
+#include "galay-mysql/base/MysqlResolver.h"
 #include "galay-mysql/protocol/Builder.h"
+#include <atomic>
 #include <concepts>
+#include <mutex>
+#include <sys/socket.h>
 #include <sys/uio.h>
 #include <utility>
 
@@ -66,6 +70,21 @@ bool handleSendResult(std::expected<size_t, IOError>& io_result,
     return false;
 }
 
+std::shared_ptr<MysqlBufferProvider> makeBufferProvider(const AsyncMysqlConfig& config)
+{
+    if (config.max_buffer_size > 0) {
+        MysqlAdaptiveBufferConfig buffer_config;
+        buffer_config.max_capacity = config.max_buffer_size;
+        return std::make_shared<MysqlAdaptiveBufferProvider>(buffer_config);
+    }
+#ifdef USE_IOURING
+    // io_uring下每次唤醒都会重新提交readv，单段固定地址窗口的提交与解析开销更低
+    return std::make_shared<MysqlLinearBufferProvider>(config.buffer_size);
+#else
+    return nullptr;
+#endif
+}
+
 bool prepareRecvWindow(MysqlBufferHandle& ring_buffer, std::vector<struct iovec>& iovecs)
 {
     struct iovec raw_iovecs[2];
@@ -123,6 +142,30 @@ MysqlError toTimeoutOrInternalError(const IOError& io_error)
     return MysqlError(MYSQL_ERROR_INTERNAL, io_error.message());
 }
 
+inline MysqlError cancelledBeforeSend()
+{
+    return MysqlError(MYSQL_ERROR_CANCELLED, "Cancelled before the command was sent");
+}
+
+inline MysqlError cancelledAfterDrain()
+{
+    return MysqlError(MYSQL_ERROR_CANCELLED, "Cancelled, remaining response discarded");
+}
+
+// 传输层或协议层错误之后连接不再停在响应边界上
+inline bool leavesConnectionBroken(const MysqlError& error)
+{
+    switch (error.type()) {
+    case MYSQL_ERROR_SEND:
+    case MYSQL_ERROR_RECV:
+    case MYSQL_ERROR_CONNECTION_CLOSED:
+    case MYSQL_ERROR_PROTOCOL:
+        return true;
+    default:
+        return false;
+    }
+}
+
 inline std::string_view linearizeReadIovecs(std::span<const struct iovec> iovecs, std::string& scratch)
 {
     if (iovecs.size() == 1) {
@@ -136,6 +179,32 @@ inline std::string_view linearizeReadIovecs(std::span<const struct iovec> iovecs
     return std::string_view(scratch);
 }
 
+/**
+ * @brief 从接收缓冲解码下一个结果集事件
+ * @details 缓冲回绕时线性化到scratch；consumed为事件对应的字节数，
+ *          调用方处理完事件（payload仍指向缓冲）后再消费。
+ *          除loadLocalInfile()外的路径无法应答LOCAL INFILE请求，直接按协议错误返回。
+ */
+inline std::expected<protocol::MysqlResultEvent, MysqlError>
+nextResultEvent(MysqlBufferHandle& buffer,
+                protocol::MysqlResultDecoder& decoder,
+                std::string& scratch,
+                size_t& consumed,
+                bool accept_local_infile = false)
+{
+    struct iovec read_iovecs[2];
+    const size_t read_iovecs_count = buffer.getReadIovecs(read_iovecs, 2);
+    auto linear = linearizeReadIovecs(
+        std::span<const struct iovec>(read_iovecs, read_iovecs_count),
+        scratch);
+    auto event = decoder.feed(linear.data(), linear.size(), consumed);
+    if (event && event->type == protocol::MysqlResultEventType::LocalInfile && !accept_local_infile) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL,
+                                          "LOCAL INFILE request requires loadLocalInfile()"));
+    }
+    return event;
+}
+
 inline std::string buildSingleCommandPacket(protocol::CommandType cmd,
                                             std::string_view payload,
                                             protocol::MysqlCommandKind kind)
@@ -146,6 +215,27 @@ inline std::string buildSingleCommandPacket(protocol::CommandType cmd,
     return std::move(builder.release().encoded);
 }
 
+/**
+ * @brief 把借出的缓冲归还到客户端槽位
+ * @details 只保留容量更大的那一份，内容清空
+ */
+template<typename Buffer>
+inline void returnScratch(Buffer& slot, Buffer& borrowed) noexcept
+{
+    if (borrowed.capacity() > slot.capacity()) {
+        borrowed.clear();
+        slot = std::move(borrowed);
+    }
+}
+
+inline void returnResultSet(MysqlResultSet& slot, MysqlResultSet& result_set) noexcept
+{
+    result_set.clear();
+    if (result_set.reusableRows() >= slot.reusableRows()) {
+        slot = std::move(result_set);
+    }
+}
+
 #ifdef IOV_MAX
 constexpr int kPipelineWritevMaxIov = IOV_MAX > 0 ? IOV_MAX : 1024;
 #else
@@ -157,7 +247,8 @@ constexpr int kPipelineWritevMaxIov = 1024;
 // ======================== MysqlConnectAwaitable ========================
 
 MysqlConnectAwaitable::ProtocolConnectAwaitable::ProtocolConnectAwaitable(MysqlConnectAwaitable* owner)
-    : ConnectIOContext(Host(IPType::IPV4, owner->m_config.host, owner->m_config.port))
+    : ConnectIOContext(Host(MysqlResolver::literalFamily(owner->m_config.host) == AF_INET6 ? IPType::IPV6 : IPType::IPV4,
+                            owner->m_config.host, owner->m_config.port))
     , m_owner(owner)
 {
 }
@@ -389,8 +480,9 @@ bool MysqlConnectAwaitable::ProtocolAuthResultRecvAwaitable::handleComplete(stru
     return detail::handleReadResult(
         m_result,
         m_owner->m_client.m_ring_buffer,
-        [&](const IOError& io_error) { m_owner->setRecvError("auth", io_error); },
-        [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Connection closed during auth")); },
+        [&](const IOError& io_error) { m_owner->setRecvError(m_owner->phaseName(), io_error); },
+        [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED,
+                                                  std::string("Connection closed during ") + m_owner->phaseName())); },
         [&]() { return m_owner->parseAuthResultFromRingBuffer(); },
         [&](MysqlError err) { m_owner->setError(std::move(err)); }
     );
@@ -416,8 +508,9 @@ bool MysqlConnectAwaitable::ProtocolAuthResultRecvAwaitable::handleComplete(GHan
         if (detail::handleReadResult(
                 m_result,
                 m_owner->m_client.m_ring_buffer,
-                [&](const IOError& io_error) { m_owner->setRecvError("auth", io_error); },
-                [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Connection closed during auth")); },
+                [&](const IOError& io_error) { m_owner->setRecvError(m_owner->phaseName(), io_error); },
+                [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED,
+                                                  std::string("Connection closed during ") + m_owner->phaseName())); },
                 [&]() { return m_owner->parseAuthResultFromRingBuffer(); },
                 [&](MysqlError err) { m_owner->setError(std::move(err)); })) {
             return true;
@@ -440,12 +533,16 @@ MysqlConnectAwaitable::MysqlConnectAwaitable(AsyncMysqlClient& client, MysqlConf
     , m_handshake_recv_awaitable(this)
     , m_auth_send_awaitable(this)
     , m_auth_result_recv_awaitable(this)
+    , m_init_send_awaitable(this)
+    , m_init_result_recv_awaitable(this)
     , m_chain_error(std::nullopt)
 {
     addTask(IOEventType::CONNECT, &m_connect_awaitable);
     addTask(IOEventType::READV, &m_handshake_recv_awaitable);
     addTask(IOEventType::SEND, &m_auth_send_awaitable);
     addTask(IOEventType::READV, &m_auth_result_recv_awaitable);
+    addTask(IOEventType::SEND, &m_init_send_awaitable);
+    addTask(IOEventType::READV, &m_init_result_recv_awaitable);
 }
 
 void MysqlConnectAwaitable::reset() noexcept
@@ -455,6 +552,8 @@ void MysqlConnectAwaitable::reset() noexcept
     m_auth_packet.clear();
     m_sent = 0;
     m_connected = false;
+    m_init_sql.clear();
+    m_initializing = false;
     m_chain_error.reset();
 }
 
@@ -517,6 +616,8 @@ std::expected<bool, MysqlError> MysqlConnectAwaitable::parseHandshakeFromRingBuf
         return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse handshake packet body"));
     }
     m_handshake = std::move(hs.value());
+    m_client.m_connection_id = m_handshake.connection_id;
+    m_client.m_pending = MysqlPendingResponse{};
 
     protocol::HandshakeResponse41 resp;
     resp.capability_flags = protocol::CLIENT_PROTOCOL_41
@@ -526,16 +627,28 @@ std::expected<bool, MysqlError> MysqlConnectAwaitable::parseHandshakeFromRingBuf
         | protocol::CLIENT_MULTI_STATEMENTS
         | protocol::CLIENT_MULTI_RESULTS
         | protocol::CLIENT_PS_MULTI_RESULTS
-        | protocol::CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA;
+        | protocol::CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA
+        | protocol::CLIENT_SESSION_TRACK;
     if (!m_config.database.empty()) {
         resp.capability_flags |= protocol::CLIENT_CONNECT_WITH_DB;
     }
+    if (m_config.allow_local_infile) {
+        resp.capability_flags |= protocol::CLIENT_LOCAL_FILES;
+    }
+    if (!m_config.connect_attributes.empty()) {
+        resp.capability_flags |= protocol::CLIENT_CONNECT_ATTRS;
+    }
     resp.capability_flags &= m_handshake.capability_flags;
     m_client.m_server_capabilities = resp.capability_flags;
-    resp.character_set = protocol::CHARSET_UTF8MB4_GENERAL_CI;
+    const auto collation = protocol::collationIdForCharset(m_config.charset);
+    resp.character_set = collation.value_or(protocol::CHARSET_UTF8MB4_GENERAL_CI);
+    m_init_sql = protocol::buildSessionInitSql(m_config, collation.has_value());
     resp.username = m_config.username;
     resp.database = m_config.database;
     resp.auth_plugin_name = m_handshake.auth_plugin_name;
+    if (resp.capability_flags & protocol::CLIENT_CONNECT_ATTRS) {
+        resp.connect_attributes = protocol::buildConnectAttributes(m_config);
+    }
 
     if (m_handshake.auth_plugin_name == "mysql_native_password") {
         resp.auth_response = protocol::AuthPlugin::nativePasswordAuth(m_config.password, m_handshake.auth_plugin_data);
@@ -553,6 +666,9 @@ std::expected<bool, MysqlError> MysqlConnectAwaitable::parseHandshakeFromRingBuf
 
 std::expected<bool, MysqlError> MysqlConnectAwaitable::parseAuthResultFromRingBuffer()
 {
+    if (m_initializing) {
+        return parseInitResultFromRingBuffer();
+    }
     while (true) {
         struct iovec read_iovecs[2];
         const size_t read_iovecs_count = m_client.m_ring_buffer.getReadIovecs(read_iovecs, 2);
@@ -576,25 +692,27 @@ std::expected<bool, MysqlError> MysqlConnectAwaitable::parseAuthResultFromRingBu
         }
 
         const uint8_t first_byte = static_cast<uint8_t>(pkt->payload[0]);
-        m_client.m_ring_buffer.consume(consumed);
-
-        if (first_byte == 0x00) {
-            m_connected = true;
-            m_lifecycle = Lifecycle::Done;
-            MysqlLogInfo(m_client.m_logger, "MySQL connected successfully to {}:{}", m_config.host, m_config.port);
-            return true;
-        }
-
         if (first_byte == 0xFF) {
             auto err = m_client.m_parser.parseErr(pkt->payload, pkt->payload_len, m_client.m_server_capabilities);
+            m_client.m_ring_buffer.consume(consumed);
             if (err) {
                 return std::unexpected(MysqlError(MYSQL_ERROR_AUTH, err->error_code, err->error_message));
             }
             return std::unexpected(MysqlError(MYSQL_ERROR_AUTH, "Authentication failed"));
         }
 
+        // consume之后缓冲区可能被归还，包内容须在此之前读完
+        const bool fast_auth_ok = first_byte == 0x01 && pkt->payload_len == 2 &&
+                                  static_cast<uint8_t>(pkt->payload[1]) == 0x03;
+        m_client.m_ring_buffer.consume(consumed);
+
+        if (first_byte == 0x00) {
+            onAuthenticated();
+            return true;
+        }
+
         if (first_byte == 0x01) {
-            if (pkt->payload_len == 2 && static_cast<uint8_t>(pkt->payload[1]) == 0x03) {
+            if (fast_auth_ok) {
                 continue;
             }
             return std::unexpected(MysqlError(MYSQL_ERROR_AUTH,
@@ -609,6 +727,44 @@ std::expected<bool, MysqlError> MysqlConnectAwaitable::parseAuthResultFromRingBu
     }
 }
 
+void MysqlConnectAwaitable::onAuthenticated()
+{
+    if (m_init_sql.empty()) {
+        m_connected = true;
+        m_lifecycle = Lifecycle::Done;
+        MysqlLogInfo(m_client.m_logger, "MySQL connected successfully to {}:{}", m_config.host, m_config.port);
+        return;
+    }
+    // 复用认证发送/接收的两个任务，整个初始化只多一次往返
+    m_auth_packet = m_client.m_encoder.encodeQuery(m_init_sql);
+    m_sent = 0;
+    m_init_decoder.reset(m_client.m_server_capabilities);
+    m_initializing = true;
+}
+
+std::expected<bool, MysqlError> MysqlConnectAwaitable::parseInitResultFromRingBuffer()
+{
+    while (true) {
+        size_t consumed = 0;
+        auto event = detail::nextResultEvent(m_client.m_ring_buffer, m_init_decoder, m_parse_scratch, consumed);
+        m_client.m_ring_buffer.consume(consumed);
+        if (!event) {
+            return std::unexpected(std::move(event.error()));
+        }
+        if (event->type == protocol::MysqlResultEventType::NeedMore) {
+            return false;
+        }
+        // 初始化语句的结果集直接丢弃，多语句在第一条出错的语句处停止
+        if (event->endsResponse()) {
+            m_initializing = false;
+            m_connected = true;
+            m_lifecycle = Lifecycle::Done;
+            MysqlLogInfo(m_client.m_logger, "MySQL connected successfully to {}:{}", m_config.host, m_config.port);
+            return true;
+        }
+    }
+}
+
 std::expected<std::optional<bool>, MysqlError> MysqlConnectAwaitable::await_resume()
 {
     onCompleted();
@@ -634,11 +790,23 @@ MysqlQueryAwaitable::ProtocolSendAwaitable::ProtocolSendAwaitable(MysqlQueryAwai
     : WritevIOContext({})
     , m_owner(owner)
 {
+    m_iovecs.swap(m_owner->m_client.m_query_scratch.send_iovecs);
     m_iovecs.reserve(1);
 }
 
+MysqlQueryAwaitable::ProtocolSendAwaitable::~ProtocolSendAwaitable()
+{
+    detail::returnScratch(m_owner->m_client.m_query_scratch.send_iovecs, m_iovecs);
+}
+
 void MysqlQueryAwaitable::ProtocolSendAwaitable::syncSendIovecs()
 {
+    if (m_owner->m_sent == 0 && m_owner->m_cancel.requested()) {
+        // 尚未发出任何字节，直接放弃，连接仍在边界上
+        m_owner->setError(detail::cancelledBeforeSend());
+        m_iovecs.clear();
+        return;
+    }
     detail::syncSendWindow(m_owner->m_encoded_cmd, m_owner->m_sent, m_buffer, m_length);
     m_iovecs.clear();
     if (m_length == 0 || m_buffer == nullptr) {
@@ -655,7 +823,10 @@ bool MysqlQueryAwaitable::ProtocolSendAwaitable::handleSendResult()
         m_owner->m_encoded_cmd.size(),
         [&](const IOError& io_error) { m_owner->setSendError(io_error); },
         [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_SEND, "Send returned 0 bytes")); },
-        [&]() { m_owner->m_client.m_ring_buffer.clear(); }
+        [&]() {
+            m_owner->m_client.m_ring_buffer.clear();
+            m_owner->m_cancel.arm();
+        }
     );
 }
 
@@ -669,6 +840,9 @@ bool MysqlQueryAwaitable::ProtocolSendAwaitable::handleComplete(struct io_uring_
     syncSendIovecs();
     if (m_iovecs.empty()) {
         m_owner->m_client.m_ring_buffer.clear();
+        if (m_owner->m_lifecycle == Lifecycle::Running) {
+            m_owner->m_cancel.arm();
+        }
         return true;
     }
 
@@ -688,6 +862,9 @@ bool MysqlQueryAwaitable::ProtocolSendAwaitable::handleComplete(GHandle handle)
         syncSendIovecs();
         if (m_iovecs.empty()) {
             m_owner->m_client.m_ring_buffer.clear();
+            if (m_owner->m_lifecycle == Lifecycle::Running) {
+                m_owner->m_cancel.arm();
+            }
             return true;
         }
 
@@ -706,9 +883,15 @@ MysqlQueryAwaitable::ProtocolRecvAwaitable::ProtocolRecvAwaitable(MysqlQueryAwai
     : ReadvIOContext({})
     , m_owner(owner)
 {
+    m_iovecs.swap(m_owner->m_client.m_query_scratch.recv_iovecs);
     m_iovecs.reserve(2);
 }
 
+MysqlQueryAwaitable::ProtocolRecvAwaitable::~ProtocolRecvAwaitable()
+{
+    detail::returnScratch(m_owner->m_client.m_query_scratch.recv_iovecs, m_iovecs);
+}
+
 bool MysqlQueryAwaitable::ProtocolRecvAwaitable::prepareRecvWindow()
 {
     if (!detail::prepareRecvWindow(m_owner->m_client.m_ring_buffer, m_iovecs)) {
@@ -789,45 +972,69 @@ bool MysqlQueryAwaitable::ProtocolRecvAwaitable::handleComplete(GHandle handle)
 MysqlQueryAwaitable::MysqlQueryAwaitable(AsyncMysqlClient& client, std::string_view sql)
     : CustomAwaitable(client.m_socket.controller())
     , m_client(client)
-    , m_encoded_cmd(detail::buildSingleCommandPacket(protocol::CommandType::COM_QUERY,
-                                                     sql,
-                                                     protocol::MysqlCommandKind::Query))
+    , m_encoded_cmd(std::move(client.m_query_scratch.encoded))
     , m_lifecycle(Lifecycle::Running)
-    , m_state(State::ReceivingHeader)
     , m_sent(0)
-    , m_column_count(0)
-    , m_columns_received(0)
+    , m_result_set(std::move(client.m_result_arena))
     , m_send_awaitable(this)
     , m_recv_awaitable(this)
     , m_chain_error(std::nullopt)
+    , m_parse_scratch(std::move(client.m_query_scratch.parse_scratch))
     , m_result(std::nullopt)
 {
+    if (sql.size() + 1 < protocol::MYSQL_MAX_PACKET_SIZE) {
+        m_client.m_encoder.encodeQueryInto(m_encoded_cmd, sql);
+    } else {
+        // 超过单包上限时由Builder负责分片
+        m_encoded_cmd = detail::buildSingleCommandPacket(protocol::CommandType::COM_QUERY,
+                                                         sql,
+                                                         protocol::MysqlCommandKind::Query);
+    }
+    m_result_set.clear();
     if (m_client.m_config.result_row_reserve_hint > 0) {
         m_result_set.reserveRows(m_client.m_config.result_row_reserve_hint);
     }
+    m_decoder.reset(m_client.m_server_capabilities, protocol::MysqlRowFormat::Text);
+    if (auto busy = m_client.checkIdle()) {
+        setError(std::move(*busy));
+        return;
+    }
     addTask(IOEventType::SEND, &m_send_awaitable);
     addTask(IOEventType::READV, &m_recv_awaitable);
 }
 
+MysqlQueryAwaitable::~MysqlQueryAwaitable()
+{
+    detail::returnScratch(m_client.m_query_scratch.encoded, m_encoded_cmd);
+    detail::returnScratch(m_client.m_query_scratch.parse_scratch, m_parse_scratch);
+    detail::returnResultSet(m_client.m_result_arena, m_result_set);
+}
+
 void MysqlQueryAwaitable::reset() noexcept
 {
     m_lifecycle = Lifecycle::Invalid;
-    m_state = State::ReceivingHeader;
-    m_result_set = MysqlResultSet{};
-    if (m_client.m_config.result_row_reserve_hint > 0) {
-        m_result_set.reserveRows(m_client.m_config.result_row_reserve_hint);
-    }
+    m_draining = false;
+    m_cancelled = false;
+    m_cancel.release();
+    m_decoder.reset(m_client.m_server_capabilities, protocol::MysqlRowFormat::Text);
+    m_result_set.clear();
     m_sent = 0;
-    m_column_count = 0;
-    m_columns_received = 0;
+    m_row_sink_error.reset();
     m_chain_error.reset();
     m_result = std::nullopt;
 }
 
+MysqlQueryAwaitable& MysqlQueryAwaitable::cancelOn(MysqlCancellationToken token)
+{
+    m_cancel.bind(m_client, std::move(token));
+    return *this;
+}
+
 void MysqlQueryAwaitable::setError(MysqlError error) noexcept
 {
     m_chain_error = std::move(error);
     m_lifecycle = Lifecycle::Invalid;
+    m_cancel.complete();
 }
 
 void MysqlQueryAwaitable::setSendError(const IOError& io_error) noexcept
@@ -845,144 +1052,63 @@ void MysqlQueryAwaitable::setRecvError(const IOError& io_error) noexcept
 std::expected<bool, MysqlError> MysqlQueryAwaitable::tryParseFromRingBuffer()
 {
     while (true) {
-        struct iovec read_iovecs[2];
-        const size_t read_iovecs_count = m_client.m_ring_buffer.getReadIovecs(read_iovecs, 2);
-        if (read_iovecs_count == 0) {
-            return false;
+        if (!m_cancelled && m_cancel.requested()) {
+            // 取消后不再落地结果，剩余响应读完丢弃
+            m_cancelled = true;
+            m_draining = true;
         }
-
-        auto linear = detail::linearizeReadIovecs(
-            std::span<const struct iovec>(read_iovecs, read_iovecs_count),
-            m_parse_scratch);
-        const char* data = linear.data();
-        size_t len = linear.size();
-
         size_t consumed = 0;
-        auto pkt = m_client.m_parser.extractPacket(data, len, consumed);
-        if (!pkt) {
-            if (pkt.error() == protocol::ParseError::Incomplete) {
-                return false;
-            }
-            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Parse query packet failed"));
+        auto event = detail::nextResultEvent(m_client.m_ring_buffer, m_decoder, m_parse_scratch, consumed);
+        if (!event) {
+            m_client.m_ring_buffer.consume(consumed);
+            return std::unexpected(std::move(event.error()));
+        }
+        if (event->type == protocol::MysqlResultEventType::NeedMore) {
+            return false;
         }
 
-        const uint8_t first_byte = static_cast<uint8_t>(pkt->payload[0]);
-        const uint32_t caps = m_client.m_server_capabilities;
-
-        if (m_state == State::ReceivingHeader) {
-            if (first_byte == 0xFF) {
-                auto err = m_client.m_parser.parseErr(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (err) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-                }
-                return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Query failed"));
-            }
-
-            if (first_byte == 0x00) {
-                auto ok = m_client.m_parser.parseOk(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (!ok) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse OK packet"));
-                }
-                m_result_set.setAffectedRows(ok->affected_rows);
-                m_result_set.setLastInsertId(ok->last_insert_id);
-                m_result_set.setWarnings(ok->warnings);
-                m_result_set.setStatusFlags(ok->status_flags);
-                m_result_set.setInfo(ok->info);
+        // 多语句/CALL的后续结果集不属于query()的返回值，读完丢弃以停在响应边界
+        if (m_draining) {
+            m_client.m_ring_buffer.consume(consumed);
+            if (event->endsResponse()) {
                 m_lifecycle = Lifecycle::Done;
+                m_cancel.complete();
                 return true;
             }
-
-            size_t int_consumed = 0;
-            auto col_count = protocol::readLenEncInt(pkt->payload, pkt->payload_len, int_consumed);
-            if (!col_count) {
-                m_client.m_ring_buffer.consume(consumed);
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column count"));
-            }
-
-            m_column_count = col_count.value();
-            m_columns_received = 0;
-            m_result_set.reserveFields(static_cast<size_t>(m_column_count));
-            m_client.m_ring_buffer.consume(consumed);
-            m_state = State::ReceivingColumns;
             continue;
         }
 
-        if (m_state == State::ReceivingColumns) {
-            auto col = m_client.m_parser.parseColumnDefinition(pkt->payload, pkt->payload_len);
-            m_client.m_ring_buffer.consume(consumed);
-            if (!col) {
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column definition"));
-            }
-
-            MysqlField field(col->name,
-                             static_cast<MysqlFieldType>(col->column_type),
-                             col->flags,
-                             col->column_length,
-                             col->decimals);
-            field.setCatalog(col->catalog);
-            field.setSchema(col->schema);
-            field.setTable(col->table);
-            field.setOrgTable(col->org_table);
-            field.setOrgName(col->org_name);
-            field.setCharacterSet(col->character_set);
-            m_result_set.addField(std::move(field));
-
-            ++m_columns_received;
-            if (m_columns_received >= m_column_count) {
-                m_state = (caps & protocol::CLIENT_DEPRECATE_EOF)
-                    ? State::ReceivingRows
-                    : State::ReceivingColumnEof;
+        if (m_row_sink != nullptr && event->type == protocol::MysqlResultEventType::Row) {
+            if (!m_row_sink_error.has_value()) {
+                auto decoded = m_row_sink->onRow(event->payload.data(), event->payload.size());
+                if (!decoded) {
+                    m_row_sink_error = std::move(decoded.error());
+                }
             }
-            continue;
-        }
-
-        if (m_state == State::ReceivingColumnEof) {
             m_client.m_ring_buffer.consume(consumed);
-            m_state = State::ReceivingRows;
             continue;
         }
 
-        if (m_state == State::ReceivingRows) {
-            if (first_byte == 0xFE && pkt->payload_len < 0xFFFFFF) {
-                if (caps & protocol::CLIENT_DEPRECATE_EOF) {
-                    auto ok = m_client.m_parser.parseOk(pkt->payload, pkt->payload_len, caps);
-                    if (ok) {
-                        m_result_set.setWarnings(ok->warnings);
-                        m_result_set.setStatusFlags(ok->status_flags);
-                    }
-                } else {
-                    auto eof = m_client.m_parser.parseEof(pkt->payload, pkt->payload_len);
-                    if (eof) {
-                        m_result_set.setWarnings(eof->warnings);
-                        m_result_set.setStatusFlags(eof->status_flags);
-                    }
-                }
-                m_client.m_ring_buffer.consume(consumed);
-                m_lifecycle = Lifecycle::Done;
-                return true;
-            }
-
-            if (first_byte == 0xFF) {
-                auto err = m_client.m_parser.parseErr(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (err) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-                }
-                return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Error during row fetch"));
+        auto done = m_decoder.apply(*event, m_result_set);
+        m_client.m_ring_buffer.consume(consumed);
+        if (!done) {
+            return std::unexpected(std::move(done.error()));
+        }
+        if (m_row_sink != nullptr && event->type == protocol::MysqlResultEventType::ColumnsEnd) {
+            auto checked = m_row_sink->onColumns(m_result_set.fields());
+            if (!checked) {
+                m_row_sink_error = std::move(checked.error());
             }
-
-            auto row = m_client.m_parser.parseTextRow(pkt->payload, pkt->payload_len, m_column_count);
-            m_client.m_ring_buffer.consume(consumed);
-            if (!row) {
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse text row"));
+        }
+        if (done.value()) {
+            if (event->moreResults()) {
+                m_draining = true;
+                continue;
             }
-            m_result_set.addRow(MysqlRow(std::move(row.value())));
-            continue;
+            m_lifecycle = Lifecycle::Done;
+            m_cancel.complete();
+            return true;
         }
-
-        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Invalid query parser state"));
     }
 }
 
@@ -992,12 +1118,21 @@ std::expected<std::optional<MysqlResultSet>, MysqlError> MysqlQueryAwaitable::aw
 
     if (!m_result.has_value()) {
         auto err = detail::toTimeoutOrInternalError(m_result.error());
+        m_client.markInterrupted(m_decoder, m_sent, m_encoded_cmd.size(), 1, err.type() == MYSQL_ERROR_TIMEOUT);
         reset();
         return std::unexpected(std::move(err));
     }
 
+    if (m_cancelled && (!m_chain_error.has_value() || m_chain_error->type() == MYSQL_ERROR_SERVER)) {
+        reset();
+        return std::unexpected(detail::cancelledAfterDrain());
+    }
+
     if (m_chain_error.has_value()) {
         auto err = std::move(*m_chain_error);
+        if (detail::leavesConnectionBroken(err)) {
+            m_client.markInterrupted(m_decoder, m_sent, m_encoded_cmd.size(), 1, false);
+        }
         reset();
         return std::unexpected(std::move(err));
     }
@@ -1007,6 +1142,12 @@ std::expected<std::optional<MysqlResultSet>, MysqlError> MysqlQueryAwaitable::aw
         return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Query awaitable did not reach done state"));
     }
 
+    if (m_row_sink_error.has_value()) {
+        auto err = std::move(*m_row_sink_error);
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
     auto result = std::move(m_result_set);
     reset();
     return std::optional<MysqlResultSet>(std::move(result));
@@ -1188,6 +1329,10 @@ MysqlPrepareAwaitable::MysqlPrepareAwaitable(AsyncMysqlClient& client, std::stri
     , m_chain_error(std::nullopt)
     , m_result(std::nullopt)
 {
+    if (auto busy = m_client.checkIdle()) {
+        setError(std::move(*busy));
+        return;
+    }
     addTask(IOEventType::SEND, &m_send_awaitable);
     addTask(IOEventType::READV, &m_recv_awaitable);
 }
@@ -1350,12 +1495,16 @@ MysqlPrepareAwaitable::await_resume()
 
     if (!m_result.has_value()) {
         auto err = detail::toTimeoutOrInternalError(m_result.error());
+        m_client.markInterrupted(protocol::MysqlResultDecoder{}, m_sent, m_encoded_cmd.size(), 1, false);
         reset();
         return std::unexpected(std::move(err));
     }
 
     if (m_chain_error.has_value()) {
         auto err = std::move(*m_chain_error);
+        if (detail::leavesConnectionBroken(err)) {
+            m_client.markInterrupted(protocol::MysqlResultDecoder{}, m_sent, m_encoded_cmd.size(), 1, false);
+        }
         reset();
         return std::unexpected(std::move(err));
     }
@@ -1376,11 +1525,23 @@ MysqlStmtExecuteAwaitable::ProtocolSendAwaitable::ProtocolSendAwaitable(MysqlStm
     : WritevIOContext({})
     , m_owner(owner)
 {
+    m_iovecs.swap(m_owner->m_client.m_stmt_scratch.send_iovecs);
     m_iovecs.reserve(1);
 }
 
+MysqlStmtExecuteAwaitable::ProtocolSendAwaitable::~ProtocolSendAwaitable()
+{
+    detail::returnScratch(m_owner->m_client.m_stmt_scratch.send_iovecs, m_iovecs);
+}
+
 void MysqlStmtExecuteAwaitable::ProtocolSendAwaitable::syncSendIovecs()
 {
+    if (m_owner->m_sent == 0 && m_owner->m_cancel.requested()) {
+        // 尚未发出任何字节，直接放弃，连接仍在边界上
+        m_owner->setError(detail::cancelledBeforeSend());
+        m_iovecs.clear();
+        return;
+    }
     detail::syncSendWindow(m_owner->m_encoded_cmd, m_owner->m_sent, m_buffer, m_length);
     m_iovecs.clear();
     if (m_length == 0 || m_buffer == nullptr) {
@@ -1397,7 +1558,10 @@ bool MysqlStmtExecuteAwaitable::ProtocolSendAwaitable::handleSendResult()
         m_owner->m_encoded_cmd.size(),
         [&](const IOError& io_error) { m_owner->setSendError(io_error); },
         [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_SEND, "Send returned 0 bytes")); },
-        [&]() { m_owner->m_client.m_ring_buffer.clear(); }
+        [&]() {
+            m_owner->m_client.m_ring_buffer.clear();
+            m_owner->m_cancel.arm();
+        }
     );
 }
 
@@ -1411,6 +1575,9 @@ bool MysqlStmtExecuteAwaitable::ProtocolSendAwaitable::handleComplete(struct io_
     syncSendIovecs();
     if (m_iovecs.empty()) {
         m_owner->m_client.m_ring_buffer.clear();
+        if (m_owner->m_lifecycle == Lifecycle::Running) {
+            m_owner->m_cancel.arm();
+        }
         return true;
     }
 
@@ -1430,6 +1597,9 @@ bool MysqlStmtExecuteAwaitable::ProtocolSendAwaitable::handleComplete(GHandle ha
         syncSendIovecs();
         if (m_iovecs.empty()) {
             m_owner->m_client.m_ring_buffer.clear();
+            if (m_owner->m_lifecycle == Lifecycle::Running) {
+                m_owner->m_cancel.arm();
+            }
             return true;
         }
 
@@ -1449,9 +1619,15 @@ MysqlStmtExecuteAwaitable::ProtocolRecvAwaitable::ProtocolRecvAwaitable(MysqlStm
     : ReadvIOContext({})
     , m_owner(owner)
 {
+    m_iovecs.swap(m_owner->m_client.m_stmt_scratch.recv_iovecs);
     m_iovecs.reserve(2);
 }
 
+MysqlStmtExecuteAwaitable::ProtocolRecvAwaitable::~ProtocolRecvAwaitable()
+{
+    detail::returnScratch(m_owner->m_client.m_stmt_scratch.recv_iovecs, m_iovecs);
+}
+
 bool MysqlStmtExecuteAwaitable::ProtocolRecvAwaitable::prepareRecvWindow()
 {
     if (!detail::prepareRecvWindow(m_owner->m_client.m_ring_buffer, m_iovecs)) {
@@ -1535,42 +1711,58 @@ MysqlStmtExecuteAwaitable::MysqlStmtExecuteAwaitable(AsyncMysqlClient& client, s
     , m_client(client)
     , m_encoded_cmd(std::move(encoded_cmd))
     , m_lifecycle(Lifecycle::Running)
-    , m_state(State::ReceivingHeader)
     , m_sent(0)
-    , m_result_set()
-    , m_column_count(0)
-    , m_columns_received(0)
+    , m_result_set(std::move(client.m_result_arena))
     , m_send_awaitable(this)
     , m_recv_awaitable(this)
     , m_chain_error(std::nullopt)
+    , m_parse_scratch(std::move(client.m_stmt_scratch.parse_scratch))
     , m_result(std::nullopt)
 {
+    m_result_set.clear();
     if (m_client.m_config.result_row_reserve_hint > 0) {
         m_result_set.reserveRows(m_client.m_config.result_row_reserve_hint);
     }
+    m_decoder.reset(m_client.m_server_capabilities, protocol::MysqlRowFormat::Binary);
+    if (auto busy = m_client.checkIdle()) {
+        setError(std::move(*busy));
+        return;
+    }
     addTask(IOEventType::SEND, &m_send_awaitable);
     addTask(IOEventType::READV, &m_recv_awaitable);
 }
 
+MysqlStmtExecuteAwaitable::~MysqlStmtExecuteAwaitable()
+{
+    detail::returnScratch(m_client.m_stmt_scratch.encoded, m_encoded_cmd);
+    detail::returnScratch(m_client.m_stmt_scratch.parse_scratch, m_parse_scratch);
+    detail::returnResultSet(m_client.m_result_arena, m_result_set);
+}
+
 void MysqlStmtExecuteAwaitable::reset() noexcept
 {
     m_lifecycle = Lifecycle::Invalid;
-    m_state = State::ReceivingHeader;
-    m_result_set = MysqlResultSet{};
-    if (m_client.m_config.result_row_reserve_hint > 0) {
-        m_result_set.reserveRows(m_client.m_config.result_row_reserve_hint);
-    }
+    m_draining = false;
+    m_cancelled = false;
+    m_cancel.release();
+    m_decoder.reset(m_client.m_server_capabilities, protocol::MysqlRowFormat::Binary);
+    m_result_set.clear();
     m_sent = 0;
-    m_column_count = 0;
-    m_columns_received = 0;
     m_chain_error.reset();
     m_result = std::nullopt;
 }
 
+MysqlStmtExecuteAwaitable& MysqlStmtExecuteAwaitable::cancelOn(MysqlCancellationToken token)
+{
+    m_cancel.bind(m_client, std::move(token));
+    return *this;
+}
+
 void MysqlStmtExecuteAwaitable::setError(MysqlError error) noexcept
 {
     m_chain_error = std::move(error);
     m_lifecycle = Lifecycle::Invalid;
+    m_cancel.complete();
 }
 
 void MysqlStmtExecuteAwaitable::setSendError(const IOError& io_error) noexcept
@@ -1586,129 +1778,45 @@ void MysqlStmtExecuteAwaitable::setRecvError(const IOError& io_error) noexcept
 std::expected<bool, MysqlError> MysqlStmtExecuteAwaitable::tryParseFromRingBuffer()
 {
     while (true) {
-        struct iovec read_iovecs[2];
-        const size_t read_iovecs_count = m_client.m_ring_buffer.getReadIovecs(read_iovecs, 2);
-        if (read_iovecs_count == 0) {
-            return false;
+        if (!m_cancelled && m_cancel.requested()) {
+            m_cancelled = true;
+            m_draining = true;
         }
-
-        auto linear = detail::linearizeReadIovecs(
-            std::span<const struct iovec>(read_iovecs, read_iovecs_count),
-            m_parse_scratch);
-        const char* data = linear.data();
-        size_t len = linear.size();
-
         size_t consumed = 0;
-        auto pkt = m_client.m_parser.extractPacket(data, len, consumed);
-        if (!pkt) {
-            if (pkt.error() == protocol::ParseError::Incomplete) {
-                return false;
-            }
-            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Parse stmt-execute packet failed"));
+        auto event = detail::nextResultEvent(m_client.m_ring_buffer, m_decoder, m_parse_scratch, consumed);
+        if (!event) {
+            m_client.m_ring_buffer.consume(consumed);
+            return std::unexpected(std::move(event.error()));
+        }
+        if (event->type == protocol::MysqlResultEventType::NeedMore) {
+            return false;
         }
 
-        const uint8_t first_byte = static_cast<uint8_t>(pkt->payload[0]);
-        const uint32_t caps = m_client.m_server_capabilities;
-
-        if (m_state == State::ReceivingHeader) {
-            if (first_byte == 0xFF) {
-                auto err = m_client.m_parser.parseErr(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (err) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-                }
-                return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Execute failed"));
-            }
-
-            if (first_byte == 0x00) {
-                auto ok = m_client.m_parser.parseOk(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (!ok) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse OK packet"));
-                }
-                m_result_set.setAffectedRows(ok->affected_rows);
-                m_result_set.setLastInsertId(ok->last_insert_id);
-                m_result_set.setWarnings(ok->warnings);
-                m_result_set.setStatusFlags(ok->status_flags);
+        // CALL返回的后续结果集（含最终OK）读完丢弃
+        if (m_draining) {
+            m_client.m_ring_buffer.consume(consumed);
+            if (event->endsResponse()) {
                 m_lifecycle = Lifecycle::Done;
+                m_cancel.complete();
                 return true;
             }
-
-            size_t int_consumed = 0;
-            auto col_count = protocol::readLenEncInt(pkt->payload, pkt->payload_len, int_consumed);
-            if (!col_count) {
-                m_client.m_ring_buffer.consume(consumed);
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column count"));
-            }
-            m_column_count = col_count.value();
-            m_columns_received = 0;
-            m_result_set.reserveFields(static_cast<size_t>(m_column_count));
-            m_client.m_ring_buffer.consume(consumed);
-            m_state = State::ReceivingColumns;
-            continue;
-        }
-
-        if (m_state == State::ReceivingColumns) {
-            auto col = m_client.m_parser.parseColumnDefinition(pkt->payload, pkt->payload_len);
-            m_client.m_ring_buffer.consume(consumed);
-            if (!col) {
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Parse column definition failed"));
-            }
-
-            MysqlField field(col->name,
-                             static_cast<MysqlFieldType>(col->column_type),
-                             col->flags,
-                             col->column_length,
-                             col->decimals);
-            field.setCatalog(col->catalog);
-            field.setSchema(col->schema);
-            field.setTable(col->table);
-            field.setOrgTable(col->org_table);
-            field.setOrgName(col->org_name);
-            field.setCharacterSet(col->character_set);
-            m_result_set.addField(std::move(field));
-
-            ++m_columns_received;
-            if (m_columns_received >= m_column_count) {
-                m_state = (caps & protocol::CLIENT_DEPRECATE_EOF)
-                    ? State::ReceivingRows
-                    : State::ReceivingColumnEof;
-            }
             continue;
         }
 
-        if (m_state == State::ReceivingColumnEof) {
-            m_client.m_ring_buffer.consume(consumed);
-            m_state = State::ReceivingRows;
-            continue;
+        auto done = m_decoder.apply(*event, m_result_set);
+        m_client.m_ring_buffer.consume(consumed);
+        if (!done) {
+            return std::unexpected(std::move(done.error()));
         }
-
-        if (m_state == State::ReceivingRows) {
-            if (first_byte == 0xFE && pkt->payload_len < 0xFFFFFF) {
-                m_client.m_ring_buffer.consume(consumed);
-                m_lifecycle = Lifecycle::Done;
-                return true;
-            }
-
-            if (first_byte == 0xFF) {
-                auto err = m_client.m_parser.parseErr(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (err) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-                }
-                return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Error during row fetch"));
-            }
-
-            auto row = m_client.m_parser.parseTextRow(pkt->payload, pkt->payload_len, m_column_count);
-            m_client.m_ring_buffer.consume(consumed);
-            if (!row) {
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Parse row failed"));
+        if (done.value()) {
+            if (event->moreResults()) {
+                m_draining = true;
+                continue;
             }
-            m_result_set.addRow(MysqlRow(std::move(row.value())));
-            continue;
+            m_lifecycle = Lifecycle::Done;
+            m_cancel.complete();
+            return true;
         }
-
-        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Invalid stmt-execute parser state"));
     }
 }
 
@@ -1718,12 +1826,21 @@ std::expected<std::optional<MysqlResultSet>, MysqlError> MysqlStmtExecuteAwaitab
 
     if (!m_result.has_value()) {
         auto err = detail::toTimeoutOrInternalError(m_result.error());
+        m_client.markInterrupted(m_decoder, m_sent, m_encoded_cmd.size(), 1, err.type() == MYSQL_ERROR_TIMEOUT);
         reset();
         return std::unexpected(std::move(err));
     }
 
+    if (m_cancelled && (!m_chain_error.has_value() || m_chain_error->type() == MYSQL_ERROR_SERVER)) {
+        reset();
+        return std::unexpected(detail::cancelledAfterDrain());
+    }
+
     if (m_chain_error.has_value()) {
         auto err = std::move(*m_chain_error);
+        if (detail::leavesConnectionBroken(err)) {
+            m_client.markInterrupted(m_decoder, m_sent, m_encoded_cmd.size(), 1, false);
+        }
         reset();
         return std::unexpected(std::move(err));
     }
@@ -1851,8 +1968,13 @@ bool MysqlPipelineAwaitable::ProtocolSendAwaitable::handleComplete(struct io_uri
     if (m_owner->m_lifecycle != Lifecycle::Running) {
         return true;
     }
+    if (m_owner->m_sent_bytes == 0 && m_owner->m_cancel.requested()) {
+        m_owner->setError(detail::cancelledBeforeSend());
+        return true;
+    }
 
     if (pendingIovCount() == 0) {
+        m_owner->m_cancel.arm();
         return true;
     }
     if (cqe == nullptr) {
@@ -1874,11 +1996,16 @@ bool MysqlPipelineAwaitable::ProtocolSendAwaitable::handleComplete(struct io_uri
         return true;
     }
 
+    m_owner->m_sent_bytes += sent;
     if (!advanceAfterWrite(sent)) {
         m_owner->setSendError(IOError(galay::kernel::kSendFailed, 0));
         return true;
     }
-    return pendingIovCount() == 0;
+    if (pendingIovCount() != 0) {
+        return false;
+    }
+    m_owner->m_cancel.arm();
+    return true;
 }
 #else
 bool MysqlPipelineAwaitable::ProtocolSendAwaitable::handleComplete(GHandle handle)
@@ -1886,10 +2013,15 @@ bool MysqlPipelineAwaitable::ProtocolSendAwaitable::handleComplete(GHandle handl
     if (m_owner->m_lifecycle != Lifecycle::Running) {
         return true;
     }
+    if (m_owner->m_sent_bytes == 0 && m_owner->m_cancel.requested()) {
+        m_owner->setError(detail::cancelledBeforeSend());
+        return true;
+    }
 
     while (true) {
         const int iov_count = pendingIovCount();
         if (iov_count == 0) {
+            m_owner->m_cancel.arm();
             return true;
         }
 
@@ -1910,6 +2042,7 @@ bool MysqlPipelineAwaitable::ProtocolSendAwaitable::handleComplete(GHandle handl
             return true;
         }
 
+        m_owner->m_sent_bytes += sent;
         if (!advanceAfterWrite(sent)) {
             m_owner->setSendError(IOError(galay::kernel::kSendFailed, 0));
             return true;
@@ -2019,11 +2152,8 @@ MysqlPipelineAwaitable::MysqlPipelineAwaitable(AsyncMysqlClient& client,
     , m_client(client)
     , m_expected_results(commands.size())
     , m_lifecycle(commands.empty() ? Lifecycle::Done : Lifecycle::Running)
-    , m_state(State::ReceivingHeader)
     , m_results()
     , m_current_result()
-    , m_column_count(0)
-    , m_columns_received(0)
     , m_send_awaitable(this)
     , m_recv_awaitable(this)
     , m_chain_error(std::nullopt)
@@ -2033,6 +2163,12 @@ MysqlPipelineAwaitable::MysqlPipelineAwaitable(AsyncMysqlClient& client,
     if (m_client.m_config.result_row_reserve_hint > 0) {
         m_current_result.reserveRows(m_client.m_config.result_row_reserve_hint);
     }
+    if (!commands.empty()) {
+        if (auto busy = m_client.checkIdle()) {
+            setError(std::move(*busy));
+            return;
+        }
+    }
 
     size_t encoded_bytes = 0;
     for (const auto& cmd : commands) {
@@ -2048,8 +2184,12 @@ MysqlPipelineAwaitable::MysqlPipelineAwaitable(AsyncMysqlClient& client,
     for (const auto& cmd : commands) {
         const size_t offset = m_encoded_buffer.size();
         m_encoded_buffer.append(cmd.encoded.data(), cmd.encoded.size());
-        m_encoded_slices.push_back(EncodedSlice{offset, cmd.encoded.size()});
+        const auto format = cmd.kind == protocol::MysqlCommandKind::StmtExecute
+            ? protocol::MysqlRowFormat::Binary
+            : protocol::MysqlRowFormat::Text;
+        m_encoded_slices.push_back(EncodedSlice{offset, cmd.encoded.size(), format});
     }
+    resetDecoder();
 
     if (m_lifecycle == Lifecycle::Running) {
         initTaskQueue();
@@ -2064,22 +2204,35 @@ void MysqlPipelineAwaitable::initTaskQueue()
     addTask(IOEventType::READV, &m_recv_awaitable);
 }
 
+void MysqlPipelineAwaitable::resetDecoder() noexcept
+{
+    // 每条命令按自身的行格式解码：COM_STMT_EXECUTE为二进制行
+    const size_t index = m_commands_completed;
+    const auto format = index < m_encoded_slices.size()
+        ? m_encoded_slices[index].format
+        : protocol::MysqlRowFormat::Text;
+    m_decoder.reset(m_client.m_server_capabilities, format);
+}
+
 void MysqlPipelineAwaitable::resetCurrentResult()
 {
-    m_state = State::ReceivingHeader;
     m_current_result = MysqlResultSet{};
     if (m_client.m_config.result_row_reserve_hint > 0) {
         m_current_result.reserveRows(m_client.m_config.result_row_reserve_hint);
     }
-    m_column_count = 0;
-    m_columns_received = 0;
+    resetDecoder();
 }
 
-void MysqlPipelineAwaitable::finalizeCurrentResult()
+void MysqlPipelineAwaitable::finalizeCurrentResult(bool more_results)
 {
+    // 一条命令可能返回多个结果集（多语句、CALL），按到达顺序全部收集
     m_results.push_back(std::move(m_current_result));
-    if (m_results.size() >= m_expected_results) {
+    if (!more_results) {
+        ++m_commands_completed;
+    }
+    if (m_commands_completed >= m_expected_results) {
         m_lifecycle = Lifecycle::Done;
+        m_cancel.complete();
         return;
     }
     resetCurrentResult();
@@ -2088,14 +2241,16 @@ void MysqlPipelineAwaitable::finalizeCurrentResult()
 void MysqlPipelineAwaitable::reset() noexcept
 {
     m_lifecycle = Lifecycle::Invalid;
-    m_state = State::ReceivingHeader;
     m_expected_results = 0;
+    m_commands_completed = 0;
+    m_sent_bytes = 0;
+    m_cancelled = false;
+    m_cancel.release();
     m_encoded_buffer.clear();
     m_encoded_slices.clear();
     m_results.clear();
     m_current_result = MysqlResultSet{};
-    m_column_count = 0;
-    m_columns_received = 0;
+    resetDecoder();
     m_chain_error.reset();
     m_parse_scratch.clear();
     m_tasks.clear();
@@ -2105,10 +2260,17 @@ void MysqlPipelineAwaitable::reset() noexcept
     m_recv_awaitable.rebind(this);
 }
 
+MysqlPipelineAwaitable& MysqlPipelineAwaitable::cancelOn(MysqlCancellationToken token)
+{
+    m_cancel.bind(m_client, std::move(token));
+    return *this;
+}
+
 void MysqlPipelineAwaitable::setError(MysqlError error) noexcept
 {
     m_chain_error = std::move(error);
     m_lifecycle = Lifecycle::Invalid;
+    m_cancel.complete();
 }
 
 void MysqlPipelineAwaitable::setSendError(const IOError& io_error) noexcept
@@ -2131,150 +2293,46 @@ void MysqlPipelineAwaitable::setRecvError(const IOError& io_error) noexcept
 
 std::expected<bool, MysqlError> MysqlPipelineAwaitable::tryParseFromRingBuffer()
 {
-    while (m_results.size() < m_expected_results) {
-        struct iovec read_iovecs[2];
-        const size_t read_iovecs_count = m_client.m_ring_buffer.getReadIovecs(read_iovecs, 2);
-        if (read_iovecs_count == 0) {
-            return false;
+    while (m_commands_completed < m_expected_results) {
+        if (!m_cancelled && m_cancel.requested()) {
+            m_cancelled = true;
         }
-
-        auto linear = detail::linearizeReadIovecs(
-            std::span<const struct iovec>(read_iovecs, read_iovecs_count),
-            m_parse_scratch);
-        const char* data = linear.data();
-        size_t len = linear.size();
-
         size_t consumed = 0;
-        auto pkt = m_client.m_parser.extractPacket(data, len, consumed);
-        if (!pkt) {
-            if (pkt.error() == protocol::ParseError::Incomplete) {
-                return false;
-            }
-            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Parse pipeline packet failed"));
-        }
-
-        const uint8_t first_byte = static_cast<uint8_t>(pkt->payload[0]);
-        const uint32_t caps = m_client.m_server_capabilities;
-
-        if (m_state == State::ReceivingHeader) {
-            if (first_byte == 0xFF) {
-                auto err = m_client.m_parser.parseErr(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (err) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-                }
-                return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Pipeline query failed"));
-            }
-
-            if (first_byte == 0x00) {
-                auto ok = m_client.m_parser.parseOk(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (!ok) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse OK packet"));
-                }
-
-                m_current_result.setAffectedRows(ok->affected_rows);
-                m_current_result.setLastInsertId(ok->last_insert_id);
-                m_current_result.setWarnings(ok->warnings);
-                m_current_result.setStatusFlags(ok->status_flags);
-                m_current_result.setInfo(ok->info);
-                finalizeCurrentResult();
+        auto event = detail::nextResultEvent(m_client.m_ring_buffer, m_decoder, m_parse_scratch, consumed);
+        if (!event) {
+            m_client.m_ring_buffer.consume(consumed);
+            if (m_cancelled && event.error().type() == MYSQL_ERROR_SERVER) {
+                // 被KILL的命令以ERR结束，继续丢弃后续命令的响应
+                ++m_commands_completed;
+                resetDecoder();
                 continue;
             }
-
-            size_t int_consumed = 0;
-            auto col_count = protocol::readLenEncInt(pkt->payload, pkt->payload_len, int_consumed);
-            if (!col_count) {
-                m_client.m_ring_buffer.consume(consumed);
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column count"));
-            }
-
-            m_column_count = col_count.value();
-            m_columns_received = 0;
-            m_current_result.reserveFields(static_cast<size_t>(m_column_count));
-            m_client.m_ring_buffer.consume(consumed);
-            m_state = State::ReceivingColumns;
-            continue;
+            return std::unexpected(std::move(event.error()));
         }
-
-        if (m_state == State::ReceivingColumns) {
-            auto col = m_client.m_parser.parseColumnDefinition(pkt->payload, pkt->payload_len);
+        if (event->type == protocol::MysqlResultEventType::NeedMore) {
+            return false;
+        }
+        if (m_cancelled) {
             m_client.m_ring_buffer.consume(consumed);
-            if (!col) {
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column definition"));
-            }
-
-            MysqlField field(col->name,
-                             static_cast<MysqlFieldType>(col->column_type),
-                             col->flags,
-                             col->column_length,
-                             col->decimals);
-            field.setCatalog(col->catalog);
-            field.setSchema(col->schema);
-            field.setTable(col->table);
-            field.setOrgTable(col->org_table);
-            field.setOrgName(col->org_name);
-            field.setCharacterSet(col->character_set);
-            m_current_result.addField(std::move(field));
-
-            ++m_columns_received;
-            if (m_columns_received >= m_column_count) {
-                m_state = (caps & protocol::CLIENT_DEPRECATE_EOF)
-                    ? State::ReceivingRows
-                    : State::ReceivingColumnEof;
+            if (event->endsResponse()) {
+                ++m_commands_completed;
+                resetDecoder();
             }
             continue;
         }
 
-        if (m_state == State::ReceivingColumnEof) {
-            m_client.m_ring_buffer.consume(consumed);
-            m_state = State::ReceivingRows;
-            continue;
+        auto done = m_decoder.apply(*event, m_current_result);
+        m_client.m_ring_buffer.consume(consumed);
+        if (!done) {
+            return std::unexpected(std::move(done.error()));
         }
-
-        if (m_state == State::ReceivingRows) {
-            if (first_byte == 0xFE && pkt->payload_len < 0xFFFFFF) {
-                if (caps & protocol::CLIENT_DEPRECATE_EOF) {
-                    auto ok = m_client.m_parser.parseOk(pkt->payload, pkt->payload_len, caps);
-                    if (ok) {
-                        m_current_result.setWarnings(ok->warnings);
-                        m_current_result.setStatusFlags(ok->status_flags);
-                    }
-                } else {
-                    auto eof = m_client.m_parser.parseEof(pkt->payload, pkt->payload_len);
-                    if (eof) {
-                        m_current_result.setWarnings(eof->warnings);
-                        m_current_result.setStatusFlags(eof->status_flags);
-                    }
-                }
-
-                m_client.m_ring_buffer.consume(consumed);
-                finalizeCurrentResult();
-                continue;
-            }
-
-            if (first_byte == 0xFF) {
-                auto err = m_client.m_parser.parseErr(pkt->payload, pkt->payload_len, caps);
-                m_client.m_ring_buffer.consume(consumed);
-                if (err) {
-                    return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-                }
-                return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Pipeline row fetch failed"));
-            }
-
-            auto row = m_client.m_parser.parseTextRow(pkt->payload, pkt->payload_len, m_column_count);
-            m_client.m_ring_buffer.consume(consumed);
-            if (!row) {
-                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse text row"));
-            }
-            m_current_result.addRow(MysqlRow(std::move(row.value())));
-            continue;
+        if (done.value()) {
+            finalizeCurrentResult(event->moreResults());
         }
-
-        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Invalid pipeline parser state"));
     }
 
     m_lifecycle = Lifecycle::Done;
+    m_cancel.complete();
     return true;
 }
 
@@ -2284,12 +2342,24 @@ std::expected<std::optional<std::vector<MysqlResultSet>>, MysqlError> MysqlPipel
 
     if (!m_result.has_value()) {
         auto err = detail::toTimeoutOrInternalError(m_result.error());
+        m_client.markInterrupted(m_decoder, m_sent_bytes, m_encoded_buffer.size(),
+                                 m_expected_results - m_commands_completed,
+                                 err.type() == MYSQL_ERROR_TIMEOUT);
         reset();
         return std::unexpected(std::move(err));
     }
 
+    if (m_cancelled && (!m_chain_error.has_value() || m_chain_error->type() == MYSQL_ERROR_SERVER)) {
+        reset();
+        return std::unexpected(detail::cancelledAfterDrain());
+    }
+
     if (m_chain_error.has_value()) {
         auto err = std::move(*m_chain_error);
+        if (detail::leavesConnectionBroken(err)) {
+            m_client.markInterrupted(m_decoder, m_sent_bytes, m_encoded_buffer.size(),
+                                     m_expected_results - m_commands_completed, false);
+        }
         reset();
         return std::unexpected(std::move(err));
     }
@@ -2304,81 +2374,963 @@ std::expected<std::optional<std::vector<MysqlResultSet>>, MysqlError> MysqlPipel
     return std::optional<std::vector<MysqlResultSet>>(std::move(results));
 }
 
-// ======================== AsyncMysqlClient 实现 ========================
+// ======================== MysqlLocalInfileAwaitable ========================
 
-AsyncMysqlClient::AsyncMysqlClient(IOScheduler* scheduler,
-                                   AsyncMysqlConfig config,
-                                   std::shared_ptr<MysqlBufferProvider> buffer_provider)
-    : m_scheduler(scheduler)
-    , m_config(std::move(config))
-    , m_ring_buffer(m_config.buffer_size, std::move(buffer_provider))
+MysqlLocalInfileAwaitable::ProtocolSendAwaitable::ProtocolSendAwaitable(MysqlLocalInfileAwaitable* owner)
+    : WritevIOContext({})
+    , m_owner(owner)
 {
-    m_logger = MysqlLog::getInstance()->getLogger();
+    m_iovecs.reserve(1);
 }
 
-AsyncMysqlClient::AsyncMysqlClient(AsyncMysqlClient&& other) noexcept
-    : m_is_closed(other.m_is_closed)
-    , m_socket(std::move(other.m_socket))
-    , m_scheduler(other.m_scheduler)
-    , m_parser(std::move(other.m_parser))
-    , m_encoder(std::move(other.m_encoder))
-    , m_config(std::move(other.m_config))
-    , m_ring_buffer(std::move(other.m_ring_buffer))
-    , m_server_capabilities(other.m_server_capabilities)
-    , m_logger(std::move(other.m_logger))
+void MysqlLocalInfileAwaitable::ProtocolSendAwaitable::syncSendIovecs()
 {
-    other.m_is_closed = true;
+    const auto window = m_owner->sendWindow();
+    m_iovecs.clear();
+    if (window.empty()) {
+        return;
+    }
+    m_iovecs.push_back(iovec{const_cast<char*>(window.data()), window.size()});
 }
 
-AsyncMysqlClient& AsyncMysqlClient::operator=(AsyncMysqlClient&& other) noexcept
+bool MysqlLocalInfileAwaitable::ProtocolSendAwaitable::handleSendResult()
 {
-    if (this != &other) {
-        m_is_closed = other.m_is_closed;
-        m_socket = std::move(other.m_socket);
-        m_scheduler = other.m_scheduler;
-        m_parser = std::move(other.m_parser);
-        m_encoder = std::move(other.m_encoder);
-        m_config = std::move(other.m_config);
-        m_ring_buffer = std::move(other.m_ring_buffer);
-        m_server_capabilities = other.m_server_capabilities;
-        m_logger = std::move(other.m_logger);
-        other.m_is_closed = true;
+    if (!m_result.has_value()) {
+        m_owner->setSendError(m_result.error());
+        return true;
     }
-    return *this;
+    if (m_result.value() == 0) {
+        m_owner->setError(MysqlError(MYSQL_ERROR_SEND, "Send returned 0 bytes"));
+        return true;
+    }
+    return m_owner->advanceSend(m_result.value());
 }
 
-MysqlConnectAwaitable AsyncMysqlClient::connect(MysqlConfig config)
+#ifdef USE_IOURING
+bool MysqlLocalInfileAwaitable::ProtocolSendAwaitable::handleComplete(struct io_uring_cqe* cqe, GHandle handle)
 {
-    return MysqlConnectAwaitable(*this, std::move(config));
+    if (m_owner->m_lifecycle != Lifecycle::Running) {
+        return true;
+    }
+
+    syncSendIovecs();
+    if (m_iovecs.empty()) {
+        return true;
+    }
+
+    if (cqe == nullptr) {
+        return false;
+    }
+
+    if (!WritevIOContext::handleComplete(cqe, handle)) {
+        return false;
+    }
+    return handleSendResult();
 }
+#else
+bool MysqlLocalInfileAwaitable::ProtocolSendAwaitable::handleComplete(GHandle handle)
+{
+    while (m_owner->m_lifecycle == Lifecycle::Running) {
+        syncSendIovecs();
+        if (m_iovecs.empty()) {
+            return true;
+        }
 
-MysqlConnectAwaitable AsyncMysqlClient::connect(std::string_view host, uint16_t port,
-                                                std::string_view user, std::string_view password,
-                                                std::string_view database)
+        if (!WritevIOContext::handleComplete(handle)) {
+            return false;
+        }
+        if (handleSendResult()) {
+            return true;
+        }
+    }
+    return true;
+}
+#endif
+
+MysqlLocalInfileAwaitable::ProtocolRecvAwaitable::ProtocolRecvAwaitable(MysqlLocalInfileAwaitable* owner)
+    : ReadvIOContext({})
+    , m_owner(owner)
 {
-    MysqlConfig config;
-    config.host.assign(host.data(), host.size());
-    config.port = port;
-    config.username.assign(user.data(), user.size());
-    config.password.assign(password.data(), password.size());
-    config.database.assign(database.data(), database.size());
-    return connect(std::move(config));
+    m_iovecs.reserve(2);
 }
 
-MysqlQueryAwaitable AsyncMysqlClient::query(std::string_view sql)
+bool MysqlLocalInfileAwaitable::ProtocolRecvAwaitable::prepareRecvWindow()
 {
-    return MysqlQueryAwaitable(*this, sql);
+    if (!detail::prepareRecvWindow(m_owner->m_client.m_ring_buffer, m_iovecs)) {
+        m_owner->setError(MysqlError(MYSQL_ERROR_RECV, "No writable ring buffer space"));
+        return false;
+    }
+    return true;
 }
 
-MysqlPipelineAwaitable AsyncMysqlClient::batch(std::span<const protocol::MysqlCommandView> commands)
+bool MysqlLocalInfileAwaitable::ProtocolRecvAwaitable::tryParseAndCheckDone()
 {
-    return MysqlPipelineAwaitable(*this, commands);
+    return detail::parseOrSetError(
+        [&]() { return m_owner->tryParseFromRingBuffer(); },
+        [&](MysqlError err) { m_owner->setError(std::move(err)); }
+    );
 }
 
-MysqlPipelineAwaitable AsyncMysqlClient::pipeline(std::span<const std::string_view> sqls)
+bool MysqlLocalInfileAwaitable::ProtocolRecvAwaitable::handleReadResult()
 {
-    size_t reserve_bytes = 0;
-    for (const auto sql : sqls) {
+    return detail::handleReadResult(
+        m_result,
+        m_owner->m_client.m_ring_buffer,
+        [&](const IOError& io_error) { m_owner->setRecvError(io_error); },
+        [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Connection closed")); },
+        [&]() { return m_owner->tryParseFromRingBuffer(); },
+        [&](MysqlError err) { m_owner->setError(std::move(err)); }
+    );
+}
+
+#ifdef USE_IOURING
+bool MysqlLocalInfileAwaitable::ProtocolRecvAwaitable::handleComplete(struct io_uring_cqe* cqe, GHandle handle)
+{
+    if (m_owner->m_lifecycle != Lifecycle::Running) {
+        return true;
+    }
+
+    if (tryParseAndCheckDone()) {
+        return true;
+    }
+
+    if (!prepareRecvWindow()) {
+        return true;
+    }
+
+    if (cqe == nullptr) {
+        return false;
+    }
+
+    if (!ReadvIOContext::handleComplete(cqe, handle)) {
+        return false;
+    }
+    return handleReadResult();
+}
+#else
+bool MysqlLocalInfileAwaitable::ProtocolRecvAwaitable::handleComplete(GHandle handle)
+{
+    while (m_owner->m_lifecycle == Lifecycle::Running) {
+        if (tryParseAndCheckDone()) {
+            return true;
+        }
+
+        if (!prepareRecvWindow()) {
+            return true;
+        }
+
+        if (!ReadvIOContext::handleComplete(handle)) {
+            return false;
+        }
+
+        if (handleReadResult()) {
+            return true;
+        }
+    }
+    return true;
+}
+#endif
+
+MysqlLocalInfileAwaitable::MysqlLocalInfileAwaitable(AsyncMysqlClient& client,
+                                                     std::string_view sql,
+                                                     MysqlLocalInfileSource source)
+    : CustomAwaitable(client.m_socket.controller())
+    , m_client(client)
+    , m_encoded_cmd(detail::buildSingleCommandPacket(protocol::CommandType::COM_QUERY,
+                                                     sql,
+                                                     protocol::MysqlCommandKind::Query))
+    , m_lifecycle(Lifecycle::Running)
+    , m_source(std::move(source))
+    , m_command_send(this)
+    , m_request_recv(this)
+    , m_data_send(this)
+    , m_result_recv(this)
+    , m_result(std::nullopt)
+{
+    m_decoder.reset(m_client.m_server_capabilities, protocol::MysqlRowFormat::Text);
+    if (!(m_client.m_server_capabilities & protocol::CLIENT_LOCAL_FILES)) {
+        setError(MysqlError(MYSQL_ERROR_INVALID_PARAM,
+                            "LOCAL INFILE is disabled, set MysqlConfig::allow_local_infile"));
+        return;
+    }
+    if (auto busy = m_client.checkIdle()) {
+        setError(std::move(*busy));
+        return;
+    }
+    addTask(IOEventType::SEND, &m_command_send);
+    addTask(IOEventType::READV, &m_request_recv);
+    addTask(IOEventType::SEND, &m_data_send);
+    addTask(IOEventType::READV, &m_result_recv);
+}
+
+std::string_view MysqlLocalInfileAwaitable::sendWindow()
+{
+    if (m_phase == Phase::SendCommand) {
+        return std::string_view(m_encoded_cmd).substr(std::min(m_sent, m_encoded_cmd.size()));
+    }
+    if (m_phase != Phase::SendData) {
+        return {};
+    }
+    if (m_chunk_sent >= m_chunk.size()) {
+        if (m_data_finished) {
+            return {};
+        }
+        refillChunk();
+    }
+    return std::string_view(m_chunk).substr(m_chunk_sent);
+}
+
+void MysqlLocalInfileAwaitable::refillChunk()
+{
+    // 数据直接读进包体，头部在读完后回填；读到0字节即为结束传输的空包
+    const size_t capacity = m_source.chunkBytes();
+    m_chunk.resize(protocol::MYSQL_PACKET_HEADER_SIZE + capacity);
+    size_t length = 0;
+    if (!m_source_error.has_value()) {
+        auto n = m_source.read(m_chunk.data() + protocol::MYSQL_PACKET_HEADER_SIZE, capacity);
+        if (n) {
+            length = std::min(n.value(), capacity);
+        } else {
+            m_source_error = std::move(n.error());
+        }
+    }
+    m_chunk.resize(protocol::MYSQL_PACKET_HEADER_SIZE + length);
+    m_chunk[0] = static_cast<char>(length & 0xFF);
+    m_chunk[1] = static_cast<char>((length >> 8) & 0xFF);
+    m_chunk[2] = static_cast<char>((length >> 16) & 0xFF);
+    m_chunk[3] = static_cast<char>(m_sequence_id++);
+    m_chunk_sent = 0;
+    m_data_finished = length == 0;
+}
+
+bool MysqlLocalInfileAwaitable::advanceSend(size_t sent_bytes)
+{
+    if (m_phase == Phase::SendCommand) {
+        m_sent += sent_bytes;
+        if (m_sent < m_encoded_cmd.size()) {
+            return false;
+        }
+        m_client.m_ring_buffer.clear();
+        m_phase = Phase::AwaitRequest;
+        return true;
+    }
+
+    m_chunk_sent += sent_bytes;
+    if (m_chunk_sent < m_chunk.size() || !m_data_finished) {
+        return false;
+    }
+    m_phase = Phase::AwaitResult;
+    return true;
+}
+
+void MysqlLocalInfileAwaitable::reset() noexcept
+{
+    m_lifecycle = Lifecycle::Invalid;
+    m_phase = Phase::SendCommand;
+    m_sent = 0;
+    m_chunk.clear();
+    m_chunk_sent = 0;
+    m_data_finished = false;
+    m_source_error.reset();
+    m_decoder.reset(m_client.m_server_capabilities, protocol::MysqlRowFormat::Text);
+    m_result_set.clear();
+    m_draining = false;
+    m_chain_error.reset();
+    m_result = std::nullopt;
+}
+
+void MysqlLocalInfileAwaitable::setError(MysqlError error) noexcept
+{
+    m_chain_error = std::move(error);
+    m_lifecycle = Lifecycle::Invalid;
+}
+
+void MysqlLocalInfileAwaitable::setSendError(const IOError& io_error) noexcept
+{
+    MysqlLogDebug(m_client.m_logger, "send local infile failed: {}", io_error.message());
+    setError(MysqlError(MYSQL_ERROR_SEND, io_error.message()));
+}
+
+void MysqlLocalInfileAwaitable::setRecvError(const IOError& io_error) noexcept
+{
+    MysqlLogDebug(m_client.m_logger, "recv local infile failed: {}", io_error.message());
+    setError(MysqlError(MYSQL_ERROR_RECV, io_error.message()));
+}
+
+std::expected<bool, MysqlError> MysqlLocalInfileAwaitable::tryParseFromRingBuffer()
+{
+    while (true) {
+        size_t consumed = 0;
+        auto event = detail::nextResultEvent(m_client.m_ring_buffer, m_decoder, m_parse_scratch, consumed,
+                                             m_phase == Phase::AwaitRequest);
+        if (!event) {
+            m_client.m_ring_buffer.consume(consumed);
+            return std::unexpected(std::move(event.error()));
+        }
+        if (event->type == protocol::MysqlResultEventType::NeedMore) {
+            return false;
+        }
+
+        if (event->type == protocol::MysqlResultEventType::LocalInfile) {
+            MysqlLogDebug(m_client.m_logger, "server requested local infile '{}'", event->payload);
+            m_sequence_id = static_cast<uint8_t>(event->sequence_id + 1);
+            m_client.m_ring_buffer.consume(consumed);
+            m_phase = Phase::SendData;
+            return true;
+        }
+
+        if (m_draining) {
+            m_client.m_ring_buffer.consume(consumed);
+            if (event->endsResponse()) {
+                m_lifecycle = Lifecycle::Done;
+                return true;
+            }
+            continue;
+        }
+
+        auto done = m_decoder.apply(*event, m_result_set);
+        m_client.m_ring_buffer.consume(consumed);
+        if (!done) {
+            return std::unexpected(std::move(done.error()));
+        }
+        if (done.value()) {
+            if (event->moreResults()) {
+                m_draining = true;
+                continue;
+            }
+            m_lifecycle = Lifecycle::Done;
+            return true;
+        }
+    }
+}
+
+std::expected<std::optional<MysqlResultSet>, MysqlError> MysqlLocalInfileAwaitable::await_resume()
+{
+    onCompleted();
+
+    // 数据传输中途被打断时服务端仍在等待数据，连接无法再回到边界
+    if (!m_result.has_value()) {
+        auto err = detail::toTimeoutOrInternalError(m_result.error());
+        m_client.markInterrupted(m_decoder, m_sent, m_encoded_cmd.size(), 1, false);
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    if (m_chain_error.has_value()) {
+        auto err = std::move(*m_chain_error);
+        if (detail::leavesConnectionBroken(err)) {
+            m_client.markInterrupted(m_decoder, m_sent, m_encoded_cmd.size(), 1, false);
+        }
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    if (m_lifecycle != Lifecycle::Done) {
+        reset();
+        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Local infile awaitable did not reach done state"));
+    }
+
+    if (m_source_error.has_value()) {
+        auto err = std::move(*m_source_error);
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    auto result = std::move(m_result_set);
+    reset();
+    return std::optional<MysqlResultSet>(std::move(result));
+}
+
+// ======================== MysqlStmtLongDataAwaitable ========================
+
+MysqlStmtLongDataAwaitable::ProtocolSendAwaitable::ProtocolSendAwaitable(MysqlStmtLongDataAwaitable* owner)
+    : WritevIOContext({})
+    , m_owner(owner)
+{
+    m_iovecs.reserve(1);
+}
+
+void MysqlStmtLongDataAwaitable::ProtocolSendAwaitable::syncSendIovecs()
+{
+    const auto window = m_owner->sendWindow();
+    m_iovecs.clear();
+    if (window.empty()) {
+        return;
+    }
+    m_iovecs.push_back(iovec{const_cast<char*>(window.data()), window.size()});
+}
+
+bool MysqlStmtLongDataAwaitable::ProtocolSendAwaitable::handleSendResult()
+{
+    if (!m_result.has_value()) {
+        m_owner->setSendError(m_result.error());
+        return true;
+    }
+    if (m_result.value() == 0) {
+        m_owner->setError(MysqlError(MYSQL_ERROR_SEND, "Send returned 0 bytes"));
+        return true;
+    }
+    return m_owner->advanceSend(m_result.value());
+}
+
+#ifdef USE_IOURING
+bool MysqlStmtLongDataAwaitable::ProtocolSendAwaitable::handleComplete(struct io_uring_cqe* cqe, GHandle handle)
+{
+    if (m_owner->m_lifecycle != Lifecycle::Running) {
+        return true;
+    }
+
+    syncSendIovecs();
+    if (m_iovecs.empty()) {
+        return true;
+    }
+
+    if (cqe == nullptr) {
+        return false;
+    }
+
+    if (!WritevIOContext::handleComplete(cqe, handle)) {
+        return false;
+    }
+    return handleSendResult();
+}
+#else
+bool MysqlStmtLongDataAwaitable::ProtocolSendAwaitable::handleComplete(GHandle handle)
+{
+    while (m_owner->m_lifecycle == Lifecycle::Running) {
+        syncSendIovecs();
+        if (m_iovecs.empty()) {
+            return true;
+        }
+
+        if (!WritevIOContext::handleComplete(handle)) {
+            return false;
+        }
+        if (handleSendResult()) {
+            return true;
+        }
+    }
+    return true;
+}
+#endif
+
+MysqlStmtLongDataAwaitable::MysqlStmtLongDataAwaitable(AsyncMysqlClient& client,
+                                                       uint32_t stmt_id,
+                                                       uint16_t param_id,
+                                                       MysqlLongDataSource source)
+    : CustomAwaitable(client.m_socket.controller())
+    , m_client(client)
+    , m_stmt_id(stmt_id)
+    , m_param_id(param_id)
+    , m_lifecycle(Lifecycle::Running)
+    , m_source(std::move(source))
+    , m_send_awaitable(this)
+    , m_result(std::nullopt)
+{
+    if (auto busy = m_client.checkIdle()) {
+        setError(std::move(*busy));
+        return;
+    }
+    addTask(IOEventType::SEND, &m_send_awaitable);
+}
+
+std::string_view MysqlStmtLongDataAwaitable::sendWindow()
+{
+    if (m_packet_sent >= m_packet.size() && !m_finished) {
+        refillPacket();
+    }
+    if (m_packet_sent >= m_packet.size()) {
+        // 数据已全部写出，或数据源出错停在包边界上
+        if (!m_source_error.has_value()) {
+            m_lifecycle = Lifecycle::Done;
+        }
+        return {};
+    }
+    return std::string_view(m_packet).substr(m_packet_sent);
+}
+
+void MysqlStmtLongDataAwaitable::refillPacket()
+{
+    // 数据直接读进包体，前缀在读完后回填
+    const size_t capacity = std::min<size_t>(m_source.chunkBytes(), protocol::MYSQL_STMT_LONG_DATA_MAX_CHUNK);
+    m_packet.resize(protocol::MYSQL_STMT_LONG_DATA_PREFIX_SIZE + capacity);
+    size_t length = 0;
+    auto n = m_source.read(m_packet.data() + protocol::MYSQL_STMT_LONG_DATA_PREFIX_SIZE, capacity);
+    if (n) {
+        length = std::min(n.value(), capacity);
+    } else {
+        // 停在包边界上，连接仍可用
+        m_source_error = std::move(n.error());
+        m_finished = true;
+        m_packet.clear();
+        m_packet_sent = 0;
+        return;
+    }
+    m_packet_sent = 0;
+    if (length == 0) {
+        m_finished = true;
+        if (m_packets > 0) {
+            m_packet.clear();
+            return;
+        }
+    }
+    m_packet.resize(protocol::MYSQL_STMT_LONG_DATA_PREFIX_SIZE + length);
+    protocol::MysqlEncoder::writeStmtSendLongDataPrefix(m_packet.data(), m_stmt_id, m_param_id, length, 0);
+    ++m_packets;
+}
+
+bool MysqlStmtLongDataAwaitable::advanceSend(size_t sent_bytes)
+{
+    m_packet_sent += sent_bytes;
+    if (m_packet_sent < m_packet.size() || !m_finished) {
+        return false;
+    }
+    m_lifecycle = Lifecycle::Done;
+    return true;
+}
+
+void MysqlStmtLongDataAwaitable::reset() noexcept
+{
+    m_lifecycle = Lifecycle::Invalid;
+    m_packet.clear();
+    m_packet_sent = 0;
+    m_packets = 0;
+    m_finished = false;
+    m_source_error.reset();
+    m_chain_error.reset();
+    m_result = std::nullopt;
+}
+
+void MysqlStmtLongDataAwaitable::setError(MysqlError error) noexcept
+{
+    m_chain_error = std::move(error);
+    m_lifecycle = Lifecycle::Invalid;
+}
+
+void MysqlStmtLongDataAwaitable::setSendError(const IOError& io_error) noexcept
+{
+    MysqlLogDebug(m_client.m_logger, "send long data failed: {}", io_error.message());
+    setError(MysqlError(MYSQL_ERROR_SEND, io_error.message()));
+}
+
+std::expected<std::optional<bool>, MysqlError> MysqlStmtLongDataAwaitable::await_resume()
+{
+    onCompleted();
+
+    // 没有响应需要读取，只有写到一半的包会让连接失去边界
+    if (!m_result.has_value()) {
+        auto err = detail::toTimeoutOrInternalError(m_result.error());
+        if (midPacket()) {
+            m_client.m_pending.broken = true;
+        }
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    if (m_chain_error.has_value()) {
+        auto err = std::move(*m_chain_error);
+        if (midPacket() || detail::leavesConnectionBroken(err)) {
+            m_client.m_pending.broken = true;
+        }
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    if (m_source_error.has_value()) {
+        auto err = std::move(*m_source_error);
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    if (m_lifecycle != Lifecycle::Done) {
+        reset();
+        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Long data awaitable did not reach done state"));
+    }
+
+    reset();
+    return std::optional<bool>(true);
+}
+
+// ======================== MysqlCancelBinding ========================
+
+/**
+ * @brief 一次在途命令的取消状态，由令牌回调与绑定共享
+ */
+struct MysqlCancelBinding::Flight
+{
+    std::mutex mutex;
+    bool armed = true;
+    uint32_t connection_id = 0;
+    uint64_t generation = 0;
+    AsyncMysqlClient::CancelHook hook;
+};
+
+namespace
+{
+
+std::atomic<uint64_t> g_next_command_generation{1};
+
+} // namespace
+
+void MysqlCancelBinding::bind(AsyncMysqlClient& client, MysqlCancellationToken token)
+{
+    release();
+    m_client = &client;
+    m_token = std::move(token);
+}
+
+void MysqlCancelBinding::arm()
+{
+    if (!m_token.has_value() || m_generation != 0) {
+        return;
+    }
+    const uint64_t generation = g_next_command_generation.fetch_add(1, std::memory_order_relaxed);
+    m_generation = generation;
+    m_client->m_inflight_generation = generation;
+    if (!m_client->m_cancel_hook) {
+        return;
+    }
+    m_flight = std::make_shared<Flight>();
+    m_flight->connection_id = m_client->m_connection_id;
+    m_flight->generation = generation;
+    m_flight->hook = m_client->m_cancel_hook;
+    // 回调可能在任意线程执行，只持有Flight；已取消时在此立即执行
+    m_subscription = m_token->subscribe([flight = m_flight]() {
+        AsyncMysqlClient::CancelHook hook;
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            if (!flight->armed) {
+                return;
+            }
+            flight->armed = false;
+            hook = std::move(flight->hook);
+        }
+        hook(flight->connection_id, flight->generation);
+    });
+}
+
+void MysqlCancelBinding::complete() noexcept
+{
+    if (m_token.has_value()) {
+        m_token->unsubscribe(m_subscription);
+    }
+    m_subscription = 0;
+    if (m_flight) {
+        std::lock_guard<std::mutex> lock(m_flight->mutex);
+        m_flight->armed = false;
+        m_flight->hook = nullptr;
+    }
+    m_flight.reset();
+    if (m_generation != 0 && m_client->m_inflight_generation == m_generation) {
+        m_client->m_inflight_generation = 0;
+    }
+    m_generation = 0;
+}
+
+void MysqlCancelBinding::release() noexcept
+{
+    complete();
+    m_token.reset();
+    m_client = nullptr;
+}
+
+// ======================== MysqlDrainAwaitable ========================
+
+MysqlDrainAwaitable::ProtocolRecvAwaitable::ProtocolRecvAwaitable(MysqlDrainAwaitable* owner)
+    : ReadvIOContext({})
+    , m_owner(owner)
+{
+    m_iovecs.reserve(2);
+}
+
+bool MysqlDrainAwaitable::ProtocolRecvAwaitable::prepareRecvWindow()
+{
+    if (!detail::prepareRecvWindow(m_owner->m_client.m_ring_buffer, m_iovecs)) {
+        m_owner->setError(MysqlError(MYSQL_ERROR_RECV, "No writable ring buffer space while draining response"));
+        return false;
+    }
+    return true;
+}
+
+bool MysqlDrainAwaitable::ProtocolRecvAwaitable::tryParseAndCheckDone()
+{
+    return detail::parseOrSetError(
+        [&]() { return m_owner->tryParseFromRingBuffer(); },
+        [&](MysqlError err) { m_owner->setError(std::move(err)); }
+    );
+}
+
+bool MysqlDrainAwaitable::ProtocolRecvAwaitable::handleReadResult()
+{
+    return detail::handleReadResult(
+        m_result,
+        m_owner->m_client.m_ring_buffer,
+        [&](const IOError& io_error) { m_owner->setRecvError(io_error); },
+        [&]() { m_owner->setError(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Connection closed")); },
+        [&]() { return m_owner->tryParseFromRingBuffer(); },
+        [&](MysqlError err) { m_owner->setError(std::move(err)); }
+    );
+}
+
+#ifdef USE_IOURING
+bool MysqlDrainAwaitable::ProtocolRecvAwaitable::handleComplete(struct io_uring_cqe* cqe, GHandle handle)
+{
+    if (m_owner->m_lifecycle != Lifecycle::Running) {
+        return true;
+    }
+
+    if (tryParseAndCheckDone()) {
+        return true;
+    }
+
+    if (!prepareRecvWindow()) {
+        return true;
+    }
+
+    if (cqe == nullptr) {
+        return false;
+    }
+
+    if (!ReadvIOContext::handleComplete(cqe, handle)) {
+        return false;
+    }
+    return handleReadResult();
+}
+#else
+bool MysqlDrainAwaitable::ProtocolRecvAwaitable::handleComplete(GHandle handle)
+{
+    while (m_owner->m_lifecycle == Lifecycle::Running) {
+        if (tryParseAndCheckDone()) {
+            return true;
+        }
+
+        if (!prepareRecvWindow()) {
+            return true;
+        }
+
+        if (!ReadvIOContext::handleComplete(handle)) {
+            return false;
+        }
+
+        if (handleReadResult()) {
+            return true;
+        }
+    }
+    return true;
+}
+#endif
+
+MysqlDrainAwaitable::MysqlDrainAwaitable(AsyncMysqlClient& client)
+    : CustomAwaitable(client.m_socket.controller())
+    , m_client(client)
+    , m_lifecycle(Lifecycle::Running)
+    , m_recv_awaitable(this)
+    , m_chain_error(std::nullopt)
+    , m_result(std::nullopt)
+{
+    if (m_client.m_pending.broken) {
+        setError(MysqlError(MYSQL_ERROR_CONNECTION, "Connection is broken and cannot be drained"));
+        return;
+    }
+    if (m_client.m_pending.responses == 0) {
+        m_lifecycle = Lifecycle::Done;
+        return;
+    }
+    addTask(IOEventType::READV, &m_recv_awaitable);
+}
+
+void MysqlDrainAwaitable::reset() noexcept
+{
+    m_lifecycle = Lifecycle::Invalid;
+    m_chain_error.reset();
+    m_parse_scratch.clear();
+    m_result = std::nullopt;
+}
+
+void MysqlDrainAwaitable::setError(MysqlError error) noexcept
+{
+    m_chain_error = std::move(error);
+    m_lifecycle = Lifecycle::Invalid;
+}
+
+void MysqlDrainAwaitable::setRecvError(const IOError& io_error) noexcept
+{
+    MysqlLogDebug(m_client.m_logger, "drain response failed: {}", io_error.message());
+    setError(MysqlError(MYSQL_ERROR_RECV, io_error.message()));
+}
+
+std::expected<bool, MysqlError> MysqlDrainAwaitable::tryParseFromRingBuffer()
+{
+    auto& pending = m_client.m_pending;
+    while (pending.responses > 0) {
+        size_t consumed = 0;
+        auto event = detail::nextResultEvent(m_client.m_ring_buffer, pending.decoder, m_parse_scratch, consumed);
+        m_client.m_ring_buffer.consume(consumed);
+        if (!event) {
+            // ERR包（如KILL QUERY产生的1317）同样结束一条命令的响应
+            if (event.error().type() != MYSQL_ERROR_SERVER) {
+                return std::unexpected(std::move(event.error()));
+            }
+            pending.decoder.reset(m_client.m_server_capabilities, pending.decoder.rowFormat());
+            --pending.responses;
+            continue;
+        }
+        if (event->type == protocol::MysqlResultEventType::NeedMore) {
+            return false;
+        }
+        if (event->endsResponse()) {
+            pending.decoder.reset(m_client.m_server_capabilities, pending.decoder.rowFormat());
+            --pending.responses;
+        }
+    }
+
+    m_lifecycle = Lifecycle::Done;
+    return true;
+}
+
+std::expected<std::optional<bool>, MysqlError> MysqlDrainAwaitable::await_resume()
+{
+    onCompleted();
+
+    if (!m_result.has_value()) {
+        // 再次超时时保留解码进度，可稍后重新drain()
+        auto err = detail::toTimeoutOrInternalError(m_result.error());
+        if (err.type() != MYSQL_ERROR_TIMEOUT) {
+            m_client.m_pending.broken = true;
+        }
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    if (m_chain_error.has_value()) {
+        auto err = std::move(*m_chain_error);
+        if (detail::leavesConnectionBroken(err)) {
+            m_client.m_pending.broken = true;
+        }
+        reset();
+        return std::unexpected(std::move(err));
+    }
+
+    if (m_lifecycle != Lifecycle::Done) {
+        reset();
+        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Drain awaitable did not reach done state"));
+    }
+
+    reset();
+    return std::optional<bool>(true);
+}
+
+// ======================== AsyncMysqlClient 实现 ========================
+
+AsyncMysqlClient::AsyncMysqlClient(IOScheduler* scheduler,
+                                   AsyncMysqlConfig config,
+                                   std::shared_ptr<MysqlBufferProvider> buffer_provider)
+    : m_scheduler(scheduler)
+    , m_config(std::move(config))
+    , m_ring_buffer(m_config.buffer_size,
+                    buffer_provider ? std::move(buffer_provider) : detail::makeBufferProvider(m_config))
+{
+    m_logger = MysqlLog::getInstance()->getLogger();
+}
+
+AsyncMysqlClient::AsyncMysqlClient(AsyncMysqlClient&& other) noexcept
+    : m_is_closed(other.m_is_closed)
+    , m_socket(std::move(other.m_socket))
+    , m_scheduler(other.m_scheduler)
+    , m_parser(std::move(other.m_parser))
+    , m_encoder(std::move(other.m_encoder))
+    , m_config(std::move(other.m_config))
+    , m_ring_buffer(std::move(other.m_ring_buffer))
+    , m_server_capabilities(other.m_server_capabilities)
+    , m_connection_id(other.m_connection_id)
+    , m_pending(std::move(other.m_pending))
+    , m_cancel_hook(std::move(other.m_cancel_hook))
+    , m_query_scratch(std::move(other.m_query_scratch))
+    , m_stmt_scratch(std::move(other.m_stmt_scratch))
+    , m_result_arena(std::move(other.m_result_arena))
+    , m_logger(std::move(other.m_logger))
+{
+    other.m_is_closed = true;
+}
+
+AsyncMysqlClient& AsyncMysqlClient::operator=(AsyncMysqlClient&& other) noexcept
+{
+    if (this != &other) {
+        m_is_closed = other.m_is_closed;
+        m_socket = std::move(other.m_socket);
+        m_scheduler = other.m_scheduler;
+        m_parser = std::move(other.m_parser);
+        m_encoder = std::move(other.m_encoder);
+        m_config = std::move(other.m_config);
+        m_ring_buffer = std::move(other.m_ring_buffer);
+        m_server_capabilities = other.m_server_capabilities;
+        m_connection_id = other.m_connection_id;
+        m_pending = std::move(other.m_pending);
+        m_cancel_hook = std::move(other.m_cancel_hook);
+        m_query_scratch = std::move(other.m_query_scratch);
+        m_stmt_scratch = std::move(other.m_stmt_scratch);
+        m_result_arena = std::move(other.m_result_arena);
+        m_logger = std::move(other.m_logger);
+        other.m_is_closed = true;
+    }
+    return *this;
+}
+
+MysqlConnectAwaitable AsyncMysqlClient::connect(MysqlConfig config)
+{
+    prepareSocket(config);
+    return MysqlConnectAwaitable(*this, std::move(config));
+}
+
+void AsyncMysqlClient::prepareSocket(MysqlConfig& config)
+{
+    if (MysqlResolver::literalFamily(config.host) != AF_INET6) {
+        return;
+    }
+    if (config.host.front() == '[') {
+        config.host = config.host.substr(1, config.host.size() - 2);
+    }
+    m_socket = TcpSocket(IPType::IPV6);
+}
+
+void AsyncMysqlClient::adoptConnection(AsyncMysqlClient& other) noexcept
+{
+    m_socket = std::move(other.m_socket);
+    m_is_closed = other.m_is_closed;
+    m_server_capabilities = other.m_server_capabilities;
+    m_connection_id = other.m_connection_id;
+    m_pending = MysqlPendingResponse{};
+    m_ring_buffer.clear();
+    other.m_is_closed = true;
+}
+
+MysqlConnectAwaitable AsyncMysqlClient::connect(std::string_view host, uint16_t port,
+                                                std::string_view user, std::string_view password,
+                                                std::string_view database)
+{
+    MysqlConfig config;
+    config.host.assign(host.data(), host.size());
+    config.port = port;
+    config.username.assign(user.data(), user.size());
+    config.password.assign(password.data(), password.size());
+    config.database.assign(database.data(), database.size());
+    return connect(std::move(config));
+}
+
+MysqlQueryAwaitable AsyncMysqlClient::query(std::string_view sql)
+{
+    return MysqlQueryAwaitable(*this, sql);
+}
+
+MysqlPipelineAwaitable AsyncMysqlClient::batch(std::span<const protocol::MysqlCommandView> commands)
+{
+    return MysqlPipelineAwaitable(*this, commands);
+}
+
+MysqlPipelineAwaitable AsyncMysqlClient::pipeline(std::span<const std::string_view> sqls)
+{
+    size_t reserve_bytes = 0;
+    for (const auto sql : sqls) {
         reserve_bytes += protocol::MYSQL_PACKET_HEADER_SIZE + 1 + sql.size();
     }
 
@@ -2391,6 +3343,19 @@ MysqlPipelineAwaitable AsyncMysqlClient::pipeline(std::span<const std::string_vi
     return batch(builder.commands());
 }
 
+MysqlPipelineAwaitable AsyncMysqlClient::queryMulti(std::string_view sql)
+{
+    protocol::MysqlCommandBuilder builder;
+    builder.reserve(1, protocol::MYSQL_PACKET_HEADER_SIZE + 1 + sql.size());
+    builder.appendQuery(sql);
+    return batch(builder.commands());
+}
+
+MysqlLocalInfileAwaitable AsyncMysqlClient::loadLocalInfile(std::string_view sql, MysqlLocalInfileSource source)
+{
+    return MysqlLocalInfileAwaitable(*this, sql, std::move(source));
+}
+
 MysqlPrepareAwaitable AsyncMysqlClient::prepare(std::string_view sql)
 {
     return MysqlPrepareAwaitable(*this, sql);
@@ -2400,14 +3365,39 @@ MysqlStmtExecuteAwaitable AsyncMysqlClient::stmtExecute(uint32_t stmt_id,
                                                         std::span<const std::optional<std::string>> params,
                                                         std::span<const uint8_t> param_types)
 {
-    return MysqlStmtExecuteAwaitable(*this, m_encoder.encodeStmtExecute(stmt_id, params, param_types, 0));
+    std::string encoded = std::move(m_stmt_scratch.encoded);
+    m_encoder.encodeStmtExecuteInto(encoded, stmt_id, params, param_types, 0);
+    return MysqlStmtExecuteAwaitable(*this, std::move(encoded));
 }
 
 MysqlStmtExecuteAwaitable AsyncMysqlClient::stmtExecute(uint32_t stmt_id,
                                                         std::span<const std::optional<std::string_view>> params,
                                                         std::span<const uint8_t> param_types)
 {
-    return MysqlStmtExecuteAwaitable(*this, m_encoder.encodeStmtExecute(stmt_id, params, param_types, 0));
+    std::string encoded = std::move(m_stmt_scratch.encoded);
+    m_encoder.encodeStmtExecuteInto(encoded, stmt_id, params, param_types, 0);
+    return MysqlStmtExecuteAwaitable(*this, std::move(encoded));
+}
+
+MysqlStmtExecuteAwaitable AsyncMysqlClient::stmtExecute(uint32_t stmt_id,
+                                                        std::span<const std::optional<std::string_view>> params,
+                                                        std::span<const uint8_t> param_types,
+                                                        std::span<const uint16_t> long_data_params)
+{
+    std::string encoded = std::move(m_stmt_scratch.encoded);
+    m_encoder.encodeStmtExecuteInto(encoded, stmt_id, params, param_types, long_data_params, 0);
+    return MysqlStmtExecuteAwaitable(*this, std::move(encoded));
+}
+
+MysqlStmtLongDataAwaitable AsyncMysqlClient::stmtSendLongData(uint32_t stmt_id, uint16_t param_id,
+                                                              MysqlLongDataSource source)
+{
+    return MysqlStmtLongDataAwaitable(*this, stmt_id, param_id, std::move(source));
+}
+
+void AsyncMysqlClient::recycle(MysqlResultSet&& result_set) noexcept
+{
+    detail::returnResultSet(m_result_arena, result_set);
 }
 
 MysqlQueryAwaitable AsyncMysqlClient::beginTransaction()
@@ -2439,4 +3429,40 @@ MysqlQueryAwaitable AsyncMysqlClient::useDatabase(std::string_view database)
     return query(sql);
 }
 
+MysqlQueryAwaitable AsyncMysqlClient::killQuery(uint32_t connection_id)
+{
+    return query("KILL QUERY " + std::to_string(connection_id));
+}
+
+MysqlDrainAwaitable AsyncMysqlClient::drain()
+{
+    return MysqlDrainAwaitable(*this);
+}
+
+void AsyncMysqlClient::markInterrupted(const protocol::MysqlResultDecoder& decoder,
+                                       size_t sent, size_t total, size_t responses, bool timed_out) noexcept
+{
+    if (sent == 0) {
+        return;
+    }
+    if (!timed_out || sent < total) {
+        m_pending.broken = true;
+        return;
+    }
+    // 超时发生时本条命令的已读部分已按包消费，解码进度足以定位剩余响应
+    m_pending.decoder = decoder;
+    m_pending.responses += responses;
+}
+
+std::optional<MysqlError> AsyncMysqlClient::checkIdle() const
+{
+    if (m_pending.broken) {
+        return MysqlError(MYSQL_ERROR_CONNECTION, "Connection was left mid-response and must be closed");
+    }
+    if (m_pending.responses > 0) {
+        return MysqlError(MYSQL_ERROR_CONNECTION, "Connection has an unfinished response, drain() it first");
+    }
+    return std::nullopt;
+}
+
 } // namespace galay::mysql
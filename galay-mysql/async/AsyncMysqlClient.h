@@ -7,6 +7,7 @@
 #include <galay-kernel/kernel/Timeout.hpp>
 #include <galay-kernel/common/Host.hpp>
 #include <galay-kernel/common/Error.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -16,12 +17,16 @@
 #include <vector>
 #include <coroutine>
 #include <utility>
+#include "galay-mysql/base/MysqlCancellation.h"
 #include "galay-mysql/base/MysqlError.h"
+#include "galay-mysql/base/MysqlLocalInfile.h"
 #include "galay-mysql/base/MysqlLog.h"
 #include "galay-mysql/base/MysqlValue.h"
 #include "galay-mysql/base/MysqlConfig.h"
 #include "galay-mysql/protocol/MysqlProtocol.h"
+#include "galay-mysql/protocol/MysqlResultDecoder.h"
 #include "galay-mysql/protocol/MysqlAuth.h"
+#include "galay-mysql/protocol/MysqlRowMapper.h"
 #include "galay-mysql/protocol/Builder.h"
 #include "AsyncMysqlConfig.h"
 #include "MysqlBufferProvider.h"
@@ -82,6 +87,12 @@ public:
         return *this;
     }
 
+    AsyncMysqlClientBuilder& maxBufferSize(size_t size)
+    {
+        m_config.max_buffer_size = size;
+        return *this;
+    }
+
     AsyncMysqlClientBuilder& bufferProvider(std::shared_ptr<MysqlBufferProvider> provider)
     {
         m_buffer_provider = std::move(provider);
@@ -202,6 +213,9 @@ private:
     void setRecvError(const std::string& phase, const IOError& io_error) noexcept;
     std::expected<bool, MysqlError> parseHandshakeFromRingBuffer();
     std::expected<bool, MysqlError> parseAuthResultFromRingBuffer();
+    std::expected<bool, MysqlError> parseInitResultFromRingBuffer();
+    void onAuthenticated();
+    const char* phaseName() const { return m_initializing ? "session init" : "auth"; }
 
     AsyncMysqlClient& m_client;
     MysqlConfig m_config;
@@ -209,18 +223,88 @@ private:
 
     // 握手数据
     protocol::HandshakeV10 m_handshake;
-    std::string m_auth_packet;
+    std::string m_auth_packet;      // 认证响应；认证成功后换成会话初始化请求
     size_t m_sent;
     bool m_connected = false;
 
+    // 会话初始化：认证成功后把会话变量与初始化语句作为一条多语句请求发送
+    std::string m_init_sql;
+    bool m_initializing = false;
+    protocol::MysqlResultDecoder m_init_decoder;
+
     ProtocolConnectAwaitable m_connect_awaitable;
     ProtocolHandshakeRecvAwaitable m_handshake_recv_awaitable;
     ProtocolAuthSendAwaitable m_auth_send_awaitable;
     ProtocolAuthResultRecvAwaitable m_auth_result_recv_awaitable;
+    ProtocolAuthSendAwaitable m_init_send_awaitable;                // 无需初始化时直接完成
+    ProtocolAuthResultRecvAwaitable m_init_result_recv_awaitable;
     std::optional<MysqlError> m_chain_error;
     std::string m_parse_scratch;
 };
 
+// ============= MysqlCommandScratch ========================
+
+/**
+ * @brief 命令级可复用缓冲
+ * @details 查询/预处理执行等待体构造时从客户端借出，析构时清空内容、保留容量后归还；
+ *          同一连接上的稳态命令因此不再为编码包、解析暂存和iovec数组重新分配内存。
+ */
+struct MysqlCommandScratch
+{
+    std::string encoded;
+    std::string parse_scratch;
+    std::vector<struct iovec> send_iovecs;
+    std::vector<struct iovec> recv_iovecs;
+};
+
+// ============= MysqlPendingResponse ========================
+
+/**
+ * @brief 被超时打断、尚未读完的响应
+ * @details 超时只放弃本地等待，服务端仍会把（被KILL QUERY中断的）响应写回连接；
+ *          客户端记录被打断时的解码进度，drain()据此读完残留字节，连接回到响应边界后即可继续使用。
+ */
+struct MysqlPendingResponse
+{
+    protocol::MysqlResultDecoder decoder;   // 被打断命令的解码进度
+    size_t responses = 0;                   // 尚未读完的命令响应数
+    bool broken = false;                    // 请求只发出一部分或传输出错，连接只能关闭
+};
+
+// ============= MysqlCancelBinding ========================
+
+/**
+ * @brief 等待体与取消令牌的绑定
+ * @details bind()只记下令牌；命令完整发出后arm()为其分配代号并向令牌登记回调，
+ *          收到终止包或出错时complete()注销，因此取消钩子只在命令“已发出、未结束”期间触发。
+ *          回调在调用cancel()的线程中执行，只访问共享的Flight，不触碰客户端；
+ *          钩子收到的代号由执行方回到调度器后与AsyncMysqlClient::inflightGeneration()核对。
+ */
+class MysqlCancelBinding
+{
+public:
+    MysqlCancelBinding() = default;
+    ~MysqlCancelBinding() { release(); }
+
+    MysqlCancelBinding(const MysqlCancelBinding&) = delete;
+    MysqlCancelBinding& operator=(const MysqlCancelBinding&) = delete;
+
+    void bind(AsyncMysqlClient& client, MysqlCancellationToken token);
+    void arm();
+    void complete() noexcept;
+    void release() noexcept;
+    bool requested() const { return m_token.has_value() && m_token->isCancelled(); }
+
+private:
+    struct Flight;
+
+    AsyncMysqlClient* m_client = nullptr;
+    std::optional<MysqlCancellationToken> m_token;
+    std::shared_ptr<Flight> m_flight;
+    uint64_t m_generation = 0;
+    uint64_t m_subscription = 0;
+};
+
 // ============= MysqlQueryAwaitable ========================
 
 /**
@@ -235,6 +319,7 @@ public:
     {
     public:
         explicit ProtocolSendAwaitable(MysqlQueryAwaitable* owner);
+        ~ProtocolSendAwaitable();
 
 #ifdef USE_IOURING
         bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
@@ -255,6 +340,7 @@ public:
     {
     public:
         explicit ProtocolRecvAwaitable(MysqlQueryAwaitable* owner);
+        ~ProtocolRecvAwaitable();
 
 #ifdef USE_IOURING
         bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
@@ -271,6 +357,10 @@ public:
     };
 
     MysqlQueryAwaitable(AsyncMysqlClient& client, std::string_view sql);
+    ~MysqlQueryAwaitable();
+
+    MysqlQueryAwaitable(const MysqlQueryAwaitable&) = delete;
+    MysqlQueryAwaitable& operator=(const MysqlQueryAwaitable&) = delete;
 
     bool await_ready() const noexcept { return false; }
     using CustomAwaitable::await_suspend;
@@ -278,6 +368,21 @@ public:
 
     bool isInvalid() const { return m_lifecycle == Lifecycle::Invalid; }
 
+    /**
+     * @brief 设置行接收器
+     * @details 设置后行包直接交给sink解码，不再写入MysqlResultSet；
+     *          sink返回的错误不会中断接收，剩余行被丢弃后在await_resume中返回该错误，
+     *          保证连接停在响应边界上。
+     */
+    void setRowSink(MysqlRowSink* sink) noexcept { m_row_sink = sink; }
+
+    /**
+     * @brief 绑定取消令牌
+     * @details 发送前取消则不发送；发送后取消则丢弃剩余响应直到边界（配合取消钩子中断服务端语句），
+     *          两种情况都以MYSQL_ERROR_CANCELLED恢复协程，连接可继续使用。
+     */
+    MysqlQueryAwaitable& cancelOn(MysqlCancellationToken token);
+
 private:
     enum class Lifecycle {
         Invalid,
@@ -285,13 +390,6 @@ private:
         Done
     };
 
-    enum class State {
-        ReceivingHeader,
-        ReceivingColumns,
-        ReceivingColumnEof,
-        ReceivingRows,
-    };
-
     void reset() noexcept;
     void setError(MysqlError error) noexcept;
     void setSendError(const IOError& io_error) noexcept;
@@ -301,13 +399,16 @@ private:
     AsyncMysqlClient& m_client;
     std::string m_encoded_cmd;
     Lifecycle m_lifecycle;
-    State m_state;
     size_t m_sent;
 
     // 结果集构建
     MysqlResultSet m_result_set;
-    uint64_t m_column_count;
-    size_t m_columns_received;
+    protocol::MysqlResultDecoder m_decoder;
+    bool m_draining = false;
+    bool m_cancelled = false;
+    MysqlCancelBinding m_cancel;
+    MysqlRowSink* m_row_sink = nullptr;
+    std::optional<MysqlError> m_row_sink_error;
 
     ProtocolSendAwaitable m_send_awaitable;
     ProtocolRecvAwaitable m_recv_awaitable;
@@ -319,6 +420,46 @@ public:
     std::expected<std::optional<MysqlResultSet>, galay::kernel::IOError> m_result;
 };
 
+// ======================== MysqlQueryAsAwaitable ========================
+
+/**
+ * @brief 类型化查询等待体
+ * @details 复用MysqlQueryAwaitable的SEND -> READV链，行包经MysqlRowCollector
+ *          直接解码为T，列数/列类型在每个结果集收到列定义后校验一次。
+ */
+template<MysqlRowMappable T>
+class MysqlQueryAsAwaitable
+{
+public:
+    MysqlQueryAsAwaitable(AsyncMysqlClient& client, std::string_view sql);
+
+    MysqlQueryAsAwaitable(const MysqlQueryAsAwaitable&) = delete;
+    MysqlQueryAsAwaitable& operator=(const MysqlQueryAsAwaitable&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    template<typename Handle>
+    decltype(auto) await_suspend(Handle handle)
+    {
+        return m_query.await_suspend(handle);
+    }
+
+    std::expected<std::optional<std::vector<T>>, MysqlError> await_resume()
+    {
+        auto result = m_query.await_resume();
+        if (!result.has_value()) {
+            return std::unexpected(std::move(result.error()));
+        }
+        return std::optional<std::vector<T>>(std::move(m_collector.rows()));
+    }
+
+    bool isInvalid() const { return m_query.isInvalid(); }
+
+private:
+    MysqlRowCollector<T> m_collector;
+    MysqlQueryAwaitable m_query;
+};
+
 // ======================== MysqlPrepareAwaitable ========================
 
 /**
@@ -439,6 +580,7 @@ public:
     {
     public:
         explicit ProtocolSendAwaitable(MysqlStmtExecuteAwaitable* owner);
+        ~ProtocolSendAwaitable();
 
 #ifdef USE_IOURING
         bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
@@ -459,6 +601,7 @@ public:
     {
     public:
         explicit ProtocolRecvAwaitable(MysqlStmtExecuteAwaitable* owner);
+        ~ProtocolRecvAwaitable();
 
 #ifdef USE_IOURING
         bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
@@ -475,6 +618,10 @@ public:
     };
 
     MysqlStmtExecuteAwaitable(AsyncMysqlClient& client, std::string encoded_cmd);
+    ~MysqlStmtExecuteAwaitable();
+
+    MysqlStmtExecuteAwaitable(const MysqlStmtExecuteAwaitable&) = delete;
+    MysqlStmtExecuteAwaitable& operator=(const MysqlStmtExecuteAwaitable&) = delete;
 
     bool await_ready() const noexcept { return false; }
     using CustomAwaitable::await_suspend;
@@ -482,6 +629,11 @@ public:
 
     bool isInvalid() const { return m_lifecycle == Lifecycle::Invalid; }
 
+    /**
+     * @brief 绑定取消令牌，语义同MysqlQueryAwaitable::cancelOn
+     */
+    MysqlStmtExecuteAwaitable& cancelOn(MysqlCancellationToken token);
+
 private:
     enum class Lifecycle {
         Invalid,
@@ -489,13 +641,6 @@ private:
         Done
     };
 
-    enum class State {
-        ReceivingHeader,
-        ReceivingColumns,
-        ReceivingColumnEof,
-        ReceivingRows,
-    };
-
     void reset() noexcept;
     void setError(MysqlError error) noexcept;
     void setSendError(const IOError& io_error) noexcept;
@@ -505,12 +650,13 @@ private:
     AsyncMysqlClient& m_client;
     std::string m_encoded_cmd;
     Lifecycle m_lifecycle;
-    State m_state;
     size_t m_sent;
 
     MysqlResultSet m_result_set;
-    uint64_t m_column_count;
-    size_t m_columns_received;
+    protocol::MysqlResultDecoder m_decoder;
+    bool m_draining = false;
+    bool m_cancelled = false;
+    MysqlCancelBinding m_cancel;
 
     ProtocolSendAwaitable m_send_awaitable;
     ProtocolRecvAwaitable m_recv_awaitable;
@@ -583,6 +729,12 @@ public:
 
     bool isInvalid() const { return m_lifecycle == Lifecycle::Invalid; }
 
+    /**
+     * @brief 绑定取消令牌
+     * @details 取消后剩余命令的响应全部读完丢弃（含ERR），连接停在边界上
+     */
+    MysqlPipelineAwaitable& cancelOn(MysqlCancellationToken token);
+
 private:
     enum class Lifecycle {
         Invalid,
@@ -590,21 +742,16 @@ private:
         Done
     };
 
-    enum class State {
-        ReceivingHeader,
-        ReceivingColumns,
-        ReceivingColumnEof,
-        ReceivingRows,
-    };
-
     struct EncodedSlice {
         size_t offset = 0;
         size_t length = 0;
+        protocol::MysqlRowFormat format = protocol::MysqlRowFormat::Text;
     };
 
     void initTaskQueue();
+    void resetDecoder() noexcept;
     void resetCurrentResult();
-    void finalizeCurrentResult();
+    void finalizeCurrentResult(bool more_results);
     void reset() noexcept;
     void setError(MysqlError error) noexcept;
     void setSendError(const IOError& io_error) noexcept;
@@ -613,14 +760,16 @@ private:
 
     AsyncMysqlClient& m_client;
     size_t m_expected_results;
+    size_t m_commands_completed = 0;
+    size_t m_sent_bytes = 0;
     std::string m_encoded_buffer;
     std::vector<EncodedSlice> m_encoded_slices;
     Lifecycle m_lifecycle;
-    State m_state;
     std::vector<MysqlResultSet> m_results;
     MysqlResultSet m_current_result;
-    uint64_t m_column_count;
-    size_t m_columns_received;
+    protocol::MysqlResultDecoder m_decoder;
+    bool m_cancelled = false;
+    MysqlCancelBinding m_cancel;
 
     ProtocolSendAwaitable m_send_awaitable;
     ProtocolRecvAwaitable m_recv_awaitable;
@@ -631,6 +780,257 @@ public:
     std::expected<std::optional<std::vector<MysqlResultSet>>, galay::kernel::IOError> m_result;
 };
 
+// ======================== MysqlLocalInfileAwaitable ========================
+
+/**
+ * @brief LOAD DATA LOCAL INFILE等待体
+ * @details 固定任务链 SEND(COM_QUERY) -> READV(0xFB请求) -> SEND(数据包...空包) -> READV(OK/ERR)。
+ *          数据按MysqlLocalInfileSource::chunkBytes()逐块读取，每块直接写进包缓冲后发送，发送完再读下一块；
+ *          服务端没有发出LOCAL INFILE请求（如返回ERR或普通结果）时后两步直接跳过。
+ *          数据源出错时以空包提前结束传输，读完服务端响应后返回数据源的错误（已发送的数据可能已写入）。
+ */
+class MysqlLocalInfileAwaitable : public CustomAwaitable, public galay::kernel::TimeoutSupport<MysqlLocalInfileAwaitable>
+{
+public:
+    class ProtocolSendAwaitable : public WritevIOContext
+    {
+    public:
+        explicit ProtocolSendAwaitable(MysqlLocalInfileAwaitable* owner);
+
+#ifdef USE_IOURING
+        bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
+#else
+        bool handleComplete(GHandle handle) override;
+#endif
+
+    private:
+        void syncSendIovecs();
+        bool handleSendResult();
+
+        MysqlLocalInfileAwaitable* m_owner;
+    };
+
+    class ProtocolRecvAwaitable : public ReadvIOContext
+    {
+    public:
+        explicit ProtocolRecvAwaitable(MysqlLocalInfileAwaitable* owner);
+
+#ifdef USE_IOURING
+        bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
+#else
+        bool handleComplete(GHandle handle) override;
+#endif
+
+    private:
+        bool prepareRecvWindow();
+        bool tryParseAndCheckDone();
+        bool handleReadResult();
+
+        MysqlLocalInfileAwaitable* m_owner;
+    };
+
+    MysqlLocalInfileAwaitable(AsyncMysqlClient& client, std::string_view sql, MysqlLocalInfileSource source);
+
+    MysqlLocalInfileAwaitable(const MysqlLocalInfileAwaitable&) = delete;
+    MysqlLocalInfileAwaitable& operator=(const MysqlLocalInfileAwaitable&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    using CustomAwaitable::await_suspend;
+    std::expected<std::optional<MysqlResultSet>, MysqlError> await_resume();
+
+    bool isInvalid() const { return m_lifecycle == Lifecycle::Invalid; }
+
+private:
+    enum class Lifecycle {
+        Invalid,
+        Running,
+        Done
+    };
+
+    enum class Phase {
+        SendCommand,
+        AwaitRequest,
+        SendData,
+        AwaitResult
+    };
+
+    std::string_view sendWindow();
+    bool advanceSend(size_t sent_bytes);
+    void refillChunk();
+    void reset() noexcept;
+    void setError(MysqlError error) noexcept;
+    void setSendError(const IOError& io_error) noexcept;
+    void setRecvError(const IOError& io_error) noexcept;
+    std::expected<bool, MysqlError> tryParseFromRingBuffer();
+
+    AsyncMysqlClient& m_client;
+    std::string m_encoded_cmd;
+    Lifecycle m_lifecycle;
+    Phase m_phase = Phase::SendCommand;
+    size_t m_sent = 0;
+
+    // 数据发送
+    MysqlLocalInfileSource m_source;
+    std::string m_chunk;
+    size_t m_chunk_sent = 0;
+    uint8_t m_sequence_id = 0;
+    bool m_data_finished = false;
+    std::optional<MysqlError> m_source_error;
+
+    MysqlResultSet m_result_set;
+    protocol::MysqlResultDecoder m_decoder;
+    bool m_draining = false;
+
+    ProtocolSendAwaitable m_command_send;
+    ProtocolRecvAwaitable m_request_recv;
+    ProtocolSendAwaitable m_data_send;
+    ProtocolRecvAwaitable m_result_recv;
+    std::optional<MysqlError> m_chain_error;
+    std::string m_parse_scratch;
+
+public:
+    std::expected<std::optional<MysqlResultSet>, galay::kernel::IOError> m_result;
+};
+
+// ======================== MysqlStmtLongDataAwaitable ========================
+
+/**
+ * @brief COM_STMT_SEND_LONG_DATA发送等待体
+ * @details 只执行SEND：按chunkBytes()从数据源读一块、写进包缓冲后发送，发完再读下一块，
+ *          峰值内存为一个包缓冲。服务端对该命令不回复，因此各块之间无需等待往返，
+ *          全部写出后即完成，随后用带long_data_params的stmtExecute执行。
+ *          数据源为空时仍发送一个空数据包，使该参数成为空串而非缺失。
+ */
+class MysqlStmtLongDataAwaitable : public CustomAwaitable, public galay::kernel::TimeoutSupport<MysqlStmtLongDataAwaitable>
+{
+public:
+    class ProtocolSendAwaitable : public WritevIOContext
+    {
+    public:
+        explicit ProtocolSendAwaitable(MysqlStmtLongDataAwaitable* owner);
+
+#ifdef USE_IOURING
+        bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
+#else
+        bool handleComplete(GHandle handle) override;
+#endif
+
+    private:
+        void syncSendIovecs();
+        bool handleSendResult();
+
+        MysqlStmtLongDataAwaitable* m_owner;
+    };
+
+    MysqlStmtLongDataAwaitable(AsyncMysqlClient& client, uint32_t stmt_id, uint16_t param_id,
+                               MysqlLongDataSource source);
+
+    MysqlStmtLongDataAwaitable(const MysqlStmtLongDataAwaitable&) = delete;
+    MysqlStmtLongDataAwaitable& operator=(const MysqlStmtLongDataAwaitable&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    using CustomAwaitable::await_suspend;
+    std::expected<std::optional<bool>, MysqlError> await_resume();
+
+    bool isInvalid() const { return m_lifecycle == Lifecycle::Invalid; }
+
+private:
+    enum class Lifecycle {
+        Invalid,
+        Running,
+        Done
+    };
+
+    std::string_view sendWindow();
+    bool advanceSend(size_t sent_bytes);
+    void refillPacket();
+    bool midPacket() const { return m_packet_sent > 0 && m_packet_sent < m_packet.size(); }
+    void reset() noexcept;
+    void setError(MysqlError error) noexcept;
+    void setSendError(const IOError& io_error) noexcept;
+
+    AsyncMysqlClient& m_client;
+    uint32_t m_stmt_id;
+    uint16_t m_param_id;
+    Lifecycle m_lifecycle;
+
+    MysqlLongDataSource m_source;
+    std::string m_packet;
+    size_t m_packet_sent = 0;
+    size_t m_packets = 0;
+    bool m_finished = false;
+    std::optional<MysqlError> m_source_error;
+
+    ProtocolSendAwaitable m_send_awaitable;
+    std::optional<MysqlError> m_chain_error;
+
+public:
+    std::expected<std::optional<bool>, galay::kernel::IOError> m_result;
+};
+
+// ======================== MysqlDrainAwaitable ========================
+
+/**
+ * @brief 残留响应排空等待体
+ * @details 只执行READV，按MysqlPendingResponse中保存的解码进度丢弃被打断命令的剩余响应；
+ *          被KILL QUERY中断的语句以ERR 1317结束，同样视为响应边界。没有残留响应时立即完成。
+ */
+class MysqlDrainAwaitable : public CustomAwaitable, public galay::kernel::TimeoutSupport<MysqlDrainAwaitable>
+{
+public:
+    class ProtocolRecvAwaitable : public ReadvIOContext
+    {
+    public:
+        explicit ProtocolRecvAwaitable(MysqlDrainAwaitable* owner);
+
+#ifdef USE_IOURING
+        bool handleComplete(struct io_uring_cqe* cqe, GHandle handle) override;
+#else
+        bool handleComplete(GHandle handle) override;
+#endif
+
+    private:
+        bool prepareRecvWindow();
+        bool tryParseAndCheckDone();
+        bool handleReadResult();
+
+        MysqlDrainAwaitable* m_owner;
+    };
+
+    explicit MysqlDrainAwaitable(AsyncMysqlClient& client);
+
+    MysqlDrainAwaitable(const MysqlDrainAwaitable&) = delete;
+    MysqlDrainAwaitable& operator=(const MysqlDrainAwaitable&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    using CustomAwaitable::await_suspend;
+    std::expected<std::optional<bool>, MysqlError> await_resume();
+
+    bool isInvalid() const { return m_lifecycle == Lifecycle::Invalid; }
+
+private:
+    enum class Lifecycle {
+        Invalid,
+        Running,
+        Done
+    };
+
+    void reset() noexcept;
+    void setError(MysqlError error) noexcept;
+    void setRecvError(const IOError& io_error) noexcept;
+    std::expected<bool, MysqlError> tryParseFromRingBuffer();
+
+    AsyncMysqlClient& m_client;
+    Lifecycle m_lifecycle;
+
+    ProtocolRecvAwaitable m_recv_awaitable;
+    std::optional<MysqlError> m_chain_error;
+    std::string m_parse_scratch;
+
+public:
+    std::expected<std::optional<bool>, galay::kernel::IOError> m_result;
+};
+
 // ======================== AsyncMysqlClient ========================
 
 /**
@@ -676,9 +1076,45 @@ public:
     // ======================== 查询 ========================
 
     MysqlQueryAwaitable query(std::string_view sql);
+
+    /**
+     * @brief 查询并将每行直接映射为T
+     * @details T需声明MYSQL_FIELDS(...)或为成员类型受支持的聚合体，列按顺序对应成员。
+     * @code
+     * auto users = co_await client.queryAs<User>("SELECT id, name, age FROM users");
+     * @endcode
+     */
+    template<MysqlRowMappable T>
+    MysqlQueryAsAwaitable<T> queryAs(std::string_view sql);
+
     MysqlPipelineAwaitable batch(std::span<const protocol::MysqlCommandView> commands);
     MysqlPipelineAwaitable pipeline(std::span<const std::string_view> sqls);
 
+    /**
+     * @brief 执行多语句（或CALL存储过程）并返回全部结果集
+     * @details 一次往返内按到达顺序收集SERVER_MORE_RESULTS_EXISTS串起的每个结果集；
+     *          query()只返回第一个结果集，其余读完丢弃。
+     * @code
+     * auto r = co_await client.queryMulti("UPDATE t SET v = v + 1 WHERE id = 1; SELECT v FROM t WHERE id = 1");
+     * // (*r)->at(0)为UPDATE的OK，(*r)->at(1)为SELECT结果
+     * @endcode
+     */
+    MysqlPipelineAwaitable queryMulti(std::string_view sql);
+
+    /**
+     * @brief 执行LOAD DATA LOCAL INFILE，从调用方提供的数据源流式发送文件内容
+     * @details 需在MysqlConfig中开启allow_local_infile；服务端请求的文件名被忽略，只发送source的数据。
+     *          返回OK包对应的结果集，affectedRows()为导入的行数。
+     * @code
+     * auto r = co_await client.loadLocalInfile("LOAD DATA LOCAL INFILE 'feed' INTO TABLE events",
+     *     MysqlLocalInfileSource::fromGenerator([&]() -> std::optional<std::string> {
+     *         if (cursor == rows.end()) return std::nullopt;
+     *         return (cursor++)->toCsvLine();
+     *     }));
+     * @endcode
+     */
+    MysqlLocalInfileAwaitable loadLocalInfile(std::string_view sql, MysqlLocalInfileSource source);
+
     // ======================== 预处理语句 ========================
 
     MysqlPrepareAwaitable prepare(std::string_view sql);
@@ -689,6 +1125,28 @@ public:
                                           std::span<const std::optional<std::string_view>> params,
                                           std::span<const uint8_t> param_types = {});
 
+    /**
+     * @brief 以COM_STMT_SEND_LONG_DATA流式发送参数param_id的数据
+     * @details 大BLOB/TEXT参数不必整体放进COM_STMT_EXECUTE包；数据源出错时已发送的部分留在服务端，
+     *          应stmtClose后重新prepare。同一参数可多次调用，数据依次追加。
+     * @code
+     * auto sent = co_await client.stmtSendLongData(stmt_id, 1, MysqlLongDataSource::fromFile("/data/doc.pdf"));
+     * std::array<std::optional<std::string_view>, 2> params{"doc-42", std::nullopt};
+     * std::array<uint16_t, 1> long_data{1};
+     * auto r = co_await client.stmtExecute(stmt_id, params, {}, long_data);
+     * @endcode
+     */
+    MysqlStmtLongDataAwaitable stmtSendLongData(uint32_t stmt_id, uint16_t param_id, MysqlLongDataSource source);
+
+    /**
+     * @brief 执行预处理语句，long_data_params中的参数使用此前stmtSendLongData发送的数据
+     * @details params仍需覆盖全部参数，长数据参数所在位置的值被忽略
+     */
+    MysqlStmtExecuteAwaitable stmtExecute(uint32_t stmt_id,
+                                          std::span<const std::optional<std::string_view>> params,
+                                          std::span<const uint8_t> param_types,
+                                          std::span<const uint16_t> long_data_params);
+
     // ======================== 事务 ========================
 
     MysqlQueryAwaitable beginTransaction();
@@ -700,6 +1158,86 @@ public:
     MysqlQueryAwaitable ping();
     MysqlQueryAwaitable useDatabase(std::string_view database);
 
+    // ======================== 超时恢复 ========================
+
+    /**
+     * @brief 服务端分配的连接ID（HandshakeV10中的thread id）
+     */
+    uint32_t connectionId() const { return m_connection_id; }
+
+    /**
+     * @brief 在本连接上发送KILL QUERY，中断另一个连接上正在执行的语句
+     * @details 通常在旁路连接（如从连接池借出的另一个客户端）上调用
+     */
+    MysqlQueryAwaitable killQuery(uint32_t connection_id);
+
+    /**
+     * @brief 是否有被超时打断、尚未读完的响应
+     * @details 为true时新命令直接返回MYSQL_ERROR_CONNECTION，需先drain()
+     */
+    bool hasPendingResponse() const { return m_pending.responses > 0; }
+
+    /**
+     * @brief 连接是否停在响应边界上、可继续使用或归还连接池
+     */
+    bool isReusable() const { return !m_is_closed && !m_pending.broken && m_pending.responses == 0; }
+
+    /**
+     * @brief 是否只差读完被超时打断的响应即可复用（请求完整发出、传输未出错）
+     */
+    bool isDrainable() const { return !m_is_closed && !m_pending.broken && m_pending.responses > 0; }
+
+    /**
+     * @brief 读完被打断命令的剩余响应
+     * @details 超时后服务端语句仍在执行，应先在旁路连接上killQuery(connectionId())再drain()，
+     *          否则需等语句自然结束。
+     * @code
+     * auto slow = client.query("SELECT SLEEP(10)");
+     * slow.timeout(std::chrono::milliseconds(100));
+     * auto r = co_await slow;
+     * if (!r && client.hasPendingResponse()) {
+     *     auto side = co_await pool.acquire();
+     *     co_await (**side)->killQuery(client.connectionId());
+     *     pool.release(**side);
+     *     auto draining = client.drain();
+     *     draining.timeout(std::chrono::seconds(1));
+     *     auto drained = co_await draining;
+     *     // drained成功后client.isReusable()为true
+     * }
+     * @endcode
+     */
+    MysqlDrainAwaitable drain();
+
+    // ======================== 取消 ========================
+
+    using CancelHook = std::function<void(uint32_t connection_id, uint64_t generation)>;
+
+    /**
+     * @brief 设置取消钩子
+     * @details 绑定了取消令牌的命令在已发出、尚未结束时被取消，在调用cancel()的线程中以本连接ID和命令代号调用，
+     *          用于在旁路连接上KILL QUERY使服务端尽快返回；未发出或已结束的命令不会触发。
+     *          钩子不应在该线程中访问客户端，应回到客户端的调度器后确认inflightGeneration()仍等于generation再KILL，
+     *          否则KILL可能落到复用该连接的下一条语句上。未设置时只能等语句自然结束后丢弃结果。
+     *          连接池创建的连接默认设置为借用池内另一条连接执行KILL QUERY。
+     */
+    void setCancelHook(CancelHook hook) { m_cancel_hook = std::move(hook); }
+
+    /**
+     * @brief 当前在途的可取消命令的代号
+     * @details 绑定了取消令牌的命令完整发出时分配（进程内唯一且递增），收到终止包或出错时清零；
+     *          没有此类命令时为0。只应在客户端的调度器上读取。
+     */
+    uint64_t inflightGeneration() const { return m_inflight_generation; }
+
+    // ======================== 结果集复用 ========================
+
+    /**
+     * @brief 归还不再使用的结果集
+     * @details 结果集被清空后留作下一次query/stmtExecute的行存储，
+     *          行对象及其字符串容量得以复用；不调用则按普通对象析构。
+     */
+    void recycle(MysqlResultSet&& result_set) noexcept;
+
     // ======================== 连接管理 ========================
 
     auto close() { m_is_closed = true; return m_socket.close(); }
@@ -724,6 +1262,32 @@ private:
     friend class MysqlPrepareAwaitable;
     friend class MysqlStmtExecuteAwaitable;
     friend class MysqlPipelineAwaitable;
+    friend class MysqlLocalInfileAwaitable;
+    friend class MysqlStmtLongDataAwaitable;
+    friend class MysqlDrainAwaitable;
+    friend class MysqlCancelBinding;
+    friend class MysqlConnector;
+    template<MysqlRowMappable T> friend class MysqlQueryAsAwaitable;
+
+    /**
+     * @brief 按目标地址准备套接字：去掉IPv6字面量的方括号，IPv6地址换用AF_INET6套接字
+     */
+    void prepareSocket(MysqlConfig& config);
+
+    /**
+     * @brief 接管other已完成握手的连接，保留本对象的取消钩子、接收缓冲与日志器
+     */
+    void adoptConnection(AsyncMysqlClient& other) noexcept;
+
+    /**
+     * @brief 命令未正常结束时记录连接状态
+     * @param sent 已发出的请求字节数，为0时连接仍在边界上
+     * @param responses 尚未读完的响应数
+     * @param timed_out 仅超时可恢复，其余传输错误视为连接损坏
+     */
+    void markInterrupted(const protocol::MysqlResultDecoder& decoder,
+                         size_t sent, size_t total, size_t responses, bool timed_out) noexcept;
+    std::optional<MysqlError> checkIdle() const;
 
     bool m_is_closed = false;
     TcpSocket m_socket;
@@ -733,6 +1297,15 @@ private:
     AsyncMysqlConfig m_config;
     MysqlBufferHandle m_ring_buffer;
     uint32_t m_server_capabilities = 0;
+    uint32_t m_connection_id = 0;
+    MysqlPendingResponse m_pending;
+    CancelHook m_cancel_hook;
+    uint64_t m_inflight_generation = 0;
+
+    // 跨等待体复用的命令缓冲与结果集存储
+    MysqlCommandScratch m_query_scratch;
+    MysqlCommandScratch m_stmt_scratch;
+    MysqlResultSet m_result_arena;
 
     MysqlLoggerPtr m_logger;
 };
@@ -742,6 +1315,22 @@ inline galay::mysql::AsyncMysqlClient galay::mysql::AsyncMysqlClientBuilder::bui
     return AsyncMysqlClient(m_scheduler, m_config, m_buffer_provider);
 }
 
+template<MysqlRowMappable T>
+MysqlQueryAsAwaitable<T>::MysqlQueryAsAwaitable(AsyncMysqlClient& client, std::string_view sql)
+    : m_query(client, sql)
+{
+    if (client.m_config.result_row_reserve_hint > 0) {
+        m_collector.reserve(client.m_config.result_row_reserve_hint);
+    }
+    m_query.setRowSink(&m_collector);
+}
+
+template<MysqlRowMappable T>
+MysqlQueryAsAwaitable<T> AsyncMysqlClient::queryAs(std::string_view sql)
+{
+    return MysqlQueryAsAwaitable<T>(*this, sql);
+}
+
 } // namespace galay::mysql
 
 #endif // GALAY_MYSQL_ASYNC_CLIENT_H
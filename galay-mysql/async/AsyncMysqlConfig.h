@@ -15,6 +15,8 @@ struct AsyncMysqlConfig
     std::chrono::milliseconds send_timeout = std::chrono::milliseconds(-1);
     std::chrono::milliseconds recv_timeout = std::chrono::milliseconds(-1);
     size_t buffer_size = 16384;
+    // >0时使用MysqlAdaptiveBufferProvider：常驻4KB内联区，按包大小扩容到该上限（忽略buffer_size）
+    size_t max_buffer_size = 0;
     // 结果集行预分配提示（0表示不预分配）
     size_t result_row_reserve_hint = 0;
 
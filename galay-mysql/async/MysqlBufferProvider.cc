@@ -1,4 +1,12 @@
 #include "MysqlBufferProvider.h"
+#include "galay-mysql/protocol/MysqlPacket.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
 
 namespace galay::mysql
 {
@@ -33,6 +41,339 @@ void MysqlRingBufferProvider::clear()
     m_buffer.clear();
 }
 
+namespace
+{
+constexpr size_t kPageSize = 4096;
+constexpr size_t kCacheLineSize = 64;
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+size_t roundUp(size_t value, size_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+// 线性缓冲区的写窗口：尾部剩余不足1/4时前移未解析数据，通常只是半个包，拷贝量很小
+size_t linearWriteWindow(char* base, size_t capacity, size_t& read, size_t& write, struct iovec* out)
+{
+    if (read > 0 && capacity - write < capacity / 4) {
+        const size_t pending = write - read;
+        std::memmove(base, base + read, pending);
+        read = 0;
+        write = pending;
+    }
+    if (write == capacity) {
+        return 0;
+    }
+    out[0] = {base + write, capacity - write};
+    return 1;
+}
+} // namespace
+
+void MysqlLinearBufferProvider::FreeDeleter::operator()(char* ptr) const noexcept
+{
+    std::free(ptr);
+}
+
+MysqlLinearBufferProvider::MysqlLinearBufferProvider(size_t capacity)
+    : m_capacity((std::max<size_t>(capacity, 1) + kPageSize - 1) / kPageSize * kPageSize)
+{
+    m_storage.reset(static_cast<char*>(std::aligned_alloc(kPageSize, m_capacity)));
+    if (!m_storage) {
+        throw std::bad_alloc();
+    }
+}
+
+size_t MysqlLinearBufferProvider::getWriteIovecs(struct iovec* out, size_t max_iovecs)
+{
+    if (max_iovecs == 0) {
+        return 0;
+    }
+    return linearWriteWindow(m_storage.get(), m_capacity, m_read, m_write, out);
+}
+
+size_t MysqlLinearBufferProvider::getReadIovecs(struct iovec* out, size_t max_iovecs) const
+{
+    if (max_iovecs == 0 || m_read == m_write) {
+        return 0;
+    }
+    out[0] = {m_storage.get() + m_read, m_write - m_read};
+    return 1;
+}
+
+void MysqlLinearBufferProvider::produce(size_t len)
+{
+    m_write += std::min(len, m_capacity - m_write);
+}
+
+void MysqlLinearBufferProvider::consume(size_t len)
+{
+    m_read += std::min(len, m_write - m_read);
+    if (m_read == m_write) {
+        m_read = 0;
+        m_write = 0;
+    }
+}
+
+void MysqlLinearBufferProvider::clear()
+{
+    m_read = 0;
+    m_write = 0;
+}
+
+MysqlBufferSlabPool::MysqlBufferSlabPool(MysqlBufferSlabPoolConfig config)
+    : m_chunk_size(roundUp(std::max<size_t>(config.chunk_size, 1), kCacheLineSize))
+    , m_slab_bytes(roundUp(m_chunk_size * std::max<size_t>(config.chunks_per_slab, 1), kHugePageSize))
+    , m_chunks_per_slab(m_slab_bytes / m_chunk_size)
+{
+}
+
+MysqlBufferSlabPool::~MysqlBufferSlabPool()
+{
+    for (void* slab : m_slabs) {
+        std::free(slab);
+    }
+}
+
+const std::shared_ptr<MysqlBufferSlabPool>& MysqlBufferSlabPool::global()
+{
+    static const std::shared_ptr<MysqlBufferSlabPool> pool = std::make_shared<MysqlBufferSlabPool>();
+    return pool;
+}
+
+char* MysqlBufferSlabPool::acquire()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free_chunks.empty()) {
+        allocateSlab();
+    }
+    char* chunk = m_free_chunks.back();
+    m_free_chunks.pop_back();
+    m_leased.fetch_add(1, std::memory_order_relaxed);
+    return chunk;
+}
+
+void MysqlBufferSlabPool::release(char* chunk) noexcept
+{
+    if (chunk == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // m_free_chunks在allocateSlab时已按总块数预留，这里不会再分配
+    m_free_chunks.push_back(chunk);
+    m_leased.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t MysqlBufferSlabPool::totalChunks() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slabs.size() * m_chunks_per_slab;
+}
+
+void MysqlBufferSlabPool::allocateSlab()
+{
+    void* slab = std::aligned_alloc(kHugePageSize, m_slab_bytes);
+    if (slab == nullptr) {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    ::madvise(slab, m_slab_bytes, MADV_HUGEPAGE);
+#endif
+    m_slabs.push_back(slab);
+    m_free_chunks.reserve(m_slabs.size() * m_chunks_per_slab);
+
+    char* base = static_cast<char*>(slab);
+    // 逆序压栈，先分出去的是低地址块
+    for (size_t i = m_chunks_per_slab; i > 0; --i) {
+        m_free_chunks.push_back(base + (i - 1) * m_chunk_size);
+    }
+}
+
+MysqlSlabBufferProvider::MysqlSlabBufferProvider(std::shared_ptr<MysqlBufferSlabPool> pool)
+    : m_pool(std::move(pool))
+{
+}
+
+MysqlSlabBufferProvider::~MysqlSlabBufferProvider()
+{
+    releaseChunk();
+}
+
+size_t MysqlSlabBufferProvider::getWriteIovecs(struct iovec* out, size_t max_iovecs)
+{
+    if (max_iovecs == 0) {
+        return 0;
+    }
+    if (m_chunk == nullptr) {
+        m_chunk = m_pool->acquire();
+    }
+    return linearWriteWindow(m_chunk, m_pool->chunkSize(), m_read, m_write, out);
+}
+
+size_t MysqlSlabBufferProvider::getReadIovecs(struct iovec* out, size_t max_iovecs) const
+{
+    if (max_iovecs == 0 || m_read == m_write) {
+        return 0;
+    }
+    out[0] = {m_chunk + m_read, m_write - m_read};
+    return 1;
+}
+
+void MysqlSlabBufferProvider::produce(size_t len)
+{
+    if (m_chunk == nullptr) {
+        return;
+    }
+    m_write += std::min(len, m_pool->chunkSize() - m_write);
+}
+
+void MysqlSlabBufferProvider::consume(size_t len)
+{
+    m_read += std::min(len, m_write - m_read);
+    if (m_read == m_write) {
+        releaseChunk();
+    }
+}
+
+void MysqlSlabBufferProvider::clear()
+{
+    releaseChunk();
+}
+
+void MysqlSlabBufferProvider::releaseChunk() noexcept
+{
+    m_read = 0;
+    m_write = 0;
+    if (m_chunk != nullptr) {
+        m_pool->release(m_chunk);
+        m_chunk = nullptr;
+    }
+}
+
+MysqlAdaptiveBufferProvider::MysqlAdaptiveBufferProvider(MysqlAdaptiveBufferConfig config)
+    : m_config(config)
+{
+    m_config.max_capacity = std::max(m_config.max_capacity, kInlineCapacity);
+}
+
+size_t MysqlAdaptiveBufferProvider::getWriteIovecs(struct iovec* out, size_t max_iovecs)
+{
+    if (max_iovecs == 0) {
+        return 0;
+    }
+
+    const size_t pending = pendingPacketSize();
+    if (pending > m_capacity || m_size == m_capacity) {
+        grow(std::max(pending, m_capacity * 2));
+    }
+    if (m_size == m_capacity) {
+        return 0;
+    }
+
+    char* base = storage();
+    const size_t tail = (m_head + m_size) % m_capacity;
+    if (tail >= m_head) {
+        out[0] = {base + tail, m_capacity - tail};
+        if (m_head > 0 && max_iovecs > 1) {
+            out[1] = {base, m_head};
+            return 2;
+        }
+        return 1;
+    }
+    out[0] = {base + tail, m_head - tail};
+    return 1;
+}
+
+size_t MysqlAdaptiveBufferProvider::getReadIovecs(struct iovec* out, size_t max_iovecs) const
+{
+    if (max_iovecs == 0 || m_size == 0) {
+        return 0;
+    }
+
+    char* base = const_cast<char*>(storage());
+    const size_t first = std::min(m_size, m_capacity - m_head);
+    out[0] = {base + m_head, first};
+    if (first < m_size && max_iovecs > 1) {
+        out[1] = {base, m_size - first};
+        return 2;
+    }
+    return 1;
+}
+
+void MysqlAdaptiveBufferProvider::produce(size_t len)
+{
+    m_size += std::min(len, m_capacity - m_size);
+    if (m_heap && m_size > kInlineCapacity) {
+        m_last_large_use = std::chrono::steady_clock::now();
+    }
+}
+
+void MysqlAdaptiveBufferProvider::consume(size_t len)
+{
+    len = std::min(len, m_size);
+    m_head = (m_head + len) % m_capacity;
+    m_size -= len;
+    if (m_size == 0) {
+        m_head = 0;
+        maybeShrink();
+    }
+}
+
+void MysqlAdaptiveBufferProvider::clear()
+{
+    m_head = 0;
+    m_size = 0;
+    m_heap.reset();
+    m_capacity = kInlineCapacity;
+}
+
+size_t MysqlAdaptiveBufferProvider::pendingPacketSize() const
+{
+    if (m_size < protocol::MYSQL_PACKET_HEADER_SIZE) {
+        return 0;
+    }
+    const char* base = storage();
+    size_t payload_len = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        const auto byte = static_cast<uint8_t>(base[(m_head + i) % m_capacity]);
+        payload_len |= static_cast<size_t>(byte) << (8 * i);
+    }
+    return protocol::MYSQL_PACKET_HEADER_SIZE + payload_len;
+}
+
+void MysqlAdaptiveBufferProvider::grow(size_t min_capacity)
+{
+    const size_t target = std::min(std::bit_ceil(min_capacity), m_config.max_capacity);
+    if (target <= m_capacity) {
+        return;
+    }
+
+    auto next = std::make_unique_for_overwrite<char[]>(target);
+    struct iovec readable[2];
+    const size_t count = getReadIovecs(readable, 2);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(next.get() + offset, readable[i].iov_base, readable[i].iov_len);
+        offset += readable[i].iov_len;
+    }
+
+    m_heap = std::move(next);
+    m_capacity = target;
+    m_head = 0;
+    m_last_large_use = std::chrono::steady_clock::now();
+}
+
+void MysqlAdaptiveBufferProvider::maybeShrink()
+{
+    if (!m_heap) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() - m_last_large_use < m_config.shrink_after) {
+        return;
+    }
+    m_heap.reset();
+    m_capacity = kInlineCapacity;
+}
+
 MysqlBufferHandle::MysqlBufferHandle(size_t capacity,
                                      std::shared_ptr<MysqlBufferProvider> provider)
 {
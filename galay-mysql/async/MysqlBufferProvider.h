@@ -3,8 +3,13 @@
 
 #include <galay-kernel/common/Buffer.h>
 
+#include <array>
+#include <chrono>
 #include <cstddef>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include <sys/uio.h>
 
 namespace galay::mysql
@@ -37,6 +42,177 @@ private:
     galay::kernel::RingBuffer m_buffer;
 };
 
+/**
+ * @brief 线性（非环形）接收缓冲区
+ * @details 存储按页对齐、地址在连接生命周期内不变，可直接注册为io_uring固定缓冲区；
+ *          读写窗口始终各为一段连续内存：写端空间不足时把未解析的尾部前移，
+ *          因此readv只提交单个iovec，解析端也不会因环形回绕而拷贝到临时缓冲。
+ */
+class MysqlLinearBufferProvider final : public MysqlBufferProvider
+{
+public:
+    explicit MysqlLinearBufferProvider(size_t capacity);
+
+    MysqlLinearBufferProvider(const MysqlLinearBufferProvider&) = delete;
+    MysqlLinearBufferProvider& operator=(const MysqlLinearBufferProvider&) = delete;
+
+    size_t getWriteIovecs(struct iovec* out, size_t max_iovecs = 2) override;
+    size_t getReadIovecs(struct iovec* out, size_t max_iovecs = 2) const override;
+    void produce(size_t len) override;
+    void consume(size_t len) override;
+    void clear() override;
+
+    char* data() { return m_storage.get(); }
+    size_t capacity() const { return m_capacity; }
+    size_t size() const { return m_write - m_read; }
+
+private:
+    struct FreeDeleter {
+        void operator()(char* ptr) const noexcept;
+    };
+
+    std::unique_ptr<char, FreeDeleter> m_storage;
+    size_t m_capacity;
+    size_t m_read = 0;
+    size_t m_write = 0;
+};
+
+/**
+ * @brief 缓冲块池配置
+ */
+struct MysqlBufferSlabPoolConfig
+{
+    // 单块大小，向上取整到缓存行
+    size_t chunk_size = 16384;
+    // 每次向系统申请的块数，总大小向上按2MB对齐以便使用透明大页（多出的空间也切成块）
+    size_t chunks_per_slab = 128;
+};
+
+/**
+ * @brief 接收缓冲块池
+ * @details 以2MB对齐的大块（slab）为单位申请内存并切分为定长块，块在池析构前不归还系统。
+ *          可全局共享（global()），也可按调度器各建一个以避免跨线程争用。
+ */
+class MysqlBufferSlabPool
+{
+public:
+    explicit MysqlBufferSlabPool(MysqlBufferSlabPoolConfig config = {});
+    ~MysqlBufferSlabPool();
+
+    MysqlBufferSlabPool(const MysqlBufferSlabPool&) = delete;
+    MysqlBufferSlabPool& operator=(const MysqlBufferSlabPool&) = delete;
+
+    /**
+     * @brief 进程级默认池（16KB块）
+     */
+    static const std::shared_ptr<MysqlBufferSlabPool>& global();
+
+    char* acquire();
+    void release(char* chunk) noexcept;
+
+    size_t chunkSize() const { return m_chunk_size; }
+    size_t leasedChunks() const { return m_leased.load(std::memory_order_relaxed); }
+    size_t totalChunks() const;
+
+private:
+    void allocateSlab();
+
+    size_t m_chunk_size;
+    size_t m_slab_bytes;
+    size_t m_chunks_per_slab;
+    mutable std::mutex m_mutex;
+    std::vector<char*> m_free_chunks;
+    std::vector<void*> m_slabs;
+    std::atomic<size_t> m_leased{0};
+};
+
+/**
+ * @brief 从缓冲块池租用内存的接收缓冲区
+ * @details 首次需要写窗口时租用一块，数据全部消费完（命令响应解析结束）或clear时归还，
+ *          大量空闲的池化连接因此只占用与在途命令数相当的缓冲内存。
+ *          读写窗口与MysqlLinearBufferProvider相同，始终为单段连续内存；单个包不能超过块大小。
+ */
+class MysqlSlabBufferProvider final : public MysqlBufferProvider
+{
+public:
+    explicit MysqlSlabBufferProvider(std::shared_ptr<MysqlBufferSlabPool> pool = MysqlBufferSlabPool::global());
+    ~MysqlSlabBufferProvider() override;
+
+    MysqlSlabBufferProvider(const MysqlSlabBufferProvider&) = delete;
+    MysqlSlabBufferProvider& operator=(const MysqlSlabBufferProvider&) = delete;
+
+    size_t getWriteIovecs(struct iovec* out, size_t max_iovecs = 2) override;
+    size_t getReadIovecs(struct iovec* out, size_t max_iovecs = 2) const override;
+    void produce(size_t len) override;
+    void consume(size_t len) override;
+    void clear() override;
+
+    bool leased() const { return m_chunk != nullptr; }
+    size_t size() const { return m_write - m_read; }
+
+private:
+    void releaseChunk() noexcept;
+
+    std::shared_ptr<MysqlBufferSlabPool> m_pool;
+    char* m_chunk = nullptr;
+    size_t m_read = 0;
+    size_t m_write = 0;
+};
+
+/**
+ * @brief 可增长缓冲区配置
+ */
+struct MysqlAdaptiveBufferConfig
+{
+    // 扩容上限，单个包超过该值时收包失败
+    size_t max_capacity = 64 * 1024 * 1024;
+    // 连续这么久没有收到超过内联区大小的数据后，在缓冲区清空时释放扩容内存
+    std::chrono::milliseconds shrink_after = std::chrono::seconds(5);
+};
+
+/**
+ * @brief 按需增长的接收缓冲区
+ * @details 常驻一块固定的内联区（kInlineCapacity），小包不产生额外分配；
+ *          当读端待解析包头声明的长度放不下、或缓冲区已满时，按2倍扩容到堆上；
+ *          缓冲区清空且空闲超过shrink_after后回落到内联区。
+ */
+class MysqlAdaptiveBufferProvider final : public MysqlBufferProvider
+{
+public:
+    static constexpr size_t kInlineCapacity = 4096;
+
+    explicit MysqlAdaptiveBufferProvider(MysqlAdaptiveBufferConfig config = {});
+
+    MysqlAdaptiveBufferProvider(const MysqlAdaptiveBufferProvider&) = delete;
+    MysqlAdaptiveBufferProvider& operator=(const MysqlAdaptiveBufferProvider&) = delete;
+
+    size_t getWriteIovecs(struct iovec* out, size_t max_iovecs = 2) override;
+    size_t getReadIovecs(struct iovec* out, size_t max_iovecs = 2) const override;
+    void produce(size_t len) override;
+    void consume(size_t len) override;
+    void clear() override;
+
+    size_t capacity() const { return m_capacity; }
+    size_t size() const { return m_size; }
+    bool usesInlineStorage() const { return m_heap == nullptr; }
+
+private:
+    char* storage() { return m_heap ? m_heap.get() : m_inline.data(); }
+    const char* storage() const { return m_heap ? m_heap.get() : m_inline.data(); }
+
+    size_t pendingPacketSize() const;
+    void grow(size_t min_capacity);
+    void maybeShrink();
+
+    MysqlAdaptiveBufferConfig m_config;
+    std::unique_ptr<char[]> m_heap;
+    size_t m_capacity = kInlineCapacity;
+    size_t m_head = 0;
+    size_t m_size = 0;
+    std::chrono::steady_clock::time_point m_last_large_use{};
+    alignas(64) std::array<char, kInlineCapacity> m_inline;
+};
+
 class MysqlBufferHandle
 {
 public:
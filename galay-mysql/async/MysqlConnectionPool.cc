@@ -1,10 +1,41 @@
 #include "MysqlConnectionPool.h"
 
+#include <algorithm>
+#include <string>
 #include <utility>
 
 namespace galay::mysql
 {
 
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr double kLatencyEwmaAlpha = 0.2;
+
+bool isEndpointFailure(MysqlErrorType type)
+{
+    switch (type) {
+    case MYSQL_ERROR_CONNECTION:
+    case MYSQL_ERROR_SEND:
+    case MYSQL_ERROR_RECV:
+    case MYSQL_ERROR_TIMEOUT:
+    case MYSQL_ERROR_CONNECTION_CLOSED:
+    case MYSQL_ERROR_PROTOCOL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+MysqlError endpointUnavailable(std::string reason)
+{
+    return MysqlError(MYSQL_ERROR_UNAVAILABLE, std::move(reason));
+}
+
+} // namespace
+
 // ======================== MysqlConnectionPool ========================
 
 MysqlConnectionPool::MysqlConnectionPool(galay::kernel::IOScheduler* scheduler,
@@ -14,12 +45,17 @@ MysqlConnectionPool::MysqlConnectionPool(galay::kernel::IOScheduler* scheduler,
     , m_async_config(std::move(config.async_config))
     , m_min_connections(config.min_connections)
     , m_max_connections(config.max_connections)
+    , m_buffer_provider_factory(std::move(config.buffer_provider_factory))
+    , m_breaker(config.breaker)
+    , m_resolver(config.resolver ? std::move(config.resolver) : MysqlResolver::shared())
+    , m_recover_timeout(config.recover_timeout)
+    , m_backoff(config.breaker.backoff)
 {
 }
 
 MysqlConnectionPool::~MysqlConnectionPool()
 {
-    std::queue<std::coroutine_handle<>> waiters_to_resume;
+    std::queue<AcquireAwaitable*> waiters_to_resume;
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         waiters_to_resume.swap(m_waiters);
@@ -29,9 +65,10 @@ MysqlConnectionPool::~MysqlConnectionPool()
         m_all_clients.clear();
     }
     while (!waiters_to_resume.empty()) {
-        auto h = waiters_to_resume.front();
+        auto* waiter = waiters_to_resume.front();
         waiters_to_resume.pop();
-        h.resume();
+        waiter->m_error = MysqlError(MYSQL_ERROR_INTERNAL, "Connection pool destroyed");
+        waiter->m_handle.resume();
     }
 }
 
@@ -52,8 +89,12 @@ AsyncMysqlClient* MysqlConnectionPool::createClient()
     if (m_total_connections.load(std::memory_order_relaxed) >= m_max_connections) {
         return nullptr;
     }
-    auto client = std::make_unique<AsyncMysqlClient>(m_scheduler, m_async_config);
+    auto client = std::make_unique<AsyncMysqlClient>(
+        m_scheduler, m_async_config, m_buffer_provider_factory ? m_buffer_provider_factory() : nullptr);
     auto* ptr = client.get();
+    ptr->setCancelHook([this, ptr](uint32_t connection_id, uint64_t generation) {
+        m_scheduler->spawn(killQueryTask(this, ptr, connection_id, generation));
+    });
     m_all_clients.push_back(std::move(client));
     m_total_connections.fetch_add(1, std::memory_order_relaxed);
     return ptr;
@@ -63,18 +104,339 @@ void MysqlConnectionPool::release(AsyncMysqlClient* client)
 {
     if (!client) return;
 
-    std::coroutine_handle<> waiter_to_resume;
+    if (client->isDrainable() && m_recover_timeout.count() > 0) {
+        m_scheduler->spawn(recoverTask(this, client));
+        return;
+    }
+    if (!client->isReusable()) {
+        // 只有请求发出一半或传输出错（broken）说明端点有问题；超时未读完的响应不计
+        if (!client->isClosed() && !client->isDrainable()) {
+            onEndpointFailure();
+        }
+        discard(client);
+        return;
+    }
+
+    AcquireAwaitable* waiter = nullptr;
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         if (!m_waiters.empty()) {
-            waiter_to_resume = m_waiters.front();
+            waiter = m_waiters.front();
+            m_waiters.pop();
+            waiter->m_client = client;
+        } else {
+            m_idle_clients.push(client);
+        }
+    }
+    if (waiter && waiter->m_probe) {
+        m_scheduler->spawn(probeTask(this, waiter));
+    } else if (waiter) {
+        waiter->m_handle.resume();
+    }
+}
+
+void MysqlConnectionPool::recordSuccess(std::chrono::microseconds latency)
+{
+    onEndpointSuccess(latency);
+}
+
+void MysqlConnectionPool::recordFailure(const MysqlError& error)
+{
+    if (isEndpointFailure(error.type())) {
+        onEndpointFailure();
+    }
+}
+
+MysqlEndpointHealth MysqlConnectionPool::health() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MysqlEndpointHealth health;
+    switch (m_breaker_state) {
+    case BreakerState::Closed:   health.state = MysqlEndpointState::Healthy; break;
+    case BreakerState::Open:     health.state = MysqlEndpointState::Ejected; break;
+    case BreakerState::HalfOpen: health.state = MysqlEndpointState::Probing; break;
+    }
+    health.consecutive_failures = m_consecutive_failures;
+    health.ejections = m_ejections;
+    health.latency_ewma_us = m_latency_ewma_us;
+    health.backoff = m_backoff;
+    return health;
+}
+
+std::expected<bool, MysqlError> MysqlConnectionPool::admit()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    switch (m_breaker_state) {
+    case BreakerState::Closed:
+        return false;
+    case BreakerState::Open: {
+        const auto now = Clock::now();
+        if (now < m_open_until) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(m_open_until - now);
+            return std::unexpected(endpointUnavailable("Endpoint ejected, retry in " +
+                                                       std::to_string(left.count()) + "ms"));
+        }
+        // 退避结束：本次获取作为探测，结论出来之前其余获取继续快速失败
+        m_breaker_state = BreakerState::HalfOpen;
+        return true;
+    }
+    case BreakerState::HalfOpen:
+        break;
+    }
+    return std::unexpected(endpointUnavailable("Endpoint probe in progress"));
+}
+
+void MysqlConnectionPool::onEndpointSuccess(std::chrono::microseconds latency)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const double sample_us = static_cast<double>(latency.count());
+        const bool outlier = sample_us > 0.0 && m_breaker.latency_outlier_factor > 0.0 && m_latency_ewma_us > 0.0
+            && sample_us > m_breaker.latency_outlier_factor * m_latency_ewma_us
+            && latency >= m_breaker.latency_outlier_floor;
+        if (!outlier) {
+            if (sample_us > 0.0) {
+                m_latency_ewma_us = m_latency_ewma_us == 0.0
+                    ? sample_us
+                    : kLatencyEwmaAlpha * sample_us + (1.0 - kLatencyEwmaAlpha) * m_latency_ewma_us;
+            }
+            if (m_breaker_state == BreakerState::HalfOpen) {
+                m_breaker_state = BreakerState::Closed;
+                m_backoff = m_breaker.backoff;
+            }
+            if (m_breaker_state == BreakerState::Closed) {
+                m_consecutive_failures = 0;
+            }
+            return;
+        }
+    }
+    // 离群样本不进入EWMA，避免持续变慢的端点把基线拉高
+    onEndpointFailure();
+}
+
+void MysqlConnectionPool::onEndpointFailure()
+{
+    std::vector<AcquireAwaitable*> rejected;
+    std::vector<AsyncMysqlClient*> idle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        switch (m_breaker_state) {
+        case BreakerState::Closed:
+            ++m_consecutive_failures;
+            if (m_breaker.failure_threshold > 0 && m_consecutive_failures >= m_breaker.failure_threshold) {
+                openBreakerLocked(m_breaker.backoff, rejected, idle);
+            }
+            break;
+        case BreakerState::HalfOpen:
+            ++m_consecutive_failures;
+            openBreakerLocked(std::min(m_backoff * 2, m_breaker.max_backoff), rejected, idle);
+            break;
+        case BreakerState::Open:
+            break;
+        }
+    }
+    resumeRejected(rejected, idle);
+}
+
+void MysqlConnectionPool::openBreakerLocked(std::chrono::milliseconds backoff,
+                                            std::vector<AcquireAwaitable*>& rejected,
+                                            std::vector<AsyncMysqlClient*>& idle)
+{
+    m_breaker_state = BreakerState::Open;
+    m_backoff = backoff;
+    m_open_until = Clock::now() + backoff;
+    ++m_ejections;
+    while (!m_waiters.empty()) {
+        auto* waiter = m_waiters.front();
+        m_waiters.pop();
+        waiter->m_error = endpointUnavailable("Endpoint ejected after " + std::to_string(m_consecutive_failures) +
+                                              " consecutive failures");
+        rejected.push_back(waiter);
+    }
+    // 空闲连接多半已随端点失效，关闭后探测总能新建连接
+    while (!m_idle_clients.empty()) {
+        idle.push_back(m_idle_clients.front());
+        m_idle_clients.pop();
+    }
+}
+
+void MysqlConnectionPool::resumeRejected(std::vector<AcquireAwaitable*>& rejected,
+                                         std::vector<AsyncMysqlClient*>& idle)
+{
+    for (auto* client : idle) {
+        discard(client);
+    }
+    for (auto* waiter : rejected) {
+        waiter->m_handle.resume();
+    }
+}
+
+void MysqlConnectionPool::discard(AsyncMysqlClient* client)
+{
+    std::unique_ptr<AsyncMysqlClient> owned;
+    AcquireAwaitable* waiter = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_all_clients.begin(), m_all_clients.end(),
+                               [client](const auto& c) { return c.get() == client; });
+        if (it != m_all_clients.end()) {
+            owned = std::move(*it);
+            m_all_clients.erase(it);
+            m_total_connections.fetch_sub(1, std::memory_order_relaxed);
+        }
+        // 腾出的名额为队首等待者新建连接；熔断中不新建，等待者已被快速失败
+        if (!m_waiters.empty() && m_breaker_state == BreakerState::Closed) {
+            waiter = m_waiters.front();
             m_waiters.pop();
         }
-        m_idle_clients.push(client);
     }
-    if (waiter_to_resume) {
-        waiter_to_resume.resume();
+    if (owned) {
+        // 连接对象随关闭协程一起释放，不依赖连接池的生命周期
+        m_scheduler->spawn(closeTask(std::move(owned)));
+    }
+    if (waiter) {
+        m_scheduler->spawn(replaceTask(this, waiter));
+    }
+}
+
+galay::kernel::Coroutine MysqlConnectionPool::closeTask(std::unique_ptr<AsyncMysqlClient> client)
+{
+    co_await client->close();
+}
+
+galay::kernel::Coroutine MysqlConnectionPool::replaceTask(MysqlConnectionPool* pool, AcquireAwaitable* waiter)
+{
+    {
+        std::lock_guard<std::mutex> lock(pool->m_mutex);
+        if (pool->m_breaker_state != BreakerState::Closed) {
+            waiter->m_error = endpointUnavailable("Endpoint ejected");
+        }
+    }
+    if (waiter->m_error) {
+        waiter->m_handle.resume();
+        co_return;
+    }
+    AsyncMysqlClient* replacement = pool->createClient();
+    if (!replacement) {
+        std::lock_guard<std::mutex> lock(pool->m_mutex);
+        pool->m_waiters.push(waiter);
+        co_return;
     }
+    const auto started = Clock::now();
+    auto connected = co_await MysqlConnector::connect(*replacement, pool->m_mysql_config, pool->m_resolver);
+    if (connected && connected->has_value()) {
+        pool->onEndpointSuccess(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started));
+        waiter->m_client = replacement;
+    } else {
+        waiter->m_error = connected ? MysqlError(MYSQL_ERROR_INTERNAL, "Connect awaitable resumed without value")
+                                    : connected.error();
+        pool->onEndpointFailure();
+        pool->discard(replacement);
+    }
+    waiter->m_handle.resume();
+}
+
+galay::kernel::Coroutine MysqlConnectionPool::probeTask(MysqlConnectionPool* pool, AcquireAwaitable* waiter)
+{
+    AsyncMysqlClient* client = waiter->m_client;
+    const auto started = Clock::now();
+    auto pinged = co_await client->ping();
+    if (pinged) {
+        pool->onEndpointSuccess(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started));
+    } else {
+        waiter->m_client = nullptr;
+        waiter->m_error = std::move(pinged.error());
+        pool->onEndpointFailure();
+        pool->discard(client);
+    }
+    waiter->m_handle.resume();
+}
+
+galay::kernel::Coroutine MysqlConnectionPool::killQueryTask(MysqlConnectionPool* pool, AsyncMysqlClient* client,
+                                                            uint32_t connection_id, uint64_t generation)
+{
+    if (!pool->isInflight(client, generation)) {
+        co_return;
+    }
+    auto acquired = co_await pool->acquire();
+    if (!acquired || !acquired->has_value()) {
+        co_return;
+    }
+    AsyncMysqlClient* side = acquired->value();
+    // 等待借用期间命令可能已经结束、连接已被复用，发送前再确认一次
+    if (pool->isInflight(client, generation)) {
+        auto killed = co_await side->killQuery(connection_id);
+        if (!killed) {
+            MysqlLogDebug(side->logger(), "KILL QUERY {} failed: {}", connection_id, killed.error().message());
+        }
+    }
+    pool->release(side);
+}
+
+bool MysqlConnectionPool::isInflight(AsyncMysqlClient* client, uint64_t generation) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool owned = std::any_of(m_all_clients.begin(), m_all_clients.end(),
+                                   [client](const auto& c) { return c.get() == client; });
+    // 代号全局唯一，同一地址上的新连接不会与旧代号相等
+    return owned && client->inflightGeneration() == generation;
+}
+
+galay::kernel::Coroutine MysqlConnectionPool::recoverTask(MysqlConnectionPool* pool, AsyncMysqlClient* client)
+{
+    const uint32_t connection_id = client->connectionId();
+    AsyncMysqlClient* side = pool->tryAcquire();
+    std::unique_ptr<AsyncMysqlClient> temporary;
+    if (!side) {
+        // 池已满时等待空闲连接可能要等到这条连接自己恢复，改用临时连接
+        temporary = std::make_unique<AsyncMysqlClient>(pool->m_scheduler, pool->m_async_config);
+        auto connected = co_await MysqlConnector::connect(*temporary, pool->m_mysql_config, pool->m_resolver);
+        if (connected && connected->has_value()) {
+            side = temporary.get();
+        } else {
+            MysqlLogDebug(client->logger(), "recover {}: side connection failed", connection_id);
+        }
+    }
+    if (side) {
+        // 借用期间连接可能已被关闭或移出本池，发送前确认
+        if (pool->isDraining(client)) {
+            auto killed = co_await side->killQuery(connection_id);
+            if (!killed) {
+                MysqlLogDebug(side->logger(), "KILL QUERY {} failed: {}", connection_id, killed.error().message());
+            }
+        }
+        if (temporary) {
+            co_await temporary->close();
+        } else {
+            pool->release(side);
+        }
+    }
+    if (!pool->isDraining(client)) {
+        co_return;
+    }
+
+    auto draining = client->drain();
+    draining.timeout(pool->m_recover_timeout);
+    auto drained = co_await draining;
+    if (drained && client->isReusable()) {
+        pool->release(client);
+        co_return;
+    }
+    MysqlLogDebug(client->logger(), "recover {} failed: {}", connection_id,
+                  drained ? std::string("response still pending") : drained.error().message());
+    // 排空超时只说明语句没被及时中断，传输错误才计为端点故障
+    if (!drained && drained.error().type() != MYSQL_ERROR_TIMEOUT && isEndpointFailure(drained.error().type())) {
+        pool->onEndpointFailure();
+    }
+    pool->discard(client);
+}
+
+bool MysqlConnectionPool::isDraining(AsyncMysqlClient* client) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool owned = std::any_of(m_all_clients.begin(), m_all_clients.end(),
+                                   [client](const auto& c) { return c.get() == client; });
+    return owned && client->isDrainable();
 }
 
 size_t MysqlConnectionPool::idleCount() const
@@ -103,12 +465,29 @@ bool MysqlConnectionPool::AcquireAwaitable::await_suspend(std::coroutine_handle<
     if (m_state != State::Invalid) {
         return false;
     }
+    m_client = nullptr;
+    m_error.reset();
+
+    auto admitted = m_pool.admit();
+    if (!admitted) {
+        m_state = State::Rejected;
+        m_error = std::move(admitted.error());
+        return false;
+    }
+    m_probe = admitted.value();
 
     // 尝试获取空闲连接
     m_client = m_pool.tryAcquire();
     if (m_client) {
-        m_state = State::Ready;
         m_connect_awaitable.reset();
+        if (m_probe) {
+            // 空闲连接可能在熔断前就已建立，探测必须真正到达端点
+            m_state = State::Waiting;
+            m_handle = handle;
+            m_pool.m_scheduler->spawn(probeTask(&m_pool, this));
+            return true;
+        }
+        m_state = State::Ready;
         return false; // 不挂起，立即返回
     }
 
@@ -116,29 +495,43 @@ bool MysqlConnectionPool::AcquireAwaitable::await_suspend(std::coroutine_handle<
     m_client = m_pool.createClient();
     if (m_client) {
         m_state = State::Creating;
-        m_connect_awaitable.emplace(*m_client, m_pool.m_mysql_config);
+        m_started_at = Clock::now();
+        m_connect_awaitable.emplace(*m_client, m_pool.m_mysql_config, m_pool.m_resolver);
         return m_connect_awaitable->await_suspend(handle);
     }
 
-    // 池已满，等待连接释放
+    // 池已满，等待连接释放（归还的连接直接交给等待者）
     m_state = State::Waiting;
     m_connect_awaitable.reset();
-    std::lock_guard<std::mutex> lock(m_pool.m_mutex);
-    m_pool.m_waiters.push(handle);
+    m_handle = handle;
+    std::unique_lock<std::mutex> lock(m_pool.m_mutex);
+    if (!m_pool.m_idle_clients.empty()) {
+        m_client = m_pool.m_idle_clients.front();
+        m_pool.m_idle_clients.pop();
+        if (m_probe) {
+            lock.unlock();
+            m_pool.m_scheduler->spawn(probeTask(&m_pool, this));
+            return true;
+        }
+        m_state = State::Ready;
+        return false;
+    }
+    m_pool.m_waiters.push(this);
     return true;
 }
 
 std::expected<std::optional<AsyncMysqlClient*>, MysqlError>
 MysqlConnectionPool::AcquireAwaitable::await_resume()
 {
-    if (m_state == State::Ready) {
-        m_state = State::Invalid;
+    const State state = m_state;
+    m_state = State::Invalid;
+
+    if (state == State::Ready) {
         m_connect_awaitable.reset();
         return m_client;
     }
-    else if (m_state == State::Creating) {
+    else if (state == State::Creating) {
         if (!m_connect_awaitable.has_value()) {
-            m_state = State::Invalid;
             m_client = nullptr;
             return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Missing connect awaitable in creating state"));
         }
@@ -146,31 +539,34 @@ MysqlConnectionPool::AcquireAwaitable::await_resume()
         auto result = m_connect_awaitable.value().await_resume();
         m_connect_awaitable.reset();
 
-        if (!result) {
-            m_state = State::Invalid;
-            m_client = nullptr;
-            return std::unexpected(result.error());
-        }
-        if (!result->has_value()) {
-            m_state = State::Invalid;
+        if (!result || !result->has_value()) {
+            // 建连失败的连接不再占用名额
+            m_pool.onEndpointFailure();
+            m_pool.discard(m_client);
             m_client = nullptr;
+            if (!result) {
+                return std::unexpected(result.error());
+            }
             return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Connect awaitable resumed without value"));
         }
-        m_state = State::Invalid;
+        m_pool.onEndpointSuccess(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_started_at));
         return m_client;
     }
-    else if (m_state == State::Waiting) {
-        // 被唤醒后，从池中获取连接
-        m_client = m_pool.tryAcquire();
-        m_state = State::Invalid;
+    else if (state == State::Waiting) {
         m_connect_awaitable.reset();
         if (m_client) {
             return m_client;
         }
+        if (m_error) {
+            return std::unexpected(std::move(*m_error));
+        }
         return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Failed to acquire connection after wakeup"));
     }
+    else if (state == State::Rejected) {
+        m_client = nullptr;
+        return std::unexpected(std::move(*m_error));
+    }
 
-    m_state = State::Invalid;
     m_connect_awaitable.reset();
     m_client = nullptr;
     return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Invalid acquire state"));
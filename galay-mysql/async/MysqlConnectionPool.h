@@ -2,10 +2,13 @@
 #define GALAY_MYSQL_CONNECTION_POOL_H
 
 #include "AsyncMysqlClient.h"
+#include "MysqlConnector.h"
 #include "galay-mysql/base/MysqlConfig.h"
 #include <galay-kernel/kernel/IOScheduler.hpp>
 #include <galay-kernel/kernel/Coroutine.h>
 #include <galay-kernel/concurrency/AsyncWaiter.h>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <queue>
@@ -17,17 +20,61 @@
 namespace galay::mysql
 {
 
+/**
+ * @brief 端点熔断配置
+ * @details 连续failure_threshold次端点故障（建连失败、传输错误、recordFailure()上报的超时、离群延迟）后熔断backoff，
+ *          期间acquire()立即返回MYSQL_ERROR_UNAVAILABLE；退避结束后只放行一次获取作为探测，
+ *          成功则恢复，失败则熔断时长翻倍（不超过max_backoff）。
+ */
+struct MysqlCircuitBreakerConfig
+{
+    size_t failure_threshold = 5;                           // 0表示关闭熔断
+    std::chrono::milliseconds backoff{500};
+    std::chrono::milliseconds max_backoff{30000};
+    double latency_outlier_factor = 0.0;                    // 耗时超过延迟EWMA的该倍数计为一次故障，0表示不检测
+    std::chrono::milliseconds latency_outlier_floor{50};    // 低于该耗时的样本不算离群
+};
+
+/**
+ * @brief 端点健康状态
+ */
+enum class MysqlEndpointState : uint8_t
+{
+    Healthy,
+    Ejected,        // 熔断中，acquire()快速失败
+    Probing         // 退避结束，探测连接进行中
+};
+
+struct MysqlEndpointHealth
+{
+    MysqlEndpointState state = MysqlEndpointState::Healthy;
+    size_t consecutive_failures = 0;
+    uint64_t ejections = 0;
+    double latency_ewma_us = 0.0;
+    std::chrono::milliseconds backoff{0};                   // 当前（或下一次）熔断时长
+};
+
 struct MysqlConnectionPoolConfig
 {
     MysqlConfig mysql_config = MysqlConfig::defaultConfig();
     AsyncMysqlConfig async_config = AsyncMysqlConfig::noTimeout();
     size_t min_connections = 2;
     size_t max_connections = 10;
+    // 为每个新连接创建接收缓冲区，为空时按async_config创建；
+    // 例如返回MysqlSlabBufferProvider，使空闲连接不占用缓冲内存
+    std::function<std::shared_ptr<MysqlBufferProvider>()> buffer_provider_factory;
+    MysqlCircuitBreakerConfig breaker;
+    // 主机名解析器，为空时使用MysqlResolver::shared()；多个池共用一个解析器即共用解析缓存
+    std::shared_ptr<MysqlResolver> resolver;
+    // 归还时带着超时未读完响应的连接：KILL QUERY后等待排空的上限，0表示不恢复、直接关闭
+    std::chrono::milliseconds recover_timeout{1000};
 };
 
 /**
  * @brief 异步MySQL连接池
- * @details 管理多个AsyncMysqlClient连接，支持异步获取和归还
+ * @details 管理同一端点的多个AsyncMysqlClient连接，支持异步获取和归还。
+ *          建连失败或归还时已不可复用的连接会被关闭并腾出名额，同时计入端点健康统计；
+ *          熔断期间等待中的获取一并以MYSQL_ERROR_UNAVAILABLE返回，协程不会堆积在故障端点上。
  */
 class MysqlConnectionPool
 {
@@ -54,17 +101,24 @@ public:
         std::expected<std::optional<AsyncMysqlClient*>, MysqlError> await_resume();
 
     private:
+        friend class MysqlConnectionPool;
+
         enum class State {
             Invalid,
             Ready,       // 有空闲连接
             Waiting,     // 等待连接释放
             Creating,    // 正在创建新连接
+            Rejected,    // 熔断中，快速失败
         };
 
         MysqlConnectionPool& m_pool;
         State m_state;
+        bool m_probe = false;
         AsyncMysqlClient* m_client = nullptr;
-        std::optional<MysqlConnectAwaitable> m_connect_awaitable;
+        std::optional<MysqlError> m_error;                  // Rejected，或Waiting被唤醒时未拿到连接的原因
+        std::coroutine_handle<> m_handle;
+        std::chrono::steady_clock::time_point m_started_at;
+        std::optional<MysqlConnector::ConnectAwaitable> m_connect_awaitable;
     };
 
     /**
@@ -74,9 +128,27 @@ public:
 
     /**
      * @brief 归还连接到池中
+     * @details 带着超时未读完响应（isDrainable()）的连接先在后台恢复：旁路KILL QUERY后drain()，
+     *          排空成功即照常归还，失败才关闭。其余不可复用的连接被关闭并腾出名额；
+     *          只有请求发出一半或传输出错的连接、以及恢复时的传输错误计为端点故障
      */
     void release(AsyncMysqlClient* client);
 
+    /**
+     * @brief 上报一次命令成功及其耗时，用于离群延迟检测
+     */
+    void recordSuccess(std::chrono::microseconds latency);
+
+    /**
+     * @brief 上报一次命令失败
+     * @details 只有连接、收发、超时与协议错误计为端点故障，服务端/语句错误不计
+     */
+    void recordFailure(const MysqlError& error);
+
+    MysqlEndpointHealth health() const;
+
+    galay::kernel::IOScheduler* scheduler() const { return m_scheduler; }
+
     /**
      * @brief 获取当前池中连接数
      */
@@ -90,21 +162,78 @@ public:
 private:
     friend class AcquireAwaitable;
 
+    enum class BreakerState : uint8_t {
+        Closed,
+        Open,
+        HalfOpen,
+    };
+
     AsyncMysqlClient* tryAcquire();
     AsyncMysqlClient* createClient();
 
+    /**
+     * @brief 熔断准入：返回本次获取是否为探测，熔断中返回MYSQL_ERROR_UNAVAILABLE
+     */
+    std::expected<bool, MysqlError> admit();
+    void onEndpointSuccess(std::chrono::microseconds latency);
+    void onEndpointFailure();
+    void openBreakerLocked(std::chrono::milliseconds backoff, std::vector<AcquireAwaitable*>& rejected,
+                           std::vector<AsyncMysqlClient*>& idle);
+    void resumeRejected(std::vector<AcquireAwaitable*>& rejected, std::vector<AsyncMysqlClient*>& idle);
+
+    /**
+     * @brief 关闭并移除连接，腾出的名额用于为等待者新建连接
+     */
+    void discard(AsyncMysqlClient* client);
+    static galay::kernel::Coroutine closeTask(std::unique_ptr<AsyncMysqlClient> client);
+    static galay::kernel::Coroutine replaceTask(MysqlConnectionPool* pool, AcquireAwaitable* waiter);
+
+    /**
+     * @brief 熔断探测拿到的是已有连接时先PING一次，以PING的结果和耗时作为探测结论，再唤醒waiter
+     */
+    static galay::kernel::Coroutine probeTask(MysqlConnectionPool* pool, AcquireAwaitable* waiter);
+
+    /**
+     * @brief 取消钩子：借用池内另一条连接对connection_id执行KILL QUERY
+     * @details 池已满且全部繁忙时等待空闲连接，被取消的命令在此期间照常丢弃到达的结果。
+     *          发送KILL前在调度器上确认client仍属于本池且在途命令仍是generation，否则放弃，
+     *          避免KILL落到复用该连接的下一条语句上
+     */
+    static galay::kernel::Coroutine killQueryTask(MysqlConnectionPool* pool, AsyncMysqlClient* client,
+                                                  uint32_t connection_id, uint64_t generation);
+    bool isInflight(AsyncMysqlClient* client, uint64_t generation) const;
+
+    /**
+     * @brief 恢复超时归还的连接
+     * @details 借一条空闲连接（没有时临时建一条不占名额的旁路连接）KILL QUERY，
+     *          再在recover_timeout内drain()；恢复期间连接不在空闲队列中，不会被借出
+     */
+    static galay::kernel::Coroutine recoverTask(MysqlConnectionPool* pool, AsyncMysqlClient* client);
+    bool isDraining(AsyncMysqlClient* client) const;
+
     galay::kernel::IOScheduler* m_scheduler;
     MysqlConfig m_mysql_config;
     AsyncMysqlConfig m_async_config;
     size_t m_min_connections;
     size_t m_max_connections;
+    std::function<std::shared_ptr<MysqlBufferProvider>()> m_buffer_provider_factory;
+    MysqlCircuitBreakerConfig m_breaker;
+    std::shared_ptr<MysqlResolver> m_resolver;
+    std::chrono::milliseconds m_recover_timeout;
 
     mutable std::mutex m_mutex;
     std::queue<AsyncMysqlClient*> m_idle_clients;
     std::vector<std::unique_ptr<AsyncMysqlClient>> m_all_clients;
-    std::queue<std::coroutine_handle<>> m_waiters;
+    std::queue<AcquireAwaitable*> m_waiters;                // 归还的连接直接交给队首等待者
     std::atomic<size_t> m_total_connections{0};
 
+    BreakerState m_breaker_state = BreakerState::Closed;
+    size_t m_consecutive_failures = 0;
+    uint64_t m_ejections = 0;
+    std::chrono::milliseconds m_backoff;
+    std::chrono::steady_clock::time_point m_open_until{};
+    double m_latency_ewma_us = 0.0;
+
 };
 
 } // namespace galay::mysql
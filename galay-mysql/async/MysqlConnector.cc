@@ -0,0 +1,176 @@
+#include "MysqlConnector.h"
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief 一次建连的共享状态
+ * @details 各尝试协程都在目标客户端的调度器上运行，状态无需加锁；done之后不再访问target与handle
+ */
+struct MysqlConnector::DialState
+{
+    AsyncMysqlClient* target = nullptr;
+    IOScheduler* scheduler = nullptr;
+    AsyncMysqlConfig async_config;
+    MysqlConfig config;
+    std::shared_ptr<MysqlResolver> resolver;
+    std::coroutine_handle<> handle;
+
+    std::vector<MysqlResolvedAddress> addresses;
+    size_t started = 0;
+    size_t failed = 0;
+    bool done = false;
+    std::optional<MysqlError> error;
+};
+
+MysqlConnector::ConnectAwaitable MysqlConnector::connect(AsyncMysqlClient& client, MysqlConfig config,
+                                                         std::shared_ptr<MysqlResolver> resolver)
+{
+    return ConnectAwaitable(client, std::move(config), std::move(resolver));
+}
+
+MysqlConnector::ConnectAwaitable::ConnectAwaitable(AsyncMysqlClient& client, MysqlConfig config,
+                                                   std::shared_ptr<MysqlResolver> resolver)
+    : m_client(client)
+    , m_config(std::move(config))
+    , m_resolver(resolver ? std::move(resolver) : MysqlResolver::shared())
+{
+}
+
+bool MysqlConnector::ConnectAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    auto cached = m_resolver->cached(m_config.host);
+    if (cached.has_value() && !cached->has_value()) {
+        m_error = cached->error();
+        return false;
+    }
+    if (cached.has_value() && cached->value().size() == 1) {
+        MysqlConfig config = m_config;
+        config.host = cached->value().front().ip;
+        m_client.prepareSocket(config);
+        m_direct.emplace(m_client, std::move(config));
+        return m_direct->await_suspend(handle);
+    }
+
+    m_dial = std::make_shared<DialState>();
+    m_dial->target = &m_client;
+    m_dial->scheduler = m_client.m_scheduler;
+    m_dial->async_config = m_client.m_config;
+    m_dial->config = std::move(m_config);
+    m_dial->resolver = m_resolver;
+    m_dial->handle = handle;
+    if (cached.has_value()) {
+        m_dial->scheduler->spawn(dialTask(m_dial, std::move(*cached)));
+        return true;
+    }
+    // 回调在解析线程中执行，由调度器接着完成连接
+    m_resolver->resolveAsync(m_dial->config.host, [state = m_dial](MysqlResolver::Result resolved) {
+        state->scheduler->spawn(dialTask(state, std::move(resolved)));
+    });
+    return true;
+}
+
+std::expected<std::optional<bool>, MysqlError> MysqlConnector::ConnectAwaitable::await_resume()
+{
+    if (m_direct.has_value()) {
+        auto result = m_direct->await_resume();
+        m_direct.reset();
+        if (!result) {
+            m_resolver->invalidate(m_config.host);
+        }
+        return result;
+    }
+    if (m_dial) {
+        m_error = std::move(m_dial->error);
+        m_dial.reset();
+    }
+    if (m_error.has_value()) {
+        return std::unexpected(std::move(*m_error));
+    }
+    return std::optional<bool>(true);
+}
+
+void MysqlConnector::finish(const std::shared_ptr<DialState>& state, std::optional<MysqlError> error)
+{
+    state->done = true;
+    state->error = std::move(error);
+    state->handle.resume();
+}
+
+void MysqlConnector::startNext(const std::shared_ptr<DialState>& state)
+{
+    if (state->done || state->started >= state->addresses.size()) {
+        return;
+    }
+    const size_t index = state->started++;
+    state->scheduler->spawn(attemptTask(state, index));
+    if (state->started < state->addresses.size()) {
+        state->scheduler->spawn(delayTask(state, state->started));
+    }
+}
+
+galay::kernel::Coroutine MysqlConnector::dialTask(std::shared_ptr<DialState> state, MysqlResolver::Result resolved)
+{
+    if (!resolved) {
+        finish(state, std::move(resolved.error()));
+        co_return;
+    }
+    state->addresses = std::move(resolved.value());
+    if (state->addresses.size() == 1) {
+        MysqlConfig config = state->config;
+        config.host = state->addresses.front().ip;
+        auto connected = co_await state->target->connect(std::move(config));
+        if (!connected) {
+            state->resolver->invalidate(state->config.host);
+            finish(state, std::move(connected.error()));
+        } else {
+            finish(state, std::nullopt);
+        }
+        co_return;
+    }
+    startNext(state);
+}
+
+galay::kernel::Coroutine MysqlConnector::attemptTask(std::shared_ptr<DialState> state, size_t index)
+{
+    auto client = std::make_unique<AsyncMysqlClient>(state->scheduler, state->async_config);
+    MysqlConfig config = state->config;
+    config.host = state->addresses[index].ip;
+    auto connected = co_await client->connect(std::move(config));
+    if (connected && connected->has_value()) {
+        if (!state->done) {
+            state->target->adoptConnection(*client);
+            finish(state, std::nullopt);
+            co_return;
+        }
+    } else if (!state->done) {
+        state->error = connected ? MysqlError(MYSQL_ERROR_INTERNAL, "Connect awaitable resumed without value")
+                                 : std::move(connected.error());
+        if (++state->failed == state->addresses.size()) {
+            state->resolver->invalidate(state->config.host);
+            finish(state, std::move(state->error));
+        } else {
+            // 失败的地址不再占用间隔，立即尝试下一个
+            startNext(state);
+        }
+    }
+    // 落败或失败的连接在这里关闭
+    if (!client->isClosed()) {
+        co_await client->close();
+    }
+}
+
+galay::kernel::Coroutine MysqlConnector::delayTask(std::shared_ptr<DialState> state, size_t index)
+{
+    co_await galay::kernel::sleep(std::chrono::milliseconds(state->config.connect_attempt_delay_ms));
+    // 间隔内已有尝试失败并提前开始了下一个时，不再重复开始
+    if (state->started == index) {
+        startNext(state);
+    }
+}
+
+} // namespace galay::mysql
@@ -0,0 +1,74 @@
+#ifndef GALAY_MYSQL_CONNECTOR_H
+#define GALAY_MYSQL_CONNECTOR_H
+
+#include "AsyncMysqlClient.h"
+#include "galay-mysql/base/MysqlConfig.h"
+#include "galay-mysql/base/MysqlResolver.h"
+#include <coroutine>
+#include <expected>
+#include <memory>
+#include <optional>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief 按主机名建立异步连接
+ * @details AsyncMysqlClient::connect()只接受数字地址；MysqlConnector先经MysqlResolver解析（缓存未命中时在解析线程中执行，
+ *          不阻塞调度器），再按解析结果连接：
+ *          - 数字地址或只有一个地址时直接在目标客户端上连接；
+ *          - 多个地址（如同时有IPv6和IPv4）时按Happy Eyeballs（RFC 8305）交替尝试，
+ *            相邻尝试间隔MysqlConfig::connect_attempt_delay_ms，某次失败时立即开始下一个，
+ *            先完成握手与认证的连接移交给目标客户端，其余连接在后台关闭。
+ *          所有地址都失败时丢弃该主机名的缓存，下一次连接重新解析。连接池与MysqlReconnectingClient均经由它建连。
+ *
+ * @code
+ * AsyncMysqlClient client(scheduler);
+ * auto config = MysqlConfig::create("db.internal", 3306, "root", "password", "test");
+ * auto connected = co_await MysqlConnector::connect(client, config);
+ * @endcode
+ */
+class MysqlConnector
+{
+public:
+    struct DialState;
+
+    class ConnectAwaitable
+    {
+    public:
+        ConnectAwaitable(AsyncMysqlClient& client, MysqlConfig config, std::shared_ptr<MysqlResolver> resolver);
+
+        ConnectAwaitable(const ConnectAwaitable&) = delete;
+        ConnectAwaitable& operator=(const ConnectAwaitable&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        std::expected<std::optional<bool>, MysqlError> await_resume();
+
+    private:
+        AsyncMysqlClient& m_client;
+        MysqlConfig m_config;
+        std::shared_ptr<MysqlResolver> m_resolver;
+        std::optional<MysqlConnectAwaitable> m_direct;      // 地址已确定时直接连接
+        std::shared_ptr<DialState> m_dial;                  // 需要解析或在多个地址间竞速
+        std::optional<MysqlError> m_error;
+    };
+
+    /**
+     * @param resolver 为空时使用MysqlResolver::shared()
+     */
+    static ConnectAwaitable connect(AsyncMysqlClient& client, MysqlConfig config,
+                                    std::shared_ptr<MysqlResolver> resolver = nullptr);
+
+private:
+    static void finish(const std::shared_ptr<DialState>& state, std::optional<MysqlError> error);
+    static void startNext(const std::shared_ptr<DialState>& state);
+
+    static galay::kernel::Coroutine dialTask(std::shared_ptr<DialState> state, MysqlResolver::Result resolved);
+    static galay::kernel::Coroutine attemptTask(std::shared_ptr<DialState> state, size_t index);
+    static galay::kernel::Coroutine delayTask(std::shared_ptr<DialState> state, size_t index);
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_CONNECTOR_H
@@ -0,0 +1,285 @@
+#include "MysqlReconnectingClient.h"
+#include "MysqlConnector.h"
+#include "MysqlRouter.h"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+
+namespace galay::mysql
+{
+
+namespace
+{
+
+/**
+ * @brief 连接层面的失败：连接已不可用，换一条连接可能成功
+ * @details 超时与取消不在其中，它们意味着语句可能仍在服务端执行，不应在新连接上再执行一次
+ */
+bool isConnectionLost(const MysqlError& error)
+{
+    switch (error.type()) {
+    case MYSQL_ERROR_CONNECTION:
+    case MYSQL_ERROR_CONNECTION_CLOSED:
+    case MYSQL_ERROR_SEND:
+    case MYSQL_ERROR_RECV:
+        return true;
+    default:
+        return false;
+    }
+}
+
+MysqlError transactionLost(std::string_view reason)
+{
+    return MysqlError(MYSQL_ERROR_TRANSACTION,
+                      "Transaction lost, the server rolled it back: " + std::string(reason));
+}
+
+} // namespace
+
+MysqlReconnectingClient::MysqlReconnectingClient(IOScheduler* scheduler,
+                                                 MysqlConfig config,
+                                                 MysqlReconnectPolicy policy,
+                                                 AsyncMysqlConfig async_config)
+    : m_scheduler(scheduler)
+    , m_config(std::move(config))
+    , m_policy(policy)
+    , m_async_config(std::move(async_config))
+{
+    m_policy.max_backoff = std::max(m_policy.max_backoff, m_policy.base_backoff);
+}
+
+MysqlReconnectingClient::~MysqlReconnectingClient()
+{
+    dropClient();
+}
+
+MysqlReconnectingClient::CommandAwaitable<bool> MysqlReconnectingClient::connect()
+{
+    CommandState state;
+    state.kind = CommandState::Kind::Connect;
+    return CommandAwaitable<bool>(*this, std::move(state));
+}
+
+MysqlReconnectingClient::CommandAwaitable<MysqlResultSet>
+MysqlReconnectingClient::query(std::string_view sql, MysqlIdempotency idempotency)
+{
+    CommandState state;
+    state.kind = CommandState::Kind::Query;
+    state.sql = std::string(sql);
+    state.idempotent = idempotent(sql, idempotency);
+    return CommandAwaitable<MysqlResultSet>(*this, std::move(state));
+}
+
+MysqlReconnectingClient::CommandAwaitable<MysqlReconnectingClient::StatementId>
+MysqlReconnectingClient::prepare(std::string_view sql)
+{
+    CommandState state;
+    state.kind = CommandState::Kind::Prepare;
+    state.sql = std::string(sql);
+    state.idempotent = true;
+    return CommandAwaitable<StatementId>(*this, std::move(state));
+}
+
+MysqlReconnectingClient::CommandAwaitable<MysqlResultSet>
+MysqlReconnectingClient::execute(StatementId statement,
+                                 std::span<const std::optional<std::string>> params,
+                                 MysqlIdempotency idempotency)
+{
+    CommandState state;
+    state.kind = CommandState::Kind::Execute;
+    state.statement = statement;
+    state.params.assign(params.begin(), params.end());
+    auto it = m_statements.find(statement);
+    state.idempotent = it != m_statements.end() && idempotent(it->second.sql, idempotency);
+    return CommandAwaitable<MysqlResultSet>(*this, std::move(state));
+}
+
+MysqlReconnectingClient::CommandAwaitable<bool> MysqlReconnectingClient::useDatabase(std::string_view database)
+{
+    CommandState state;
+    state.kind = CommandState::Kind::UseDatabase;
+    state.sql = std::string(database);
+    state.idempotent = true;
+    return CommandAwaitable<bool>(*this, std::move(state));
+}
+
+void MysqlReconnectingClient::start(CommandState* state, std::coroutine_handle<> handle)
+{
+    m_scheduler->spawn(commandTask(this, state, handle));
+}
+
+bool MysqlReconnectingClient::idempotent(std::string_view sql, MysqlIdempotency idempotency) const
+{
+    switch (idempotency) {
+    case MysqlIdempotency::Idempotent:
+        return true;
+    case MysqlIdempotency::NonIdempotent:
+        return false;
+    case MysqlIdempotency::Auto:
+        break;
+    }
+    return MysqlRouter::classify(sql) == MysqlRouteTarget::Replica;
+}
+
+std::chrono::milliseconds MysqlReconnectingClient::backoff(size_t attempt) const
+{
+    // 第一次重试不等待：故障转移后新主库通常已就绪，退避只用于连续失败
+    if (attempt <= 1) {
+        return std::chrono::milliseconds(0);
+    }
+    const size_t shift = std::min<size_t>(attempt - 2, 16);
+    const auto cap = std::min(m_policy.max_backoff, m_policy.base_backoff * (int64_t{1} << shift));
+    const auto half = cap.count() / 2;
+    thread_local std::minstd_rand rng(std::random_device{}());
+    std::uniform_int_distribution<int64_t> jitter(0, std::max<int64_t>(cap.count() - half, 0));
+    return std::chrono::milliseconds(half + jitter(rng));
+}
+
+void MysqlReconnectingClient::dropClient()
+{
+    if (m_client) {
+        m_scheduler->spawn(closeTask(std::move(m_client)));
+    }
+}
+
+galay::kernel::Coroutine MysqlReconnectingClient::commandTask(MysqlReconnectingClient* self, CommandState* state,
+                                                              std::coroutine_handle<> handle)
+{
+    using Kind = CommandState::Kind;
+    std::optional<MysqlError> error;
+    for (size_t attempt = 0;; ++attempt) {
+        if (attempt > 0) {
+            const auto wait = self->backoff(attempt);
+            if (wait.count() > 0) {
+                co_await galay::kernel::sleep(wait);
+            }
+        }
+        error.reset();
+
+        // 请求尚未发出，无论命令是否幂等都可以换一条连接；事务中则先报告事务丢失，不在新连接上执行
+        if (!self->m_client || !self->m_client->isReusable()) {
+            self->dropClient();
+            if (self->m_in_transaction) {
+                self->m_in_transaction = false;
+                error = transactionLost("connection was replaced before this command");
+                break;
+            }
+            auto client = std::make_unique<AsyncMysqlClient>(self->m_scheduler, self->m_async_config);
+            auto connected = co_await MysqlConnector::connect(*client, self->m_config);
+            if (!connected) {
+                error = std::move(connected.error());
+                if (isConnectionLost(*error) && attempt < self->m_policy.max_retries) {
+                    continue;
+                }
+                break;
+            }
+            if (self->m_generation > 0) {
+                ++self->m_reconnects;
+            }
+            ++self->m_generation;
+            self->m_client = std::move(client);
+        }
+        AsyncMysqlClient* client = self->m_client.get();
+
+        std::optional<MysqlResultSet> result_set;
+        switch (state->kind) {
+        case Kind::Connect:
+            break;
+        case Kind::Query: {
+            auto r = co_await client->query(state->sql);
+            if (!r) {
+                error = std::move(r.error());
+            } else if (r->has_value()) {
+                result_set = std::move(r->value());
+            }
+            break;
+        }
+        case Kind::Prepare: {
+            auto r = co_await client->prepare(state->sql);
+            if (!r) {
+                error = std::move(r.error());
+            } else if (r->has_value()) {
+                const StatementId id = self->m_next_statement++;
+                self->m_statements[id] = Statement{state->sql, r->value().statement_id, self->m_generation};
+                state->statement = id;
+            }
+            break;
+        }
+        case Kind::Execute: {
+            auto it = self->m_statements.find(state->statement);
+            if (it == self->m_statements.end()) {
+                error = MysqlError(MYSQL_ERROR_INVALID_PARAM, "Unknown statement id");
+                break;
+            }
+            if (it->second.generation != self->m_generation) {
+                // 语句随旧连接失效，在当前连接上重新prepare
+                const std::string sql = it->second.sql;
+                auto prepared = co_await client->prepare(sql);
+                if (!prepared) {
+                    error = std::move(prepared.error());
+                    break;
+                }
+                it = self->m_statements.find(state->statement);
+                if (!prepared->has_value() || it == self->m_statements.end()) {
+                    error = MysqlError(MYSQL_ERROR_INTERNAL, "Re-prepare resumed without value");
+                    break;
+                }
+                it->second.server_id = prepared->value().statement_id;
+                it->second.generation = self->m_generation;
+            }
+            auto r = co_await client->stmtExecute(it->second.server_id,
+                                                  std::span<const std::optional<std::string>>(state->params));
+            if (!r) {
+                error = std::move(r.error());
+            } else if (r->has_value()) {
+                result_set = std::move(r->value());
+            }
+            break;
+        }
+        case Kind::UseDatabase: {
+            auto r = co_await client->useDatabase(state->sql);
+            if (!r) {
+                error = std::move(r.error());
+            } else {
+                self->m_config.database = state->sql;
+            }
+            break;
+        }
+        }
+
+        if (!error.has_value()) {
+            if (result_set.has_value()) {
+                self->m_in_transaction = (result_set->statusFlags() & protocol::SERVER_STATUS_IN_TRANS) != 0;
+                state->result_set = std::move(result_set);
+            }
+            break;
+        }
+        if (!isConnectionLost(*error) || client->isReusable()) {
+            break;
+        }
+        // 连接在命令执行中断开：事务已随连接回滚，非幂等命令可能已经执行，都只能把错误交给调用方
+        self->dropClient();
+        if (self->m_in_transaction) {
+            self->m_in_transaction = false;
+            error = transactionLost(error->message());
+            break;
+        }
+        if (!state->idempotent || attempt >= self->m_policy.max_retries) {
+            break;
+        }
+    }
+    if (error.has_value()) {
+        state->error = std::move(error);
+    }
+    handle.resume();
+}
+
+galay::kernel::Coroutine MysqlReconnectingClient::closeTask(std::unique_ptr<AsyncMysqlClient> client)
+{
+    if (!client->isClosed()) {
+        co_await client->close();
+    }
+}
+
+} // namespace galay::mysql
@@ -0,0 +1,204 @@
+#ifndef GALAY_MYSQL_RECONNECTING_CLIENT_H
+#define GALAY_MYSQL_RECONNECTING_CLIENT_H
+
+#include "AsyncMysqlClient.h"
+#include "galay-mysql/base/MysqlConfig.h"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief 自动重连策略
+ * @details 命令开始前发现连接已断开（或被超时留在响应中途）时先重连，此时请求尚未发出，不在事务中的命令都可以执行；
+ *          事务中的连接被替换时服务端已回滚，该命令不执行，返回MYSQL_ERROR_TRANSACTION。
+ *          命令执行中连接断开时，只有事务外的幂等命令在重连后重试，最多max_retries次，每次按带抖动的指数退避等待。
+ */
+struct MysqlReconnectPolicy
+{
+    size_t max_retries = 2;                         // 0表示不重试，只在下一条命令前重连
+    std::chrono::milliseconds base_backoff{10};
+    std::chrono::milliseconds max_backoff{1000};
+};
+
+/**
+ * @brief 命令幂等性
+ * @details Auto把MysqlRouter::classify()判定为可在从库执行的只读语句视为幂等，其余语句不重试；
+ *          写语句可由调用方确认幂等（如 INSERT ... ON DUPLICATE KEY UPDATE 的覆盖写）后标记为Idempotent
+ */
+enum class MysqlIdempotency : uint8_t
+{
+    Auto,
+    Idempotent,
+    NonIdempotent
+};
+
+/**
+ * @brief 带自动重连的异步客户端
+ * @details 持有一条AsyncMysqlClient连接，断开后在后台新建连接替换：
+ *          useDatabase()切换的库随握手恢复，prepare()返回的逻辑语句ID跨重连不变，
+ *          新连接上首次执行时重新prepare（只为实际用到的语句多一次往返）。
+ *          事务丢失不会被静默跳过：事务中命令执行时断开，或下一条命令发现连接已被替换（断开、超时留在响应中途），
+ *          都返回MYSQL_ERROR_TRANSACTION且不重试，调用方据此重做整个事务；报告之后的命令在新连接上执行。
+ *          同一时刻只能有一条命令在执行，对象须比发出的命令存活更久。
+ *
+ * @code
+ * MysqlReconnectingClient db(scheduler, config);
+ * auto stmt = co_await db.prepare("SELECT name FROM users WHERE id = ?");
+ * const std::array<std::optional<std::string>, 1> params{"42"};
+ * auto user = co_await db.execute(**stmt, params);      // 连接在两次调用之间断开也只多一次重连
+ * auto moved = co_await db.query("UPDATE users SET visits = visits + 1 WHERE id = 42");   // 非幂等，执行中断开直接返回错误
+ * @endcode
+ */
+class MysqlReconnectingClient
+{
+public:
+    using StatementId = uint32_t;
+
+    /**
+     * @brief 一次命令的描述与结果，由后台协程填写
+     */
+    struct CommandState
+    {
+        enum class Kind : uint8_t {
+            Connect,
+            Query,
+            Prepare,
+            Execute,
+            UseDatabase
+        };
+
+        Kind kind = Kind::Query;
+        std::string sql;
+        StatementId statement = 0;
+        std::vector<std::optional<std::string>> params;
+        bool idempotent = false;
+        std::optional<MysqlResultSet> result_set;
+        std::optional<MysqlError> error;
+    };
+
+    template<typename T>
+    class CommandAwaitable
+    {
+    public:
+        CommandAwaitable(MysqlReconnectingClient& owner, CommandState state)
+            : m_owner(owner)
+            , m_state(std::move(state))
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_owner.start(&m_state, handle);
+            return true;
+        }
+
+        std::expected<std::optional<T>, MysqlError> await_resume()
+        {
+            if (m_state.error.has_value()) {
+                return std::unexpected(std::move(*m_state.error));
+            }
+            if constexpr (std::is_same_v<T, MysqlResultSet>) {
+                return std::move(m_state.result_set);
+            } else if constexpr (std::is_same_v<T, StatementId>) {
+                return std::optional<StatementId>(m_state.statement);
+            } else {
+                return std::optional<bool>(true);
+            }
+        }
+
+    private:
+        MysqlReconnectingClient& m_owner;
+        CommandState m_state;
+    };
+
+    MysqlReconnectingClient(IOScheduler* scheduler,
+                            MysqlConfig config,
+                            MysqlReconnectPolicy policy = {},
+                            AsyncMysqlConfig async_config = AsyncMysqlConfig::noTimeout());
+
+    /**
+     * @brief 连接在后台关闭
+     */
+    ~MysqlReconnectingClient();
+
+    MysqlReconnectingClient(const MysqlReconnectingClient&) = delete;
+    MysqlReconnectingClient& operator=(const MysqlReconnectingClient&) = delete;
+
+    /**
+     * @brief 提前建立连接；不调用时由第一条命令建立
+     */
+    CommandAwaitable<bool> connect();
+
+    CommandAwaitable<MysqlResultSet> query(std::string_view sql,
+                                           MysqlIdempotency idempotency = MysqlIdempotency::Auto);
+
+    /**
+     * @brief 预处理语句并登记，返回跨重连不变的逻辑语句ID
+     */
+    CommandAwaitable<StatementId> prepare(std::string_view sql);
+
+    CommandAwaitable<MysqlResultSet> execute(StatementId statement,
+                                             std::span<const std::optional<std::string>> params,
+                                             MysqlIdempotency idempotency = MysqlIdempotency::Auto);
+
+    /**
+     * @brief 切换默认库，之后的重连在握手中直接指定该库
+     */
+    CommandAwaitable<bool> useDatabase(std::string_view database);
+
+    /**
+     * @brief 当前连接，未连接或已断开时为nullptr；不要跨命令保存
+     */
+    AsyncMysqlClient* client() const { return m_client.get(); }
+
+    /**
+     * @brief 首次建连之后的重连次数
+     */
+    uint64_t reconnects() const { return m_reconnects; }
+
+private:
+    struct Statement
+    {
+        std::string sql;
+        uint32_t server_id = 0;
+        uint64_t generation = 0;    // 在哪一条连接上prepare的，与m_generation不同时需要重新prepare
+    };
+
+    void start(CommandState* state, std::coroutine_handle<> handle);
+    bool idempotent(std::string_view sql, MysqlIdempotency idempotency) const;
+    std::chrono::milliseconds backoff(size_t attempt) const;
+    void dropClient();
+
+    static galay::kernel::Coroutine commandTask(MysqlReconnectingClient* self, CommandState* state,
+                                                std::coroutine_handle<> handle);
+    static galay::kernel::Coroutine closeTask(std::unique_ptr<AsyncMysqlClient> client);
+
+    IOScheduler* m_scheduler;
+    MysqlConfig m_config;
+    MysqlReconnectPolicy m_policy;
+    AsyncMysqlConfig m_async_config;
+    std::unique_ptr<AsyncMysqlClient> m_client;
+    uint64_t m_generation = 0;
+    uint64_t m_reconnects = 0;
+    bool m_in_transaction = false;      // 最近一条命令结束时服务端处于事务中（SERVER_STATUS_IN_TRANS），报告事务丢失后才清除
+    std::unordered_map<StatementId, Statement> m_statements;
+    StatementId m_next_statement = 1;
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_RECONNECTING_CLIENT_H
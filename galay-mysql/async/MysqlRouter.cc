@@ -0,0 +1,588 @@
+#include "MysqlRouter.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace galay::mysql
+{
+
+namespace
+{
+
+bool isWordChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+bool equalsNoCase(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+    });
+}
+
+/**
+ * @brief 按词扫描SQL，跳过注释、字符串与引号标识符
+ */
+class SqlWordScanner
+{
+public:
+    explicit SqlWordScanner(std::string_view sql) : m_sql(sql) {}
+
+    /**
+     * @brief 下一个词；next_char输出紧随其后的第一个非空白字符（用于识别函数调用）
+     */
+    std::optional<std::string_view> next(char& next_char)
+    {
+        while (m_pos < m_sql.size()) {
+            const char c = m_sql[m_pos];
+            if (c == '\'' || c == '"' || c == '`') {
+                skipQuoted(c);
+            } else if (c == '#' || (c == '-' && startsWith("-- "))) {
+                skipUntil("\n");
+            } else if (c == '/' && startsWith("/*")) {
+                m_pos += 2;
+                skipUntil("*/");
+            } else if (isWordChar(c)) {
+                const size_t begin = m_pos;
+                while (m_pos < m_sql.size() && isWordChar(m_sql[m_pos])) {
+                    ++m_pos;
+                }
+                size_t look = m_pos;
+                while (look < m_sql.size() && std::isspace(static_cast<unsigned char>(m_sql[look]))) {
+                    ++look;
+                }
+                next_char = look < m_sql.size() ? m_sql[look] : '\0';
+                return m_sql.substr(begin, m_pos - begin);
+            } else {
+                ++m_pos;
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    bool startsWith(std::string_view prefix) const
+    {
+        return m_sql.substr(m_pos, prefix.size()) == prefix;
+    }
+
+    void skipUntil(std::string_view terminator)
+    {
+        const size_t end = m_sql.find(terminator, m_pos);
+        m_pos = end == std::string_view::npos ? m_sql.size() : end + terminator.size();
+    }
+
+    void skipQuoted(char quote)
+    {
+        ++m_pos;
+        while (m_pos < m_sql.size()) {
+            const char c = m_sql[m_pos++];
+            if (c == '\\' && quote != '`') {
+                ++m_pos;
+            } else if (c == quote) {
+                // 重复引号为转义
+                if (m_pos < m_sql.size() && m_sql[m_pos] == quote) {
+                    ++m_pos;
+                    continue;
+                }
+                return;
+            }
+        }
+    }
+
+    std::string_view m_sql;
+    size_t m_pos = 0;
+};
+
+// 依赖当前会话状态或有副作用的函数，只能在主库执行
+constexpr std::array<std::string_view, 9> kPrimaryOnlyFunctions = {
+    "GET_LOCK", "RELEASE_LOCK", "RELEASE_ALL_LOCKS", "IS_FREE_LOCK", "IS_USED_LOCK",
+    "LAST_INSERT_ID", "FOUND_ROWS", "ROW_COUNT", "NEXTVAL",
+};
+
+// 作为关键字（而非INSERT()这类同名函数）出现即意味着写入、加锁或写文件
+constexpr std::array<std::string_view, 6> kPrimaryOnlyWords = {
+    "UPDATE", "DELETE", "INSERT", "INTO", "SHARE", "LOCK",
+};
+
+} // namespace
+
+struct MysqlRouter::HedgeState
+{
+    std::mutex mutex;
+    std::string sql;
+    std::coroutine_handle<> handle;
+    std::chrono::microseconds delay{0};
+    size_t first_node = kNoNode;
+    size_t running = 0;                         // 尚未结束的请求数
+    std::array<bool, 2> settled{};              // 各请求是否已结束
+    bool hedged = false;
+    bool done = false;
+    std::array<MysqlCancellationToken, 2> tokens;
+    std::optional<MysqlResultSet> result;
+    std::optional<MysqlError> error;
+};
+
+// ======================== MysqlRouter ========================
+
+MysqlRouter::MysqlRouter(galay::kernel::IOScheduler* scheduler, MysqlRouterConfig config)
+    : m_scheduler(scheduler)
+    , m_primary(std::make_unique<MysqlConnectionPool>(scheduler, std::move(config.primary)))
+    , m_alpha(std::clamp(config.latency_ewma_alpha, 0.01, 1.0))
+    , m_down_cooldown(config.replica_down_cooldown)
+    , m_gtid_refresh_interval(config.replica_gtid_refresh_interval)
+    , m_hedge(config.hedge)
+    , m_nodes(config.replicas.size() + 1)
+{
+    m_hedge.delay_percentile = std::clamp(m_hedge.delay_percentile, 0.0, 1.0);
+    m_hedge.min_delay = std::min(m_hedge.min_delay, m_hedge.max_delay);
+    m_hedge.budget_ratio = std::clamp(m_hedge.budget_ratio, 0.0, 1.0);
+    m_hedge_delay = m_hedge.max_delay;
+    m_latency_window.reserve(kLatencyWindow);
+    m_replicas.reserve(config.replicas.size());
+    for (auto& replica : config.replicas) {
+        m_replicas.push_back(std::make_unique<MysqlConnectionPool>(scheduler, std::move(replica)));
+    }
+}
+
+MysqlRouteTarget MysqlRouter::classify(std::string_view sql)
+{
+    SqlWordScanner scanner(sql);
+    char next_char = '\0';
+    auto first = scanner.next(next_char);
+    if (!first) {
+        return MysqlRouteTarget::Primary;
+    }
+    // WITH ... 之后也可能是UPDATE/DELETE，由下面的关键字检查兜底
+    if (!equalsNoCase(*first, "SELECT") && !equalsNoCase(*first, "WITH")) {
+        return MysqlRouteTarget::Primary;
+    }
+
+    // FOR UPDATE / FOR SHARE / LOCK IN SHARE MODE / SELECT ... INTO / 写语句关键字
+    while (auto word = scanner.next(next_char)) {
+        const bool is_call = next_char == '(';
+        const auto candidates = is_call ? std::span<const std::string_view>(kPrimaryOnlyFunctions)
+                                         : std::span<const std::string_view>(kPrimaryOnlyWords);
+        for (std::string_view candidate : candidates) {
+            if (equalsNoCase(*word, candidate)) {
+                return MysqlRouteTarget::Primary;
+            }
+        }
+    }
+    return MysqlRouteTarget::Replica;
+}
+
+MysqlRouter::AcquireAwaitable MysqlRouter::acquire(std::string_view sql, MysqlRouteHint hint)
+{
+    switch (hint) {
+    case MysqlRouteHint::Primary:
+        return AcquireAwaitable(*this, MysqlRouteTarget::Primary);
+    case MysqlRouteHint::Replica:
+        return AcquireAwaitable(*this, MysqlRouteTarget::Replica);
+    case MysqlRouteHint::Auto:
+        break;
+    }
+    return AcquireAwaitable(*this, classify(sql));
+}
+
+MysqlRouter::AcquireAwaitable MysqlRouter::acquire(std::string_view sql, const MysqlGtidSet& read_after,
+                                                  MysqlRouteHint hint)
+{
+    MysqlRouteTarget target = classify(sql);
+    if (hint != MysqlRouteHint::Auto) {
+        target = hint == MysqlRouteHint::Replica ? MysqlRouteTarget::Replica : MysqlRouteTarget::Primary;
+    }
+    return AcquireAwaitable(*this, target, read_after.empty() ? nullptr : &read_after);
+}
+
+MysqlRouter::AcquireAwaitable MysqlRouter::acquire(MysqlRouteHint hint)
+{
+    return AcquireAwaitable(*this, hint == MysqlRouteHint::Replica ? MysqlRouteTarget::Replica
+                                                                    : MysqlRouteTarget::Primary);
+}
+
+size_t MysqlRouter::pickNode(MysqlRouteTarget target, const MysqlGtidSet* read_after, size_t exclude)
+{
+    std::vector<size_t> stale;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    size_t chosen = 0;
+    if (target == MysqlRouteTarget::Replica && !m_replicas.empty()) {
+        const auto now = std::chrono::steady_clock::now();
+        const size_t count = m_replicas.size();
+        const size_t start = m_next_replica++ % count;
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t node = 1 + (start + i) % count;
+            NodeState& state = m_nodes[node];
+            if (node == exclude || state.down_until > now) {
+                continue;
+            }
+            if (read_after != nullptr && !state.executed.contains(*read_after)) {
+                // 快照落后不代表从库落后，按间隔刷新后再参与选择
+                ++state.gtid_lagging;
+                if (!state.refreshing && now - state.refreshed_at >= m_gtid_refresh_interval) {
+                    state.refreshing = true;
+                    stale.push_back(node);
+                }
+                continue;
+            }
+            // 没有样本的节点按1us计，先被探测
+            const double score = static_cast<double>(state.in_flight + 1) * std::max(state.latency_ewma_us, 1.0);
+            if (score < best) {
+                best = score;
+                chosen = node;
+            }
+        }
+    }
+    // 对冲请求只在另一个从库上才有意义，除非允许落到主库
+    if (chosen == 0 && exclude != kNoNode && (exclude == 0 || !m_hedge.allow_primary)) {
+        chosen = kNoNode;
+    } else {
+        ++m_nodes[chosen].in_flight;
+        ++m_nodes[chosen].routed;
+    }
+    lock.unlock();
+
+    for (size_t node : stale) {
+        m_scheduler->spawn(refreshGtidTask(this, node));
+    }
+    return chosen;
+}
+
+void MysqlRouter::onAcquireFailed(size_t node)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    NodeState& state = m_nodes[node];
+    if (state.in_flight > 0) {
+        --state.in_flight;
+    }
+    if (node != 0) {
+        state.down_until = std::chrono::steady_clock::now() + m_down_cooldown;
+    }
+}
+
+void MysqlRouter::onGtidRefreshed(size_t node, std::optional<MysqlGtidSet> executed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    NodeState& state = m_nodes[node];
+    state.refreshing = false;
+    state.refreshed_at = std::chrono::steady_clock::now();
+    if (executed) {
+        state.executed = std::move(*executed);
+    }
+}
+
+galay::kernel::Coroutine MysqlRouter::refreshGtidTask(MysqlRouter* router, size_t node)
+{
+    std::optional<MysqlGtidSet> executed;
+    auto acquired = co_await router->pool(node).acquire();
+    if (acquired && acquired->has_value()) {
+        AsyncMysqlClient* client = acquired->value();
+        auto r = co_await client->query("SELECT @@GLOBAL.gtid_executed");
+        if (r && r->has_value() && (*r)->rowCount() == 1) {
+            auto parsed = MysqlGtidSet::parse((*r)->row(0).getString(0));
+            if (parsed) {
+                executed = std::move(parsed.value());
+            } else {
+                MysqlLogDebug(client->logger(), "replica {} gtid_executed: {}", node, parsed.error().message());
+            }
+        }
+        // 归还后连接可能立即被其他协程借走，读取与日志都在归还之前完成
+        router->pool(node).release(client);
+    }
+    router->onGtidRefreshed(node, std::move(executed));
+}
+
+void MysqlRouter::release(const MysqlRoutedClient& routed)
+{
+    if (routed.client == nullptr || routed.node >= m_nodes.size()) {
+        return;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - routed.acquired_at;
+    const double sample_us = std::chrono::duration<double, std::micro>(elapsed).count();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        NodeState& state = m_nodes[routed.node];
+        if (state.in_flight > 0) {
+            --state.in_flight;
+        }
+        state.latency_ewma_us = state.latency_ewma_us == 0.0
+            ? sample_us
+            : m_alpha * sample_us + (1.0 - m_alpha) * state.latency_ewma_us;
+        if (routed.node != 0) {
+            if (m_latency_window.size() < kLatencyWindow) {
+                m_latency_window.push_back(sample_us);
+            } else {
+                m_latency_window[m_latency_next] = sample_us;
+            }
+            m_latency_next = (m_latency_next + 1) % kLatencyWindow;
+            ++m_latency_fresh;
+        }
+    }
+    pool(routed.node).release(routed.client);
+}
+
+MysqlRouter::NodeStats MysqlRouter::stats(size_t node) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const NodeState& state = m_nodes.at(node);
+    return NodeStats{state.in_flight, state.latency_ewma_us, state.routed,
+                     state.down_until > std::chrono::steady_clock::now(), state.gtid_lagging};
+}
+
+MysqlGtidSet MysqlRouter::executedGtids(size_t node) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nodes.at(node).executed;
+}
+
+MysqlRouter::HedgeStats MysqlRouter::hedgeStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    HedgeStats stats = m_hedge_stats;
+    stats.delay = m_hedge_delay;
+    return stats;
+}
+
+MysqlRouter::HedgedQueryAwaitable MysqlRouter::hedgedQuery(std::string_view sql)
+{
+    return HedgedQueryAwaitable(*this, std::string(sql));
+}
+
+std::chrono::microseconds MysqlRouter::hedgeDelayLocked()
+{
+    if (m_latency_window.size() < std::max<size_t>(m_hedge.min_samples, 1)) {
+        return m_hedge.max_delay;
+    }
+    // 每积累一批新样本重新取一次分位数，避免每个请求都做一次选择
+    if (m_latency_fresh >= 16) {
+        std::vector<double> samples(m_latency_window);
+        const size_t rank = static_cast<size_t>(m_hedge.delay_percentile * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+        const auto delay = std::chrono::microseconds(static_cast<int64_t>(samples[rank]));
+        m_hedge_delay = std::clamp<std::chrono::microseconds>(delay, m_hedge.min_delay, m_hedge.max_delay);
+        m_latency_fresh = 0;
+    }
+    return m_hedge_delay;
+}
+
+size_t MysqlRouter::claimHedgeLocked(HedgeState& state, bool failover)
+{
+    if (state.hedged || state.done) {
+        return kNoNode;
+    }
+    if (!failover) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_hedge_credit < 1.0) {
+            ++m_hedge_stats.budget_exhausted;
+            return kNoNode;
+        }
+        m_hedge_credit -= 1.0;
+    }
+    const size_t node = pickNode(MysqlRouteTarget::Replica, nullptr, state.first_node);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (node == kNoNode) {
+        if (!failover) {
+            m_hedge_credit += 1.0;
+        }
+        return kNoNode;
+    }
+    state.hedged = true;
+    ++state.running;
+    ++m_hedge_stats.hedged;
+    return node;
+}
+
+void MysqlRouter::onHedgeAttemptDone(const std::shared_ptr<HedgeState>& state, size_t attempt,
+                                     std::expected<MysqlResultSet, MysqlError> outcome)
+{
+    size_t failover = kNoNode;
+    bool finished = false;
+    bool loser_running = false;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        --state->running;
+        state->settled[attempt] = true;
+        if (state->done) {
+            return;
+        }
+        if (outcome) {
+            state->result = std::move(outcome.value());
+            finished = true;
+        } else {
+            // 服务端ERR同样是响应；只有连接层面的失败才值得换一个从库
+            finished = outcome.error().type() == MYSQL_ERROR_SERVER;
+            state->error = std::move(outcome.error());
+            if (!finished) {
+                failover = claimHedgeLocked(*state, true);
+                finished = failover == kNoNode && state->running == 0;
+            }
+        }
+        state->done = finished;
+        loser_running = finished && state->running > 0;
+    }
+    if (failover != kNoNode) {
+        m_scheduler->spawn(hedgeAttemptTask(this, state, 1, failover));
+        return;
+    }
+    if (!finished) {
+        return;
+    }
+    if (attempt == 1 && state->result.has_value()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_hedge_stats.hedge_wins;
+    }
+    // 落后的请求多半很快结束，让它读完响应后归还连接；宽限期后仍在执行才KILL
+    if (loser_running) {
+        m_scheduler->spawn(hedgeReapTask(state, 1 - attempt, m_hedge.loser_grace));
+    }
+    state->handle.resume();
+}
+
+galay::kernel::Coroutine MysqlRouter::hedgeAttemptTask(MysqlRouter* router, std::shared_ptr<HedgeState> state,
+                                                       size_t attempt, size_t node)
+{
+    std::expected<MysqlResultSet, MysqlError> outcome =
+        std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Hedged query produced no result"));
+    auto acquired = co_await router->pool(node).acquire();
+    if (!acquired || !acquired->has_value()) {
+        router->onAcquireFailed(node);
+        if (!acquired) {
+            outcome = std::unexpected(std::move(acquired.error()));
+        }
+    } else {
+        MysqlRoutedClient routed{acquired->value(), node, std::chrono::steady_clock::now()};
+        auto query = routed->query(state->sql);
+        query.cancelOn(state->tokens[attempt]);
+        auto r = co_await query;
+        router->release(routed);
+        if (!r) {
+            outcome = std::unexpected(std::move(r.error()));
+        } else if (r->has_value()) {
+            outcome = std::move(r->value());
+        }
+    }
+    router->onHedgeAttemptDone(state, attempt, std::move(outcome));
+}
+
+galay::kernel::Coroutine MysqlRouter::hedgeTimerTask(MysqlRouter* router, std::shared_ptr<HedgeState> state)
+{
+    co_await galay::kernel::sleep(state->delay);
+    size_t node = kNoNode;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        node = router->claimHedgeLocked(*state, false);
+    }
+    if (node != kNoNode) {
+        router->m_scheduler->spawn(hedgeAttemptTask(router, state, 1, node));
+    }
+}
+
+galay::kernel::Coroutine MysqlRouter::hedgeReapTask(std::shared_ptr<HedgeState> state, size_t loser,
+                                                    std::chrono::milliseconds grace)
+{
+    co_await galay::kernel::sleep(grace);
+    bool running = false;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        running = !state->settled[loser];
+    }
+    // 尚未发出的请求直接放弃；已发出的经取消钩子KILL，连接池在KILL前还会核对命令代号
+    if (running) {
+        state->tokens[loser].cancel();
+    }
+}
+
+// ======================== HedgedQueryAwaitable ========================
+
+MysqlRouter::HedgedQueryAwaitable::HedgedQueryAwaitable(MysqlRouter& router, std::string sql)
+    : m_router(router)
+    , m_sql(std::move(sql))
+{
+}
+
+bool MysqlRouter::HedgedQueryAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    if (classify(m_sql) != MysqlRouteTarget::Replica) {
+        m_error = MysqlError(MYSQL_ERROR_INVALID_PARAM, "Hedged query must be a read-only statement");
+        return false;
+    }
+
+    m_state = std::make_shared<HedgeState>();
+    m_state->sql = std::move(m_sql);
+    m_state->handle = handle;
+    {
+        std::lock_guard<std::mutex> lock(m_router.m_mutex);
+        ++m_router.m_hedge_stats.queries;
+        m_router.m_hedge_credit = std::min(m_router.m_hedge_credit + m_router.m_hedge.budget_ratio, 10.0);
+        m_state->delay = m_router.hedgeDelayLocked();
+    }
+    const size_t node = m_router.pickNode(MysqlRouteTarget::Replica, nullptr);
+    m_state->first_node = node;
+    m_state->running = 1;
+    m_router.m_scheduler->spawn(hedgeAttemptTask(&m_router, m_state, 0, node));
+    if (node != 0) {
+        m_router.m_scheduler->spawn(hedgeTimerTask(&m_router, m_state));
+    }
+    return true;
+}
+
+std::expected<std::optional<MysqlResultSet>, MysqlError> MysqlRouter::HedgedQueryAwaitable::await_resume()
+{
+    if (m_error.has_value()) {
+        return std::unexpected(std::move(*m_error));
+    }
+    if (!m_state) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Hedged query resumed without suspend"));
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (m_state->result.has_value()) {
+        return std::optional<MysqlResultSet>(std::move(*m_state->result));
+    }
+    if (m_state->error.has_value()) {
+        return std::unexpected(*m_state->error);
+    }
+    return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Hedged query finished without result"));
+}
+
+// ======================== AcquireAwaitable ========================
+
+MysqlRouter::AcquireAwaitable::AcquireAwaitable(MysqlRouter& router, MysqlRouteTarget target,
+                                                const MysqlGtidSet* read_after)
+    : m_router(router)
+    , m_target(target)
+    , m_read_after(read_after)
+{
+}
+
+bool MysqlRouter::AcquireAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    // 真正等待时才选择节点，未被co_await的等待体不计入in_flight
+    m_node = m_router.pickNode(m_target, m_read_after);
+    m_inner.emplace(m_router.pool(m_node));
+    return m_inner->await_suspend(handle);
+}
+
+std::expected<std::optional<MysqlRoutedClient>, MysqlError> MysqlRouter::AcquireAwaitable::await_resume()
+{
+    if (!m_inner.has_value()) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Router acquire resumed without suspend"));
+    }
+    auto acquired = m_inner->await_resume();
+    m_inner.reset();
+    if (!acquired || !acquired->has_value()) {
+        m_router.onAcquireFailed(m_node);
+        if (!acquired) {
+            return std::unexpected(std::move(acquired.error()));
+        }
+        return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Pool acquire resumed without value"));
+    }
+    return MysqlRoutedClient{acquired->value(), m_node, std::chrono::steady_clock::now()};
+}
+
+} // namespace galay::mysql
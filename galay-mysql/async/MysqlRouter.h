@@ -0,0 +1,298 @@
+#ifndef GALAY_MYSQL_ROUTER_H
+#define GALAY_MYSQL_ROUTER_H
+
+#include "MysqlConnectionPool.h"
+#include "galay-mysql/base/MysqlGtid.h"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief 语句路由目标
+ */
+enum class MysqlRouteTarget : uint8_t
+{
+    Primary,
+    Replica
+};
+
+/**
+ * @brief 路由提示
+ * @details Auto按语句分类；Primary/Replica强制指定（没有可用从库时Replica退回主库）
+ */
+enum class MysqlRouteHint : uint8_t
+{
+    Auto,
+    Primary,
+    Replica
+};
+
+/**
+ * @brief 对冲读配置
+ * @details 对冲延迟取从库近期延迟（借出到归还）的delay_percentile分位数，限制在[min_delay, max_delay]内；
+ *          样本少于min_samples时使用max_delay。budget_ratio限制对冲请求占hedgedQuery()总数的比例，
+ *          避免所有从库同时变慢时把负载放大一倍。
+ */
+struct MysqlHedgeConfig
+{
+    double delay_percentile = 0.95;
+    std::chrono::milliseconds min_delay{1};
+    std::chrono::milliseconds max_delay{50};
+    size_t min_samples = 32;
+    double budget_ratio = 0.1;
+    bool allow_primary = false;                 // 没有其他可用从库时是否对冲到主库
+    std::chrono::milliseconds loser_grace{100}; // 落后请求自然结束的宽限期，超过后才KILL QUERY
+};
+
+struct MysqlRouterConfig
+{
+    MysqlConnectionPoolConfig primary;
+    std::vector<MysqlConnectionPoolConfig> replicas;
+    double latency_ewma_alpha = 0.3;                                // 新样本在延迟EWMA中的权重
+    std::chrono::milliseconds replica_down_cooldown{1000};          // 从库获取连接失败后暂停路由的时间
+    std::chrono::milliseconds replica_gtid_refresh_interval{100};   // 从库gtid_executed快照的最短刷新间隔
+    MysqlHedgeConfig hedge;
+};
+
+/**
+ * @brief 路由器借出的连接
+ * @details node为0表示主库，1..N为第N个从库；归还时交回MysqlRouter::release()
+ */
+struct MysqlRoutedClient
+{
+    AsyncMysqlClient* client = nullptr;
+    size_t node = 0;
+    std::chrono::steady_clock::time_point acquired_at;
+
+    bool isPrimary() const { return node == 0; }
+    AsyncMysqlClient* operator->() const { return client; }
+    AsyncMysqlClient& operator*() const { return *client; }
+};
+
+/**
+ * @brief 主从读写分离路由器
+ * @details 持有一个主库连接池和N个从库连接池。acquire()按提示或语句分类选择节点：
+ *          只读语句（SELECT / WITH ... SELECT，且不含FOR UPDATE、LOCK IN SHARE MODE、INTO、
+ *          GET_LOCK/LAST_INSERT_ID等依赖会话或有副作用的函数）进入从库，其余一律进入主库。
+ *          从库按 (借出中连接数 + 1) * 延迟EWMA 取最小者，延迟为借出到归还的时长；
+ *          获取连接失败的从库在replica_down_cooldown内不再参与选择。
+ *
+ *          事务固定在主库：BEGIN/START TRANSACTION等语句分类为主库，事务内的语句应在同一个
+ *          借出的连接上执行，直到COMMIT/ROLLBACK后再release()。
+ *
+ *          读己之写：把写入结果的gtids()合并进MysqlGtidSet并传给acquire()，只有已知应用了这些GTID的
+ *          从库才会被选中，否则退回主库。路由器为每个从库缓存一份@@GLOBAL.gtid_executed快照，
+ *          快照不满足时在后台刷新（间隔不小于replica_gtid_refresh_interval），判断本身不增加往返。
+ *          服务端需开启session_track_gtids=OWN_GTID才会在OK包中带回GTID。
+ *
+ *          对冲读：hedgedQuery()把只读语句发往一个从库，超过对冲延迟仍未返回时向另一个从库重发，
+ *          取先到的响应；落后的一方照常读完响应后把连接归还连接池，超过loser_grace仍在执行时
+ *          才通过取消令牌旁路KILL QUERY（KILL前核对该命令仍在途）。
+ *          只适用于幂等的只读语句。
+ *
+ * @code
+ * MysqlRouter router(scheduler, config);
+ * auto routed = co_await router.acquire("SELECT * FROM users WHERE id = 1");
+ * if (routed && routed->has_value()) {
+ *     auto& conn = routed->value();
+ *     auto r = co_await conn->query("SELECT * FROM users WHERE id = 1");
+ *     router.release(conn);
+ * }
+ *
+ * auto tx = co_await router.acquire("BEGIN");    // 主库
+ * // ... 在(*tx)->client上执行BEGIN、写入与COMMIT ...
+ * router.release(tx->value());
+ *
+ * MysqlGtidSet written;
+ * auto w = co_await primary_conn->query("UPDATE users SET name = 'bob' WHERE id = 1");
+ * written.merge(w->value().gtids());
+ * auto fresh = co_await router.acquire("SELECT name FROM users WHERE id = 1", written);
+ *
+ * auto user = co_await router.hedgedQuery("SELECT name FROM users WHERE id = 1");
+ * @endcode
+ */
+class MysqlRouter
+{
+public:
+    /**
+     * @brief 节点统计快照
+     */
+    struct NodeStats
+    {
+        size_t in_flight = 0;
+        double latency_ewma_us = 0.0;
+        uint64_t routed = 0;
+        bool down = false;
+        uint64_t gtid_lagging = 0;      // 因尚未应用所需GTID而被跳过的次数
+    };
+
+    /**
+     * @brief 对冲读统计快照
+     */
+    struct HedgeStats
+    {
+        uint64_t queries = 0;               // hedgedQuery()次数
+        uint64_t hedged = 0;                // 发出第二个请求的次数（含首个请求失败后的转移）
+        uint64_t hedge_wins = 0;            // 第二个请求先返回的次数
+        uint64_t budget_exhausted = 0;      // 到达对冲延迟但因预算不足未对冲的次数
+        std::chrono::microseconds delay{0}; // 当前对冲延迟
+    };
+
+    MysqlRouter(galay::kernel::IOScheduler* scheduler, MysqlRouterConfig config);
+
+    MysqlRouter(const MysqlRouter&) = delete;
+    MysqlRouter& operator=(const MysqlRouter&) = delete;
+
+    /**
+     * @brief 语句分类：能否在从库执行
+     * @details 只看语句本身，跳过开头的空白、注释与括号；字符串、引号标识符中的内容不参与判断。
+     *          无法确定时归为Primary。
+     */
+    static MysqlRouteTarget classify(std::string_view sql);
+
+    class AcquireAwaitable
+    {
+    public:
+        AcquireAwaitable(MysqlRouter& router, MysqlRouteTarget target, const MysqlGtidSet* read_after = nullptr);
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        std::expected<std::optional<MysqlRoutedClient>, MysqlError> await_resume();
+
+    private:
+        MysqlRouter& m_router;
+        MysqlRouteTarget m_target;
+        const MysqlGtidSet* m_read_after;
+        size_t m_node = 0;
+        std::optional<MysqlConnectionPool::AcquireAwaitable> m_inner;
+    };
+
+    struct HedgeState;      // 一次对冲读的共享状态，由等待体与后台请求共同持有
+
+    class HedgedQueryAwaitable
+    {
+    public:
+        HedgedQueryAwaitable(MysqlRouter& router, std::string sql);
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        std::expected<std::optional<MysqlResultSet>, MysqlError> await_resume();
+
+    private:
+        MysqlRouter& m_router;
+        std::string m_sql;
+        std::shared_ptr<HedgeState> m_state;
+        std::optional<MysqlError> m_error;
+    };
+
+    /**
+     * @brief 为sql借出一个连接
+     * @param sql 用于Auto分类的语句，为空时路由到主库
+     */
+    AcquireAwaitable acquire(std::string_view sql, MysqlRouteHint hint = MysqlRouteHint::Auto);
+
+    /**
+     * @brief 读己之写：路由到从库时只选择已应用read_after的从库，否则退回主库
+     * @param read_after 需要可见的GTID集合，须在co_await完成前有效；为空时等同于acquire(sql, hint)
+     */
+    AcquireAwaitable acquire(std::string_view sql, const MysqlGtidSet& read_after,
+                             MysqlRouteHint hint = MysqlRouteHint::Auto);
+
+    /**
+     * @brief 按提示借出连接（Auto视为Primary）
+     */
+    AcquireAwaitable acquire(MysqlRouteHint hint);
+
+    /**
+     * @brief 归还连接并记录该节点的延迟样本
+     */
+    void release(const MysqlRoutedClient& routed);
+
+    /**
+     * @brief 对冲读：在从库执行只读语句，超过对冲延迟未返回时向另一个从库重发，取先到的响应
+     * @details 连接错误（获取连接失败、传输中断）时立即转移到另一个从库；服务端ERR视为响应直接返回。
+     *          语句分类不是Replica时返回MYSQL_ERROR_INVALID_PARAM。路由器须比等待体与后台请求存活更久。
+     */
+    HedgedQueryAwaitable hedgedQuery(std::string_view sql);
+
+    size_t replicaCount() const { return m_replicas.size(); }
+    MysqlConnectionPool& primary() { return *m_primary; }
+    MysqlConnectionPool& replica(size_t index) { return *m_replicas.at(index); }
+
+    /**
+     * @brief 节点统计，node为0表示主库
+     */
+    NodeStats stats(size_t node) const;
+
+    /**
+     * @brief 从库最近一次刷新得到的gtid_executed快照（主库返回空集合）
+     */
+    MysqlGtidSet executedGtids(size_t node) const;
+
+    HedgeStats hedgeStats() const;
+
+private:
+    static constexpr size_t kNoNode = static_cast<size_t>(-1);
+    static constexpr size_t kLatencyWindow = 256;       // 对冲延迟分位数的样本窗口
+
+    struct NodeState
+    {
+        size_t in_flight = 0;
+        double latency_ewma_us = 0.0;
+        uint64_t routed = 0;
+        std::chrono::steady_clock::time_point down_until{};
+        MysqlGtidSet executed;                                  // 每次刷新成功整体替换（RESET MASTER后可能变小），失败时保留旧快照
+        bool refreshing = false;
+        std::chrono::steady_clock::time_point refreshed_at{};
+        uint64_t gtid_lagging = 0;
+    };
+
+    size_t pickNode(MysqlRouteTarget target, const MysqlGtidSet* read_after, size_t exclude = kNoNode);
+    MysqlConnectionPool& pool(size_t node) { return node == 0 ? *m_primary : *m_replicas[node - 1]; }
+    void onAcquireFailed(size_t node);
+    void onGtidRefreshed(size_t node, std::optional<MysqlGtidSet> executed);
+    static galay::kernel::Coroutine refreshGtidTask(MysqlRouter* router, size_t node);
+
+    std::chrono::microseconds hedgeDelayLocked();
+    size_t claimHedgeLocked(HedgeState& state, bool failover);
+    void onHedgeAttemptDone(const std::shared_ptr<HedgeState>& state, size_t attempt,
+                            std::expected<MysqlResultSet, MysqlError> outcome);
+    static galay::kernel::Coroutine hedgeAttemptTask(MysqlRouter* router, std::shared_ptr<HedgeState> state,
+                                                     size_t attempt, size_t node);
+    static galay::kernel::Coroutine hedgeTimerTask(MysqlRouter* router, std::shared_ptr<HedgeState> state);
+    static galay::kernel::Coroutine hedgeReapTask(std::shared_ptr<HedgeState> state, size_t loser,
+                                                  std::chrono::milliseconds grace);
+
+    galay::kernel::IOScheduler* m_scheduler;
+    std::unique_ptr<MysqlConnectionPool> m_primary;
+    std::vector<std::unique_ptr<MysqlConnectionPool>> m_replicas;
+    double m_alpha;
+    std::chrono::milliseconds m_down_cooldown;
+    std::chrono::milliseconds m_gtid_refresh_interval;
+    MysqlHedgeConfig m_hedge;
+
+    mutable std::mutex m_mutex;
+    std::vector<NodeState> m_nodes;     // [0]为主库
+    size_t m_next_replica = 0;          // 得分相同时轮转起点
+
+    std::vector<double> m_latency_window;           // 从库延迟样本（us），环形覆盖
+    size_t m_latency_next = 0;
+    size_t m_latency_fresh = 0;                     // 上次计算分位数后新增的样本数
+    std::chrono::microseconds m_hedge_delay{0};
+    double m_hedge_credit = 1.0;
+    HedgeStats m_hedge_stats;
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_ROUTER_H
@@ -0,0 +1,253 @@
+#include "MysqlTransaction.h"
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <utility>
+
+namespace galay::mysql
+{
+
+namespace
+{
+
+constexpr uint16_t kErLockDeadlock = 1213;
+
+/**
+ * @brief 以"; "连接多语句，去掉每条语句首尾的空白与分号
+ */
+void appendStatement(std::string& out, std::string_view sql)
+{
+    while (!sql.empty() && std::isspace(static_cast<unsigned char>(sql.front()))) {
+        sql.remove_prefix(1);
+    }
+    while (!sql.empty() && (std::isspace(static_cast<unsigned char>(sql.back())) || sql.back() == ';')) {
+        sql.remove_suffix(1);
+    }
+    if (sql.empty()) {
+        return;
+    }
+    if (!out.empty()) {
+        out.append("; ");
+    }
+    out.append(sql);
+}
+
+} // namespace
+
+MysqlTransaction::MysqlTransaction(MysqlConnectionPool& pool, MysqlTransactionConfig config)
+    : m_pool(pool)
+    , m_config(std::move(config))
+{
+    m_config.max_attempts = std::max<size_t>(m_config.max_attempts, 1);
+    m_config.max_backoff = std::max(m_config.max_backoff, m_config.base_backoff);
+}
+
+MysqlTransaction::~MysqlTransaction()
+{
+    if (m_client == nullptr) {
+        return;
+    }
+    if (m_open) {
+        m_pool.scheduler()->spawn(abandonTask(&m_pool, m_client));
+    } else {
+        m_pool.release(m_client);
+    }
+}
+
+MysqlTransaction::NextAwaitable MysqlTransaction::next()
+{
+    return NextAwaitable(*this);
+}
+
+MysqlTransaction::StepAwaitable MysqlTransaction::begin(std::string_view first_sql)
+{
+    if (m_client != nullptr && m_open && !m_failed) {
+        return StepAwaitable(*this, MysqlError(MYSQL_ERROR_TRANSACTION, "Transaction already begun"));
+    }
+    std::string sql;
+    size_t skip_front = 1;
+    if (m_rollback_pending) {
+        appendStatement(sql, "ROLLBACK");
+        ++skip_front;
+    }
+    appendStatement(sql, m_config.begin);
+    appendStatement(sql, first_sql);
+    if (m_client != nullptr && !m_failed) {
+        // 请求一经发出事务就可能已开始，之后无论成败都按需回滚
+        m_open = true;
+        m_rollback_pending = false;
+    }
+    return step(std::move(sql), skip_front, 0);
+}
+
+MysqlTransaction::StepAwaitable MysqlTransaction::query(std::string_view sql)
+{
+    if (!m_open && !m_failed) {
+        return StepAwaitable(*this, MysqlError(MYSQL_ERROR_TRANSACTION, "Transaction not begun"));
+    }
+    return step(std::string(sql), 0, 0);
+}
+
+MysqlTransaction::StepAwaitable MysqlTransaction::commit(std::span<const std::string_view> trailing_sqls)
+{
+    if (!m_open && !m_failed) {
+        return StepAwaitable(*this, MysqlError(MYSQL_ERROR_TRANSACTION, "Transaction not begun"));
+    }
+    std::string sql;
+    for (std::string_view trailing : trailing_sqls) {
+        appendStatement(sql, trailing);
+    }
+    appendStatement(sql, "COMMIT");
+    return step(std::move(sql), 0, 1);
+}
+
+MysqlTransaction::StepAwaitable MysqlTransaction::step(std::string sql, size_t skip_front, size_t skip_back)
+{
+    if (m_client == nullptr) {
+        return StepAwaitable(*this, MysqlError(MYSQL_ERROR_TRANSACTION, "No connection, co_await next() first"));
+    }
+    if (m_failed) {
+        // 服务端可能已回滚整个事务，继续发送的语句会在事务之外自动提交
+        return StepAwaitable(*this, *m_error);
+    }
+    return StepAwaitable(*this, std::move(sql), skip_front, skip_back);
+}
+
+void MysqlTransaction::onStepDone(const Result& result)
+{
+    if (!result) {
+        m_failed = true;
+        m_error = result.error();
+    }
+}
+
+bool MysqlTransaction::retryable(const MysqlError& error) const
+{
+    return error.type() == MYSQL_ERROR_SERVER
+        && std::find(m_config.retry_errnos.begin(), m_config.retry_errnos.end(), error.serverErrno())
+               != m_config.retry_errnos.end();
+}
+
+std::chrono::milliseconds MysqlTransaction::backoff() const
+{
+    // 指数退避取上限的一半再加等量随机抖动，让互相死锁的事务错开重试
+    const size_t shift = std::min<size_t>(m_attempts > 0 ? m_attempts - 1 : 0, 16);
+    const auto cap = std::min(m_config.max_backoff, m_config.base_backoff * (int64_t{1} << shift));
+    const auto half = cap.count() / 2;
+    thread_local std::minstd_rand rng(std::random_device{}());
+    std::uniform_int_distribution<int64_t> jitter(0, std::max<int64_t>(cap.count() - half, 0));
+    return std::chrono::milliseconds(half + jitter(rng));
+}
+
+galay::kernel::Coroutine MysqlTransaction::nextTask(MysqlTransaction* tx, NextAwaitable* awaitable,
+                                                    std::coroutine_handle<> handle)
+{
+    if (tx->m_attempts == 0) {
+        auto acquired = co_await tx->m_pool.acquire();
+        if (!acquired || !acquired->has_value()) {
+            tx->m_error = acquired ? MysqlError(MYSQL_ERROR_INTERNAL, "Pool acquire resumed without value")
+                                   : std::move(acquired.error());
+            handle.resume();
+            co_return;
+        }
+        tx->m_client = acquired->value();
+    } else {
+        const bool retry = !tx->m_committed && tx->m_error.has_value() && tx->retryable(*tx->m_error)
+            && tx->m_attempts < tx->m_config.max_attempts && tx->m_client != nullptr
+            && tx->m_client->isReusable();
+        if (!retry) {
+            if (tx->m_open && tx->m_client != nullptr) {
+                // 回滚失败时连接不可复用，归还后被关闭，服务端随连接断开回滚
+                co_await tx->m_client->rollback();
+                tx->m_open = false;
+            }
+            if (tx->m_client != nullptr) {
+                tx->m_pool.release(tx->m_client);
+                tx->m_client = nullptr;
+            }
+            handle.resume();
+            co_return;
+        }
+        // 死锁时服务端已回滚整个事务；锁等待超时只回滚了当前语句，下一次begin()先发送ROLLBACK
+        tx->m_rollback_pending = tx->m_open && tx->m_error->serverErrno() != kErLockDeadlock;
+        tx->m_open = false;
+        co_await galay::kernel::sleep(tx->backoff());
+    }
+    ++tx->m_attempts;
+    tx->m_failed = false;
+    tx->m_error.reset();
+    awaitable->m_run = true;
+    handle.resume();
+}
+
+galay::kernel::Coroutine MysqlTransaction::abandonTask(MysqlConnectionPool* pool, AsyncMysqlClient* client)
+{
+    co_await client->rollback();
+    pool->release(client);
+}
+
+// ======================== NextAwaitable ========================
+
+MysqlTransaction::NextAwaitable::NextAwaitable(MysqlTransaction& tx)
+    : m_tx(tx)
+{
+}
+
+bool MysqlTransaction::NextAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    m_run = false;
+    m_tx.m_pool.scheduler()->spawn(nextTask(&m_tx, this, handle));
+    return true;
+}
+
+// ======================== StepAwaitable ========================
+
+MysqlTransaction::StepAwaitable::StepAwaitable(MysqlTransaction& tx, std::string sql, size_t skip_front,
+                                               size_t skip_back)
+    : m_tx(tx)
+    , m_skip_front(skip_front)
+    , m_skip_back(skip_back)
+{
+    protocol::MysqlCommandBuilder builder;
+    builder.reserve(1, protocol::MYSQL_PACKET_HEADER_SIZE + 1 + sql.size());
+    builder.appendQuery(sql);
+    m_inner.emplace(*tx.m_client, builder.commands());
+}
+
+MysqlTransaction::StepAwaitable::StepAwaitable(MysqlTransaction& tx, MysqlError error)
+    : m_tx(tx)
+    , m_skip_front(0)
+    , m_skip_back(0)
+    , m_error(std::move(error))
+{
+}
+
+MysqlTransaction::Result MysqlTransaction::StepAwaitable::await_resume()
+{
+    Result result = std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Transaction step produced no result"));
+    if (m_error.has_value()) {
+        result = std::unexpected(std::move(*m_error));
+    } else {
+        auto r = m_inner->await_resume();
+        m_inner.reset();
+        if (!r) {
+            result = std::unexpected(std::move(r.error()));
+        } else if (r->has_value()) {
+            auto& sets = r->value();
+            const size_t front = std::min(m_skip_front, sets.size());
+            const size_t back = std::min(m_skip_back, sets.size() - front);
+            sets.erase(sets.end() - static_cast<std::ptrdiff_t>(back), sets.end());
+            sets.erase(sets.begin(), sets.begin() + static_cast<std::ptrdiff_t>(front));
+            result = std::move(*r);
+            if (m_skip_back > 0) {
+                m_tx.m_committed = true;
+                m_tx.m_open = false;
+            }
+        }
+    }
+    m_tx.onStepDone(result);
+    return result;
+}
+
+} // namespace galay::mysql
@@ -0,0 +1,159 @@
+#ifndef GALAY_MYSQL_TRANSACTION_H
+#define GALAY_MYSQL_TRANSACTION_H
+
+#include "MysqlConnectionPool.h"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace galay::mysql
+{
+
+struct MysqlTransactionConfig
+{
+    std::string begin = "BEGIN";                            // 如START TRANSACTION WITH CONSISTENT SNAPSHOT
+    size_t max_attempts = 3;                                // 含首次执行
+    std::chrono::milliseconds base_backoff{5};
+    std::chrono::milliseconds max_backoff{200};
+    std::vector<uint16_t> retry_errnos{1213, 1205};         // ER_LOCK_DEADLOCK、ER_LOCK_WAIT_TIMEOUT
+};
+
+/**
+ * @brief 带死锁重试的事务助手
+ * @details 从连接池借出一条连接并在整个事务（含重试）期间固定使用。
+ *          begin(sql)把BEGIN与第一条语句合并为一个多语句请求，commit(writes)把末尾的写入与COMMIT合并为一个，
+ *          一个只有“读-改-写”的事务因此只需两次往返。多语句在第一条出错的语句处停止，
+ *          写入失败时COMMIT不会执行。
+ *
+ *          事务体写在 while (co_await tx.next()) 循环中：语句返回retry_errnos中的错误时，
+ *          next()按带抖动的指数退避等待后返回true重新执行事务体（下一次begin()顺带发送ROLLBACK）；
+ *          事务已提交、错误不可重试或次数用尽时回滚并归还连接，返回false。
+ *          一次执行中某条语句出错后，后续语句直接返回同一错误而不发送，避免在已被服务端回滚的事务之外自动提交。
+ *          事务体未调用commit()就进入下一次next()视为放弃，回滚后结束。
+ *
+ * @code
+ * MysqlTransaction tx(pool);
+ * while (co_await tx.next()) {
+ *     auto stock = co_await tx.begin("SELECT stock FROM items WHERE id = 7 FOR UPDATE");
+ *     if (!stock) continue;
+ *     if (std::stoi(stock->value().at(0).row(0).getString(0)) == 0) continue;   // 放弃：回滚
+ *     const std::array<std::string_view, 2> writes{"UPDATE items SET stock = stock - 1 WHERE id = 7",
+ *                                                  "INSERT INTO orders (item_id) VALUES (7)"};
+ *     co_await tx.commit(writes);
+ * }
+ * if (!tx.committed() && tx.error()) { ... }
+ * @endcode
+ */
+class MysqlTransaction
+{
+public:
+    using Result = std::expected<std::optional<std::vector<MysqlResultSet>>, MysqlError>;
+
+    MysqlTransaction(MysqlConnectionPool& pool, MysqlTransactionConfig config = {});
+
+    /**
+     * @brief 仍持有连接时在后台回滚并归还，连接池须比它存活更久
+     */
+    ~MysqlTransaction();
+
+    MysqlTransaction(const MysqlTransaction&) = delete;
+    MysqlTransaction& operator=(const MysqlTransaction&) = delete;
+
+    /**
+     * @brief 结束上一次执行并决定是否（再）执行事务体
+     * @details 首次调用借出连接；之后按上一次执行的结果提交完毕、重试或回滚结束
+     */
+    class NextAwaitable
+    {
+    public:
+        explicit NextAwaitable(MysqlTransaction& tx);
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        bool await_resume() const { return m_run; }
+
+    private:
+        friend class MysqlTransaction;
+
+        MysqlTransaction& m_tx;
+        bool m_run = false;
+    };
+
+    /**
+     * @brief 事务内的一次请求，返回调用方语句的结果集（不含BEGIN/ROLLBACK/COMMIT的OK）
+     */
+    class StepAwaitable
+    {
+    public:
+        StepAwaitable(MysqlTransaction& tx, std::string sql, size_t skip_front, size_t skip_back);
+        StepAwaitable(MysqlTransaction& tx, MysqlError error);
+
+        bool await_ready() const noexcept { return !m_inner.has_value(); }
+        auto await_suspend(std::coroutine_handle<> handle) { return m_inner->await_suspend(handle); }
+        Result await_resume();
+
+    private:
+        MysqlTransaction& m_tx;
+        size_t m_skip_front;
+        size_t m_skip_back;
+        std::optional<MysqlPipelineAwaitable> m_inner;
+        std::optional<MysqlError> m_error;
+    };
+
+    NextAwaitable next();
+
+    /**
+     * @brief 开始事务并执行第一条语句（为空时只发送BEGIN）
+     */
+    StepAwaitable begin(std::string_view first_sql = {});
+
+    StepAwaitable query(std::string_view sql);
+
+    /**
+     * @brief 执行末尾的写入并提交，返回各写入的结果
+     */
+    StepAwaitable commit(std::span<const std::string_view> trailing_sqls = {});
+
+    /**
+     * @brief 当前固定的连接，事务外的命令（如预处理语句）可直接使用，但其错误不参与重试判断
+     */
+    AsyncMysqlClient* client() const { return m_client; }
+
+    bool committed() const { return m_committed; }
+    size_t attempts() const { return m_attempts; }
+
+    /**
+     * @brief 最后一次执行的错误；主动放弃时为空
+     */
+    const std::optional<MysqlError>& error() const { return m_error; }
+
+private:
+    StepAwaitable step(std::string sql, size_t skip_front, size_t skip_back);
+    void onStepDone(const Result& result);
+    bool retryable(const MysqlError& error) const;
+    std::chrono::milliseconds backoff() const;
+
+    static galay::kernel::Coroutine nextTask(MysqlTransaction* tx, NextAwaitable* awaitable,
+                                             std::coroutine_handle<> handle);
+    static galay::kernel::Coroutine abandonTask(MysqlConnectionPool* pool, AsyncMysqlClient* client);
+
+    MysqlConnectionPool& m_pool;
+    MysqlTransactionConfig m_config;
+    AsyncMysqlClient* m_client = nullptr;
+    size_t m_attempts = 0;
+    bool m_open = false;                // 已发送BEGIN且尚未提交或回滚
+    bool m_rollback_pending = false;    // 重试前需回滚，随下一次begin()发送
+    bool m_committed = false;
+    bool m_failed = false;              // 本次执行已有语句出错
+    std::optional<MysqlError> m_error;
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_TRANSACTION_H
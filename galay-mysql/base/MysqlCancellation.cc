@@ -0,0 +1,57 @@
+#include "MysqlCancellation.h"
+
+namespace galay::mysql
+{
+
+MysqlCancellationToken::MysqlCancellationToken()
+    : m_state(std::make_shared<State>())
+{
+}
+
+bool MysqlCancellationToken::cancel()
+{
+    std::vector<std::pair<uint64_t, Callback>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->cancelled.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        callbacks.swap(m_state->callbacks);
+    }
+    // 锁外执行，回调中可再次访问令牌
+    for (auto& [id, callback] : callbacks) {
+        callback();
+    }
+    return true;
+}
+
+uint64_t MysqlCancellationToken::subscribe(Callback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (!m_state->cancelled.load(std::memory_order_relaxed)) {
+            const uint64_t id = m_state->next_id++;
+            m_state->callbacks.emplace_back(id, std::move(callback));
+            return id;
+        }
+    }
+    callback();
+    return 0;
+}
+
+void MysqlCancellationToken::unsubscribe(uint64_t id)
+{
+    if (id == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    auto& callbacks = m_state->callbacks;
+    for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+        if (it->first == id) {
+            callbacks.erase(it);
+            return;
+        }
+    }
+}
+
+} // namespace galay::mysql
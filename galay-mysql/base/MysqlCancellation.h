@@ -0,0 +1,63 @@
+#ifndef GALAY_MYSQL_CANCELLATION_H
+#define GALAY_MYSQL_CANCELLATION_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief 协作式取消令牌
+ * @details 值语义，拷贝共享同一状态；cancel()可在任意线程调用且只生效一次，
+ *          依次执行已登记的回调（在调用cancel()的线程中）。之后登记的回调立即执行。
+ *
+ * @code
+ * MysqlCancellationToken token;
+ * auto aw = client.query("SELECT ...");
+ * aw.cancelOn(token);
+ * // 另一个协程：token.cancel();
+ * auto r = co_await aw;   // 取消后返回MYSQL_ERROR_CANCELLED，连接停在响应边界
+ * @endcode
+ */
+class MysqlCancellationToken
+{
+public:
+    using Callback = std::function<void()>;
+
+    MysqlCancellationToken();
+
+    /**
+     * @brief 请求取消
+     * @return 本次调用是否触发了取消（重复调用返回false）
+     */
+    bool cancel();
+
+    bool isCancelled() const { return m_state->cancelled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 登记取消回调
+     * @return 登记号，用于unsubscribe；已取消时回调立即执行并返回0
+     */
+    uint64_t subscribe(Callback callback);
+    void unsubscribe(uint64_t id);
+
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::mutex mutex;
+        uint64_t next_id = 1;
+        std::vector<std::pair<uint64_t, Callback>> callbacks;
+    };
+
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_CANCELLATION_H
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace galay::mysql
 {
@@ -16,9 +18,47 @@ struct MysqlConfig
     uint16_t port = 3306;
     std::string username;
     std::string password;
-    std::string database;
+    std::string database;       // 随握手响应发送（CLIENT_CONNECT_WITH_DB），不额外执行USE
+
+    /**
+     * @brief 字符集或排序规则名
+     * @details 常用名称映射为握手响应中的排序规则ID，不产生额外往返；
+     *          未收录的名称在认证后以SET NAMES设置，并入会话初始化请求
+     */
     std::string charset = "utf8mb4";
-    uint32_t connect_timeout_ms = 5000;
+    uint32_t connect_timeout_ms = 5000;       // 包含解析与所有地址的连接尝试
+
+    /**
+     * @brief 主机名解析出多个地址时，相邻两次连接尝试的间隔（Happy Eyeballs，RFC 8305）
+     * @details 前一个地址在间隔内未连上就并行尝试下一个，先连上的胜出；某次尝试失败时立即开始下一个
+     */
+    uint32_t connect_attempt_delay_ms = 250;
+
+    /**
+     * @brief 认证后设置的会话变量
+     * @details 值按SQL原样拼接，字符串需自带引号，如 {"time_zone", "'+00:00'"}、{"sql_mode", "'TRADITIONAL'"}。
+     *          全部变量合并为一条SET，与init_statements一起作为一条多语句请求发送，整个连接过程只多一次往返
+     */
+    std::vector<std::pair<std::string, std::string>> session_variables;
+
+    /**
+     * @brief 认证后执行的初始化语句，紧随session_variables发送
+     * @details 任一语句出错时连接失败，后续语句不再执行
+     */
+    std::vector<std::string> init_statements;
+
+    /**
+     * @brief 连接属性（CLIENT_CONNECT_ATTRS），服务端可在performance_schema.session_connect_attrs中查看
+     * @details 用于标记连接来源，如 {"program_name", "order-service"}；非空时随握手发送，
+     *          并自动补上_client_name。属性只作标记，不影响会话状态
+     */
+    std::vector<std::pair<std::string, std::string>> connect_attributes;
+
+    /**
+     * @brief 允许LOAD DATA LOCAL INFILE（握手时声明CLIENT_LOCAL_FILES）
+     * @details 默认关闭；开启后只有loadLocalInfile()会应答服务端的文件请求，数据源由调用方指定
+     */
+    bool allow_local_infile = false;
 
     /**
      * @brief 创建默认配置
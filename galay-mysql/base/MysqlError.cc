@@ -47,6 +47,9 @@ std::string MysqlError::message() const
     case MYSQL_ERROR_INTERNAL:         base = "Internal error"; break;
     case MYSQL_ERROR_BUFFER_OVERFLOW:  base = "Buffer overflow"; break;
     case MYSQL_ERROR_INVALID_PARAM:    base = "Invalid parameter"; break;
+    case MYSQL_ERROR_ROW_MAPPING:      base = "Row mapping error"; break;
+    case MYSQL_ERROR_CANCELLED:        base = "Cancelled"; break;
+    case MYSQL_ERROR_UNAVAILABLE:      base = "Endpoint unavailable"; break;
     default:                           base = "unknown error"; break;
     }
     if (m_server_errno != 0) {
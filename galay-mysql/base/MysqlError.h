@@ -24,6 +24,9 @@ enum MysqlErrorType
     MYSQL_ERROR_INTERNAL,
     MYSQL_ERROR_BUFFER_OVERFLOW,
     MYSQL_ERROR_INVALID_PARAM,
+    MYSQL_ERROR_ROW_MAPPING,
+    MYSQL_ERROR_CANCELLED,
+    MYSQL_ERROR_UNAVAILABLE,
 };
 
 class MysqlError
@@ -0,0 +1,202 @@
+#include "MysqlGtid.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace galay::mysql
+{
+
+namespace
+{
+
+constexpr size_t kUuidLength = 36;
+constexpr size_t kMaxTagLength = 32;
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+bool isUuid(std::string_view s)
+{
+    if (s.size() != kUuidLength) return false;
+    for (size_t i = 0; i < s.size(); ++i) {
+        const bool dash = i == 8 || i == 13 || i == 18 || i == 23;
+        if (dash ? s[i] != '-' : !std::isxdigit(static_cast<unsigned char>(s[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isTag(std::string_view s)
+{
+    if (s.empty() || s.size() > kMaxTagLength) return false;
+    if (!std::isalpha(static_cast<unsigned char>(s.front())) && s.front() != '_') return false;
+    return std::all_of(s.begin(), s.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    });
+}
+
+bool parseGno(std::string_view s, uint64_t& out)
+{
+    s = trim(s);
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && ptr == s.data() + s.size() && out > 0;
+}
+
+MysqlError invalid(std::string_view text)
+{
+    return MysqlError(MYSQL_ERROR_INVALID_PARAM, "Invalid GTID set: " + std::string(text.substr(0, 128)));
+}
+
+} // namespace
+
+std::expected<MysqlGtidSet, MysqlError> MysqlGtidSet::parse(std::string_view text)
+{
+    MysqlGtidSet set;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == std::string_view::npos) comma = text.size();
+        const std::string_view entry = trim(text.substr(pos, comma - pos));
+        pos = comma + 1;
+        if (entry.empty()) {
+            continue;
+        }
+
+        size_t colon = entry.find(':');
+        const std::string_view uuid = trim(entry.substr(0, colon));
+        if (!isUuid(uuid)) {
+            return std::unexpected(invalid(text));
+        }
+        std::string source = normalizeSource(uuid);
+        const size_t uuid_length = source.size();
+        while (colon != std::string_view::npos) {
+            const size_t begin = colon + 1;
+            colon = entry.find(':', begin);
+            const std::string_view part = trim(entry.substr(begin, colon == std::string_view::npos
+                                                                        ? std::string_view::npos
+                                                                        : colon - begin));
+            if (!part.empty() && !std::isdigit(static_cast<unsigned char>(part.front()))) {
+                // 带标签的GTID（8.3+）：之后的区间属于uuid:tag
+                if (!isTag(part)) {
+                    return std::unexpected(invalid(text));
+                }
+                source.resize(uuid_length);
+                source.push_back(':');
+                source.append(normalizeSource(part));
+                continue;
+            }
+            const size_t dash = part.find('-');
+            uint64_t first = 0;
+            uint64_t last = 0;
+            if (!parseGno(part.substr(0, dash), first)) {
+                return std::unexpected(invalid(text));
+            }
+            last = first;
+            if (dash != std::string_view::npos && (!parseGno(part.substr(dash + 1), last) || last < first)) {
+                return std::unexpected(invalid(text));
+            }
+            set.addNormalized(source, first, last);
+        }
+    }
+    return set;
+}
+
+std::expected<void, MysqlError> MysqlGtidSet::merge(std::string_view text)
+{
+    auto parsed = parse(text);
+    if (!parsed) {
+        return std::unexpected(std::move(parsed.error()));
+    }
+    merge(parsed.value());
+    return {};
+}
+
+void MysqlGtidSet::merge(const MysqlGtidSet& other)
+{
+    for (const auto& [source, intervals] : other.m_sources) {
+        for (const auto& [first, last] : intervals) {
+            addNormalized(source, first, last);
+        }
+    }
+}
+
+void MysqlGtidSet::add(std::string_view source, uint64_t first, uint64_t last)
+{
+    if (first == 0 || last < first) {
+        return;
+    }
+    addNormalized(normalizeSource(trim(source)), first, last);
+}
+
+void MysqlGtidSet::addNormalized(const std::string& source, uint64_t first, uint64_t last)
+{
+    auto& intervals = m_sources[source];
+    // 找到第一个可能与[first, last]相交或相邻的区间，合并后替换掉被覆盖的部分
+    auto it = std::lower_bound(intervals.begin(), intervals.end(), first, [](const Interval& iv, uint64_t value) {
+        return iv.second < value - 1;
+    });
+    auto end = it;
+    while (end != intervals.end() && end->first - 1 <= last) {
+        first = std::min(first, end->first);
+        last = std::max(last, end->second);
+        ++end;
+    }
+    it = intervals.erase(it, end);
+    intervals.insert(it, Interval{first, last});
+}
+
+bool MysqlGtidSet::contains(const MysqlGtidSet& other) const
+{
+    for (const auto& [source, needed] : other.m_sources) {
+        auto found = m_sources.find(source);
+        if (found == m_sources.end()) {
+            return false;
+        }
+        const auto& have = found->second;
+        for (const auto& [first, last] : needed) {
+            // 区间互不相交且不相邻，能覆盖[first, last]的只可能是起点不大于first的最后一个
+            auto it = std::upper_bound(have.begin(), have.end(), first, [](uint64_t value, const Interval& iv) {
+                return value < iv.first;
+            });
+            if (it == have.begin() || std::prev(it)->second < last) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::string MysqlGtidSet::toString() const
+{
+    std::string out;
+    for (const auto& [source, intervals] : m_sources) {
+        if (!out.empty()) out.push_back(',');
+        out.append(source);
+        for (const auto& [first, last] : intervals) {
+            out.push_back(':');
+            out.append(std::to_string(first));
+            if (last != first) {
+                out.push_back('-');
+                out.append(std::to_string(last));
+            }
+        }
+    }
+    return out;
+}
+
+std::string MysqlGtidSet::normalizeSource(std::string_view source)
+{
+    std::string out(source);
+    std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return out;
+}
+
+} // namespace galay::mysql
@@ -0,0 +1,74 @@
+#ifndef GALAY_MYSQL_GTID_H
+#define GALAY_MYSQL_GTID_H
+
+#include "MysqlError.h"
+#include <cstdint>
+#include <expected>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief GTID集合
+ * @details 文本格式与@@GLOBAL.gtid_executed相同：`uuid:1-5:7,uuid2[:tag]:3`，允许空白与换行。
+ *          按 源（uuid或uuid:tag，小写） -> 有序不相交区间 存储，合并与包含判断不依赖服务端。
+ *
+ * @code
+ * MysqlGtidSet written;
+ * auto r = co_await conn->query("UPDATE users SET name = 'bob' WHERE id = 1");
+ * written.merge(r->value().gtids());                       // 需要session_track_gtids=OWN_GTID
+ * auto replica_executed = MysqlGtidSet::parse(text);      // SELECT @@GLOBAL.gtid_executed
+ * bool caught_up = replica_executed->contains(written);
+ * @endcode
+ */
+class MysqlGtidSet
+{
+public:
+    using Interval = std::pair<uint64_t, uint64_t>;     // 闭区间[first, second]
+
+    MysqlGtidSet() = default;
+
+    static std::expected<MysqlGtidSet, MysqlError> parse(std::string_view text);
+
+    /**
+     * @brief 合并文本形式的GTID集合，解析失败时自身不变
+     */
+    std::expected<void, MysqlError> merge(std::string_view text);
+    void merge(const MysqlGtidSet& other);
+
+    /**
+     * @brief 加入单个事务
+     */
+    void add(std::string_view source, uint64_t gno) { add(source, gno, gno); }
+    void add(std::string_view source, uint64_t first, uint64_t last);
+
+    /**
+     * @brief other中的每个事务是否都在本集合中
+     */
+    bool contains(const MysqlGtidSet& other) const;
+
+    bool empty() const { return m_sources.empty(); }
+    void clear() { m_sources.clear(); }
+
+    /**
+     * @brief 规范化文本（源按字典序、区间合并），可直接用于GTID_SUBSET等函数
+     */
+    std::string toString() const;
+
+    bool operator==(const MysqlGtidSet& other) const = default;
+
+private:
+    static std::string normalizeSource(std::string_view source);
+    void addNormalized(const std::string& source, uint64_t first, uint64_t last);
+
+    std::map<std::string, std::vector<Interval>> m_sources;
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_GTID_H
@@ -0,0 +1,160 @@
+#include "MysqlLocalInfile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+
+namespace galay::mysql
+{
+
+MysqlLocalInfileSource::MysqlLocalInfileSource(Reader reader, size_t chunk_bytes)
+    : m_reader(std::move(reader))
+    , m_chunk_bytes(std::clamp<size_t>(chunk_bytes, 1, kMaxChunkBytes))
+{
+}
+
+MysqlLocalInfileSource MysqlLocalInfileSource::fromMemory(std::string_view data, size_t chunk_bytes)
+{
+    auto offset = std::make_shared<size_t>(0);
+    return MysqlLocalInfileSource(
+        [data, offset](char* buffer, size_t capacity) -> std::expected<size_t, MysqlError> {
+            const size_t n = std::min(capacity, data.size() - *offset);
+            std::memcpy(buffer, data.data() + *offset, n);
+            *offset += n;
+            return n;
+        },
+        chunk_bytes);
+}
+
+MysqlLocalInfileSource MysqlLocalInfileSource::fromChunks(std::span<const std::string_view> chunks,
+                                                          size_t chunk_bytes)
+{
+    struct ChunkState {
+        std::vector<std::string_view> chunks;
+        size_t index = 0;
+        size_t offset = 0;
+    };
+    auto state = std::make_shared<ChunkState>();
+    state->chunks.assign(chunks.begin(), chunks.end());
+
+    return MysqlLocalInfileSource(
+        [state](char* buffer, size_t capacity) -> std::expected<size_t, MysqlError> {
+            size_t filled = 0;
+            while (filled < capacity && state->index < state->chunks.size()) {
+                const std::string_view chunk = state->chunks[state->index];
+                const size_t n = std::min(capacity - filled, chunk.size() - state->offset);
+                std::memcpy(buffer + filled, chunk.data() + state->offset, n);
+                filled += n;
+                state->offset += n;
+                if (state->offset == chunk.size()) {
+                    ++state->index;
+                    state->offset = 0;
+                }
+            }
+            return filled;
+        },
+        chunk_bytes);
+}
+
+MysqlLocalInfileSource MysqlLocalInfileSource::fromFile(std::string path, size_t chunk_bytes)
+{
+    struct FileState {
+        std::string path;
+        int fd = -1;
+        bool eof = false;
+        ~FileState() { if (fd >= 0) ::close(fd); }
+    };
+    auto state = std::make_shared<FileState>();
+    state->path = std::move(path);
+
+    return MysqlLocalInfileSource(
+        [state](char* buffer, size_t capacity) -> std::expected<size_t, MysqlError> {
+            if (state->eof) {
+                return 0;
+            }
+            if (state->fd < 0) {
+                state->fd = ::open(state->path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (state->fd < 0) {
+                    return std::unexpected(MysqlError(MYSQL_ERROR_INVALID_PARAM,
+                        "Failed to open local infile " + state->path + ": " + std::strerror(errno)));
+                }
+            }
+            // 尽量填满一块，减少包数
+            size_t filled = 0;
+            while (filled < capacity) {
+                const ssize_t n = ::read(state->fd, buffer + filled, capacity - filled);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return std::unexpected(MysqlError(MYSQL_ERROR_INVALID_PARAM,
+                        "Failed to read local infile " + state->path + ": " + std::strerror(errno)));
+                }
+                if (n == 0) {
+                    state->eof = true;
+                    ::close(state->fd);
+                    state->fd = -1;
+                    break;
+                }
+                filled += static_cast<size_t>(n);
+            }
+            return filled;
+        },
+        chunk_bytes);
+}
+
+MysqlLocalInfileSource MysqlLocalInfileSource::fromGenerator(Generator generator, size_t chunk_bytes)
+{
+    struct GeneratorState {
+        Generator generator;
+        std::string pending;
+        size_t offset = 0;
+        bool done = false;
+    };
+    auto state = std::make_shared<GeneratorState>();
+    state->generator = std::move(generator);
+
+    return MysqlLocalInfileSource(
+        [state](char* buffer, size_t capacity) -> std::expected<size_t, MysqlError> {
+            size_t filled = 0;
+            while (filled < capacity) {
+                if (state->offset >= state->pending.size()) {
+                    if (state->done) {
+                        break;
+                    }
+                    auto next = state->generator();
+                    if (!next.has_value()) {
+                        state->done = true;
+                        break;
+                    }
+                    state->pending = std::move(*next);
+                    state->offset = 0;
+                    continue;
+                }
+                const size_t n = std::min(capacity - filled, state->pending.size() - state->offset);
+                std::memcpy(buffer + filled, state->pending.data() + state->offset, n);
+                state->offset += n;
+                filled += n;
+            }
+            return filled;
+        },
+        chunk_bytes);
+}
+
+std::expected<size_t, MysqlError> MysqlLocalInfileSource::read(char* buffer, size_t capacity)
+{
+    if (!m_reader) {
+        return 0;
+    }
+    auto n = m_reader(buffer, std::min(capacity, m_chunk_bytes));
+    if (n && *n == 0) {
+        // 结束后不再调用，释放回调持有的资源
+        m_reader = nullptr;
+    }
+    return n;
+}
+
+} // namespace galay::mysql
@@ -0,0 +1,87 @@
+#ifndef GALAY_MYSQL_LOCAL_INFILE_H
+#define GALAY_MYSQL_LOCAL_INFILE_H
+
+#include "MysqlError.h"
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief LOAD DATA LOCAL INFILE的数据源
+ * @details 客户端收到服务端的LOCAL INFILE请求后反复调用read()，每次读到的字节直接写入一个协议包发送，
+ *          读到0表示结束；整个文件不会被整体缓冲。数据源由调用方随语句一起提供，
+ *          服务端请求中的文件名只用于日志，不会被客户端打开（防止恶意服务端读取任意文件）。
+ *
+ * @code
+ * auto source = MysqlLocalInfileSource::fromFile("/data/users.csv");
+ * auto r = co_await client.loadLocalInfile(
+ *     "LOAD DATA LOCAL INFILE 'users.csv' INTO TABLE users FIELDS TERMINATED BY ','", std::move(source));
+ * // r->affectedRows()为导入的行数
+ * @endcode
+ */
+class MysqlLocalInfileSource
+{
+public:
+    /**
+     * @brief 读取回调：写入至多capacity字节，返回写入的字节数，0表示结束
+     */
+    using Reader = std::function<std::expected<size_t, MysqlError>(char* buffer, size_t capacity)>;
+
+    /**
+     * @brief 生成器回调：每次返回一段数据（如一行CSV），std::nullopt表示结束
+     */
+    using Generator = std::function<std::optional<std::string>()>;
+
+    static constexpr size_t kDefaultChunkBytes = 256 * 1024;
+    static constexpr size_t kMaxChunkBytes = 0xFFFFFE;     // MYSQL_MAX_PACKET_SIZE - 1，一个包装下一块
+
+    /**
+     * @param chunk_bytes 单个数据包的最大载荷，上限为MYSQL_MAX_PACKET_SIZE - 1
+     */
+    explicit MysqlLocalInfileSource(Reader reader, size_t chunk_bytes = kDefaultChunkBytes);
+
+    /**
+     * @brief 内存数据，调用方保证data在导入完成前有效
+     */
+    static MysqlLocalInfileSource fromMemory(std::string_view data, size_t chunk_bytes = kDefaultChunkBytes);
+
+    /**
+     * @brief 多段内存数据按顺序拼接，调用方保证各段数据在发送完成前有效
+     */
+    static MysqlLocalInfileSource fromChunks(std::span<const std::string_view> chunks,
+                                             size_t chunk_bytes = kDefaultChunkBytes);
+
+    /**
+     * @brief 本地文件，首次读取时打开，按块读取，结束或析构时关闭
+     */
+    static MysqlLocalInfileSource fromFile(std::string path, size_t chunk_bytes = kDefaultChunkBytes);
+
+    /**
+     * @brief 由生成器逐段产生数据，多段合并进同一个包，超出包容量的部分留到下一个包
+     */
+    static MysqlLocalInfileSource fromGenerator(Generator generator, size_t chunk_bytes = kDefaultChunkBytes);
+
+    std::expected<size_t, MysqlError> read(char* buffer, size_t capacity);
+    size_t chunkBytes() const { return m_chunk_bytes; }
+
+private:
+    Reader m_reader;
+    size_t m_chunk_bytes;
+};
+
+/**
+ * @brief COM_STMT_SEND_LONG_DATA的数据源，与LOCAL INFILE共用同一套分块读取接口
+ */
+using MysqlLongDataSource = MysqlLocalInfileSource;
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_LOCAL_INFILE_H
@@ -1,14 +1,38 @@
 #ifndef GALAY_MYSQL_LOG_H
 #define GALAY_MYSQL_LOG_H
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+/**
+ * @brief 编译期日志级别裁剪
+ * @details 低于GALAY_MYSQL_LOG_LEVEL的MysqlLogXxx调用在预处理阶段被移除，
+ *          不求值参数、不访问logger。取值与SPDLOG_LEVEL_*一致，
+ *          可通过CMake缓存变量GALAY_MYSQL_LOG_LEVEL（trace/debug/info/warn/error/off）设置。
+ */
+#define GALAY_MYSQL_LOG_LEVEL_TRACE 0
+#define GALAY_MYSQL_LOG_LEVEL_DEBUG 1
+#define GALAY_MYSQL_LOG_LEVEL_INFO  2
+#define GALAY_MYSQL_LOG_LEVEL_WARN  3
+#define GALAY_MYSQL_LOG_LEVEL_ERROR 4
+#define GALAY_MYSQL_LOG_LEVEL_OFF   6
+
+#ifndef GALAY_MYSQL_LOG_LEVEL
+#ifdef ENABLE_DEBUG
+#define GALAY_MYSQL_LOG_LEVEL GALAY_MYSQL_LOG_LEVEL_DEBUG
+#else
+#define GALAY_MYSQL_LOG_LEVEL GALAY_MYSQL_LOG_LEVEL_INFO
+#endif
+#endif
+
 namespace galay::mysql
 {
 
@@ -43,9 +67,9 @@ public:
                 logger = spdlog::stdout_color_mt(logger_name);
             }
             applyDefault(logger);
-            instance->m_logger = std::move(logger);
+            instance->publish(std::move(logger));
         } catch (const spdlog::spdlog_ex&) {
-            instance->m_logger = spdlog::get(logger_name);
+            instance->publish(spdlog::get(logger_name));
         }
     }
 
@@ -59,7 +83,7 @@ public:
             logger_name,
             std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_file_path, !truncate));
         applyDefault(logger);
-        instance->m_logger = std::move(logger);
+        instance->publish(std::move(logger));
     }
 
     static void disable()
@@ -69,14 +93,14 @@ public:
         if (instance->m_logger) {
             instance->m_logger->set_level(spdlog::level::off);
         }
-        instance->m_logger.reset();
+        instance->publish(nullptr);
     }
 
     static void setLogger(MysqlLoggerPtr logger)
     {
         auto instance = getInstance();
         std::lock_guard<std::mutex> lock(instance->m_mutex);
-        instance->m_logger = std::move(logger);
+        instance->publish(std::move(logger));
     }
 
     MysqlLoggerPtr getLogger() const
@@ -85,6 +109,17 @@ public:
         return m_logger;
     }
 
+    /**
+     * @brief 无锁读取当前全局logger
+     * @details 热路径专用，不复制shared_ptr。曾经发布过的logger都保留到进程退出（按指针去重，
+     *          反复切换同一批logger不会增长；每次file()都会新建logger），因此返回的指针始终有效，
+     *          与其他线程何时替换无关。
+     */
+    spdlog::logger* rawLogger() const noexcept
+    {
+        return m_raw_logger.load(std::memory_order_acquire);
+    }
+
 private:
     static void applyDefault(const MysqlLoggerPtr& logger)
     {
@@ -99,37 +134,80 @@ private:
 #endif
     }
 
+    // 调用方需持有m_mutex；保留集合的大小等于发布过的不同logger个数
+    void publish(MysqlLoggerPtr logger)
+    {
+        if (m_logger && m_logger != logger
+            && std::find(m_retired.begin(), m_retired.end(), m_logger) == m_retired.end()) {
+            m_retired.push_back(m_logger);
+        }
+        m_logger = std::move(logger);
+        m_raw_logger.store(m_logger.get(), std::memory_order_release);
+    }
+
 private:
     mutable std::mutex m_mutex;
     MysqlLoggerPtr m_logger;
+    std::vector<MysqlLoggerPtr> m_retired;      // 被替换的logger，rawLogger()的读者可能仍在使用
+    std::atomic<spdlog::logger*> m_raw_logger{nullptr};
 };
 
 namespace detail
 {
-inline MysqlLoggerPtr resolveLogger(const MysqlLoggerPtr& logger)
+/**
+ * @brief 解析本次日志调用的目标logger
+ * @details 优先使用客户端logger，未设置时回退到全局logger；级别未开启时返回nullptr，
+ *          整个过程无锁、不复制shared_ptr。
+ */
+inline spdlog::logger* resolveLogger(const MysqlLoggerPtr& logger, spdlog::level::level_enum level) noexcept
 {
-    if (logger) {
-        return logger;
+    spdlog::logger* target = logger ? logger.get() : MysqlLog::getInstance()->rawLogger();
+    if (target == nullptr || !target->should_log(level)) {
+        return nullptr;
     }
-    return MysqlLog::getInstance()->getLogger();
+    return target;
 }
 } // namespace detail
 
 } // namespace galay::mysql
 
-#define MysqlLogTrace(logger, ...) \
-    do { auto _logger = ::galay::mysql::detail::resolveLogger((logger)); if (_logger) SPDLOG_LOGGER_TRACE(_logger, __VA_ARGS__); } while (0)
+#define GALAY_MYSQL_LOG_IMPL(logger, level, ...) \
+    do { \
+        if (auto* _logger = ::galay::mysql::detail::resolveLogger((logger), (level))) { \
+            _logger->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, (level), __VA_ARGS__); \
+        } \
+    } while (0)
 
-#define MysqlLogDebug(logger, ...) \
-    do { auto _logger = ::galay::mysql::detail::resolveLogger((logger)); if (_logger) SPDLOG_LOGGER_DEBUG(_logger, __VA_ARGS__); } while (0)
+#define GALAY_MYSQL_LOG_DISCARD(logger, ...) do { } while (0)
 
-#define MysqlLogInfo(logger, ...) \
-    do { auto _logger = ::galay::mysql::detail::resolveLogger((logger)); if (_logger) SPDLOG_LOGGER_INFO(_logger, __VA_ARGS__); } while (0)
+#if GALAY_MYSQL_LOG_LEVEL <= GALAY_MYSQL_LOG_LEVEL_TRACE
+#define MysqlLogTrace(logger, ...) GALAY_MYSQL_LOG_IMPL(logger, spdlog::level::trace, __VA_ARGS__)
+#else
+#define MysqlLogTrace(logger, ...) GALAY_MYSQL_LOG_DISCARD(logger, __VA_ARGS__)
+#endif
+
+#if GALAY_MYSQL_LOG_LEVEL <= GALAY_MYSQL_LOG_LEVEL_DEBUG
+#define MysqlLogDebug(logger, ...) GALAY_MYSQL_LOG_IMPL(logger, spdlog::level::debug, __VA_ARGS__)
+#else
+#define MysqlLogDebug(logger, ...) GALAY_MYSQL_LOG_DISCARD(logger, __VA_ARGS__)
+#endif
+
+#if GALAY_MYSQL_LOG_LEVEL <= GALAY_MYSQL_LOG_LEVEL_INFO
+#define MysqlLogInfo(logger, ...) GALAY_MYSQL_LOG_IMPL(logger, spdlog::level::info, __VA_ARGS__)
+#else
+#define MysqlLogInfo(logger, ...) GALAY_MYSQL_LOG_DISCARD(logger, __VA_ARGS__)
+#endif
 
-#define MysqlLogWarn(logger, ...) \
-    do { auto _logger = ::galay::mysql::detail::resolveLogger((logger)); if (_logger) SPDLOG_LOGGER_WARN(_logger, __VA_ARGS__); } while (0)
+#if GALAY_MYSQL_LOG_LEVEL <= GALAY_MYSQL_LOG_LEVEL_WARN
+#define MysqlLogWarn(logger, ...) GALAY_MYSQL_LOG_IMPL(logger, spdlog::level::warn, __VA_ARGS__)
+#else
+#define MysqlLogWarn(logger, ...) GALAY_MYSQL_LOG_DISCARD(logger, __VA_ARGS__)
+#endif
 
-#define MysqlLogError(logger, ...) \
-    do { auto _logger = ::galay::mysql::detail::resolveLogger((logger)); if (_logger) SPDLOG_LOGGER_ERROR(_logger, __VA_ARGS__); } while (0)
+#if GALAY_MYSQL_LOG_LEVEL <= GALAY_MYSQL_LOG_LEVEL_ERROR
+#define MysqlLogError(logger, ...) GALAY_MYSQL_LOG_IMPL(logger, spdlog::level::err, __VA_ARGS__)
+#else
+#define MysqlLogError(logger, ...) GALAY_MYSQL_LOG_DISCARD(logger, __VA_ARGS__)
+#endif
 
 #endif // GALAY_MYSQL_LOG_H
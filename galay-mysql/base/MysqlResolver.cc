@@ -0,0 +1,207 @@
+#include "MysqlResolver.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <utility>
+
+namespace galay::mysql
+{
+
+namespace
+{
+
+/**
+ * @brief 按RFC 8305交替排列两个地址族，保持各自族内getaddrinfo给出的顺序
+ */
+std::vector<MysqlResolvedAddress> interleaveFamilies(std::vector<MysqlResolvedAddress> addresses)
+{
+    if (addresses.size() < 2) {
+        return addresses;
+    }
+    const int first_family = addresses.front().family;
+    std::vector<MysqlResolvedAddress> preferred;
+    std::vector<MysqlResolvedAddress> other;
+    for (auto& address : addresses) {
+        (address.family == first_family ? preferred : other).push_back(std::move(address));
+    }
+    std::vector<MysqlResolvedAddress> ordered;
+    ordered.reserve(preferred.size() + other.size());
+    for (size_t i = 0; i < preferred.size() || i < other.size(); ++i) {
+        if (i < preferred.size()) ordered.push_back(std::move(preferred[i]));
+        if (i < other.size()) ordered.push_back(std::move(other[i]));
+    }
+    return ordered;
+}
+
+} // namespace
+
+MysqlResolver::MysqlResolver(MysqlResolverConfig config)
+    : m_config(config)
+{
+}
+
+std::shared_ptr<MysqlResolver> MysqlResolver::create(MysqlResolverConfig config)
+{
+    return std::shared_ptr<MysqlResolver>(new MysqlResolver(config));
+}
+
+std::shared_ptr<MysqlResolver> MysqlResolver::shared()
+{
+    static const std::shared_ptr<MysqlResolver> instance = create();
+    return instance;
+}
+
+std::optional<int> MysqlResolver::literalFamily(std::string_view host)
+{
+    // IPv6字面量可能带方括号（如[::1]），与URL中的写法保持一致
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    const std::string text(host);
+    in_addr v4{};
+    if (::inet_pton(AF_INET, text.c_str(), &v4) == 1) {
+        return AF_INET;
+    }
+    in6_addr v6{};
+    if (::inet_pton(AF_INET6, text.c_str(), &v6) == 1) {
+        return AF_INET6;
+    }
+    return std::nullopt;
+}
+
+std::optional<MysqlResolver::Result> MysqlResolver::cached(const std::string& host)
+{
+    if (auto family = literalFamily(host)) {
+        std::string ip = host;
+        if (ip.size() >= 2 && ip.front() == '[') {
+            ip = ip.substr(1, ip.size() - 2);
+        }
+        return Result(std::vector<MysqlResolvedAddress>{MysqlResolvedAddress{*family, std::move(ip)}});
+    }
+    std::lock_guard lock(m_mutex);
+    auto it = m_cache.find(host);
+    if (it == m_cache.end() || it->second.expires_at <= std::chrono::steady_clock::now()) {
+        return std::nullopt;
+    }
+    if (it->second.error.has_value()) {
+        return Result(std::unexpected(*it->second.error));
+    }
+    return Result(it->second.addresses);
+}
+
+MysqlResolver::Result MysqlResolver::resolve(const std::string& host)
+{
+    if (auto hit = cached(host)) {
+        return std::move(*hit);
+    }
+    return store(host, lookup(host));
+}
+
+void MysqlResolver::resolveAsync(const std::string& host, Callback callback)
+{
+    if (auto hit = cached(host)) {
+        callback(std::move(*hit));
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        auto [it, inserted] = m_inflight.try_emplace(host);
+        it->second.push_back(std::move(callback));
+        if (!inserted) {
+            return;
+        }
+    }
+    // getaddrinfo没有可取消、可等待的接口，放到独立线程中执行，调度器线程不被阻塞
+    std::thread([self = shared_from_this(), host]() {
+        Result result = self->store(host, lookup(host));
+        std::vector<Callback> callbacks;
+        {
+            std::lock_guard lock(self->m_mutex);
+            auto it = self->m_inflight.find(host);
+            if (it != self->m_inflight.end()) {
+                callbacks = std::move(it->second);
+                self->m_inflight.erase(it);
+            }
+        }
+        for (auto& callback : callbacks) {
+            callback(result);
+        }
+    }).detach();
+}
+
+void MysqlResolver::invalidate(const std::string& host)
+{
+    std::lock_guard lock(m_mutex);
+    m_cache.erase(host);
+}
+
+MysqlResolver::Result MysqlResolver::lookup(const std::string& host)
+{
+    struct addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+
+    struct addrinfo* result = nullptr;
+    const int ret = ::getaddrinfo(host.c_str(), nullptr, &hints, &result);
+    if (ret != 0 || result == nullptr) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION,
+                                          "Failed to resolve host: " + host + " (" + ::gai_strerror(ret) + ")"));
+    }
+
+    std::vector<MysqlResolvedAddress> addresses;
+    for (auto* ai = result; ai != nullptr; ai = ai->ai_next) {
+        char text[INET6_ADDRSTRLEN] = {};
+        const void* raw = nullptr;
+        if (ai->ai_family == AF_INET) {
+            raw = &reinterpret_cast<const sockaddr_in*>(ai->ai_addr)->sin_addr;
+        } else if (ai->ai_family == AF_INET6) {
+            raw = &reinterpret_cast<const sockaddr_in6*>(ai->ai_addr)->sin6_addr;
+        } else {
+            continue;
+        }
+        if (::inet_ntop(ai->ai_family, raw, text, sizeof(text)) == nullptr) {
+            continue;
+        }
+        MysqlResolvedAddress address{ai->ai_family, text};
+        bool duplicate = false;
+        for (const auto& existing : addresses) {
+            duplicate = duplicate || existing == address;
+        }
+        if (!duplicate) {
+            addresses.push_back(std::move(address));
+        }
+    }
+    ::freeaddrinfo(result);
+
+    if (addresses.empty()) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION, "No usable address for host: " + host));
+    }
+    return interleaveFamilies(std::move(addresses));
+}
+
+MysqlResolver::Result MysqlResolver::store(const std::string& host, Result result)
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(m_mutex);
+    Entry& entry = m_cache[host];
+    if (result) {
+        entry.addresses = *result;
+        entry.error.reset();
+        entry.expires_at = now + m_config.ttl;
+        return result;
+    }
+    if (!entry.addresses.empty()) {
+        // 解析服务短暂不可用时继续使用上一次的结果，避免DNS故障放大成数据库不可用
+        entry.expires_at = now + m_config.negative_ttl;
+        return entry.addresses;
+    }
+    entry.error = result.error();
+    entry.expires_at = now + m_config.negative_ttl;
+    return result;
+}
+
+} // namespace galay::mysql
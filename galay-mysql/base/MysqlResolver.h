@@ -0,0 +1,112 @@
+#ifndef GALAY_MYSQL_RESOLVER_H
+#define GALAY_MYSQL_RESOLVER_H
+
+#include "MysqlError.h"
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace galay::mysql
+{
+
+/**
+ * @brief 解析得到的一个地址
+ */
+struct MysqlResolvedAddress
+{
+    int family = 0;         // AF_INET / AF_INET6
+    std::string ip;         // 数字形式，可直接作为MysqlConfig::host
+
+    bool operator==(const MysqlResolvedAddress&) const = default;
+};
+
+struct MysqlResolverConfig
+{
+    // getaddrinfo不返回DNS记录的TTL，缓存按固定时长过期
+    std::chrono::milliseconds ttl{30000};
+    // 解析失败的缓存时长；有过期结果时失败期间继续使用过期结果
+    std::chrono::milliseconds negative_ttl{2000};
+};
+
+/**
+ * @brief 带缓存的主机名解析器
+ * @details 数字地址（含IPv6）直接返回，不查缓存。主机名的解析结果按ttl缓存，同一主机名同时只有一次解析在进行，
+ *          故障转移后的建连风暴只产生一次getaddrinfo调用。
+ *          resolveAsync()在独立线程中执行getaddrinfo，回调也在该线程中执行，调用方负责切回自己的调度器；
+ *          resolve()在当前线程阻塞解析，供同步客户端使用。
+ *          地址按RFC 8305交替排列IPv6/IPv4（以getaddrinfo返回的第一个地址族开头），供Happy Eyeballs依次尝试。
+ *
+ * @code
+ * auto resolver = MysqlResolver::shared();
+ * auto addresses = resolver->resolve("db.internal");
+ * // 连接池与异步客户端使用同一个共享实例
+ * @endcode
+ */
+class MysqlResolver : public std::enable_shared_from_this<MysqlResolver>
+{
+public:
+    using Result = std::expected<std::vector<MysqlResolvedAddress>, MysqlError>;
+    using Callback = std::function<void(Result)>;
+
+    static std::shared_ptr<MysqlResolver> create(MysqlResolverConfig config = {});
+
+    /**
+     * @brief 进程内共享的解析器，未显式指定解析器的连接均使用它
+     */
+    static std::shared_ptr<MysqlResolver> shared();
+
+    /**
+     * @brief 数字地址的地址族，主机名返回空
+     */
+    static std::optional<int> literalFamily(std::string_view host);
+
+    /**
+     * @brief 不阻塞地查询：数字地址或缓存未过期时返回结果，否则返回空
+     */
+    std::optional<Result> cached(const std::string& host);
+
+    /**
+     * @brief 阻塞解析（先查缓存）
+     */
+    Result resolve(const std::string& host);
+
+    /**
+     * @brief 异步解析，命中缓存时在当前线程立即回调
+     */
+    void resolveAsync(const std::string& host, Callback callback);
+
+    /**
+     * @brief 丢弃缓存，下次解析重新查询（如连接全部失败后）
+     */
+    void invalidate(const std::string& host);
+
+private:
+    struct Entry
+    {
+        std::vector<MysqlResolvedAddress> addresses;
+        std::optional<MysqlError> error;
+        std::chrono::steady_clock::time_point expires_at;
+    };
+
+    explicit MysqlResolver(MysqlResolverConfig config);
+
+    static Result lookup(const std::string& host);
+    Result store(const std::string& host, Result result);
+
+    MysqlResolverConfig m_config;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_cache;
+    std::unordered_map<std::string, std::vector<Callback>> m_inflight;
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_RESOLVER_H
@@ -103,6 +103,34 @@ void MysqlResultSet::addRow(MysqlRow row)
     m_rows.push_back(std::move(row));
 }
 
+MysqlRow& MysqlResultSet::appendRow()
+{
+    if (m_spare_rows.empty()) {
+        return m_rows.emplace_back();
+    }
+    m_rows.push_back(std::move(m_spare_rows.back()));
+    m_spare_rows.pop_back();
+    return m_rows.back();
+}
+
+void MysqlResultSet::clear()
+{
+    m_fields.clear();
+    for (auto& row : m_rows) {
+        if (m_spare_rows.size() >= kMaxSpareRows) {
+            break;
+        }
+        m_spare_rows.push_back(std::move(row));
+    }
+    m_rows.clear();
+    m_affected_rows = 0;
+    m_last_insert_id = 0;
+    m_warnings = 0;
+    m_status_flags = 0;
+    m_info.clear();
+    m_gtids.clear();
+}
+
 const MysqlRow& MysqlResultSet::row(size_t index) const
 {
     return m_rows.at(index);
@@ -2,6 +2,7 @@
 #define GALAY_MYSQL_VALUE_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <cstdint>
@@ -136,6 +137,7 @@ public:
     double getDouble(size_t index, double default_val = 0.0) const;
 
     const std::vector<std::optional<std::string>>& values() const { return m_values; }
+    std::vector<std::optional<std::string>>& values() { return m_values; }
 
 private:
     std::vector<std::optional<std::string>> m_values;
@@ -159,6 +161,18 @@ public:
     // 行数据
     void addRow(MysqlRow row);
     void reserveRows(size_t n) { m_rows.reserve(n); }
+
+    /**
+     * @brief 追加一行并返回其引用，优先复用clear()留下的行存储
+     */
+    MysqlRow& appendRow();
+
+    /**
+     * @brief 清空内容但保留已分配的容量
+     * @details 行对象移入备用区（最多kMaxSpareRows行），之后appendRow()复用其列容器与字符串容量
+     */
+    void clear();
+    size_t reusableRows() const { return m_spare_rows.size(); }
     size_t rowCount() const { return m_rows.size(); }
     const MysqlRow& row(size_t index) const;
     const std::vector<MysqlRow>& rows() const { return m_rows; }
@@ -171,7 +185,8 @@ public:
     void setLastInsertId(uint64_t id) { m_last_insert_id = id; }
     void setWarnings(uint16_t w) { m_warnings = w; }
     void setStatusFlags(uint16_t f) { m_status_flags = f; }
-    void setInfo(std::string info) { m_info = std::move(info); }
+    void setInfo(std::string_view info) { m_info.assign(info); }
+    void setGtids(std::string_view gtids) { m_gtids.assign(gtids); }
 
     uint64_t affectedRows() const { return m_affected_rows; }
     uint64_t lastInsertId() const { return m_last_insert_id; }
@@ -179,17 +194,27 @@ public:
     uint16_t statusFlags() const { return m_status_flags; }
     const std::string& info() const { return m_info; }
 
+    /**
+     * @brief 本语句提交的GTID（服务端session_track_gtids=OWN_GTID时由OK包带回，否则为空）
+     * @details 可合并进MysqlGtidSet，作为读己之写的等待条件交给MysqlRouter
+     */
+    const std::string& gtids() const { return m_gtids; }
+
     // 是否是结果集（有列定义）还是仅OK包
     bool hasResultSet() const { return !m_fields.empty(); }
 
 private:
+    static constexpr size_t kMaxSpareRows = 256;
+
     std::vector<MysqlField> m_fields;
     std::vector<MysqlRow> m_rows;
+    std::vector<MysqlRow> m_spare_rows;
     uint64_t m_affected_rows = 0;
     uint64_t m_last_insert_id = 0;
     uint16_t m_warnings = 0;
     uint16_t m_status_flags = 0;
     std::string m_info;
+    std::string m_gtids;
 };
 
 } // namespace galay::mysql
@@ -0,0 +1,1650 @@
+#include "MysqlMockServer.h"
+#include "galay-mysql/protocol/MysqlAuth.h"
+#include "galay-mysql/protocol/MysqlProtocol.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <random>
+
+namespace galay::mysql::mock
+{
+
+using protocol::writeLenEncInt;
+using protocol::writeLenEncString;
+using protocol::writeUint16;
+using protocol::writeUint32;
+using protocol::writeUint64;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kServerCapabilities =
+    protocol::CLIENT_LONG_PASSWORD |
+    protocol::CLIENT_LONG_FLAG |
+    protocol::CLIENT_CONNECT_WITH_DB |
+    protocol::CLIENT_LOCAL_FILES |
+    protocol::CLIENT_PROTOCOL_41 |
+    protocol::CLIENT_TRANSACTIONS |
+    protocol::CLIENT_SECURE_CONNECTION |
+    protocol::CLIENT_MULTI_STATEMENTS |
+    protocol::CLIENT_MULTI_RESULTS |
+    protocol::CLIENT_PS_MULTI_RESULTS |
+    protocol::CLIENT_PLUGIN_AUTH |
+    protocol::CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA |
+    protocol::CLIENT_CONNECT_ATTRS |
+    protocol::CLIENT_SESSION_TRACK;
+
+uint32_t advertisedCapabilities(const MysqlMockServerConfig& config)
+{
+    uint32_t caps = kServerCapabilities;
+    if (config.deprecate_eof) caps |= protocol::CLIENT_DEPRECATE_EOF;
+    return caps & ~config.disabled_capabilities;
+}
+
+constexpr size_t kScrambleLength = 20;
+constexpr uint8_t kKillQuery = 0x01;
+constexpr uint8_t kKillConnection = 0x02;
+
+// ======================== 编码 ========================
+
+size_t beginPacket(std::string& out, uint8_t sequence_id)
+{
+    const size_t pos = out.size();
+    out.append(3, '\0');
+    out.push_back(static_cast<char>(sequence_id));
+    return pos;
+}
+
+void endPacket(std::string& out, size_t pos)
+{
+    const size_t len = out.size() - pos - protocol::MYSQL_PACKET_HEADER_SIZE;
+    out[pos] = static_cast<char>(len & 0xFF);
+    out[pos + 1] = static_cast<char>((len >> 8) & 0xFF);
+    out[pos + 2] = static_cast<char>((len >> 16) & 0xFF);
+}
+
+// session_track为协商了CLIENT_SESSION_TRACK：info改为lenenc，gtid非空时附带SESSION_TRACK_GTIDS
+void appendOk(std::string& out, uint8_t sequence_id, uint64_t affected_rows, uint64_t last_insert_id,
+              uint16_t status, std::string_view info, bool eof_marker = false,
+              bool session_track = false, std::string_view gtid = {})
+{
+    const bool state_changed = session_track && !gtid.empty();
+    if (state_changed) {
+        status |= protocol::SERVER_SESSION_STATE_CHANGED;
+    }
+    const size_t pos = beginPacket(out, sequence_id);
+    out.push_back(static_cast<char>(eof_marker ? 0xFE : 0x00));
+    writeLenEncInt(out, affected_rows);
+    writeLenEncInt(out, last_insert_id);
+    writeUint16(out, status);
+    writeUint16(out, 0);
+    if (!session_track) {
+        out.append(info);
+    } else if (!info.empty() || state_changed) {
+        writeLenEncString(out, info);
+    }
+    if (state_changed) {
+        std::string entry(1, '\0');        // 编码规格
+        writeLenEncString(entry, gtid);
+        std::string block(1, static_cast<char>(protocol::SESSION_TRACK_GTIDS));
+        writeLenEncString(block, entry);
+        writeLenEncString(out, block);
+    }
+    endPacket(out, pos);
+}
+
+void appendErr(std::string& out, uint8_t sequence_id, uint16_t code,
+               std::string_view sql_state, std::string_view message)
+{
+    const size_t pos = beginPacket(out, sequence_id);
+    out.push_back(static_cast<char>(0xFF));
+    writeUint16(out, code);
+    out.push_back('#');
+    std::string state(sql_state.substr(0, 5));
+    state.resize(5, '0');
+    out.append(state);
+    out.append(message);
+    endPacket(out, pos);
+}
+
+void appendEof(std::string& out, uint8_t sequence_id, uint16_t status)
+{
+    const size_t pos = beginPacket(out, sequence_id);
+    out.push_back(static_cast<char>(0xFE));
+    writeUint16(out, 0);
+    writeUint16(out, status);
+    endPacket(out, pos);
+}
+
+bool isNumericType(MysqlFieldType type)
+{
+    switch (type) {
+    case MysqlFieldType::TINY:
+    case MysqlFieldType::SHORT:
+    case MysqlFieldType::LONG:
+    case MysqlFieldType::INT24:
+    case MysqlFieldType::LONGLONG:
+    case MysqlFieldType::YEAR:
+    case MysqlFieldType::FLOAT:
+    case MysqlFieldType::DOUBLE:
+    case MysqlFieldType::DECIMAL:
+    case MysqlFieldType::NEWDECIMAL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void appendColumnDefinition(std::string& out, uint8_t sequence_id, const MysqlMockColumn& column)
+{
+    const size_t pos = beginPacket(out, sequence_id);
+    writeLenEncString(out, "def");
+    writeLenEncString(out, "");
+    writeLenEncString(out, "");
+    writeLenEncString(out, "");
+    writeLenEncString(out, column.name);
+    writeLenEncString(out, column.name);
+    writeLenEncInt(out, 0x0c);
+    const bool numeric = isNumericType(column.type);
+    writeUint16(out, numeric ? protocol::CHARSET_BINARY : protocol::CHARSET_UTF8MB4_GENERAL_CI);
+    writeUint32(out, numeric ? 20 : 1020);
+    out.push_back(static_cast<char>(column.type));
+    writeUint16(out, column.flags);
+    out.push_back(static_cast<char>(column.decimals));
+    writeUint16(out, 0);
+    endPacket(out, pos);
+}
+
+template<typename T>
+T parseNumber(std::string_view text)
+{
+    T value{};
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+template<typename T>
+void appendFixed(std::string& out, T value)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+// "YYYY-MM-DD[ HH:MM:SS[.ffffff]]" -> 二进制DATE/DATETIME
+void appendBinaryDateTime(std::string& out, std::string_view text)
+{
+    uint32_t part[7] = {0, 0, 0, 0, 0, 0, 0};
+    size_t index = 0;
+    size_t i = 0;
+    while (i < text.size() && index < 7) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < text.size() && std::isdigit(static_cast<unsigned char>(text[j]))) ++j;
+        std::string_view digits = text.substr(i, j - i);
+        uint32_t value = parseNumber<uint32_t>(digits);
+        if (index == 6) {
+            for (size_t k = digits.size(); k < 6; ++k) value *= 10;
+        }
+        part[index++] = value;
+        i = j;
+    }
+
+    uint8_t length = 11;
+    if (part[6] == 0) length = 7;
+    if (length == 7 && part[3] == 0 && part[4] == 0 && part[5] == 0) length = 4;
+    if (length == 4 && part[0] == 0 && part[1] == 0 && part[2] == 0) length = 0;
+
+    out.push_back(static_cast<char>(length));
+    if (length == 0) return;
+    writeUint16(out, static_cast<uint16_t>(part[0]));
+    out.push_back(static_cast<char>(part[1]));
+    out.push_back(static_cast<char>(part[2]));
+    if (length == 4) return;
+    out.push_back(static_cast<char>(part[3]));
+    out.push_back(static_cast<char>(part[4]));
+    out.push_back(static_cast<char>(part[5]));
+    if (length == 7) return;
+    writeUint32(out, part[6]);
+}
+
+// "[-]HHH:MM:SS[.ffffff]" -> 二进制TIME
+void appendBinaryTime(std::string& out, std::string_view text)
+{
+    const bool negative = !text.empty() && text.front() == '-';
+    if (negative) text.remove_prefix(1);
+
+    uint32_t part[4] = {0, 0, 0, 0};
+    size_t index = 0;
+    size_t i = 0;
+    while (i < text.size() && index < 4) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < text.size() && std::isdigit(static_cast<unsigned char>(text[j]))) ++j;
+        std::string_view digits = text.substr(i, j - i);
+        uint32_t value = parseNumber<uint32_t>(digits);
+        if (index == 3) {
+            for (size_t k = digits.size(); k < 6; ++k) value *= 10;
+        }
+        part[index++] = value;
+        i = j;
+    }
+
+    uint8_t length = part[3] != 0 ? 12 : 8;
+    if (length == 8 && part[0] == 0 && part[1] == 0 && part[2] == 0) length = 0;
+    out.push_back(static_cast<char>(length));
+    if (length == 0) return;
+    out.push_back(static_cast<char>(negative ? 1 : 0));
+    writeUint32(out, part[0] / 24);
+    out.push_back(static_cast<char>(part[0] % 24));
+    out.push_back(static_cast<char>(part[1]));
+    out.push_back(static_cast<char>(part[2]));
+    if (length == 12) writeUint32(out, part[3]);
+}
+
+void appendBinaryValue(std::string& out, const MysqlMockColumn& column, std::string_view text)
+{
+    const bool is_unsigned = (column.flags & UNSIGNED_FLAG) != 0;
+    switch (column.type) {
+    case MysqlFieldType::TINY:
+        out.push_back(static_cast<char>(is_unsigned ? parseNumber<uint8_t>(text)
+                                                    : static_cast<uint8_t>(parseNumber<int8_t>(text))));
+        return;
+    case MysqlFieldType::SHORT:
+    case MysqlFieldType::YEAR:
+        writeUint16(out, is_unsigned ? parseNumber<uint16_t>(text)
+                                     : static_cast<uint16_t>(parseNumber<int16_t>(text)));
+        return;
+    case MysqlFieldType::LONG:
+    case MysqlFieldType::INT24:
+        writeUint32(out, is_unsigned ? parseNumber<uint32_t>(text)
+                                     : static_cast<uint32_t>(parseNumber<int32_t>(text)));
+        return;
+    case MysqlFieldType::LONGLONG:
+        writeUint64(out, is_unsigned ? parseNumber<uint64_t>(text)
+                                     : static_cast<uint64_t>(parseNumber<int64_t>(text)));
+        return;
+    case MysqlFieldType::FLOAT:
+        appendFixed(out, parseNumber<float>(text));
+        return;
+    case MysqlFieldType::DOUBLE:
+        appendFixed(out, parseNumber<double>(text));
+        return;
+    case MysqlFieldType::DATE:
+    case MysqlFieldType::DATETIME:
+    case MysqlFieldType::TIMESTAMP:
+        appendBinaryDateTime(out, text);
+        return;
+    case MysqlFieldType::TIME:
+        appendBinaryTime(out, text);
+        return;
+    default:
+        writeLenEncString(out, text);
+        return;
+    }
+}
+
+void appendTextRow(std::string& out, uint8_t sequence_id, const MysqlMockResult::Row& row, size_t column_count)
+{
+    const size_t pos = beginPacket(out, sequence_id);
+    for (size_t i = 0; i < column_count; ++i) {
+        if (i < row.size() && row[i].has_value()) {
+            writeLenEncString(out, *row[i]);
+        } else {
+            out.push_back(static_cast<char>(0xFB));
+        }
+    }
+    endPacket(out, pos);
+}
+
+void appendBinaryRow(std::string& out, uint8_t sequence_id, const MysqlMockResult::Row& row,
+                     const std::vector<MysqlMockColumn>& columns)
+{
+    const size_t pos = beginPacket(out, sequence_id);
+    out.push_back(0x00);
+    const size_t bitmap_pos = out.size();
+    out.append((columns.size() + 7 + 2) / 8, '\0');
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i < row.size() && row[i].has_value()) {
+            appendBinaryValue(out, columns[i], *row[i]);
+        } else {
+            const size_t bit = i + 2;
+            out[bitmap_pos + bit / 8] = static_cast<char>(
+                static_cast<uint8_t>(out[bitmap_pos + bit / 8]) | (1u << (bit % 8)));
+        }
+    }
+    endPacket(out, pos);
+}
+
+// ======================== 解码 ========================
+
+bool readBinaryParam(const char*& p, const char* end, uint8_t type, bool is_unsigned, std::string& value)
+{
+    auto need = [&](size_t n) { return static_cast<size_t>(end - p) >= n; };
+    switch (static_cast<MysqlFieldType>(type)) {
+    case MysqlFieldType::TINY:
+        if (!need(1)) return false;
+        value = is_unsigned ? std::to_string(static_cast<uint8_t>(*p))
+                            : std::to_string(static_cast<int8_t>(*p));
+        p += 1;
+        return true;
+    case MysqlFieldType::SHORT:
+    case MysqlFieldType::YEAR: {
+        if (!need(2)) return false;
+        const uint16_t v = protocol::readUint16(p);
+        value = is_unsigned ? std::to_string(v) : std::to_string(static_cast<int16_t>(v));
+        p += 2;
+        return true;
+    }
+    case MysqlFieldType::LONG:
+    case MysqlFieldType::INT24: {
+        if (!need(4)) return false;
+        const uint32_t v = protocol::readUint32(p);
+        value = is_unsigned ? std::to_string(v) : std::to_string(static_cast<int32_t>(v));
+        p += 4;
+        return true;
+    }
+    case MysqlFieldType::LONGLONG: {
+        if (!need(8)) return false;
+        const uint64_t v = protocol::readUint64(p);
+        value = is_unsigned ? std::to_string(v) : std::to_string(static_cast<int64_t>(v));
+        p += 8;
+        return true;
+    }
+    case MysqlFieldType::FLOAT: {
+        if (!need(4)) return false;
+        float v;
+        std::memcpy(&v, p, 4);
+        value = std::to_string(v);
+        p += 4;
+        return true;
+    }
+    case MysqlFieldType::DOUBLE: {
+        if (!need(8)) return false;
+        double v;
+        std::memcpy(&v, p, 8);
+        value = std::to_string(v);
+        p += 8;
+        return true;
+    }
+    default: {
+        size_t consumed = 0;
+        auto str = protocol::readLenEncString(p, static_cast<size_t>(end - p), consumed);
+        if (!str) return false;
+        value = std::move(*str);
+        p += consumed;
+        return true;
+    }
+    }
+}
+
+// ======================== 文本工具 ========================
+
+std::string_view trimStatement(std::string_view sql)
+{
+    while (!sql.empty() && std::isspace(static_cast<unsigned char>(sql.front()))) sql.remove_prefix(1);
+    while (!sql.empty() && (std::isspace(static_cast<unsigned char>(sql.back())) || sql.back() == ';')) {
+        sql.remove_suffix(1);
+    }
+    return sql;
+}
+
+bool startsWithNoCase(std::string_view text, std::string_view prefix)
+{
+    if (text.size() < prefix.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(text[i])) != prefix[i]) return false;
+    }
+    return true;
+}
+
+bool equalsNoCase(std::string_view text, std::string_view upper)
+{
+    return text.size() == upper.size() && startsWithNoCase(text, upper);
+}
+
+std::optional<int64_t> parseInteger(std::string_view text)
+{
+    int64_t value = 0;
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || ptr != text.data() + text.size()) return std::nullopt;
+    return value;
+}
+
+uint16_t countPlaceholders(std::string_view sql)
+{
+    uint16_t count = 0;
+    char quote = 0;
+    for (size_t i = 0; i < sql.size(); ++i) {
+        const char c = sql[i];
+        if (quote != 0) {
+            if (c == '\\' && quote != '`') {
+                ++i;
+            } else if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '\'' || c == '"' || c == '`') {
+            quote = c;
+        } else if (c == '?') {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool setNonBlocking(int fd)
+{
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void drainEventFd(int fd)
+{
+    uint64_t value = 0;
+    while (::read(fd, &value, sizeof(value)) > 0) {
+    }
+}
+
+void signalEventFd(int fd)
+{
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t n = ::write(fd, &one, sizeof(one));
+}
+
+} // namespace
+
+// ======================== MysqlMockResult ========================
+
+struct MysqlMockResult::Data
+{
+    Kind kind = Kind::Ok;
+    std::chrono::milliseconds delay{0};
+    std::vector<MysqlMockColumn> columns;
+    std::vector<Row> rows;
+    uint64_t affected_rows = 0;
+    uint64_t last_insert_id = 0;
+    std::string info;
+    std::string gtid;
+    uint16_t error_code = 0;
+    std::string sql_state;
+    std::string message;
+    std::vector<MysqlMockResult> parts;
+
+    // [binary * 2 + deprecate_eof]
+    mutable std::once_flag encoded_once[4];
+    mutable std::string encoded[4];
+
+    std::shared_ptr<Data> clone() const
+    {
+        auto copy = std::make_shared<Data>();
+        copy->kind = kind;
+        copy->delay = delay;
+        copy->columns = columns;
+        copy->rows = rows;
+        copy->affected_rows = affected_rows;
+        copy->last_insert_id = last_insert_id;
+        copy->info = info;
+        copy->gtid = gtid;
+        copy->error_code = error_code;
+        copy->sql_state = sql_state;
+        copy->message = message;
+        copy->parts = parts;
+        return copy;
+    }
+};
+
+MysqlMockResult::MysqlMockResult(std::shared_ptr<Data> data)
+    : m_data(std::move(data))
+{
+}
+
+MysqlMockResult MysqlMockResult::ok(uint64_t affected_rows, uint64_t last_insert_id, std::string info)
+{
+    auto data = std::make_shared<Data>();
+    data->kind = Kind::Ok;
+    data->affected_rows = affected_rows;
+    data->last_insert_id = last_insert_id;
+    data->info = std::move(info);
+    return MysqlMockResult(std::move(data));
+}
+
+MysqlMockResult MysqlMockResult::error(uint16_t error_code, std::string message, std::string sql_state)
+{
+    auto data = std::make_shared<Data>();
+    data->kind = Kind::Error;
+    data->error_code = error_code;
+    data->message = std::move(message);
+    data->sql_state = std::move(sql_state);
+    return MysqlMockResult(std::move(data));
+}
+
+MysqlMockResult MysqlMockResult::resultSet(std::vector<MysqlMockColumn> columns, std::vector<Row> rows)
+{
+    auto data = std::make_shared<Data>();
+    data->kind = Kind::ResultSet;
+    data->columns = std::move(columns);
+    data->rows = std::move(rows);
+    return MysqlMockResult(std::move(data));
+}
+
+MysqlMockResult MysqlMockResult::multi(std::vector<MysqlMockResult> parts)
+{
+    auto data = std::make_shared<Data>();
+    data->kind = Kind::Multi;
+    data->parts = std::move(parts);
+    return MysqlMockResult(std::move(data));
+}
+
+MysqlMockResult MysqlMockResult::generated(size_t columns, size_t rows, size_t value_bytes)
+{
+    static constexpr MysqlFieldType kTypes[] = {
+        MysqlFieldType::LONGLONG,
+        MysqlFieldType::VAR_STRING,
+        MysqlFieldType::DOUBLE,
+    };
+
+    std::vector<MysqlMockColumn> defs;
+    defs.reserve(columns);
+    for (size_t c = 0; c < columns; ++c) {
+        defs.push_back(MysqlMockColumn{"c" + std::to_string(c), kTypes[c % 3], 0, 0});
+    }
+
+    std::vector<Row> data;
+    data.reserve(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        Row row;
+        row.reserve(columns);
+        for (size_t c = 0; c < columns; ++c) {
+            switch (defs[c].type) {
+            case MysqlFieldType::LONGLONG:
+                row.emplace_back(std::to_string(r * columns + c));
+                break;
+            case MysqlFieldType::DOUBLE:
+                row.emplace_back(std::to_string(r) + ".5");
+                break;
+            default:
+                row.emplace_back(std::string(value_bytes, static_cast<char>('a' + (r + c) % 26)));
+                break;
+            }
+        }
+        data.push_back(std::move(row));
+    }
+    return resultSet(std::move(defs), std::move(data));
+}
+
+MysqlMockResult& MysqlMockResult::withDelay(std::chrono::milliseconds delay)
+{
+    if (m_data.use_count() > 1) {
+        m_data = m_data->clone();
+    }
+    m_data->delay = delay;
+    return *this;
+}
+
+MysqlMockResult& MysqlMockResult::withGtid(std::string gtid)
+{
+    if (m_data.use_count() > 1) {
+        m_data = m_data->clone();
+    }
+    m_data->gtid = std::move(gtid);
+    return *this;
+}
+
+MysqlMockResult::Kind MysqlMockResult::kind() const { return m_data->kind; }
+std::chrono::milliseconds MysqlMockResult::delay() const { return m_data->delay; }
+const std::vector<MysqlMockColumn>& MysqlMockResult::columns() const { return m_data->columns; }
+const std::vector<MysqlMockResult::Row>& MysqlMockResult::rows() const { return m_data->rows; }
+uint64_t MysqlMockResult::affectedRows() const { return m_data->affected_rows; }
+uint64_t MysqlMockResult::lastInsertId() const { return m_data->last_insert_id; }
+const std::string& MysqlMockResult::info() const { return m_data->info; }
+const std::string& MysqlMockResult::gtid() const { return m_data->gtid; }
+uint16_t MysqlMockResult::errorCode() const { return m_data->error_code; }
+const std::string& MysqlMockResult::sqlState() const { return m_data->sql_state; }
+const std::string& MysqlMockResult::message() const { return m_data->message; }
+const std::vector<MysqlMockResult>& MysqlMockResult::parts() const { return m_data->parts; }
+
+std::string_view MysqlMockResult::encodedBody(bool binary, bool deprecate_eof) const
+{
+    if (m_data->kind != Kind::ResultSet) {
+        return {};
+    }
+
+    const size_t slot = (binary ? 2 : 0) + (deprecate_eof ? 1 : 0);
+    std::call_once(m_data->encoded_once[slot], [&]() {
+        const Data& data = *m_data;
+        std::string& out = data.encoded[slot];
+        uint8_t seq = 1;
+
+        const size_t pos = beginPacket(out, seq++);
+        writeLenEncInt(out, data.columns.size());
+        endPacket(out, pos);
+
+        for (const auto& column : data.columns) {
+            appendColumnDefinition(out, seq++, column);
+        }
+        if (!deprecate_eof) {
+            appendEof(out, seq++, protocol::SERVER_STATUS_AUTOCOMMIT);
+        }
+        for (const auto& row : data.rows) {
+            if (binary) {
+                appendBinaryRow(out, seq++, row, data.columns);
+            } else {
+                appendTextRow(out, seq++, row, data.columns.size());
+            }
+        }
+    });
+    return m_data->encoded[slot];
+}
+
+// ======================== 连接与工作线程 ========================
+
+struct MysqlMockServer::Connection
+{
+    enum class State : uint8_t {
+        Auth,
+        Command,
+        InfileData,     // 已发出LOCAL INFILE请求，接收数据包直到空包
+        Closing,
+        Closed,
+    };
+
+    struct Statement {
+        std::string sql;
+        uint16_t num_params = 0;
+        std::vector<uint8_t> param_types;   // 每个参数2字节（type, flags）
+        std::unordered_map<uint16_t, std::string> long_data;   // COM_STMT_SEND_LONG_DATA累积的参数，执行后清空
+    };
+
+    int fd = -1;
+    uint32_t id = 0;
+    State state = State::Auth;
+    std::string scramble;
+    uint32_t capabilities = 0;
+    bool in_transaction = false;
+    std::vector<std::pair<std::string, std::string>> connect_attributes;
+
+    std::string in;
+    size_t in_pos = 0;
+
+    uint64_t infile_rows = 0;
+    bool infile_line_open = false;
+    std::string out;
+    size_t out_pos = 0;
+
+    std::optional<Clock::time_point> delayed_until;
+    std::string delayed_response;
+    std::shared_ptr<std::atomic<uint8_t>> kill_flag = std::make_shared<std::atomic<uint8_t>>(0);
+
+    std::unordered_map<uint32_t, Statement> statements;
+    uint32_t next_statement_id = 1;
+
+    bool deprecateEof() const { return (capabilities & protocol::CLIENT_DEPRECATE_EOF) != 0; }
+    bool sessionTrack() const { return (capabilities & protocol::CLIENT_SESSION_TRACK) != 0; }
+
+    uint16_t status() const
+    {
+        uint16_t flags = protocol::SERVER_STATUS_AUTOCOMMIT;
+        if (in_transaction) flags |= protocol::SERVER_STATUS_IN_TRANS;
+        return flags;
+    }
+};
+
+class MysqlMockServer::Worker
+{
+public:
+    explicit Worker(MysqlMockServer& server)
+        : m_server(server)
+    {
+    }
+
+    ~Worker() { stop(); }
+
+    bool start()
+    {
+        m_wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_wake_fd < 0) {
+            return false;
+        }
+        m_stopping.store(false, std::memory_order_release);
+        m_thread = std::thread([this]() { run(); });
+        return true;
+    }
+
+    void stop()
+    {
+        if (!m_thread.joinable()) {
+            return;
+        }
+        m_stopping.store(true, std::memory_order_release);
+        wake();
+        m_thread.join();
+        for (auto& conn : m_connections) closeConnection(*conn);
+        m_connections.clear();
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        for (auto& conn : m_pending) closeConnection(*conn);
+        m_pending.clear();
+        ::close(m_wake_fd);
+        m_wake_fd = -1;
+    }
+
+    void adopt(std::unique_ptr<Connection> conn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_pending_mutex);
+            m_pending.push_back(std::move(conn));
+        }
+        wake();
+    }
+
+    void wake()
+    {
+        if (m_wake_fd >= 0) {
+            signalEventFd(m_wake_fd);
+        }
+    }
+
+private:
+    void run()
+    {
+        std::vector<pollfd> fds;
+        while (!m_stopping.load(std::memory_order_acquire)) {
+            {
+                std::lock_guard<std::mutex> lock(m_pending_mutex);
+                for (auto& conn : m_pending) {
+                    m_connections.push_back(std::move(conn));
+                    flush(*m_connections.back());
+                }
+                m_pending.clear();
+            }
+
+            fds.clear();
+            fds.push_back(pollfd{m_wake_fd, POLLIN, 0});
+            int timeout_ms = -1;
+            const auto now = Clock::now();
+            for (auto& conn : m_connections) {
+                short events = POLLIN;
+                if (conn->out_pos < conn->out.size()) events |= POLLOUT;
+                fds.push_back(pollfd{conn->fd, events, 0});
+                if (conn->delayed_until) {
+                    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        *conn->delayed_until - now).count() + 1;
+                    const int wait = static_cast<int>(std::max<int64_t>(0, remaining));
+                    timeout_ms = timeout_ms < 0 ? wait : std::min(timeout_ms, wait);
+                }
+            }
+
+            const int ready = ::poll(fds.data(), fds.size(), timeout_ms);
+            if (ready < 0 && errno != EINTR) {
+                break;
+            }
+            if (fds[0].revents & POLLIN) {
+                drainEventFd(m_wake_fd);
+            }
+
+            for (size_t i = 0; i < m_connections.size(); ++i) {
+                Connection& conn = *m_connections[i];
+                const short revents = fds[i + 1].revents;
+                handleKill(conn);
+                if (conn.state != Connection::State::Closed && (revents & (POLLIN | POLLHUP | POLLERR))) {
+                    readAvailable(conn);
+                }
+                if (conn.state != Connection::State::Closed) {
+                    resumeDelayed(conn);
+                    processInput(conn);
+                    flush(conn);
+                }
+                if (conn.state == Connection::State::Closing && conn.out_pos == conn.out.size()) {
+                    conn.state = Connection::State::Closed;
+                }
+            }
+
+            for (auto it = m_connections.begin(); it != m_connections.end();) {
+                if ((*it)->state == Connection::State::Closed) {
+                    closeConnection(**it);
+                    it = m_connections.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    void closeConnection(Connection& conn)
+    {
+        if (conn.fd >= 0) {
+            ::close(conn.fd);
+            conn.fd = -1;
+        }
+        conn.state = Connection::State::Closed;
+        m_server.unregisterKillTarget(conn.id);
+    }
+
+    void readAvailable(Connection& conn)
+    {
+        char buffer[64 * 1024];
+        while (true) {
+            const ssize_t n = ::recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                conn.in.append(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            conn.state = Connection::State::Closed;
+            return;
+        }
+    }
+
+    void flush(Connection& conn)
+    {
+        while (conn.out_pos < conn.out.size()) {
+            const ssize_t n = ::send(conn.fd, conn.out.data() + conn.out_pos,
+                                     conn.out.size() - conn.out_pos, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_pos += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            conn.state = Connection::State::Closed;
+            return;
+        }
+        conn.out.clear();
+        conn.out_pos = 0;
+    }
+
+    void handleKill(Connection& conn)
+    {
+        const uint8_t flag = conn.kill_flag->exchange(0, std::memory_order_acq_rel);
+        if (flag == 0) {
+            return;
+        }
+        if (flag & kKillConnection) {
+            conn.state = Connection::State::Closed;
+            return;
+        }
+        if (conn.delayed_until) {
+            conn.delayed_until.reset();
+            conn.delayed_response.clear();
+            appendErr(conn.out, 1, 1317, "70100", "Query execution was interrupted");
+        }
+    }
+
+    void resumeDelayed(Connection& conn)
+    {
+        if (!conn.delayed_until || Clock::now() < *conn.delayed_until) {
+            return;
+        }
+        conn.delayed_until.reset();
+        conn.out.append(conn.delayed_response);
+        conn.delayed_response.clear();
+    }
+
+    void processInput(Connection& conn)
+    {
+        while (!conn.delayed_until &&
+               (conn.state == Connection::State::Auth || conn.state == Connection::State::Command ||
+                conn.state == Connection::State::InfileData)) {
+            const size_t available = conn.in.size() - conn.in_pos;
+            if (available < protocol::MYSQL_PACKET_HEADER_SIZE) {
+                break;
+            }
+            const char* header = conn.in.data() + conn.in_pos;
+            const uint32_t length = protocol::readUint24(header);
+            if (available < protocol::MYSQL_PACKET_HEADER_SIZE + length) {
+                break;
+            }
+            const uint8_t sequence_id = static_cast<uint8_t>(header[3]);
+            const std::string_view payload(header + protocol::MYSQL_PACKET_HEADER_SIZE, length);
+            conn.in_pos += protocol::MYSQL_PACKET_HEADER_SIZE + length;
+
+            if (conn.state == Connection::State::Auth) {
+                handleAuth(conn, payload, sequence_id);
+            } else if (conn.state == Connection::State::InfileData) {
+                handleInfileData(conn, payload, sequence_id);
+            } else {
+                handleCommand(conn, payload);
+            }
+        }
+
+        if (conn.in_pos == conn.in.size()) {
+            conn.in.clear();
+            conn.in_pos = 0;
+        } else if (conn.in_pos > 64 * 1024) {
+            conn.in.erase(0, conn.in_pos);
+            conn.in_pos = 0;
+        }
+    }
+
+    void handleAuth(Connection& conn, std::string_view payload, uint8_t sequence_id)
+    {
+        const auto& config = m_server.m_config;
+        const char* p = payload.data();
+        const char* end = p + payload.size();
+        auto fail = [&](std::string_view message, uint16_t code, std::string_view state) {
+            appendErr(conn.out, static_cast<uint8_t>(sequence_id + 1), code, state, message);
+            conn.state = Connection::State::Closing;
+        };
+
+        if (payload.size() < 32) {
+            fail("Bad handshake", 1043, "08S01");
+            return;
+        }
+        const uint32_t client_caps = protocol::readUint32(p);
+        p += 32;
+
+        size_t consumed = 0;
+        auto username = protocol::readNullTermString(p, static_cast<size_t>(end - p), consumed);
+        if (!username) {
+            fail("Bad handshake", 1043, "08S01");
+            return;
+        }
+        p += consumed;
+
+        std::string auth_response;
+        if (client_caps & protocol::CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA) {
+            auto auth = protocol::readLenEncString(p, static_cast<size_t>(end - p), consumed);
+            if (!auth) {
+                fail("Bad handshake", 1043, "08S01");
+                return;
+            }
+            auth_response = std::move(*auth);
+            p += consumed;
+        } else if (p < end) {
+            const size_t len = static_cast<uint8_t>(*p++);
+            if (static_cast<size_t>(end - p) < len) {
+                fail("Bad handshake", 1043, "08S01");
+                return;
+            }
+            auth_response.assign(p, len);
+            p += len;
+        }
+
+        if ((client_caps & protocol::CLIENT_CONNECT_WITH_DB) && p < end) {
+            auto database = protocol::readNullTermString(p, static_cast<size_t>(end - p), consumed);
+            if (database) p += consumed;
+        }
+        if ((client_caps & protocol::CLIENT_PLUGIN_AUTH) && p < end) {
+            auto plugin = protocol::readNullTermString(p, static_cast<size_t>(end - p), consumed);
+            if (plugin) p += consumed;
+        }
+        std::vector<std::pair<std::string, std::string>> attributes;
+        if ((client_caps & protocol::CLIENT_CONNECT_ATTRS) && p < end) {
+            auto total = protocol::readLenEncInt(p, static_cast<size_t>(end - p), consumed);
+            if (!total || *total > static_cast<uint64_t>(end - p) - consumed) {
+                fail("Bad handshake", 1043, "08S01");
+                return;
+            }
+            p += consumed;
+            const char* attrs_end = p + *total;
+            while (p < attrs_end) {
+                auto key = protocol::readLenEncString(p, static_cast<size_t>(attrs_end - p), consumed);
+                if (!key) break;
+                p += consumed;
+                auto value = protocol::readLenEncString(p, static_cast<size_t>(attrs_end - p), consumed);
+                if (!value) break;
+                p += consumed;
+                attributes.emplace_back(std::move(*key), std::move(*value));
+            }
+            p = attrs_end;
+        }
+
+        const bool sha2 = config.auth_plugin == "caching_sha2_password";
+        const std::string expected = sha2
+            ? protocol::AuthPlugin::cachingSha2Auth(config.password, conn.scramble)
+            : protocol::AuthPlugin::nativePasswordAuth(config.password, conn.scramble);
+
+        if (*username != config.username || auth_response != expected) {
+            fail("Access denied for user '" + *username + "'@'localhost' (using password: " +
+                     (auth_response.empty() ? "NO" : "YES") + ")",
+                 1045, "28000");
+            return;
+        }
+
+        conn.capabilities = client_caps & serverCapabilities();
+        conn.connect_attributes = std::move(attributes);
+        uint8_t seq = static_cast<uint8_t>(sequence_id + 1);
+        if (sha2) {
+            const size_t pos = beginPacket(conn.out, seq++);
+            conn.out.push_back(0x01);
+            conn.out.push_back(0x03);
+            endPacket(conn.out, pos);
+        }
+        appendOk(conn.out, seq, 0, 0, conn.status(), "");
+        conn.state = Connection::State::Command;
+    }
+
+    uint32_t serverCapabilities() const
+    {
+        return advertisedCapabilities(m_server.m_config);
+    }
+
+    void handleCommand(Connection& conn, std::string_view payload)
+    {
+        m_server.m_commands.fetch_add(1, std::memory_order_relaxed);
+        if (payload.empty()) {
+            appendErr(conn.out, 1, 1047, "08S01", "Unknown command");
+            return;
+        }
+
+        const auto command = static_cast<protocol::CommandType>(static_cast<uint8_t>(payload[0]));
+        const std::string_view body = payload.substr(1);
+        switch (command) {
+        case protocol::CommandType::COM_QUIT:
+            conn.state = Connection::State::Closed;
+            return;
+        case protocol::CommandType::COM_PING:
+        case protocol::CommandType::COM_INIT_DB:
+            appendOk(conn.out, 1, 0, 0, conn.status(), "");
+            return;
+        case protocol::CommandType::COM_STMT_RESET:
+            if (body.size() >= 4) {
+                if (auto it = conn.statements.find(protocol::readUint32(body.data())); it != conn.statements.end()) {
+                    it->second.long_data.clear();
+                }
+            }
+            appendOk(conn.out, 1, 0, 0, conn.status(), "");
+            return;
+        case protocol::CommandType::COM_RESET_CONNECTION:
+            conn.in_transaction = false;
+            conn.statements.clear();
+            appendOk(conn.out, 1, 0, 0, conn.status(), "");
+            return;
+        case protocol::CommandType::COM_QUERY:
+            if (startsWithNoCase(trimStatement(body), "LOAD DATA LOCAL INFILE ")) {
+                requestInfile(conn, trimStatement(body));
+                return;
+            }
+            respond(conn, execute(conn, body, false, {}), false);
+            return;
+        case protocol::CommandType::COM_STMT_PREPARE:
+            prepare(conn, body);
+            return;
+        case protocol::CommandType::COM_STMT_EXECUTE:
+            executeStatement(conn, body);
+            return;
+        case protocol::CommandType::COM_STMT_CLOSE:
+            if (body.size() >= 4) conn.statements.erase(protocol::readUint32(body.data()));
+            return;
+        case protocol::CommandType::COM_STMT_SEND_LONG_DATA:
+            // 不回复；未知语句或参数越界时静默丢弃，与服务端一致（错误推迟到执行时）
+            if (body.size() >= 6) {
+                auto it = conn.statements.find(protocol::readUint32(body.data()));
+                const uint16_t param_id = static_cast<uint16_t>(static_cast<uint8_t>(body[4]) |
+                                                                (static_cast<uint8_t>(body[5]) << 8));
+                if (it != conn.statements.end() && param_id < it->second.num_params) {
+                    it->second.long_data[param_id].append(body.substr(6));
+                }
+            }
+            return;
+        default:
+            appendErr(conn.out, 1, 1047, "08S01", "Unknown command");
+            return;
+        }
+    }
+
+    void requestInfile(Connection& conn, std::string_view sql)
+    {
+        if (!(conn.capabilities & protocol::CLIENT_LOCAL_FILES)) {
+            appendErr(conn.out, 1, 1148, "42000", "The used command is not allowed with this MySQL version");
+            return;
+        }
+        // 文件名取第一对单引号之间的内容
+        std::string_view name = sql.substr(std::string_view("LOAD DATA LOCAL INFILE ").size());
+        const size_t open = name.find('\'');
+        const size_t close = open == std::string_view::npos ? open : name.find('\'', open + 1);
+        name = close == std::string_view::npos ? std::string_view{} : name.substr(open + 1, close - open - 1);
+
+        const size_t pos = beginPacket(conn.out, 1);
+        conn.out.push_back(static_cast<char>(0xFB));
+        conn.out.append(name);
+        endPacket(conn.out, pos);
+        conn.infile_rows = 0;
+        conn.infile_line_open = false;
+        conn.state = Connection::State::InfileData;
+    }
+
+    void handleInfileData(Connection& conn, std::string_view payload, uint8_t sequence_id)
+    {
+        if (!payload.empty()) {
+            // 行可能跨包，按换行符计数，末尾不完整的行在空包到达时补记
+            conn.infile_rows += static_cast<uint64_t>(std::count(payload.begin(), payload.end(), '\n'));
+            conn.infile_line_open = payload.back() != '\n';
+            return;
+        }
+        if (conn.infile_line_open) {
+            ++conn.infile_rows;
+        }
+        const std::string info = "Records: " + std::to_string(conn.infile_rows) +
+                                 "  Deleted: 0  Skipped: 0  Warnings: 0";
+        appendOk(conn.out, static_cast<uint8_t>(sequence_id + 1), conn.infile_rows, 0, conn.status(), info,
+                 false, conn.sessionTrack());
+        conn.state = Connection::State::Command;
+    }
+
+    MysqlMockResult execute(Connection& conn, std::string_view sql, bool prepared,
+                            std::span<const std::optional<std::string>> params)
+    {
+        MysqlMockRequest request{sql, prepared, params, conn.id, conn.connect_attributes};
+        if (auto scripted = m_server.lookup(request)) {
+            return std::move(*scripted);
+        }
+        if (auto builtin = builtinResult(conn, sql, true)) {
+            return std::move(*builtin);
+        }
+        if (m_server.m_config.default_result) {
+            return *m_server.m_config.default_result;
+        }
+        return MysqlMockResult::ok();
+    }
+
+    std::optional<MysqlMockResult> builtinResult(Connection& conn, std::string_view raw_sql, bool side_effects)
+    {
+        const std::string_view sql = trimStatement(raw_sql);
+
+        if (equalsNoCase(sql, "BEGIN") || startsWithNoCase(sql, "START TRANSACTION")) {
+            if (side_effects) conn.in_transaction = true;
+            return MysqlMockResult::ok();
+        }
+        if (equalsNoCase(sql, "COMMIT") || equalsNoCase(sql, "ROLLBACK")) {
+            if (side_effects) conn.in_transaction = false;
+            return MysqlMockResult::ok();
+        }
+        if (startsWithNoCase(sql, "SET ") || startsWithNoCase(sql, "USE ")) {
+            return MysqlMockResult::ok();
+        }
+        if (startsWithNoCase(sql, "KILL ")) {
+            std::string_view target = trimStatement(sql.substr(5));
+            bool whole_connection = true;
+            if (startsWithNoCase(target, "QUERY ")) {
+                whole_connection = false;
+                target = trimStatement(target.substr(6));
+            } else if (startsWithNoCase(target, "CONNECTION ")) {
+                target = trimStatement(target.substr(11));
+            }
+            const auto id = parseInteger(target);
+            if (!side_effects) {
+                return MysqlMockResult::ok();
+            }
+            if (!id || !m_server.requestKill(static_cast<uint32_t>(*id), whole_connection)) {
+                return MysqlMockResult::error(1094, "Unknown thread id: " + std::string(target));
+            }
+            return MysqlMockResult::ok();
+        }
+        if (startsWithNoCase(sql, "SELECT ")) {
+            const std::string_view expr = trimStatement(sql.substr(7));
+            if (equalsNoCase(expr, "CONNECTION_ID()")) {
+                return MysqlMockResult::resultSet({{"CONNECTION_ID()", MysqlFieldType::LONGLONG}},
+                                                  {{std::to_string(conn.id)}});
+            }
+            if (startsWithNoCase(expr, "SLEEP(") && expr.back() == ')') {
+                const std::string_view arg = expr.substr(6, expr.size() - 7);
+                const double seconds = parseNumber<double>(arg);
+                auto result = MysqlMockResult::resultSet({{std::string(expr), MysqlFieldType::LONGLONG}}, {{"0"}});
+                result.withDelay(std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000.0)));
+                return result;
+            }
+            if (parseInteger(expr)) {
+                auto it = m_literal_cache.find(std::string(expr));
+                if (it == m_literal_cache.end()) {
+                    it = m_literal_cache.emplace(std::string(expr),
+                        MysqlMockResult::resultSet({{std::string(expr), MysqlFieldType::LONGLONG}},
+                                                   {{std::string(expr)}})).first;
+                }
+                return it->second;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void respond(Connection& conn, const MysqlMockResult& result, bool binary)
+    {
+        const bool delayed = result.delay().count() > 0;
+        std::string& out = delayed ? conn.delayed_response : conn.out;
+
+        if (result.kind() == MysqlMockResult::Kind::Multi) {
+            const auto& parts = result.parts();
+            uint8_t seq = 1;
+            for (size_t i = 0; i < parts.size(); ++i) {
+                const bool last = i + 1 == parts.size();
+                const uint16_t status = last ? conn.status()
+                                             : static_cast<uint16_t>(conn.status() | protocol::SERVER_MORE_RESULTS_EXISTS);
+                seq = appendResult(conn, out, parts[i], binary, seq, status);
+                if (parts[i].kind() == MysqlMockResult::Kind::Error) {
+                    break;
+                }
+            }
+        } else {
+            appendResult(conn, out, result, binary, 1, conn.status());
+        }
+
+        if (delayed) {
+            conn.delayed_until = Clock::now() + result.delay();
+        }
+    }
+
+    // 追加单个结果（OK/ERR/结果集），返回下一个序列号
+    uint8_t appendResult(Connection& conn, std::string& out, const MysqlMockResult& result,
+                         bool binary, uint8_t seq, uint16_t status)
+    {
+        switch (result.kind()) {
+        case MysqlMockResult::Kind::Ok:
+            appendOk(out, seq, result.affectedRows(), result.lastInsertId(), status, result.info(),
+                     false, conn.sessionTrack(), result.gtid());
+            return static_cast<uint8_t>(seq + 1);
+        case MysqlMockResult::Kind::Error:
+            appendErr(out, seq, result.errorCode(), result.sqlState(), result.message());
+            return static_cast<uint8_t>(seq + 1);
+        case MysqlMockResult::Kind::ResultSet: {
+            const bool deprecate_eof = conn.deprecateEof();
+            const size_t body_pos = out.size();
+            out.append(result.encodedBody(binary, deprecate_eof));
+            if (seq != 1) {
+                // 缓存的主体序列号从1开始，接在前一个结果之后时逐包改写
+                uint8_t next = seq;
+                for (size_t pos = body_pos; pos + 4 <= out.size();) {
+                    const size_t len = static_cast<uint8_t>(out[pos])
+                                     | (static_cast<size_t>(static_cast<uint8_t>(out[pos + 1])) << 8)
+                                     | (static_cast<size_t>(static_cast<uint8_t>(out[pos + 2])) << 16);
+                    out[pos + 3] = static_cast<char>(next++);
+                    pos += 4 + len;
+                }
+            }
+            seq = static_cast<uint8_t>(
+                seq + 1 + result.columns().size() + (deprecate_eof ? 0 : 1) + result.rows().size());
+            if (deprecate_eof) {
+                appendOk(out, seq, 0, 0, status, "", true);
+            } else {
+                appendEof(out, seq, status);
+            }
+            return static_cast<uint8_t>(seq + 1);
+        }
+        case MysqlMockResult::Kind::Multi:
+            break;
+        }
+        return seq;
+    }
+
+    void prepare(Connection& conn, std::string_view sql)
+    {
+        Connection::Statement stmt;
+        stmt.sql.assign(sql);
+        stmt.num_params = countPlaceholders(sql);
+
+        std::vector<MysqlMockColumn> columns;
+        MysqlMockRequest request{sql, true, {}, conn.id, conn.connect_attributes};
+        std::optional<MysqlMockResult> shape = m_server.lookup(request);
+        if (!shape) shape = builtinResult(conn, sql, false);
+        if (shape && shape->kind() == MysqlMockResult::Kind::Error) {
+            appendErr(conn.out, 1, shape->errorCode(), shape->sqlState(), shape->message());
+            return;
+        }
+        if (shape && shape->kind() == MysqlMockResult::Kind::ResultSet) {
+            columns = shape->columns();
+        }
+
+        const uint32_t stmt_id = conn.next_statement_id++;
+        uint8_t seq = 1;
+        size_t pos = beginPacket(conn.out, seq++);
+        conn.out.push_back(0x00);
+        writeUint32(conn.out, stmt_id);
+        writeUint16(conn.out, static_cast<uint16_t>(columns.size()));
+        writeUint16(conn.out, stmt.num_params);
+        conn.out.push_back(0x00);
+        writeUint16(conn.out, 0);
+        endPacket(conn.out, pos);
+
+        if (stmt.num_params > 0) {
+            const MysqlMockColumn param{"?", MysqlFieldType::VAR_STRING, 0, 0};
+            for (uint16_t i = 0; i < stmt.num_params; ++i) {
+                appendColumnDefinition(conn.out, seq++, param);
+            }
+            if (!conn.deprecateEof()) appendEof(conn.out, seq++, conn.status());
+        }
+        if (!columns.empty()) {
+            for (const auto& column : columns) {
+                appendColumnDefinition(conn.out, seq++, column);
+            }
+            if (!conn.deprecateEof()) appendEof(conn.out, seq++, conn.status());
+        }
+
+        conn.statements.emplace(stmt_id, std::move(stmt));
+    }
+
+    void executeStatement(Connection& conn, std::string_view body)
+    {
+        if (body.size() < 9) {
+            appendErr(conn.out, 1, 1835, "HY000", "Malformed communication packet");
+            return;
+        }
+        const uint32_t stmt_id = protocol::readUint32(body.data());
+        auto it = conn.statements.find(stmt_id);
+        if (it == conn.statements.end()) {
+            appendErr(conn.out, 1, 1243, "HY000",
+                      "Unknown prepared statement handler (" + std::to_string(stmt_id) + ") given to mysqld_stmt_execute");
+            return;
+        }
+        Connection::Statement& stmt = it->second;
+
+        std::vector<std::optional<std::string>> params(stmt.num_params);
+        const char* p = body.data() + 9;
+        const char* end = body.data() + body.size();
+        if (stmt.num_params > 0) {
+            const size_t bitmap_len = (stmt.num_params + 7) / 8;
+            if (static_cast<size_t>(end - p) < bitmap_len + 1) {
+                appendErr(conn.out, 1, 1835, "HY000", "Malformed communication packet");
+                return;
+            }
+            const char* bitmap = p;
+            p += bitmap_len;
+            const bool new_params_bound = *p++ != 0;
+            if (new_params_bound) {
+                if (static_cast<size_t>(end - p) < stmt.num_params * 2u) {
+                    appendErr(conn.out, 1, 1835, "HY000", "Malformed communication packet");
+                    return;
+                }
+                stmt.param_types.assign(p, p + stmt.num_params * 2u);
+                p += stmt.num_params * 2u;
+            }
+            for (uint16_t i = 0; i < stmt.num_params; ++i) {
+                // 已发送长数据的参数不读NULL位和值
+                if (auto long_data = stmt.long_data.find(i); long_data != stmt.long_data.end()) {
+                    params[i] = std::move(long_data->second);
+                    continue;
+                }
+                if (static_cast<uint8_t>(bitmap[i / 8]) & (1u << (i % 8))) {
+                    continue;
+                }
+                const uint8_t type = i * 2u < stmt.param_types.size()
+                    ? stmt.param_types[i * 2u] : static_cast<uint8_t>(MysqlFieldType::VAR_STRING);
+                const bool is_unsigned = i * 2u + 1 < stmt.param_types.size() &&
+                    (stmt.param_types[i * 2u + 1] & 0x80) != 0;
+                if (type == static_cast<uint8_t>(MysqlFieldType::NULL_TYPE)) {
+                    continue;
+                }
+                std::string value;
+                if (!readBinaryParam(p, end, type, is_unsigned, value)) {
+                    appendErr(conn.out, 1, 1835, "HY000", "Malformed communication packet");
+                    return;
+                }
+                params[i] = std::move(value);
+            }
+        }
+
+        stmt.long_data.clear();
+        respond(conn, execute(conn, stmt.sql, true, params), true);
+    }
+
+    MysqlMockServer& m_server;
+    int m_wake_fd = -1;
+    std::thread m_thread;
+    std::atomic<bool> m_stopping{false};
+
+    std::mutex m_pending_mutex;
+    std::vector<std::unique_ptr<Connection>> m_pending;
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    std::unordered_map<std::string, MysqlMockResult> m_literal_cache;
+};
+
+// ======================== MysqlMockServer ========================
+
+MysqlMockServer::MysqlMockServer(MysqlMockServerConfig config)
+    : m_config(std::move(config))
+{
+    if (m_config.worker_threads == 0) {
+        m_config.worker_threads = 1;
+    }
+}
+
+MysqlMockServer::~MysqlMockServer()
+{
+    stop();
+}
+
+std::expected<void, MysqlError> MysqlMockServer::start()
+{
+    if (isRunning()) {
+        return {};
+    }
+
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(sockaddr_in);
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&addr);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&addr);
+    if (::inet_pton(AF_INET, m_config.host.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(m_config.port);
+    } else if (::inet_pton(AF_INET6, m_config.host.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(m_config.port);
+        addr_len = sizeof(sockaddr_in6);
+    } else {
+        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION, "Invalid mock server host: " + m_config.host));
+    }
+
+    m_listen_fd = ::socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION, "Failed to create socket: " + std::string(std::strerror(errno))));
+    }
+    const int one = 1;
+    ::setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    auto fail = [this](const std::string& what) {
+        const std::string reason = what + ": " + std::strerror(errno);
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION, reason));
+    };
+
+    if (::bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+        return fail("Failed to bind mock server");
+    }
+    if (::listen(m_listen_fd, 1024) != 0) {
+        return fail("Failed to listen");
+    }
+    addr_len = sizeof(addr);
+    if (::getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0) {
+        return fail("Failed to query mock server port");
+    }
+    m_port = ntohs(addr.ss_family == AF_INET6 ? v6->sin6_port : v4->sin_port);
+    if (!setNonBlocking(m_listen_fd)) {
+        return fail("Failed to set non-blocking");
+    }
+
+    m_wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wake_fd < 0) {
+        return fail("Failed to create eventfd");
+    }
+
+    m_workers.clear();
+    for (size_t i = 0; i < m_config.worker_threads; ++i) {
+        auto worker = std::make_unique<Worker>(*this);
+        if (!worker->start()) {
+            m_workers.clear();
+            ::close(m_wake_fd);
+            m_wake_fd = -1;
+            return fail("Failed to start mock server worker");
+        }
+        m_workers.push_back(std::move(worker));
+    }
+
+    m_running.store(true, std::memory_order_release);
+    m_accept_thread = std::thread([this]() { acceptLoop(); });
+    return {};
+}
+
+void MysqlMockServer::stop()
+{
+    if (!m_running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    signalEventFd(m_wake_fd);
+    if (m_accept_thread.joinable()) {
+        m_accept_thread.join();
+    }
+    m_workers.clear();
+    ::close(m_listen_fd);
+    m_listen_fd = -1;
+    ::close(m_wake_fd);
+    m_wake_fd = -1;
+
+    std::lock_guard<std::mutex> lock(m_kill_mutex);
+    m_kill_targets.clear();
+}
+
+MysqlConfig MysqlMockServer::clientConfig(const std::string& database) const
+{
+    return MysqlConfig::create(m_config.host, m_port, m_config.username, m_config.password, database);
+}
+
+void MysqlMockServer::script(std::string sql, MysqlMockResult result)
+{
+    std::lock_guard<std::mutex> lock(m_script_mutex);
+    m_scripts.insert_or_assign(std::move(sql), std::move(result));
+}
+
+void MysqlMockServer::setHandler(QueryHandler handler)
+{
+    auto shared = handler ? std::make_shared<const QueryHandler>(std::move(handler)) : nullptr;
+    std::lock_guard<std::mutex> lock(m_script_mutex);
+    m_handler = std::move(shared);
+}
+
+std::optional<MysqlMockResult> MysqlMockServer::lookup(const MysqlMockRequest& request)
+{
+    std::shared_ptr<const QueryHandler> handler;
+    {
+        std::lock_guard<std::mutex> lock(m_script_mutex);
+        if (!m_scripts.empty()) {
+            auto it = m_scripts.find(std::string(request.sql));
+            if (it != m_scripts.end()) {
+                return it->second;
+            }
+        }
+        handler = m_handler;
+    }
+    if (handler) {
+        return (*handler)(request);
+    }
+    return std::nullopt;
+}
+
+bool MysqlMockServer::requestKill(uint32_t connection_id, bool whole_connection)
+{
+    std::lock_guard<std::mutex> lock(m_kill_mutex);
+    auto it = m_kill_targets.find(connection_id);
+    if (it == m_kill_targets.end()) {
+        return false;
+    }
+    it->second.flag->fetch_or(whole_connection ? kKillConnection : kKillQuery, std::memory_order_acq_rel);
+    it->second.worker->wake();
+    return true;
+}
+
+void MysqlMockServer::unregisterKillTarget(uint32_t connection_id)
+{
+    std::lock_guard<std::mutex> lock(m_kill_mutex);
+    m_kill_targets.erase(connection_id);
+}
+
+void MysqlMockServer::acceptLoop()
+{
+    std::mt19937 rng(std::random_device{}());
+    std::uniform_int_distribution<int> scramble_byte(1, 127);
+
+    pollfd fds[2] = {
+        {m_listen_fd, POLLIN, 0},
+        {m_wake_fd, POLLIN, 0},
+    };
+
+    while (m_running.load(std::memory_order_acquire)) {
+        const int ready = ::poll(fds, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            drainEventFd(m_wake_fd);
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        while (true) {
+            const int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                break;
+            }
+            const int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            auto conn = std::make_unique<Connection>();
+            conn->fd = fd;
+            conn->id = m_next_connection_id.fetch_add(1, std::memory_order_relaxed);
+            conn->scramble.resize(kScrambleLength);
+            for (auto& c : conn->scramble) {
+                c = static_cast<char>(scramble_byte(rng));
+            }
+
+            // HandshakeV10
+            std::string& out = conn->out;
+            const size_t pos = beginPacket(out, 0);
+            out.push_back(0x0a);
+            out.append(m_config.server_version);
+            out.push_back('\0');
+            writeUint32(out, conn->id);
+            out.append(conn->scramble, 0, 8);
+            out.push_back('\0');
+            const uint32_t caps = advertisedCapabilities(m_config);
+            writeUint16(out, static_cast<uint16_t>(caps & 0xFFFF));
+            out.push_back(static_cast<char>(protocol::CHARSET_UTF8MB4_GENERAL_CI));
+            writeUint16(out, protocol::SERVER_STATUS_AUTOCOMMIT);
+            writeUint16(out, static_cast<uint16_t>(caps >> 16));
+            out.push_back(static_cast<char>(kScrambleLength + 1));
+            out.append(10, '\0');
+            out.append(conn->scramble, 8, kScrambleLength - 8);
+            out.push_back('\0');
+            out.append(m_config.auth_plugin);
+            out.push_back('\0');
+            endPacket(out, pos);
+
+            Worker* worker = m_workers[conn->id % m_workers.size()].get();
+            {
+                std::lock_guard<std::mutex> lock(m_kill_mutex);
+                m_kill_targets[conn->id] = KillTarget{worker, conn->kill_flag};
+            }
+            m_accepted.fetch_add(1, std::memory_order_relaxed);
+            worker->adopt(std::move(conn));
+        }
+    }
+}
+
+} // namespace galay::mysql::mock
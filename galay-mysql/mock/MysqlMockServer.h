@@ -0,0 +1,224 @@
+#ifndef GALAY_MYSQL_MOCK_SERVER_H
+#define GALAY_MYSQL_MOCK_SERVER_H
+
+#include "galay-mysql/base/MysqlConfig.h"
+#include "galay-mysql/base/MysqlError.h"
+#include "galay-mysql/base/MysqlValue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace galay::mysql::mock
+{
+
+/**
+ * @brief 模拟结果集的列描述
+ */
+struct MysqlMockColumn
+{
+    std::string name;
+    MysqlFieldType type = MysqlFieldType::VAR_STRING;
+    uint16_t flags = 0;
+    uint8_t decimals = 0;
+};
+
+/**
+ * @brief 模拟服务器对单条语句的响应（OK / ERR / 结果集）
+ * @details 值语义、可在线程间共享；结果集的列定义与行数据按text/binary协议各编码一次后缓存，
+ *          之后每次响应只需拷贝字节，保证服务端开销远低于被测客户端。
+ */
+class MysqlMockResult
+{
+public:
+    enum class Kind : uint8_t {
+        Ok,
+        Error,
+        ResultSet,
+        Multi,
+    };
+
+    using Row = std::vector<std::optional<std::string>>;
+
+    static MysqlMockResult ok(uint64_t affected_rows = 0, uint64_t last_insert_id = 0, std::string info = "");
+    static MysqlMockResult error(uint16_t error_code, std::string message, std::string sql_state = "HY000");
+    static MysqlMockResult resultSet(std::vector<MysqlMockColumn> columns, std::vector<Row> rows);
+
+    /**
+     * @brief 生成指定形状的结果集
+     * @details 列类型按 LONGLONG / VAR_STRING / DOUBLE 轮换，字符串列值长度为value_bytes
+     */
+    static MysqlMockResult generated(size_t columns, size_t rows, size_t value_bytes = 16);
+
+    /**
+     * @brief 多结果集响应（多语句或CALL），除最后一部分外均带SERVER_MORE_RESULTS_EXISTS
+     * @details parts中不允许再嵌套Multi；遇到Error部分时响应在此结束
+     */
+    static MysqlMockResult multi(std::vector<MysqlMockResult> parts);
+
+    /**
+     * @brief 设置响应延迟（模拟慢查询，可被KILL QUERY中断）
+     */
+    MysqlMockResult& withDelay(std::chrono::milliseconds delay);
+
+    /**
+     * @brief OK响应附带的GTID（客户端协商了CLIENT_SESSION_TRACK时以SESSION_TRACK_GTIDS下发）
+     */
+    MysqlMockResult& withGtid(std::string gtid);
+
+    Kind kind() const;
+    std::chrono::milliseconds delay() const;
+    const std::vector<MysqlMockColumn>& columns() const;
+    const std::vector<Row>& rows() const;
+    uint64_t affectedRows() const;
+    uint64_t lastInsertId() const;
+    const std::string& info() const;
+    const std::string& gtid() const;
+    uint16_t errorCode() const;
+    const std::string& sqlState() const;
+    const std::string& message() const;
+    const std::vector<MysqlMockResult>& parts() const;
+
+    /**
+     * @brief 结果集主体（列数包、列定义、可选EOF、全部行包）的编码，序列号从1开始
+     */
+    std::string_view encodedBody(bool binary, bool deprecate_eof) const;
+
+private:
+    struct Data;
+
+    explicit MysqlMockResult(std::shared_ptr<Data> data);
+
+    std::shared_ptr<Data> m_data;
+};
+
+/**
+ * @brief 一次命令请求（供QueryHandler路由）
+ */
+struct MysqlMockRequest
+{
+    std::string_view sql;
+    bool prepared = false;                                  // COM_STMT_EXECUTE时为true
+    std::span<const std::optional<std::string>> params;     // 预处理参数（文本形式）
+    uint32_t connection_id = 0;
+    std::span<const std::pair<std::string, std::string>> connect_attributes;  // 握手时客户端发送的连接属性
+};
+
+struct MysqlMockServerConfig
+{
+    std::string host = "127.0.0.1";                        // IPv4或IPv6数字地址
+    uint16_t port = 0;                                      // 0表示由内核分配端口
+    std::string username = "root";
+    std::string password = "password";
+    std::string auth_plugin = "mysql_native_password";      // 或 caching_sha2_password
+    std::string server_version = "8.0.36-galay-mock";
+    bool deprecate_eof = false;                             // 是否通告CLIENT_DEPRECATE_EOF
+    uint32_t disabled_capabilities = 0;                     // 不通告的能力标志，模拟旧版本或关闭了相应特性的服务端
+    size_t worker_threads = 1;
+    std::optional<MysqlMockResult> default_result;          // 未匹配语句的响应，默认OK
+};
+
+/**
+ * @brief 进程内MySQL协议模拟服务器
+ * @details 监听TCP端口，支持握手、mysql_native_password / caching_sha2_password（快速认证）、
+ *          COM_QUERY、COM_STMT_PREPARE/EXECUTE/CLOSE/RESET/SEND_LONG_DATA、COM_PING、COM_INIT_DB、
+ *          COM_RESET_CONNECTION与COM_QUIT，按连接顺序处理流水线请求。
+ *          服务端运行在独立线程（poll），不占用被测客户端的IOScheduler。
+ *
+ * 语句解析顺序：script()精确匹配 -> QueryHandler -> 内置语句 -> default_result。
+ * 内置语句：SELECT <整数>、SELECT SLEEP(n)、BEGIN/START TRANSACTION/COMMIT/ROLLBACK、
+ *          KILL [QUERY] <id>、SET/USE（返回OK）、LOAD DATA LOCAL INFILE（请求文件数据，按行数返回OK）。
+ *
+ * @code
+ * MysqlMockServer server;
+ * server.script("SELECT id, name FROM users",
+ *               MysqlMockResult::resultSet({{"id", MysqlFieldType::LONGLONG}, {"name"}},
+ *                                          {{"1", "alice"}}));
+ * server.start();
+ * auto config = server.clientConfig("test");
+ * @endcode
+ */
+class MysqlMockServer
+{
+public:
+    using QueryHandler = std::function<std::optional<MysqlMockResult>(const MysqlMockRequest& request)>;
+
+    explicit MysqlMockServer(MysqlMockServerConfig config = {});
+    ~MysqlMockServer();
+
+    MysqlMockServer(const MysqlMockServer&) = delete;
+    MysqlMockServer& operator=(const MysqlMockServer&) = delete;
+
+    std::expected<void, MysqlError> start();
+    void stop();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    uint16_t port() const { return m_port; }
+    const MysqlMockServerConfig& config() const { return m_config; }
+
+    /**
+     * @brief 指向本服务器的客户端连接配置
+     */
+    MysqlConfig clientConfig(const std::string& database = "") const;
+
+    /**
+     * @brief 为精确SQL文本注册响应（可在运行中调用）
+     */
+    void script(std::string sql, MysqlMockResult result);
+
+    /**
+     * @brief 设置语句处理回调（在服务端工作线程中调用，需线程安全）
+     */
+    void setHandler(QueryHandler handler);
+
+    uint64_t acceptedConnections() const { return m_accepted.load(std::memory_order_relaxed); }
+    uint64_t handledCommands() const { return m_commands.load(std::memory_order_relaxed); }
+
+private:
+    class Worker;
+    struct Connection;
+    friend class Worker;
+
+    void acceptLoop();
+    std::optional<MysqlMockResult> lookup(const MysqlMockRequest& request);
+    bool requestKill(uint32_t connection_id, bool whole_connection);
+    void unregisterKillTarget(uint32_t connection_id);
+
+    MysqlMockServerConfig m_config;
+    uint16_t m_port = 0;
+    int m_listen_fd = -1;
+    int m_wake_fd = -1;
+    std::atomic<bool> m_running{false};
+    std::atomic<uint32_t> m_next_connection_id{1};
+    std::atomic<uint64_t> m_accepted{0};
+    std::atomic<uint64_t> m_commands{0};
+
+    std::thread m_accept_thread;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_script_mutex;
+    std::unordered_map<std::string, MysqlMockResult> m_scripts;
+    std::shared_ptr<const QueryHandler> m_handler;
+
+    struct KillTarget {
+        Worker* worker = nullptr;
+        std::shared_ptr<std::atomic<uint8_t>> flag;
+    };
+    std::mutex m_kill_mutex;
+    std::unordered_map<uint32_t, KillTarget> m_kill_targets;
+};
+
+} // namespace galay::mysql::mock
+
+#endif // GALAY_MYSQL_MOCK_SERVER_H
@@ -11,6 +11,9 @@
 #if __has_include(<atomic>)
 #include <atomic>
 #endif
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
 #if __has_include(<cerrno>)
 #include <cerrno>
 #endif
@@ -38,6 +41,9 @@
 #if __has_include(<fcntl.h>)
 #include <fcntl.h>
 #endif
+#if __has_include(<functional>)
+#include <functional>
+#endif
 #if __has_include(<galay-kernel/async/TcpSocket.h>)
 #include <galay-kernel/async/TcpSocket.h>
 #endif
@@ -107,6 +113,12 @@
 #if __has_include(<sys/socket.h>)
 #include <sys/socket.h>
 #endif
+#if __has_include(<tuple>)
+#include <tuple>
+#endif
+#if __has_include(<type_traits>)
+#include <type_traits>
+#endif
 #if __has_include(<unistd.h>)
 #include <unistd.h>
 #endif
@@ -131,15 +143,39 @@
 #if __has_include("galay-mysql/async/MysqlConnectionPool.h")
 #include "galay-mysql/async/MysqlConnectionPool.h"
 #endif
+#if __has_include("galay-mysql/async/MysqlConnector.h")
+#include "galay-mysql/async/MysqlConnector.h"
+#endif
+#if __has_include("galay-mysql/async/MysqlReconnectingClient.h")
+#include "galay-mysql/async/MysqlReconnectingClient.h"
+#endif
+#if __has_include("galay-mysql/async/MysqlRouter.h")
+#include "galay-mysql/async/MysqlRouter.h"
+#endif
+#if __has_include("galay-mysql/async/MysqlTransaction.h")
+#include "galay-mysql/async/MysqlTransaction.h"
+#endif
+#if __has_include("galay-mysql/base/MysqlCancellation.h")
+#include "galay-mysql/base/MysqlCancellation.h"
+#endif
 #if __has_include("galay-mysql/base/MysqlConfig.h")
 #include "galay-mysql/base/MysqlConfig.h"
 #endif
 #if __has_include("galay-mysql/base/MysqlError.h")
 #include "galay-mysql/base/MysqlError.h"
 #endif
+#if __has_include("galay-mysql/base/MysqlGtid.h")
+#include "galay-mysql/base/MysqlGtid.h"
+#endif
+#if __has_include("galay-mysql/base/MysqlLocalInfile.h")
+#include "galay-mysql/base/MysqlLocalInfile.h"
+#endif
 #if __has_include("galay-mysql/base/MysqlLog.h")
 #include "galay-mysql/base/MysqlLog.h"
 #endif
+#if __has_include("galay-mysql/base/MysqlResolver.h")
+#include "galay-mysql/base/MysqlResolver.h"
+#endif
 #if __has_include("galay-mysql/base/MysqlValue.h")
 #include "galay-mysql/base/MysqlValue.h"
 #endif
@@ -155,6 +191,12 @@
 #if __has_include("galay-mysql/protocol/MysqlProtocol.h")
 #include "galay-mysql/protocol/MysqlProtocol.h"
 #endif
+#if __has_include("galay-mysql/protocol/MysqlResultDecoder.h")
+#include "galay-mysql/protocol/MysqlResultDecoder.h"
+#endif
+#if __has_include("galay-mysql/protocol/MysqlRowMapper.h")
+#include "galay-mysql/protocol/MysqlRowMapper.h"
+#endif
 #if __has_include("galay-mysql/sync/MysqlClient.h")
 #include "galay-mysql/sync/MysqlClient.h"
 #endif
@@ -5,11 +5,19 @@ module;
 export module galay.mysql;
 
 export {
+#include "galay-mysql/base/MysqlCancellation.h"
 #include "galay-mysql/base/MysqlConfig.h"
 #include "galay-mysql/base/MysqlError.h"
+#include "galay-mysql/base/MysqlGtid.h"
+#include "galay-mysql/base/MysqlLocalInfile.h"
+#include "galay-mysql/base/MysqlResolver.h"
 #include "galay-mysql/base/MysqlValue.h"
 #include "galay-mysql/async/AsyncMysqlConfig.h"
 #include "galay-mysql/async/AsyncMysqlClient.h"
 #include "galay-mysql/async/MysqlConnectionPool.h"
+#include "galay-mysql/async/MysqlConnector.h"
+#include "galay-mysql/async/MysqlReconnectingClient.h"
+#include "galay-mysql/async/MysqlRouter.h"
+#include "galay-mysql/async/MysqlTransaction.h"
 #include "galay-mysql/sync/MysqlClient.h"
 }
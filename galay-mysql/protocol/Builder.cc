@@ -1,5 +1,9 @@
 #include "Builder.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
 namespace galay::mysql::protocol
 {
 
@@ -51,6 +55,17 @@ MysqlCommandBuilder& MysqlCommandBuilder::appendResetConnection(uint8_t sequence
                         MysqlCommandKind::ResetConnection);
 }
 
+MysqlCommandBuilder& MysqlCommandBuilder::appendStmtExecute(uint32_t stmt_id,
+                                                            std::span<const std::optional<std::string_view>> params,
+                                                            std::span<const uint8_t> param_types,
+                                                            uint8_t sequence_id)
+{
+    std::string packet;
+    MysqlEncoder().encodeStmtExecuteInto(packet, stmt_id, params, param_types, sequence_id);
+    appendEncoded(packet, sequence_id, MysqlCommandKind::StmtExecute);
+    return *this;
+}
+
 MysqlCommandBuilder& MysqlCommandBuilder::appendSimple(CommandType cmd,
                                                        std::string_view payload,
                                                        uint8_t sequence_id,
@@ -147,6 +162,18 @@ void MysqlCommandBuilder::appendSimpleFast(CommandType cmd,
     m_views_dirty = true;
 }
 
+void MysqlCommandBuilder::appendEncoded(std::string_view packet, uint8_t sequence_id, MysqlCommandKind kind)
+{
+    const size_t begin = m_encoded.size();
+    m_encoded.append(packet.data(), packet.size());
+    m_commands.push_back(CommandMeta{
+        .encoded = Slice{begin, packet.size()},
+        .kind = kind,
+        .sequence_id = sequence_id
+    });
+    m_views_dirty = true;
+}
+
 void MysqlCommandBuilder::rebuildViewsIfNeeded() const
 {
     if (!m_views_dirty) {
@@ -171,4 +198,292 @@ void MysqlCommandBuilder::rebuildViewsIfNeeded() const
     m_views_dirty = false;
 }
 
+// ======================== MysqlBulkInsertBuilder ========================
+
+namespace
+{
+
+// `db`.`table`形式，标识符内的反引号加倍
+void appendQuotedIdentifier(std::string& out, std::string_view name, bool split_schema)
+{
+    out.push_back('`');
+    for (char c : name) {
+        if (c == '`') {
+            out.append("``");
+        } else if (c == '.' && split_schema) {
+            out.append("`.`");
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('`');
+}
+
+const char* escapeSequence(char c, bool no_backslash_escapes) noexcept
+{
+    if (no_backslash_escapes) {
+        return c == '\'' ? "''" : nullptr;
+    }
+    switch (c) {
+    case '\0': return "\\0";
+    case '\n': return "\\n";
+    case '\r': return "\\r";
+    case '\\': return "\\\\";
+    case '\'': return "\\'";
+    case '"': return "\\\"";
+    case '\x1a': return "\\Z";
+    default: return nullptr;
+    }
+}
+
+} // namespace
+
+MysqlBulkInsertBuilder::MysqlBulkInsertBuilder(std::string_view table,
+                                               std::span<const std::string_view> columns,
+                                               size_t max_packet_bytes)
+    : m_column_count(columns.size())
+    , m_max_payload(std::min<size_t>(max_packet_bytes, MYSQL_MAX_PACKET_SIZE - 1))
+{
+    m_head.append("INSERT INTO ");
+    appendQuotedIdentifier(m_head, table, true);
+    m_head.append(" (");
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) {
+            m_head.push_back(',');
+        }
+        appendQuotedIdentifier(m_head, columns[i], false);
+    }
+    m_head.append(") VALUES ");
+}
+
+MysqlBulkInsertBuilder& MysqlBulkInsertBuilder::setNoBackslashEscapes(bool enabled) noexcept
+{
+    m_no_backslash_escapes = enabled;
+    return *this;
+}
+
+void MysqlBulkInsertBuilder::beginRow()
+{
+    if (!m_open) {
+        openStatement();
+    }
+    m_row_begin = m_encoded.size();
+    if (m_open_rows > 0) {
+        m_encoded.push_back(',');
+    }
+    m_encoded.push_back('(');
+    m_row_values = 0;
+    m_row_error.reset();
+}
+
+std::expected<void, MysqlError> MysqlBulkInsertBuilder::endRow()
+{
+    m_encoded.push_back(')');
+    if (!m_row_error && m_row_values != m_column_count) {
+        m_row_error = MysqlError(MYSQL_ERROR_INVALID_PARAM,
+                                 "Bulk insert row has " + std::to_string(m_row_values) +
+                                 " values, expected " + std::to_string(m_column_count));
+    }
+
+    auto discardRow = [this]() {
+        if (m_open_rows == 0) {
+            m_encoded.resize(m_open_begin);
+            m_open = false;
+        } else {
+            m_encoded.resize(m_row_begin);
+        }
+    };
+    auto payloadSize = [this]() { return m_encoded.size() - m_open_begin - MYSQL_PACKET_HEADER_SIZE; };
+
+    if (m_row_error) {
+        discardRow();
+        return std::unexpected(std::move(*m_row_error));
+    }
+    if (payloadSize() > m_max_payload && m_open_rows > 0) {
+        // 行移到新语句：跳过前导逗号，当前语句封包
+        m_row_scratch.assign(m_encoded, m_row_begin + 1);
+        m_encoded.resize(m_row_begin);
+        sealStatement();
+        openStatement();
+        m_row_begin = m_encoded.size();
+        m_encoded.append(m_row_scratch);
+    }
+    if (payloadSize() > m_max_payload) {
+        discardRow();
+        return std::unexpected(MysqlError(MYSQL_ERROR_INVALID_PARAM,
+                                          "Bulk insert row exceeds max packet size"));
+    }
+    ++m_open_rows;
+    return {};
+}
+
+MysqlBulkInsertBuilder& MysqlBulkInsertBuilder::binary(std::string_view bytes)
+{
+    static constexpr char kHex[] = "0123456789ABCDEF";
+    beginValue();
+    m_encoded.reserve(m_encoded.size() + bytes.size() * 2 + 3);
+    m_encoded.append("X'");
+    for (char c : bytes) {
+        const auto b = static_cast<uint8_t>(c);
+        m_encoded.push_back(kHex[b >> 4]);
+        m_encoded.push_back(kHex[b & 0x0F]);
+    }
+    m_encoded.push_back('\'');
+    return *this;
+}
+
+void MysqlBulkInsertBuilder::finish()
+{
+    if (m_open && m_open_rows > 0) {
+        sealStatement();
+    }
+}
+
+std::span<const MysqlCommandView> MysqlBulkInsertBuilder::commands() const
+{
+    rebuildViewsIfNeeded();
+    return std::span<const MysqlCommandView>(m_views);
+}
+
+std::span<const size_t> MysqlBulkInsertBuilder::chunkRows() const
+{
+    return std::span<const size_t>(m_chunk_rows);
+}
+
+void MysqlBulkInsertBuilder::consume()
+{
+    if (m_open) {
+        m_encoded.erase(0, m_open_begin);
+        m_open_begin = 0;
+    } else {
+        m_encoded.clear();
+    }
+    m_chunks.clear();
+    m_chunk_rows.clear();
+    m_views_dirty = true;
+}
+
+void MysqlBulkInsertBuilder::clear() noexcept
+{
+    m_encoded.clear();
+    m_chunks.clear();
+    m_chunk_rows.clear();
+    m_views.clear();
+    m_views_dirty = true;
+    m_open = false;
+    m_open_begin = 0;
+    m_open_rows = 0;
+    m_row_begin = 0;
+    m_row_values = 0;
+    m_row_error.reset();
+}
+
+void MysqlBulkInsertBuilder::openStatement()
+{
+    m_open_begin = m_encoded.size();
+    m_encoded.append(MYSQL_PACKET_HEADER_SIZE, '\0');
+    m_encoded.push_back(static_cast<char>(CommandType::COM_QUERY));
+    m_encoded.append(m_head);
+    m_open = true;
+    m_open_rows = 0;
+}
+
+void MysqlBulkInsertBuilder::sealStatement()
+{
+    const size_t length = m_encoded.size() - m_open_begin;
+    const auto payload_len = static_cast<uint32_t>(length - MYSQL_PACKET_HEADER_SIZE);
+    char* header = m_encoded.data() + m_open_begin;
+    header[0] = static_cast<char>(payload_len & 0xFF);
+    header[1] = static_cast<char>((payload_len >> 8) & 0xFF);
+    header[2] = static_cast<char>((payload_len >> 16) & 0xFF);
+    header[3] = 0;
+
+    m_chunks.push_back(Chunk{m_open_begin, length});
+    m_chunk_rows.push_back(m_open_rows);
+    m_views_dirty = true;
+    m_open = false;
+    m_open_rows = 0;
+}
+
+void MysqlBulkInsertBuilder::beginValue()
+{
+    if (m_row_values++ > 0) {
+        m_encoded.push_back(',');
+    }
+}
+
+void MysqlBulkInsertBuilder::appendNull()
+{
+    beginValue();
+    m_encoded.append("NULL");
+}
+
+void MysqlBulkInsertBuilder::appendInteger(int64_t v)
+{
+    beginValue();
+    char buf[24];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    m_encoded.append(buf, end);
+}
+
+void MysqlBulkInsertBuilder::appendUnsigned(uint64_t v)
+{
+    beginValue();
+    char buf[24];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    m_encoded.append(buf, end);
+}
+
+void MysqlBulkInsertBuilder::appendDouble(double v)
+{
+    beginValue();
+    if (!std::isfinite(v)) {
+        // MySQL没有NaN/Inf字面量，整行在endRow()中丢弃
+        if (!m_row_error) {
+            m_row_error = MysqlError(MYSQL_ERROR_INVALID_PARAM, "Bulk insert value is not a finite number");
+        }
+        m_encoded.append("NULL");
+        return;
+    }
+    char buf[32];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    m_encoded.append(buf, end);
+}
+
+void MysqlBulkInsertBuilder::appendString(std::string_view v)
+{
+    beginValue();
+    m_encoded.reserve(m_encoded.size() + v.size() + 2);
+    m_encoded.push_back('\'');
+    size_t run = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        const char* escaped = escapeSequence(v[i], m_no_backslash_escapes);
+        if (escaped == nullptr) {
+            continue;
+        }
+        m_encoded.append(v.data() + run, i - run);
+        m_encoded.append(escaped);
+        run = i + 1;
+    }
+    m_encoded.append(v.data() + run, v.size() - run);
+    m_encoded.push_back('\'');
+}
+
+void MysqlBulkInsertBuilder::rebuildViewsIfNeeded() const
+{
+    if (!m_views_dirty) {
+        return;
+    }
+
+    m_views.resize(m_chunks.size());
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        m_views[i] = MysqlCommandView{
+            .encoded = std::string_view(m_encoded.data() + m_chunks[i].offset, m_chunks[i].length),
+            .kind = MysqlCommandKind::Query,
+            .sequence_id = 0
+        };
+    }
+    m_views_dirty = false;
+}
+
 } // namespace galay::mysql::protocol
@@ -2,12 +2,16 @@
 #define GALAY_MYSQL_PROTOCOL_BUILDER_H
 
 #include "MysqlProtocol.h"
+#include "galay-mysql/base/MysqlError.h"
 
 #include <cstddef>
 #include <cstdint>
+#include <expected>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace galay::mysql::protocol
@@ -21,7 +25,8 @@ enum class MysqlCommandKind : uint8_t
     InitDb,
     Ping,
     Quit,
-    ResetConnection
+    ResetConnection,
+    StmtExecute
 };
 
 struct MysqlCommandView
@@ -51,6 +56,14 @@ public:
     MysqlCommandBuilder& appendPing(uint8_t sequence_id = 0);
     MysqlCommandBuilder& appendQuit(uint8_t sequence_id = 0);
     MysqlCommandBuilder& appendResetConnection(uint8_t sequence_id = 0);
+
+    /**
+     * @brief 追加COM_STMT_EXECUTE，其响应在batch中按二进制协议行解码
+     */
+    MysqlCommandBuilder& appendStmtExecute(uint32_t stmt_id,
+                                           std::span<const std::optional<std::string_view>> params,
+                                           std::span<const uint8_t> param_types = {},
+                                           uint8_t sequence_id = 0);
     MysqlCommandBuilder& appendSimple(CommandType cmd,
                                       std::string_view payload = {},
                                       uint8_t sequence_id = 0,
@@ -90,6 +103,7 @@ private:
                           std::string_view payload,
                           uint8_t sequence_id,
                           MysqlCommandKind kind);
+    void appendEncoded(std::string_view packet, uint8_t sequence_id, MysqlCommandKind kind);
     void rebuildViewsIfNeeded() const;
 
     std::string m_encoded;
@@ -98,6 +112,158 @@ private:
     mutable bool m_views_dirty = true;
 };
 
+/**
+ * @brief 多行INSERT构建器
+ * @details 把类型化的行直接转义写入COM_QUERY包缓冲，拼成
+ *          INSERT INTO `t` (`a`,`b`) VALUES (...),(...)；
+ *          加入一行后语句超过maxPacketBytes时，该行移到新语句，前一条语句封包成一个chunk。
+ *          commands()只包含已封包的chunk，可直接交给AsyncMysqlClient::batch()/MysqlClient::batch()
+ *          在一次往返内流水线发送，返回的第i个结果集的affectedRows()即第i个chunk写入的行数。
+ *
+ * @code
+ * std::array<std::string_view, 3> columns{"id", "name", "score"};
+ * MysqlBulkInsertBuilder bulk("scores", columns);
+ * for (const auto& r : input) {
+ *     if (auto ok = bulk.addRow(r.id, r.name, r.score); !ok) return ok.error();
+ *     if (bulk.readyChunks() >= 8) {
+ *         auto res = co_await client.batch(bulk.commands());
+ *         bulk.consume();
+ *     }
+ * }
+ * bulk.finish();
+ * auto res = co_await client.batch(bulk.commands());
+ * @endcode
+ */
+class MysqlBulkInsertBuilder
+{
+public:
+    /**
+     * @param table 表名，按标识符加反引号
+     * @param columns 列名，每行的值个数必须与之相同
+     * @param max_packet_bytes 单条语句（COM_QUERY包体）上限，应不大于服务端max_allowed_packet；
+     *        同时被限制在单个协议包内（MYSQL_MAX_PACKET_SIZE - 1）
+     */
+    MysqlBulkInsertBuilder(std::string_view table,
+                           std::span<const std::string_view> columns,
+                           size_t max_packet_bytes = MYSQL_MAX_PACKET_SIZE - 1);
+
+    /**
+     * @brief 服务端处于NO_BACKSLASH_ESCAPES模式时只把单引号转义为两个单引号
+     * @details 可按OK包中的SERVER_STATUS_NO_BACKSLASH_ESCAPES设置
+     */
+    MysqlBulkInsertBuilder& setNoBackslashEscapes(bool enabled) noexcept;
+
+    /**
+     * @brief 追加一行
+     * @details 支持整数、浮点、bool、字符串、nullptr/std::nullopt及其std::optional
+     * @return 值个数不符、浮点非有限值或单行超过上限时返回MYSQL_ERROR_INVALID_PARAM，该行被丢弃
+     */
+    template<typename... Args>
+    std::expected<void, MysqlError> addRow(const Args&... values)
+    {
+        beginRow();
+        (value(values), ...);
+        return endRow();
+    }
+
+    // 逐列追加：beginRow() -> value()... -> endRow()
+    void beginRow();
+    std::expected<void, MysqlError> endRow();
+
+    template<typename T>
+    MysqlBulkInsertBuilder& value(const T& v)
+    {
+        if constexpr (std::is_same_v<T, std::nullptr_t> || std::is_same_v<T, std::nullopt_t>) {
+            appendNull();
+        } else if constexpr (std::is_same_v<T, bool>) {
+            appendInteger(v ? 1 : 0);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            appendInteger(static_cast<int64_t>(v));
+        } else if constexpr (std::is_integral_v<T>) {
+            appendUnsigned(static_cast<uint64_t>(v));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            appendDouble(static_cast<double>(v));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            appendString(std::string_view(v));
+        } else if constexpr (requires { v.has_value(); *v; }) {
+            if (v.has_value()) {
+                value(*v);
+            } else {
+                appendNull();
+            }
+        } else {
+            static_assert(sizeof(T) == 0, "Unsupported bulk insert value type");
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 以十六进制字面量X'..'写入二进制数据
+     */
+    MysqlBulkInsertBuilder& binary(std::string_view bytes);
+
+    /**
+     * @brief 封包当前未满的语句
+     */
+    void finish();
+
+    /**
+     * @brief 已封包的chunk（每个为一条完整的COM_QUERY）
+     */
+    [[nodiscard]] std::span<const MysqlCommandView> commands() const;
+
+    /**
+     * @brief 每个已封包chunk包含的行数，与commands()一一对应
+     */
+    [[nodiscard]] std::span<const size_t> chunkRows() const;
+
+    [[nodiscard]] size_t readyChunks() const noexcept { return m_chunks.size(); }
+    [[nodiscard]] size_t pendingRows() const noexcept { return m_open_rows; }
+    [[nodiscard]] size_t maxPacketBytes() const noexcept { return m_max_payload; }
+
+    /**
+     * @brief 丢弃已封包的chunk（发送之后调用），未封包的语句保留
+     */
+    void consume();
+    void clear() noexcept;
+
+private:
+    struct Chunk
+    {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    void openStatement();
+    void sealStatement();
+    void appendNull();
+    void appendInteger(int64_t v);
+    void appendUnsigned(uint64_t v);
+    void appendDouble(double v);
+    void appendString(std::string_view v);
+    void beginValue();
+    void rebuildViewsIfNeeded() const;
+
+    std::string m_head;
+    size_t m_column_count = 0;
+    size_t m_max_payload = 0;
+    bool m_no_backslash_escapes = false;
+
+    std::string m_encoded;
+    std::vector<Chunk> m_chunks;
+    std::vector<size_t> m_chunk_rows;
+    mutable std::vector<MysqlCommandView> m_views;
+    mutable bool m_views_dirty = true;
+
+    bool m_open = false;
+    size_t m_open_begin = 0;
+    size_t m_open_rows = 0;
+    size_t m_row_begin = 0;
+    size_t m_row_values = 0;
+    std::optional<MysqlError> m_row_error;
+    std::string m_row_scratch;
+};
+
 } // namespace galay::mysql::protocol
 
 #endif // GALAY_MYSQL_PROTOCOL_BUILDER_H
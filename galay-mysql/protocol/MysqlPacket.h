@@ -2,9 +2,11 @@
 #define GALAY_MYSQL_PACKET_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 #include <optional>
+#include <utility>
 #include "galay-mysql/base/MysqlValue.h"
 
 namespace galay::mysql::protocol
@@ -14,6 +16,8 @@ namespace galay::mysql::protocol
 
 constexpr uint32_t MYSQL_PACKET_HEADER_SIZE = 4;
 constexpr uint32_t MYSQL_MAX_PACKET_SIZE = 0xFFFFFF; // 16MB - 1
+constexpr uint32_t MYSQL_STMT_LONG_DATA_PREFIX_SIZE = MYSQL_PACKET_HEADER_SIZE + 7;    // 包头 + cmd + stmt_id + param_id
+constexpr uint32_t MYSQL_STMT_LONG_DATA_MAX_CHUNK = MYSQL_MAX_PACKET_SIZE - 8;         // 单个COM_STMT_SEND_LONG_DATA包的最大数据量
 
 // MySQL命令类型
 enum class CommandType : uint8_t
@@ -67,6 +71,7 @@ enum CapabilityFlags : uint32_t
     CLIENT_PLUGIN_AUTH                    = 0x00080000,
     CLIENT_CONNECT_ATTRS                  = 0x00100000,
     CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA = 0x00200000,
+    CLIENT_SESSION_TRACK                  = 0x00800000,
     CLIENT_DEPRECATE_EOF                  = 0x01000000,
 };
 
@@ -89,6 +94,17 @@ enum ServerStatusFlags : uint16_t
     SERVER_SESSION_STATE_CHANGED       = 0x4000,
 };
 
+// 会话状态变更类型（OK包中的session_state_info，需CLIENT_SESSION_TRACK）
+enum SessionStateType : uint8_t
+{
+    SESSION_TRACK_SYSTEM_VARIABLES            = 0x00,
+    SESSION_TRACK_SCHEMA                      = 0x01,
+    SESSION_TRACK_STATE_CHANGE                = 0x02,
+    SESSION_TRACK_GTIDS                       = 0x03,
+    SESSION_TRACK_TRANSACTION_CHARACTERISTICS = 0x04,
+    SESSION_TRACK_TRANSACTION_STATE           = 0x05,
+};
+
 // 字符集
 enum CharacterSet : uint8_t
 {
@@ -136,6 +152,19 @@ struct HandshakeResponse41
     std::string auth_response;
     std::string database;
     std::string auth_plugin_name;
+    std::vector<std::pair<std::string, std::string>> connect_attributes;  // CLIENT_CONNECT_ATTRS时发送
+};
+
+/**
+ * @brief 一条会话状态变更
+ * @details SYSTEM_VARIABLES时name为变量名、value为新值；其余类型只有value
+ *          （SCHEMA为库名，GTIDS为GTID集合，STATE_CHANGE为"1"/"0"）
+ */
+struct SessionStateChange
+{
+    uint8_t type = 0;
+    std::string name;
+    std::string value;
 };
 
 /**
@@ -148,6 +177,23 @@ struct OkPacket
     uint16_t status_flags = 0;
     uint16_t warnings = 0;
     std::string info;
+    std::vector<SessionStateChange> session_state;     // 仅当SERVER_SESSION_STATE_CHANGED时非空
+    std::string gtids;                                 // session_state中SESSION_TRACK_GTIDS的值
+};
+
+/**
+ * @brief OK包的零拷贝视图
+ * @details 字符串字段指向被解析的payload，只在payload有效期内可用
+ */
+struct OkPacketView
+{
+    uint64_t affected_rows = 0;
+    uint64_t last_insert_id = 0;
+    uint16_t status_flags = 0;
+    uint16_t warnings = 0;
+    std::string_view info;
+    std::string_view session_state;     // 状态变更块的原始字节（不含外层lenenc长度），可交给parseSessionState()
+    std::string_view gtids;             // 最后一条SESSION_TRACK_GTIDS的值
 };
 
 /**
@@ -1,7 +1,14 @@
 #include "MysqlProtocol.h"
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
 #include <cstring>
+#include <optional>
 #include <algorithm>
+#include <array>
+#include <cctype>
 #include <concepts>
+#include <utility>
 
 namespace galay::mysql::protocol
 {
@@ -85,6 +92,88 @@ void writeLenEncString(std::string& buf, std::string_view str)
     buf.append(str.data(), str.size());
 }
 
+std::optional<uint8_t> collationIdForCharset(std::string_view name)
+{
+    static constexpr std::array<std::pair<std::string_view, uint8_t>, 21> kCollations{{
+        {"big5", 1},
+        {"latin1", 8},
+        {"latin1_swedish_ci", 8},
+        {"ascii", 11},
+        {"gb2312", 24},
+        {"gbk", 28},
+        {"gbk_chinese_ci", 28},
+        {"utf8", CHARSET_UTF8_GENERAL_CI},
+        {"utf8mb3", CHARSET_UTF8_GENERAL_CI},
+        {"utf8_general_ci", CHARSET_UTF8_GENERAL_CI},
+        {"utf8mb3_general_ci", CHARSET_UTF8_GENERAL_CI},
+        {"utf8_bin", 83},
+        {"utf8mb4", CHARSET_UTF8MB4_GENERAL_CI},
+        {"utf8mb4_general_ci", CHARSET_UTF8MB4_GENERAL_CI},
+        {"utf8mb4_bin", 46},
+        {"utf8mb4_unicode_ci", 224},
+        {"utf8mb4_0900_ai_ci", CHARSET_UTF8MB4_0900_AI_CI},
+        {"binary", CHARSET_BINARY},
+        {"cp1251", 51},
+        {"utf16", 54},
+        {"gb18030", 248},
+    }};
+    std::string lowered(name);
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (const auto& [collation, id] : kCollations) {
+        if (collation == lowered) {
+            return id;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string buildSessionInitSql(const MysqlConfig& config, bool charset_in_handshake)
+{
+    std::string sql;
+    if (!charset_in_handshake && !config.charset.empty()) {
+        sql.append("SET NAMES ").append(config.charset);
+    }
+    if (!config.session_variables.empty()) {
+        if (!sql.empty()) {
+            sql.append("; ");
+        }
+        sql.append("SET ");
+        for (size_t i = 0; i < config.session_variables.size(); ++i) {
+            if (i > 0) {
+                sql.append(", ");
+            }
+            sql.append(config.session_variables[i].first).append(" = ").append(config.session_variables[i].second);
+        }
+    }
+    for (const auto& statement : config.init_statements) {
+        if (statement.empty()) {
+            continue;
+        }
+        if (!sql.empty()) {
+            sql.append("; ");
+        }
+        sql.append(statement);
+    }
+    return sql;
+}
+
+std::vector<std::pair<std::string, std::string>> buildConnectAttributes(const MysqlConfig& config)
+{
+    std::vector<std::pair<std::string, std::string>> attributes;
+    if (config.connect_attributes.empty()) {
+        return attributes;
+    }
+    const bool named = std::any_of(config.connect_attributes.begin(), config.connect_attributes.end(),
+                                   [](const auto& attribute) { return attribute.first == "_client_name"; });
+    attributes.reserve(config.connect_attributes.size() + 1);
+    if (!named) {
+        attributes.emplace_back("_client_name", "galay-mysql");
+    }
+    attributes.insert(attributes.end(), config.connect_attributes.begin(), config.connect_attributes.end());
+    return attributes;
+}
+
 std::expected<uint64_t, ParseError> readLenEncInt(const char* data, size_t len, size_t& consumed)
 {
     if (len < 1) return std::unexpected(ParseError::Incomplete);
@@ -114,16 +203,23 @@ std::expected<uint64_t, ParseError> readLenEncInt(const char* data, size_t len,
 }
 
 std::expected<std::string, ParseError> readLenEncString(const char* data, size_t len, size_t& consumed)
+{
+    auto view = readLenEncStringView(data, len, consumed);
+    if (!view) return std::unexpected(view.error());
+    return std::string(view.value());
+}
+
+std::expected<std::string_view, ParseError> readLenEncStringView(const char* data, size_t len, size_t& consumed)
 {
     size_t int_consumed = 0;
     auto int_result = readLenEncInt(data, len, int_consumed);
     if (!int_result) return std::unexpected(int_result.error());
 
     uint64_t str_len = int_result.value();
-    if (len < int_consumed + str_len) return std::unexpected(ParseError::Incomplete);
+    if (str_len > len - int_consumed) return std::unexpected(ParseError::Incomplete);
 
     consumed = int_consumed + str_len;
-    return std::string(data + int_consumed, str_len);
+    return std::string_view(data + int_consumed, static_cast<size_t>(str_len));
 }
 
 std::expected<std::string, ParseError> readNullTermString(const char* data, size_t len, size_t& consumed)
@@ -277,9 +373,60 @@ ResponseType MysqlParser::identifyResponse(uint8_t first_byte, uint32_t payload_
 std::expected<OkPacket, ParseError>
 MysqlParser::parseOk(const char* data, size_t len, uint32_t capabilities)
 {
-    if (len < 1) return std::unexpected(ParseError::Incomplete);
+    auto view = parseOkView(data, len, capabilities);
+    if (!view) return std::unexpected(view.error());
 
     OkPacket ok;
+    ok.affected_rows = view->affected_rows;
+    ok.last_insert_id = view->last_insert_id;
+    ok.status_flags = view->status_flags;
+    ok.warnings = view->warnings;
+    ok.info.assign(view->info);
+    ok.gtids.assign(view->gtids);
+    if (!view->session_state.empty()) {
+        auto changes = parseSessionState(view->session_state.data(), view->session_state.size());
+        if (!changes) return std::unexpected(changes.error());
+        ok.session_state = std::move(changes.value());
+    }
+    return ok;
+}
+
+namespace
+{
+
+/**
+ * @brief 在状态变更块中查找最后一条SESSION_TRACK_GTIDS的值，不复制
+ */
+std::expected<std::string_view, ParseError> findSessionGtids(const char* data, size_t len)
+{
+    std::string_view gtids;
+    size_t pos = 0;
+    size_t consumed = 0;
+    while (pos < len) {
+        const uint8_t type = static_cast<uint8_t>(data[pos++]);
+        auto entry = readLenEncStringView(data + pos, len - pos, consumed);
+        if (!entry) return std::unexpected(entry.error());
+        pos += consumed;
+        if (type != SESSION_TRACK_GTIDS) {
+            continue;
+        }
+        // 1字节编码规格（目前只有0），随后是lenenc的GTID集合
+        if (entry->empty()) return std::unexpected(ParseError::Incomplete);
+        auto value = readLenEncStringView(entry->data() + 1, entry->size() - 1, consumed);
+        if (!value) return std::unexpected(value.error());
+        gtids = value.value();
+    }
+    return gtids;
+}
+
+} // namespace
+
+std::expected<OkPacketView, ParseError>
+MysqlParser::parseOkView(const char* data, size_t len, uint32_t capabilities)
+{
+    if (len < 1) return std::unexpected(ParseError::Incomplete);
+
+    OkPacketView ok;
     size_t pos = 1; // 跳过0x00标识字节
     size_t consumed = 0;
 
@@ -304,14 +451,86 @@ MysqlParser::parseOk(const char* data, size_t len, uint32_t capabilities)
         pos += 2;
     }
 
-    // info (remaining bytes)
+    if (!(capabilities & CLIENT_SESSION_TRACK)) {
+        // info (remaining bytes)
+        if (pos < len) {
+            ok.info = std::string_view(data + pos, len - pos);
+        }
+        return ok;
+    }
+
+    // CLIENT_SESSION_TRACK: info为lenenc字符串，没有info也没有状态变更时整体省略
     if (pos < len) {
-        ok.info.assign(data + pos, len - pos);
+        auto info = readLenEncStringView(data + pos, len - pos, consumed);
+        if (!info) return std::unexpected(info.error());
+        ok.info = info.value();
+        pos += consumed;
+    }
+    if ((ok.status_flags & SERVER_SESSION_STATE_CHANGED) && pos < len) {
+        auto block = readLenEncStringView(data + pos, len - pos, consumed);
+        if (!block) return std::unexpected(block.error());
+        auto gtids = findSessionGtids(block->data(), block->size());
+        if (!gtids) return std::unexpected(gtids.error());
+        ok.session_state = block.value();
+        ok.gtids = gtids.value();
     }
 
     return ok;
 }
 
+std::expected<std::vector<SessionStateChange>, ParseError>
+MysqlParser::parseSessionState(const char* data, size_t len)
+{
+    std::vector<SessionStateChange> changes;
+    size_t pos = 0;
+    size_t consumed = 0;
+    while (pos < len) {
+        SessionStateChange change;
+        change.type = static_cast<uint8_t>(data[pos++]);
+        auto entry_len = readLenEncInt(data + pos, len - pos, consumed);
+        if (!entry_len) return std::unexpected(entry_len.error());
+        pos += consumed;
+        if (entry_len.value() > len - pos) return std::unexpected(ParseError::Incomplete);
+        const char* entry = data + pos;
+        const size_t entry_size = static_cast<size_t>(entry_len.value());
+        pos += entry_size;
+
+        size_t epos = 0;
+        switch (change.type) {
+        case SESSION_TRACK_SYSTEM_VARIABLES: {
+            auto name = readLenEncString(entry, entry_size, consumed);
+            if (!name) return std::unexpected(name.error());
+            epos += consumed;
+            auto value = readLenEncString(entry + epos, entry_size - epos, consumed);
+            if (!value) return std::unexpected(value.error());
+            change.name = std::move(name.value());
+            change.value = std::move(value.value());
+            break;
+        }
+        case SESSION_TRACK_GTIDS:
+            // 1字节编码规格（目前只有0），随后是lenenc的GTID集合
+            if (entry_size < 1) return std::unexpected(ParseError::Incomplete);
+            epos = 1;
+            [[fallthrough]];
+        case SESSION_TRACK_SCHEMA:
+        case SESSION_TRACK_STATE_CHANGE:
+        case SESSION_TRACK_TRANSACTION_CHARACTERISTICS:
+        case SESSION_TRACK_TRANSACTION_STATE: {
+            auto value = readLenEncString(entry + epos, entry_size - epos, consumed);
+            if (!value) return std::unexpected(value.error());
+            change.value = std::move(value.value());
+            break;
+        }
+        default:
+            // 未知类型保留原始字节
+            change.value.assign(entry, entry_size);
+            break;
+        }
+        changes.push_back(std::move(change));
+    }
+    return changes;
+}
+
 std::expected<ErrPacket, ParseError>
 MysqlParser::parseErr(const char* data, size_t len, uint32_t capabilities)
 {
@@ -420,7 +639,16 @@ std::expected<std::vector<std::optional<std::string>>, ParseError>
 MysqlParser::parseTextRow(const char* data, size_t len, size_t column_count)
 {
     std::vector<std::optional<std::string>> row;
-    row.reserve(column_count);
+    auto parsed = parseTextRowInto(data, len, column_count, row);
+    if (!parsed) return std::unexpected(parsed.error());
+    return row;
+}
+
+std::expected<void, ParseError>
+MysqlParser::parseTextRowInto(const char* data, size_t len, size_t column_count,
+                              std::vector<std::optional<std::string>>& row)
+{
+    row.resize(column_count);
     size_t pos = 0;
 
     for (size_t i = 0; i < column_count; ++i) {
@@ -428,14 +656,197 @@ MysqlParser::parseTextRow(const char* data, size_t len, size_t column_count)
 
         if (static_cast<uint8_t>(data[pos]) == 0xFB) {
             // NULL
-            row.push_back(std::nullopt);
+            row[i].reset();
             pos += 1;
+            continue;
+        }
+
+        size_t int_consumed = 0;
+        auto str_len = readLenEncInt(data + pos, len - pos, int_consumed);
+        if (!str_len) return std::unexpected(str_len.error());
+        pos += int_consumed;
+        if (len - pos < str_len.value()) return std::unexpected(ParseError::Incomplete);
+
+        const size_t n = static_cast<size_t>(str_len.value());
+        if (row[i].has_value()) {
+            row[i]->assign(data + pos, n);
         } else {
+            row[i].emplace(data + pos, n);
+        }
+        pos += n;
+    }
+
+    return {};
+}
+
+namespace
+{
+
+template<typename T>
+std::string formatBinaryNumber(T value)
+{
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    return std::string(buf, ec == std::errc() ? ptr : buf);
+}
+
+std::string formatFraction(uint32_t micro, uint8_t decimals)
+{
+    if (decimals == 0 || decimals > 6) {
+        if (micro == 0) return {};
+        decimals = 6;
+    }
+    char buf[8];
+    std::snprintf(buf, sizeof(buf), ".%06u", micro);
+    return std::string(buf, 1 + decimals);
+}
+
+} // namespace
+
+std::expected<std::vector<std::optional<std::string>>, ParseError>
+MysqlParser::parseBinaryRow(const char* data, size_t len, std::span<const MysqlField> fields)
+{
+    const size_t column_count = fields.size();
+    const size_t bitmap_len = (column_count + 7 + 2) / 8;
+    if (len < 1 + bitmap_len) return std::unexpected(ParseError::Incomplete);
+    if (static_cast<uint8_t>(data[0]) != 0x00) return std::unexpected(ParseError::InvalidFormat);
+
+    const char* bitmap = data + 1;
+    size_t pos = 1 + bitmap_len;
+    std::vector<std::optional<std::string>> row;
+    row.reserve(column_count);
+
+    auto need = [&](size_t n) { return len - pos >= n; };
+
+    for (size_t i = 0; i < column_count; ++i) {
+        const size_t bit = i + 2;
+        if (static_cast<uint8_t>(bitmap[bit / 8]) & (1u << (bit % 8))) {
+            row.push_back(std::nullopt);
+            continue;
+        }
+
+        const MysqlField& field = fields[i];
+        const bool is_unsigned = field.isUnsigned();
+        switch (field.type()) {
+        case MysqlFieldType::TINY:
+            if (!need(1)) return std::unexpected(ParseError::Incomplete);
+            row.push_back(is_unsigned ? formatBinaryNumber(static_cast<uint8_t>(data[pos]))
+                                      : formatBinaryNumber(static_cast<int8_t>(data[pos])));
+            pos += 1;
+            break;
+        case MysqlFieldType::SHORT:
+        case MysqlFieldType::YEAR: {
+            if (!need(2)) return std::unexpected(ParseError::Incomplete);
+            const uint16_t v = readUint16(data + pos);
+            row.push_back(is_unsigned ? formatBinaryNumber(v) : formatBinaryNumber(static_cast<int16_t>(v)));
+            pos += 2;
+            break;
+        }
+        case MysqlFieldType::LONG:
+        case MysqlFieldType::INT24: {
+            if (!need(4)) return std::unexpected(ParseError::Incomplete);
+            const uint32_t v = readUint32(data + pos);
+            row.push_back(is_unsigned ? formatBinaryNumber(v) : formatBinaryNumber(static_cast<int32_t>(v)));
+            pos += 4;
+            break;
+        }
+        case MysqlFieldType::LONGLONG: {
+            if (!need(8)) return std::unexpected(ParseError::Incomplete);
+            const uint64_t v = readUint64(data + pos);
+            row.push_back(is_unsigned ? formatBinaryNumber(v) : formatBinaryNumber(static_cast<int64_t>(v)));
+            pos += 8;
+            break;
+        }
+        case MysqlFieldType::FLOAT: {
+            if (!need(4)) return std::unexpected(ParseError::Incomplete);
+            float v;
+            std::memcpy(&v, data + pos, sizeof(v));
+            row.push_back(formatBinaryNumber(v));
+            pos += 4;
+            break;
+        }
+        case MysqlFieldType::DOUBLE: {
+            if (!need(8)) return std::unexpected(ParseError::Incomplete);
+            double v;
+            std::memcpy(&v, data + pos, sizeof(v));
+            row.push_back(formatBinaryNumber(v));
+            pos += 8;
+            break;
+        }
+        case MysqlFieldType::DATE:
+        case MysqlFieldType::DATETIME:
+        case MysqlFieldType::TIMESTAMP: {
+            if (!need(1)) return std::unexpected(ParseError::Incomplete);
+            const uint8_t n = static_cast<uint8_t>(data[pos++]);
+            if (!need(n) || (n != 0 && n != 4 && n != 7 && n != 11)) {
+                return std::unexpected(ParseError::InvalidLength);
+            }
+            unsigned year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+            uint32_t micro = 0;
+            if (n >= 4) {
+                year = readUint16(data + pos);
+                month = static_cast<uint8_t>(data[pos + 2]);
+                day = static_cast<uint8_t>(data[pos + 3]);
+            }
+            if (n >= 7) {
+                hour = static_cast<uint8_t>(data[pos + 4]);
+                minute = static_cast<uint8_t>(data[pos + 5]);
+                second = static_cast<uint8_t>(data[pos + 6]);
+            }
+            if (n == 11) {
+                micro = readUint32(data + pos + 7);
+            }
+            pos += n;
+
+            char buf[32];
+            if (field.type() == MysqlFieldType::DATE) {
+                std::snprintf(buf, sizeof(buf), "%04u-%02u-%02u", year, month, day);
+                row.push_back(std::string(buf));
+            } else {
+                std::snprintf(buf, sizeof(buf), "%04u-%02u-%02u %02u:%02u:%02u",
+                              year, month, day, hour, minute, second);
+                row.push_back(std::string(buf) + formatFraction(micro, field.decimals()));
+            }
+            break;
+        }
+        case MysqlFieldType::TIME: {
+            if (!need(1)) return std::unexpected(ParseError::Incomplete);
+            const uint8_t n = static_cast<uint8_t>(data[pos++]);
+            if (!need(n) || (n != 0 && n != 8 && n != 12)) {
+                return std::unexpected(ParseError::InvalidLength);
+            }
+            bool negative = false;
+            unsigned long hours = 0;
+            unsigned minute = 0, second = 0;
+            uint32_t micro = 0;
+            if (n >= 8) {
+                negative = data[pos] != 0;
+                hours = static_cast<unsigned long>(readUint32(data + pos + 1)) * 24 +
+                        static_cast<uint8_t>(data[pos + 5]);
+                minute = static_cast<uint8_t>(data[pos + 6]);
+                second = static_cast<uint8_t>(data[pos + 7]);
+            }
+            if (n == 12) {
+                micro = readUint32(data + pos + 8);
+            }
+            pos += n;
+
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%s%02lu:%02u:%02u", negative ? "-" : "", hours, minute, second);
+            row.push_back(std::string(buf) + formatFraction(micro, field.decimals()));
+            break;
+        }
+        case MysqlFieldType::NULL_TYPE:
+            row.push_back(std::nullopt);
+            break;
+        default: {
             size_t consumed = 0;
             auto val = readLenEncString(data + pos, len - pos, consumed);
             if (!val) return std::unexpected(val.error());
             row.push_back(std::move(val.value()));
             pos += consumed;
+            break;
+        }
         }
     }
 
@@ -471,12 +882,90 @@ concept StmtExecuteParamSpan = requires(const ParamSpan& params, size_t i) {
     { *params[i] } -> std::convertible_to<std::string_view>;
 };
 
+// 声明为数值类型的参数按二进制定长编码，文本无法转换时退回VAR_STRING
+struct BinaryParam {
+    char bytes[8];
+    uint8_t width = 0;
+    bool is_unsigned = false;
+};
+
+std::optional<BinaryParam> encodeBinaryParam(uint8_t type, std::string_view text)
+{
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    BinaryParam out;
+
+    auto store_int = [&](auto value, uint8_t width) {
+        const uint64_t bits = static_cast<uint64_t>(value);
+        for (uint8_t i = 0; i < width; ++i) {
+            out.bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+        }
+        out.width = width;
+    };
+    auto parse_int = [&](uint8_t width) -> bool {
+        int64_t value = 0;
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec == std::errc() && ptr == last) {
+            const int64_t limit = width == 8 ? INT64_MAX : (int64_t{1} << (8 * width - 1)) - 1;
+            if (value > limit || value < -limit - 1) {
+                if (width == 8 || value < 0 || value > limit * 2 + 1) return false;
+                out.is_unsigned = true;
+            }
+            store_int(value, width);
+            return true;
+        }
+        uint64_t uvalue = 0;
+        auto [uptr, uec] = std::from_chars(first, last, uvalue);
+        if (width != 8 || uec != std::errc() || uptr != last) return false;
+        out.is_unsigned = true;
+        store_int(uvalue, width);
+        return true;
+    };
+
+    switch (static_cast<MysqlFieldType>(type)) {
+    case MysqlFieldType::TINY:
+        return parse_int(1) ? std::optional(out) : std::nullopt;
+    case MysqlFieldType::SHORT:
+    case MysqlFieldType::YEAR:
+        return parse_int(2) ? std::optional(out) : std::nullopt;
+    case MysqlFieldType::LONG:
+    case MysqlFieldType::INT24:
+        return parse_int(4) ? std::optional(out) : std::nullopt;
+    case MysqlFieldType::LONGLONG:
+        return parse_int(8) ? std::optional(out) : std::nullopt;
+    case MysqlFieldType::FLOAT: {
+        float value = 0;
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc() || ptr != last) return std::nullopt;
+        std::memcpy(out.bytes, &value, sizeof(value));
+        out.width = sizeof(value);
+        return out;
+    }
+    case MysqlFieldType::DOUBLE: {
+        double value = 0;
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc() || ptr != last) return std::nullopt;
+        std::memcpy(out.bytes, &value, sizeof(value));
+        out.width = sizeof(value);
+        return out;
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
 template<StmtExecuteParamSpan ParamSpan>
-std::string encodeStmtExecuteImpl(uint32_t stmt_id,
-                                  ParamSpan params,
-                                  std::span<const uint8_t> param_types,
-                                  uint8_t sequence_id)
+void encodeStmtExecuteImpl(std::string& packet,
+                           uint32_t stmt_id,
+                           ParamSpan params,
+                           std::span<const uint8_t> param_types,
+                           std::span<const uint16_t> long_data_params,
+                           uint8_t sequence_id)
 {
+    // 长数据参数通常只有一两个，线性查找即可
+    auto is_long_data = [&](size_t i) {
+        return std::find(long_data_params.begin(), long_data_params.end(), i) != long_data_params.end();
+    };
     auto len_enc_size = [](size_t n) -> size_t {
         if (n < 251) return 1;
         if (n < (1ULL << 16)) return 3;
@@ -488,65 +977,85 @@ std::string encodeStmtExecuteImpl(uint32_t stmt_id,
     if (!params.empty()) {
         const size_t null_bitmap_len = (params.size() + 7) / 8;
         payload_reserve += null_bitmap_len + 1 + params.size() * 2;
-        for (const auto& param : params) {
-            if (param.has_value()) {
-                const std::string_view value = *param;
+        for (size_t i = 0; i < params.size(); ++i) {
+            if (params[i].has_value() && !is_long_data(i)) {
+                const std::string_view value = *params[i];
                 payload_reserve += len_enc_size(value.size()) + value.size();
             }
         }
     }
 
-    std::string payload;
-    payload.reserve(payload_reserve);
-    payload.push_back(static_cast<char>(CommandType::COM_STMT_EXECUTE));
+    // 包头先占位，payload写完后回填长度，避免payload与整包各分配一次
+    packet.clear();
+    packet.reserve(MYSQL_PACKET_HEADER_SIZE + payload_reserve);
+    packet.append(MYSQL_PACKET_HEADER_SIZE, '\0');
+    packet.push_back(static_cast<char>(CommandType::COM_STMT_EXECUTE));
 
     // statement_id (4 bytes)
-    writeUint32(payload, stmt_id);
+    writeUint32(packet, stmt_id);
 
     // flags (1 byte) - CURSOR_TYPE_NO_CURSOR
-    payload.push_back(0x00);
+    packet.push_back(0x00);
 
     // iteration_count (4 bytes) - always 1
-    writeUint32(payload, 1);
+    writeUint32(packet, 1);
 
     if (!params.empty()) {
         // NULL bitmap
         size_t null_bitmap_len = (params.size() + 7) / 8;
-        const size_t null_bitmap_pos = payload.size();
-        payload.append(null_bitmap_len, '\0');
+        const size_t null_bitmap_pos = packet.size();
+        packet.append(null_bitmap_len, '\0');
         for (size_t i = 0; i < params.size(); ++i) {
-            if (!params[i].has_value()) {
-                payload[null_bitmap_pos + (i / 8)] |= static_cast<char>(1u << (i % 8));
+            if (!params[i].has_value() && !is_long_data(i)) {
+                packet[null_bitmap_pos + (i / 8)] |= static_cast<char>(1u << (i % 8));
             }
         }
 
         // new_params_bound_flag (1 byte)
-        payload.push_back(0x01);
+        packet.push_back(0x01);
 
         // parameter types (2 bytes each)
         for (size_t i = 0; i < params.size(); ++i) {
-            if (i < param_types.size()) {
-                payload.push_back(static_cast<char>(param_types[i]));
-            } else {
-                payload.push_back(static_cast<char>(MysqlFieldType::VAR_STRING));
+            uint8_t type = static_cast<uint8_t>(MysqlFieldType::VAR_STRING);
+            uint8_t flags = 0x00;
+            if (is_long_data(i)) {
+                type = i < param_types.size() ? param_types[i] : static_cast<uint8_t>(MysqlFieldType::BLOB);
+            } else if (i < param_types.size()) {
+                type = param_types[i];
+                if (params[i].has_value()) {
+                    const auto binary = encodeBinaryParam(type, std::string_view(*params[i]));
+                    if (binary) {
+                        flags = binary->is_unsigned ? 0x80 : 0x00;
+                    } else {
+                        type = static_cast<uint8_t>(MysqlFieldType::VAR_STRING);
+                    }
+                }
             }
-            payload.push_back(0x00); // unsigned flag
+            packet.push_back(static_cast<char>(type));
+            packet.push_back(static_cast<char>(flags));
         }
 
         // parameter values
-        for (const auto& param : params) {
-            if (param.has_value()) {
-                writeLenEncString(payload, std::string_view(*param));
+        for (size_t i = 0; i < params.size(); ++i) {
+            if (!params[i].has_value() || is_long_data(i)) {
+                continue;
             }
+            const std::string_view value(*params[i]);
+            if (i < param_types.size()) {
+                if (const auto binary = encodeBinaryParam(param_types[i], value)) {
+                    packet.append(binary->bytes, binary->width);
+                    continue;
+                }
+            }
+            writeLenEncString(packet, value);
         }
     }
 
-    std::string packet;
-    packet.reserve(MYSQL_PACKET_HEADER_SIZE + payload.size());
-    writeUint24(packet, static_cast<uint32_t>(payload.size()));
-    packet.push_back(static_cast<char>(sequence_id));
-    packet.append(payload.data(), payload.size());
-    return packet;
+    const size_t payload_len = packet.size() - MYSQL_PACKET_HEADER_SIZE;
+    packet[0] = static_cast<char>(payload_len & 0xFF);
+    packet[1] = static_cast<char>((payload_len >> 8) & 0xFF);
+    packet[2] = static_cast<char>((payload_len >> 16) & 0xFF);
+    packet[3] = static_cast<char>(sequence_id);
 }
 
 } // namespace
@@ -563,16 +1072,22 @@ std::string MysqlEncoder::wrapPacket(std::string_view payload, uint8_t sequence_
 
 std::string MysqlEncoder::encodeSimpleCommand(CommandType cmd, std::string_view payload, uint8_t sequence_id)
 {
-    const uint32_t payload_len = 1U + static_cast<uint32_t>(payload.size());
     std::string packet;
-    packet.reserve(MYSQL_PACKET_HEADER_SIZE + payload_len);
-    writeUint24(packet, payload_len);
-    packet.push_back(static_cast<char>(sequence_id));
-    packet.push_back(static_cast<char>(cmd));
-    packet.append(payload.data(), payload.size());
+    encodeSimpleCommandInto(packet, cmd, payload, sequence_id);
     return packet;
 }
 
+void MysqlEncoder::encodeSimpleCommandInto(std::string& out, CommandType cmd, std::string_view payload, uint8_t sequence_id)
+{
+    const uint32_t payload_len = 1U + static_cast<uint32_t>(payload.size());
+    out.clear();
+    out.reserve(MYSQL_PACKET_HEADER_SIZE + payload_len);
+    writeUint24(out, payload_len);
+    out.push_back(static_cast<char>(sequence_id));
+    out.push_back(static_cast<char>(cmd));
+    out.append(payload.data(), payload.size());
+}
+
 std::string MysqlEncoder::encodeHandshakeResponse(const HandshakeResponse41& resp, uint8_t sequence_id)
 {
     std::string payload;
@@ -617,6 +1132,17 @@ std::string MysqlEncoder::encodeHandshakeResponse(const HandshakeResponse41& res
         payload.push_back('\0');
     }
 
+    // connection attributes (if CLIENT_CONNECT_ATTRS): lenenc总长度 + 若干lenenc键值对
+    if (resp.capability_flags & CLIENT_CONNECT_ATTRS) {
+        std::string attrs;
+        for (const auto& [key, value] : resp.connect_attributes) {
+            writeLenEncString(attrs, key);
+            writeLenEncString(attrs, value);
+        }
+        writeLenEncInt(payload, attrs.size());
+        payload.append(attrs);
+    }
+
     return wrapPacket(payload, sequence_id);
 }
 
@@ -625,6 +1151,11 @@ std::string MysqlEncoder::encodeQuery(std::string_view sql, uint8_t sequence_id)
     return encodeSimpleCommand(CommandType::COM_QUERY, sql, sequence_id);
 }
 
+void MysqlEncoder::encodeQueryInto(std::string& out, std::string_view sql, uint8_t sequence_id)
+{
+    encodeSimpleCommandInto(out, CommandType::COM_QUERY, sql, sequence_id);
+}
+
 std::string MysqlEncoder::encodeStmtPrepare(std::string_view sql, uint8_t sequence_id)
 {
     return encodeSimpleCommand(CommandType::COM_STMT_PREPARE, sql, sequence_id);
@@ -635,7 +1166,9 @@ std::string MysqlEncoder::encodeStmtExecute(uint32_t stmt_id,
                                              std::span<const uint8_t> param_types,
                                              uint8_t sequence_id)
 {
-    return encodeStmtExecuteImpl(stmt_id, params, param_types, sequence_id);
+    std::string packet;
+    encodeStmtExecuteImpl(packet, stmt_id, params, param_types, {}, sequence_id);
+    return packet;
 }
 
 std::string MysqlEncoder::encodeStmtExecute(uint32_t stmt_id,
@@ -643,7 +1176,73 @@ std::string MysqlEncoder::encodeStmtExecute(uint32_t stmt_id,
                                              std::span<const uint8_t> param_types,
                                              uint8_t sequence_id)
 {
-    return encodeStmtExecuteImpl(stmt_id, params, param_types, sequence_id);
+    std::string packet;
+    encodeStmtExecuteImpl(packet, stmt_id, params, param_types, {}, sequence_id);
+    return packet;
+}
+
+void MysqlEncoder::encodeStmtExecuteInto(std::string& out,
+                                         uint32_t stmt_id,
+                                         std::span<const std::optional<std::string>> params,
+                                         std::span<const uint8_t> param_types,
+                                         uint8_t sequence_id)
+{
+    encodeStmtExecuteImpl(out, stmt_id, params, param_types, {}, sequence_id);
+}
+
+void MysqlEncoder::encodeStmtExecuteInto(std::string& out,
+                                         uint32_t stmt_id,
+                                         std::span<const std::optional<std::string_view>> params,
+                                         std::span<const uint8_t> param_types,
+                                         uint8_t sequence_id)
+{
+    encodeStmtExecuteImpl(out, stmt_id, params, param_types, {}, sequence_id);
+}
+
+void MysqlEncoder::encodeStmtExecuteInto(std::string& out,
+                                         uint32_t stmt_id,
+                                         std::span<const std::optional<std::string>> params,
+                                         std::span<const uint8_t> param_types,
+                                         std::span<const uint16_t> long_data_params,
+                                         uint8_t sequence_id)
+{
+    encodeStmtExecuteImpl(out, stmt_id, params, param_types, long_data_params, sequence_id);
+}
+
+void MysqlEncoder::encodeStmtExecuteInto(std::string& out,
+                                         uint32_t stmt_id,
+                                         std::span<const std::optional<std::string_view>> params,
+                                         std::span<const uint8_t> param_types,
+                                         std::span<const uint16_t> long_data_params,
+                                         uint8_t sequence_id)
+{
+    encodeStmtExecuteImpl(out, stmt_id, params, param_types, long_data_params, sequence_id);
+}
+
+std::string MysqlEncoder::encodeStmtSendLongData(uint32_t stmt_id, uint16_t param_id,
+                                                 std::string_view data, uint8_t sequence_id)
+{
+    std::string packet(MYSQL_STMT_LONG_DATA_PREFIX_SIZE + data.size(), '\0');
+    writeStmtSendLongDataPrefix(packet.data(), stmt_id, param_id, data.size(), sequence_id);
+    std::memcpy(packet.data() + MYSQL_STMT_LONG_DATA_PREFIX_SIZE, data.data(), data.size());
+    return packet;
+}
+
+void MysqlEncoder::writeStmtSendLongDataPrefix(char* out, uint32_t stmt_id, uint16_t param_id,
+                                               size_t data_len, uint8_t sequence_id)
+{
+    const size_t payload_len = 7 + data_len;
+    out[0] = static_cast<char>(payload_len & 0xFF);
+    out[1] = static_cast<char>((payload_len >> 8) & 0xFF);
+    out[2] = static_cast<char>((payload_len >> 16) & 0xFF);
+    out[3] = static_cast<char>(sequence_id);
+    out[4] = static_cast<char>(CommandType::COM_STMT_SEND_LONG_DATA);
+    out[5] = static_cast<char>(stmt_id & 0xFF);
+    out[6] = static_cast<char>((stmt_id >> 8) & 0xFF);
+    out[7] = static_cast<char>((stmt_id >> 16) & 0xFF);
+    out[8] = static_cast<char>((stmt_id >> 24) & 0xFF);
+    out[9] = static_cast<char>(param_id & 0xFF);
+    out[10] = static_cast<char>((param_id >> 8) & 0xFF);
 }
 
 std::string MysqlEncoder::encodeStmtClose(uint32_t stmt_id, uint8_t sequence_id)
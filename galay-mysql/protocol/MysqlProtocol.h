@@ -9,6 +9,7 @@
 #include <span>
 #include <vector>
 #include <expected>
+#include <optional>
 #include <cstdint>
 
 namespace galay::mysql::protocol
@@ -34,6 +35,11 @@ std::expected<uint64_t, ParseError> readLenEncInt(const char* data, size_t len,
  */
 std::expected<std::string, ParseError> readLenEncString(const char* data, size_t len, size_t& consumed);
 
+/**
+ * @brief 读取length-encoded string，不复制，返回值指向data
+ */
+std::expected<std::string_view, ParseError> readLenEncStringView(const char* data, size_t len, size_t& consumed);
+
 /**
  * @brief 读取null-terminated string
  */
@@ -65,6 +71,25 @@ void writeLenEncInt(std::string& buf, uint64_t val);
  */
 void writeLenEncString(std::string& buf, std::string_view str);
 
+/**
+ * @brief 把字符集或排序规则名映射为握手响应中的排序规则ID（大小写不敏感）
+ * @details 字符集名取兼容MySQL 5.7/8.0与MariaDB的排序规则，utf8mb4对应utf8mb4_general_ci；
+ *          未收录的名称返回空，由调用方在连接后以SET NAMES设置
+ */
+std::optional<uint8_t> collationIdForCharset(std::string_view name);
+
+/**
+ * @brief 生成认证成功后的会话初始化请求
+ * @details 依次为SET NAMES（charset_in_handshake为false时）、一条合并了全部session_variables的SET
+ *          以及init_statements，以"; "连接成一条多语句COM_QUERY；无需初始化时返回空串
+ */
+std::string buildSessionInitSql(const MysqlConfig& config, bool charset_in_handshake);
+
+/**
+ * @brief 生成握手响应中的连接属性，未指定_client_name时补为galay-mysql；config中没有属性时返回空
+ */
+std::vector<std::pair<std::string, std::string>> buildConnectAttributes(const MysqlConfig& config);
+
 // ======================== 解析器 ========================
 
 class MysqlParser
@@ -102,6 +127,18 @@ public:
      */
     std::expected<OkPacket, ParseError> parseOk(const char* data, size_t len, uint32_t capabilities);
 
+    /**
+     * @brief 解析OK包但不复制字符串
+     * @details 结果集解码器用它处理每条命令的终止包，整个过程不分配内存；需要逐条状态变更时再调用parseOk()
+     */
+    std::expected<OkPacketView, ParseError> parseOkView(const char* data, size_t len, uint32_t capabilities);
+
+    /**
+     * @brief 解析OK包中的session_state_info（不含外层lenenc长度）
+     * @details 每条为 type(1) + lenenc长度 + 数据，未知类型按原始字节保留在value中
+     */
+    std::expected<std::vector<SessionStateChange>, ParseError> parseSessionState(const char* data, size_t len);
+
     /**
      * @brief 解析ERR包
      * @param data payload数据（不含包头，含0xFF标识字节）
@@ -134,6 +171,22 @@ public:
     std::expected<std::vector<std::optional<std::string>>, ParseError>
     parseTextRow(const char* data, size_t len, size_t column_count);
 
+    /**
+     * @brief 解析文本协议行数据到已有容器
+     * @details 复用row及其中字符串已有的容量，用于结果集存储复用的路径
+     */
+    std::expected<void, ParseError>
+    parseTextRowInto(const char* data, size_t len, size_t column_count,
+                     std::vector<std::optional<std::string>>& row);
+
+    /**
+     * @brief 解析二进制协议行数据（COM_STMT_EXECUTE结果）
+     * @param fields 列定义，用于确定每列的编码方式
+     * @return 一行数据，数值/时间列转换为与文本协议一致的字符串形式
+     */
+    std::expected<std::vector<std::optional<std::string>>, ParseError>
+    parseBinaryRow(const char* data, size_t len, std::span<const MysqlField> fields);
+
     /**
      * @brief 解析COM_STMT_PREPARE响应的OK部分
      * @param data payload数据（不含包头）
@@ -179,6 +232,11 @@ public:
      */
     std::string encodeQuery(std::string_view sql, uint8_t sequence_id = 0);
 
+    /**
+     * @brief 编码COM_QUERY命令到out（覆盖原内容，复用其容量）
+     */
+    void encodeQueryInto(std::string& out, std::string_view sql, uint8_t sequence_id = 0);
+
     /**
      * @brief 编码COM_STMT_PREPARE命令
      * @param sql SQL语句
@@ -204,6 +262,52 @@ public:
                                    std::span<const uint8_t> param_types,
                                    uint8_t sequence_id = 0);
 
+    /**
+     * @brief 编码COM_STMT_EXECUTE命令到out（覆盖原内容，复用其容量）
+     */
+    void encodeStmtExecuteInto(std::string& out,
+                               uint32_t stmt_id,
+                               std::span<const std::optional<std::string>> params,
+                               std::span<const uint8_t> param_types,
+                               uint8_t sequence_id = 0);
+    void encodeStmtExecuteInto(std::string& out,
+                               uint32_t stmt_id,
+                               std::span<const std::optional<std::string_view>> params,
+                               std::span<const uint8_t> param_types,
+                               uint8_t sequence_id = 0);
+
+    /**
+     * @brief 编码COM_STMT_EXECUTE命令到out，long_data_params中的参数已由COM_STMT_SEND_LONG_DATA发送
+     * @details 这些参数只写入类型（未指定时为BLOB），params中对应位置的值被忽略，服务端使用已累积的长数据
+     */
+    void encodeStmtExecuteInto(std::string& out,
+                               uint32_t stmt_id,
+                               std::span<const std::optional<std::string>> params,
+                               std::span<const uint8_t> param_types,
+                               std::span<const uint16_t> long_data_params,
+                               uint8_t sequence_id = 0);
+    void encodeStmtExecuteInto(std::string& out,
+                               uint32_t stmt_id,
+                               std::span<const std::optional<std::string_view>> params,
+                               std::span<const uint8_t> param_types,
+                               std::span<const uint16_t> long_data_params,
+                               uint8_t sequence_id = 0);
+
+    /**
+     * @brief 编码COM_STMT_SEND_LONG_DATA命令（服务端不回复）
+     * @param data 追加到参数param_id的数据，不超过MYSQL_STMT_LONG_DATA_MAX_CHUNK
+     * @return 完整的MySQL包
+     */
+    std::string encodeStmtSendLongData(uint32_t stmt_id, uint16_t param_id,
+                                       std::string_view data, uint8_t sequence_id = 0);
+
+    /**
+     * @brief 在out处写入COM_STMT_SEND_LONG_DATA的包头与命令头（MYSQL_STMT_LONG_DATA_PREFIX_SIZE字节）
+     * @details 供数据直接读进包缓冲的路径使用：先把data_len字节读到out + MYSQL_STMT_LONG_DATA_PREFIX_SIZE，再回填前缀
+     */
+    static void writeStmtSendLongDataPrefix(char* out, uint32_t stmt_id, uint16_t param_id,
+                                            size_t data_len, uint8_t sequence_id = 0);
+
     /**
      * @brief 编码COM_STMT_CLOSE命令
      * @param stmt_id 语句ID
@@ -252,6 +356,7 @@ private:
      * @brief 编码简单命令（1字节命令 + 可选payload）
      */
     std::string encodeSimpleCommand(CommandType cmd, std::string_view payload, uint8_t sequence_id);
+    void encodeSimpleCommandInto(std::string& out, CommandType cmd, std::string_view payload, uint8_t sequence_id);
 };
 
 } // namespace galay::mysql::protocol
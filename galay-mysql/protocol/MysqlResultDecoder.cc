@@ -0,0 +1,204 @@
+#include "MysqlResultDecoder.h"
+
+namespace galay::mysql::protocol
+{
+
+namespace
+{
+
+MysqlError serverError(MysqlParser& parser, const char* payload, size_t len, uint32_t capabilities)
+{
+    auto err = parser.parseErr(payload, len, capabilities);
+    if (err) {
+        return MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message);
+    }
+    return MysqlError(MYSQL_ERROR_QUERY, "Query failed");
+}
+
+} // namespace
+
+void MysqlResultDecoder::reset(uint32_t capabilities, MysqlRowFormat format) noexcept
+{
+    m_capabilities = capabilities;
+    m_format = format;
+    m_state = State::Header;
+    m_column_count = 0;
+    m_columns_received = 0;
+}
+
+std::expected<MysqlResultEvent, MysqlError>
+MysqlResultDecoder::feed(const char* data, size_t len, size_t& consumed)
+{
+    consumed = 0;
+    MysqlResultEvent event;
+
+    // DEPRECATE_EOF下列定义后没有EOF包，不需要任何字节即可推进
+    if (m_state == State::ColumnEof && (m_capabilities & CLIENT_DEPRECATE_EOF)) {
+        m_state = State::Rows;
+        event.type = MysqlResultEventType::ColumnsEnd;
+        return event;
+    }
+
+    size_t packet_size = 0;
+    auto pkt = m_parser.extractPacket(data, len, packet_size);
+    if (!pkt) {
+        if (pkt.error() == ParseError::Incomplete) {
+            return event;
+        }
+        return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse MySQL packet"));
+    }
+    consumed = packet_size;
+    event.sequence_id = pkt->sequence_id;
+    if (pkt->payload_len == 0) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Empty server payload"));
+    }
+
+    const char* payload = pkt->payload;
+    const size_t payload_len = pkt->payload_len;
+    const uint8_t first_byte = static_cast<uint8_t>(payload[0]);
+    event.payload = std::string_view(payload, payload_len);
+
+    switch (m_state) {
+    case State::Header: {
+        if (first_byte == 0xFF) {
+            return std::unexpected(serverError(m_parser, payload, payload_len, m_capabilities));
+        }
+        if (first_byte == 0x00) {
+            auto ok = m_parser.parseOkView(payload, payload_len, m_capabilities);
+            if (!ok) {
+                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse OK packet"));
+            }
+            event.type = MysqlResultEventType::Ok;
+            event.ok = ok.value();
+            return event;
+        }
+        if (first_byte == 0xFB) {
+            // 状态仍停在Header：客户端发送完数据后服务端回复OK/ERR
+            event.type = MysqlResultEventType::LocalInfile;
+            event.payload = std::string_view(payload + 1, payload_len - 1);
+            return event;
+        }
+
+        size_t int_consumed = 0;
+        auto col_count = readLenEncInt(payload, payload_len, int_consumed);
+        if (!col_count || col_count.value() == 0) {
+            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column count"));
+        }
+        m_column_count = col_count.value();
+        m_columns_received = 0;
+        m_state = State::Columns;
+        event.type = MysqlResultEventType::ColumnCount;
+        event.column_count = m_column_count;
+        return event;
+    }
+    case State::Columns:
+        ++m_columns_received;
+        if (m_columns_received >= m_column_count) {
+            m_state = State::ColumnEof;
+        }
+        event.type = MysqlResultEventType::Column;
+        return event;
+    case State::ColumnEof:
+        if (first_byte == 0xFF) {
+            return std::unexpected(serverError(m_parser, payload, payload_len, m_capabilities));
+        }
+        m_state = State::Rows;
+        event.type = MysqlResultEventType::ColumnsEnd;
+        return event;
+    case State::Rows:
+        if (first_byte == 0xFE && payload_len < MYSQL_MAX_PACKET_SIZE) {
+            if (m_capabilities & CLIENT_DEPRECATE_EOF) {
+                auto ok = m_parser.parseOkView(payload, payload_len, m_capabilities);
+                if (ok) {
+                    event.ok = ok.value();
+                }
+            } else {
+                auto eof = m_parser.parseEof(payload, payload_len);
+                if (eof) {
+                    event.ok.warnings = eof->warnings;
+                    event.ok.status_flags = eof->status_flags;
+                }
+            }
+            m_state = State::Header;
+            event.type = MysqlResultEventType::End;
+            return event;
+        }
+        if (first_byte == 0xFF) {
+            m_state = State::Header;
+            return std::unexpected(serverError(m_parser, payload, payload_len, m_capabilities));
+        }
+        event.type = MysqlResultEventType::Row;
+        return event;
+    }
+    return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Invalid result decoder state"));
+}
+
+std::expected<bool, MysqlError>
+MysqlResultDecoder::apply(const MysqlResultEvent& event, MysqlResultSet& result_set)
+{
+    switch (event.type) {
+    case MysqlResultEventType::NeedMore:
+        return false;
+    case MysqlResultEventType::Ok:
+        result_set.setAffectedRows(event.ok.affected_rows);
+        result_set.setLastInsertId(event.ok.last_insert_id);
+        result_set.setWarnings(event.ok.warnings);
+        result_set.setStatusFlags(event.ok.status_flags);
+        result_set.setInfo(event.ok.info);
+        result_set.setGtids(event.ok.gtids);
+        return true;
+    case MysqlResultEventType::ColumnCount:
+        result_set.reserveFields(static_cast<size_t>(event.column_count));
+        return false;
+    case MysqlResultEventType::Column: {
+        auto col = m_parser.parseColumnDefinition(event.payload.data(), event.payload.size());
+        if (!col) {
+            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column definition"));
+        }
+        MysqlField field(std::move(col->name),
+                         static_cast<MysqlFieldType>(col->column_type),
+                         col->flags,
+                         col->column_length,
+                         col->decimals);
+        field.setCatalog(std::move(col->catalog));
+        field.setSchema(std::move(col->schema));
+        field.setTable(std::move(col->table));
+        field.setOrgTable(std::move(col->org_table));
+        field.setOrgName(std::move(col->org_name));
+        field.setCharacterSet(col->character_set);
+        result_set.addField(std::move(field));
+        return false;
+    }
+    case MysqlResultEventType::ColumnsEnd:
+        return false;
+    case MysqlResultEventType::Row: {
+        if (m_format == MysqlRowFormat::Binary) {
+            auto row = m_parser.parseBinaryRow(event.payload.data(), event.payload.size(), result_set.fields());
+            if (!row) {
+                return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse binary row"));
+            }
+            result_set.addRow(MysqlRow(std::move(row.value())));
+            return false;
+        }
+        auto& row = result_set.appendRow();
+        auto parsed = m_parser.parseTextRowInto(event.payload.data(), event.payload.size(),
+                                                static_cast<size_t>(m_column_count), row.values());
+        if (!parsed) {
+            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse text row"));
+        }
+        return false;
+    }
+    case MysqlResultEventType::End:
+        result_set.setWarnings(event.ok.warnings);
+        result_set.setStatusFlags(event.ok.status_flags);
+        result_set.setGtids(event.ok.gtids);
+        return true;
+    case MysqlResultEventType::LocalInfile:
+        // 只有loadLocalInfile()会应答该请求，其他路径无法让连接回到边界
+        return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL,
+                                          "LOCAL INFILE request requires loadLocalInfile()"));
+    }
+    return std::unexpected(MysqlError(MYSQL_ERROR_INTERNAL, "Invalid result event"));
+}
+
+} // namespace galay::mysql::protocol
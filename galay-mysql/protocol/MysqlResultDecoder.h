@@ -0,0 +1,143 @@
+#ifndef GALAY_MYSQL_RESULT_DECODER_H
+#define GALAY_MYSQL_RESULT_DECODER_H
+
+#include "MysqlProtocol.h"
+#include "galay-mysql/base/MysqlError.h"
+#include "galay-mysql/base/MysqlValue.h"
+#include <cstdint>
+#include <expected>
+#include <string_view>
+
+namespace galay::mysql::protocol
+{
+
+/**
+ * @brief 行编码格式
+ * @details COM_QUERY返回文本协议行，COM_STMT_EXECUTE返回二进制协议行
+ */
+enum class MysqlRowFormat : uint8_t
+{
+    Text,
+    Binary
+};
+
+/**
+ * @brief 结果集解码事件类型
+ */
+enum class MysqlResultEventType : uint8_t
+{
+    NeedMore,       // 缓冲中不足一个完整包
+    Ok,             // 无结果集的OK响应，ok有效
+    ColumnCount,    // 列数包，column_count有效
+    Column,         // 一个列定义包，payload为原始包体
+    ColumnsEnd,     // 列定义结束（非DEPRECATE_EOF模式下同时吞掉EOF包）
+    Row,            // 一行数据，payload为原始行包
+    End,            // 行结束（EOF包，或DEPRECATE_EOF下的OK包），ok中的warnings/status_flags有效
+    LocalInfile     // LOCAL INFILE请求（0xFB），payload为服务端请求的文件名；数据发送完毕后仍以Ok/ERR结束
+};
+
+/**
+ * @brief 结果集解码事件
+ * @details payload指向调用方传入的缓冲，仅在消费对应字节前有效
+ */
+struct MysqlResultEvent
+{
+    MysqlResultEventType type = MysqlResultEventType::NeedMore;
+    std::string_view payload;
+    uint64_t column_count = 0;
+    uint8_t sequence_id = 0;    // 事件所在包的序列号（LocalInfile之后的数据包从sequence_id + 1开始）
+    OkPacketView ok;            // 字符串字段与payload同生命周期
+
+    /**
+     * @brief Ok/End之后是否还有后续结果集（SERVER_MORE_RESULTS_EXISTS）
+     */
+    bool moreResults() const { return (ok.status_flags & SERVER_MORE_RESULTS_EXISTS) != 0; }
+
+    /**
+     * @brief 是否结束了一个结果集（Ok/End）
+     */
+    bool endsResultSet() const
+    {
+        return type == MysqlResultEventType::Ok || type == MysqlResultEventType::End;
+    }
+
+    /**
+     * @brief 是否结束了整个响应（最后一个结果集的Ok/End）
+     */
+    bool endsResponse() const { return endsResultSet() && !moreResults(); }
+};
+
+/**
+ * @brief 推式结果集解码器
+ * @details query、stmtExecute、pipeline以及同步客户端共用的 头部 -> 列定义 -> [EOF] -> 行 -> 结束 状态机。
+ *          调用方把可读字节交给feed()，每次得到一个事件和应消费的字节数；
+ *          解码器本身不持有缓冲也不分配内存，事件落地到MysqlResultSet由apply()完成，
+ *          需要自定义落地方式（如行接收器）的路径可直接处理事件。
+ *
+ * @code
+ * decoder.reset(capabilities, MysqlRowFormat::Text);
+ * while (true) {
+ *     size_t consumed = 0;
+ *     auto event = decoder.feed(data, len, consumed);
+ *     if (!event) { consume(consumed); return error; }
+ *     if (event->type == MysqlResultEventType::NeedMore) { recv more; continue; }
+ *     auto done = decoder.apply(*event, result_set);
+ *     consume(consumed);
+ *     if (!done) return error;
+ *     if (*done) break;
+ * }
+ * @endcode
+ */
+class MysqlResultDecoder
+{
+public:
+    MysqlResultDecoder() = default;
+
+    /**
+     * @brief 开始解码新的响应
+     * @param capabilities 协商后的能力标志（决定是否存在列EOF包）
+     * @param format 行编码格式
+     */
+    void reset(uint32_t capabilities, MysqlRowFormat format = MysqlRowFormat::Text) noexcept;
+
+    /**
+     * @brief 从缓冲头部解码下一个事件
+     * @param consumed 输出：该事件对应的字节数（NeedMore时为0），调用方在处理完事件后消费
+     * @return 事件；服务端ERR包或协议错误时返回MysqlError，此时consumed仍指向完整的包
+     */
+    std::expected<MysqlResultEvent, MysqlError> feed(const char* data, size_t len, size_t& consumed);
+
+    /**
+     * @brief 把事件落地到结果集
+     * @details Ok/End的info与gtids在此才复制进结果集，写入其已有的字符串容量（复用的结果集不再分配）
+     * @return 结果集是否已完整（Ok/End事件）
+     */
+    std::expected<bool, MysqlError> apply(const MysqlResultEvent& event, MysqlResultSet& result_set);
+
+    MysqlRowFormat rowFormat() const { return m_format; }
+    uint64_t columnCount() const { return m_column_count; }
+
+    /**
+     * @brief 当前是否停在响应边界上（尚未收到任何包，或上一个结果集已结束）
+     */
+    bool atBoundary() const { return m_state == State::Header; }
+
+private:
+    enum class State : uint8_t {
+        Header,
+        Columns,
+        ColumnEof,
+        Rows
+    };
+
+    MysqlParser m_parser;
+    uint32_t m_capabilities = 0;
+    MysqlRowFormat m_format = MysqlRowFormat::Text;
+    State m_state = State::Header;
+    uint64_t m_column_count = 0;
+    uint64_t m_columns_received = 0;
+};
+
+} // namespace galay::mysql::protocol
+
+#endif // GALAY_MYSQL_RESULT_DECODER_H
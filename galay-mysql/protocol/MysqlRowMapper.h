@@ -0,0 +1,467 @@
+#ifndef GALAY_MYSQL_ROW_MAPPER_H
+#define GALAY_MYSQL_ROW_MAPPER_H
+
+#include "galay-mysql/base/MysqlError.h"
+#include "galay-mysql/base/MysqlValue.h"
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 声明结构体成员到结果集列的映射（按列顺序）
+ * @details 放在结构体内部使用，成员顺序需与SELECT列顺序一致：
+ * @code
+ * struct User {
+ *     int64_t id;
+ *     std::string name;
+ *     std::optional<int32_t> age;
+ *     MYSQL_FIELDS(id, name, age)
+ * };
+ * @endcode
+ * 未声明MYSQL_FIELDS的聚合体按成员声明顺序映射（最多16个成员）。
+ */
+#define MYSQL_FIELDS(...)                                                   \
+    auto mysqlFields() { return std::tie(__VA_ARGS__); }                    \
+    auto mysqlFields() const { return std::tie(__VA_ARGS__); }
+
+namespace galay::mysql
+{
+
+// ======================== 行接收器 ========================
+
+/**
+ * @brief 结果集行接收器
+ * @details 解析器在列定义接收完毕后调用一次onColumns，之后每个行包调用一次onRow，
+ *          payload指向原始text row包体，仅在回调期间有效。
+ */
+class MysqlRowSink
+{
+public:
+    virtual ~MysqlRowSink() = default;
+
+    virtual std::expected<void, MysqlError> onColumns(std::span<const MysqlField> fields) = 0;
+    virtual std::expected<void, MysqlError> onRow(const char* payload, size_t len) = 0;
+};
+
+namespace detail
+{
+
+// ======================== 成员枚举 ========================
+
+struct AnyRowField
+{
+    template<typename U>
+    operator U&() const&& noexcept;
+};
+
+template<size_t>
+using AnyRowFieldFor = AnyRowField;
+
+template<typename T, size_t... I>
+constexpr bool braceConstructibleWith(std::index_sequence<I...>)
+{
+    return requires { T{AnyRowFieldFor<I>{}...}; };
+}
+
+inline constexpr size_t kMaxAggregateRowFields = 16;
+
+template<typename T, size_t N = kMaxAggregateRowFields>
+constexpr size_t aggregateFieldCount()
+{
+    if constexpr (N == 0) {
+        return 0;
+    } else if constexpr (braceConstructibleWith<T>(std::make_index_sequence<N>{})) {
+        return N;
+    } else {
+        return aggregateFieldCount<T, N - 1>();
+    }
+}
+
+template<typename T>
+concept DescribedRow = requires(T& row) {
+    row.mysqlFields();
+};
+
+template<typename T>
+concept AggregateRow = std::is_aggregate_v<T> &&
+                       std::is_default_constructible_v<T> &&
+                       (aggregateFieldCount<T>() > 0);
+
+template<typename T>
+auto tieAggregate(T& row)
+{
+    constexpr size_t n = aggregateFieldCount<T>();
+    if constexpr (n == 1) {
+        auto& [a] = row;
+        return std::tie(a);
+    } else if constexpr (n == 2) {
+        auto& [a, b] = row;
+        return std::tie(a, b);
+    } else if constexpr (n == 3) {
+        auto& [a, b, c] = row;
+        return std::tie(a, b, c);
+    } else if constexpr (n == 4) {
+        auto& [a, b, c, d] = row;
+        return std::tie(a, b, c, d);
+    } else if constexpr (n == 5) {
+        auto& [a, b, c, d, e] = row;
+        return std::tie(a, b, c, d, e);
+    } else if constexpr (n == 6) {
+        auto& [a, b, c, d, e, f] = row;
+        return std::tie(a, b, c, d, e, f);
+    } else if constexpr (n == 7) {
+        auto& [a, b, c, d, e, f, g] = row;
+        return std::tie(a, b, c, d, e, f, g);
+    } else if constexpr (n == 8) {
+        auto& [a, b, c, d, e, f, g, h] = row;
+        return std::tie(a, b, c, d, e, f, g, h);
+    } else if constexpr (n == 9) {
+        auto& [a, b, c, d, e, f, g, h, i] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i);
+    } else if constexpr (n == 10) {
+        auto& [a, b, c, d, e, f, g, h, i, j] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i, j);
+    } else if constexpr (n == 11) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+    } else if constexpr (n == 12) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+    } else if constexpr (n == 13) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m);
+    } else if constexpr (n == 14) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o);
+    } else if constexpr (n == 15) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p);
+    } else {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q] = row;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q);
+    }
+}
+
+// ======================== 列类型 ========================
+
+inline bool isIntegerColumn(const MysqlField& field)
+{
+    switch (field.type()) {
+    case MysqlFieldType::TINY:
+    case MysqlFieldType::SHORT:
+    case MysqlFieldType::LONG:
+    case MysqlFieldType::LONGLONG:
+    case MysqlFieldType::INT24:
+    case MysqlFieldType::YEAR:
+        return true;
+    case MysqlFieldType::DECIMAL:
+    case MysqlFieldType::NEWDECIMAL:
+        // SUM(int)/COUNT类聚合常以无小数位DECIMAL返回
+        return field.decimals() == 0;
+    default:
+        return false;
+    }
+}
+
+inline bool isRealColumn(const MysqlField& field)
+{
+    switch (field.type()) {
+    case MysqlFieldType::FLOAT:
+    case MysqlFieldType::DOUBLE:
+    case MysqlFieldType::DECIMAL:
+    case MysqlFieldType::NEWDECIMAL:
+        return true;
+    default:
+        return isIntegerColumn(field);
+    }
+}
+
+template<typename M>
+struct RowMemberTraits;
+
+template<typename M>
+requires (std::is_integral_v<M> && !std::is_same_v<M, bool>)
+struct RowMemberTraits<M>
+{
+    static constexpr bool kNullable = false;
+    static constexpr const char* kName = "integer";
+
+    static bool accepts(const MysqlField& field) { return isIntegerColumn(field); }
+
+    static bool decode(const char* data, size_t len, M& out)
+    {
+        const char* end = data + len;
+        auto [ptr, ec] = std::from_chars(data, end, out);
+        return ec == std::errc{} && ptr == end;
+    }
+};
+
+template<>
+struct RowMemberTraits<bool>
+{
+    static constexpr bool kNullable = false;
+    static constexpr const char* kName = "bool";
+
+    static bool accepts(const MysqlField& field) { return isIntegerColumn(field); }
+
+    static bool decode(const char* data, size_t len, bool& out)
+    {
+        int64_t value = 0;
+        if (!RowMemberTraits<int64_t>::decode(data, len, value)) {
+            return false;
+        }
+        out = value != 0;
+        return true;
+    }
+};
+
+template<typename M>
+requires std::is_floating_point_v<M>
+struct RowMemberTraits<M>
+{
+    static constexpr bool kNullable = false;
+    static constexpr const char* kName = "floating point";
+
+    static bool accepts(const MysqlField& field) { return isRealColumn(field); }
+
+    static bool decode(const char* data, size_t len, M& out)
+    {
+        const char* end = data + len;
+        auto [ptr, ec] = std::from_chars(data, end, out);
+        return ec == std::errc{} && ptr == end;
+    }
+};
+
+template<>
+struct RowMemberTraits<std::string>
+{
+    static constexpr bool kNullable = false;
+    static constexpr const char* kName = "string";
+
+    static bool accepts(const MysqlField&) { return true; }
+
+    static bool decode(const char* data, size_t len, std::string& out)
+    {
+        out.assign(data, len);
+        return true;
+    }
+};
+
+template<typename M>
+struct RowMemberTraits<std::optional<M>>
+{
+    static constexpr bool kNullable = true;
+    static constexpr const char* kName = RowMemberTraits<M>::kName;
+
+    static bool accepts(const MysqlField& field)
+    {
+        return field.type() == MysqlFieldType::NULL_TYPE || RowMemberTraits<M>::accepts(field);
+    }
+
+    static bool decode(const char* data, size_t len, std::optional<M>& out)
+    {
+        return RowMemberTraits<M>::decode(data, len, out.emplace());
+    }
+};
+
+template<typename M>
+concept RowMember = requires {
+    RowMemberTraits<std::remove_cvref_t<M>>::kNullable;
+};
+
+template<typename Tuple>
+struct AllRowMembers;
+
+template<typename... Ms>
+struct AllRowMembers<std::tuple<Ms...>>
+    : std::bool_constant<(RowMember<Ms> && ...)> {};
+
+template<typename T>
+auto tieRow(T& row)
+{
+    if constexpr (DescribedRow<T>) {
+        return row.mysqlFields();
+    } else {
+        return tieAggregate(row);
+    }
+}
+
+template<typename T>
+using RowTie = decltype(tieRow(std::declval<T&>()));
+
+inline std::expected<void, MysqlError> rowMappingError(size_t column, std::string reason)
+{
+    return std::unexpected(MysqlError(MYSQL_ERROR_ROW_MAPPING,
+                                      "column " + std::to_string(column) + ": " + std::move(reason)));
+}
+
+template<typename M>
+std::expected<void, MysqlError> decodeTextColumn(const char* payload, size_t len, size_t& pos,
+                                                 size_t column, M& member)
+{
+    using Traits = RowMemberTraits<std::remove_cvref_t<M>>;
+
+    if (pos >= len) {
+        return rowMappingError(column, "row packet truncated");
+    }
+
+    const uint8_t first = static_cast<uint8_t>(payload[pos]);
+    if (first == 0xFB) {
+        ++pos;
+        if constexpr (Traits::kNullable) {
+            member.reset();
+            return {};
+        } else {
+            return rowMappingError(column, "NULL value for non-optional member");
+        }
+    }
+
+    // 内联length-encoded整数解析，避免逐列经过readLenEncInt的expected包装
+    uint64_t value_len = 0;
+    size_t header_len = 0;
+    if (first < 0xFB) {
+        value_len = first;
+        header_len = 1;
+    } else if (first == 0xFC && pos + 3 <= len) {
+        value_len = static_cast<uint8_t>(payload[pos + 1]) |
+                    (static_cast<uint64_t>(static_cast<uint8_t>(payload[pos + 2])) << 8);
+        header_len = 3;
+    } else if (first == 0xFD && pos + 4 <= len) {
+        value_len = static_cast<uint8_t>(payload[pos + 1]) |
+                    (static_cast<uint64_t>(static_cast<uint8_t>(payload[pos + 2])) << 8) |
+                    (static_cast<uint64_t>(static_cast<uint8_t>(payload[pos + 3])) << 16);
+        header_len = 4;
+    } else if (first == 0xFE && pos + 9 <= len) {
+        for (size_t i = 0; i < 8; ++i) {
+            value_len |= static_cast<uint64_t>(static_cast<uint8_t>(payload[pos + 1 + i])) << (8 * i);
+        }
+        header_len = 9;
+    } else {
+        return rowMappingError(column, "invalid length-encoded value");
+    }
+
+    pos += header_len;
+    if (value_len > len - pos) {
+        return rowMappingError(column, "row packet truncated");
+    }
+
+    const char* data = payload + pos;
+    pos += static_cast<size_t>(value_len);
+    if (!Traits::decode(data, static_cast<size_t>(value_len), member)) {
+        return rowMappingError(column, std::string("cannot convert '") +
+                                       std::string(data, static_cast<size_t>(value_len)) +
+                                       "' to " + Traits::kName);
+    }
+    return {};
+}
+
+} // namespace detail
+
+/**
+ * @brief 可直接由结果集行映射的类型
+ * @details 声明了MYSQL_FIELDS的类型，或成员均为受支持标量的聚合体。
+ *          受支持的成员类型：整数、bool、浮点、std::string及其std::optional包装（NULL映射为nullopt）。
+ */
+template<typename T>
+concept MysqlRowMappable = std::is_default_constructible_v<T> &&
+                           (detail::DescribedRow<T> || detail::AggregateRow<T>) &&
+                           detail::AllRowMembers<std::remove_cvref_t<detail::RowTie<T>>>::value;
+
+/**
+ * @brief 映射类型的列数（编译期常量）
+ */
+template<MysqlRowMappable T>
+inline constexpr size_t kMysqlRowColumnCount =
+    std::tuple_size_v<std::remove_cvref_t<detail::RowTie<T>>>;
+
+/**
+ * @brief 校验结果集列定义与映射类型是否匹配（每个结果集调用一次）
+ */
+template<MysqlRowMappable T>
+std::expected<void, MysqlError> mysqlCheckColumns(std::span<const MysqlField> fields)
+{
+    using Tie = std::remove_cvref_t<detail::RowTie<T>>;
+    constexpr size_t expected_count = kMysqlRowColumnCount<T>;
+
+    if (fields.size() != expected_count) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_ROW_MAPPING,
+            "column count mismatch: result has " + std::to_string(fields.size()) +
+            ", mapped type expects " + std::to_string(expected_count)));
+    }
+
+    std::expected<void, MysqlError> result;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (void)((([&] {
+            using Member = std::remove_cvref_t<std::tuple_element_t<I, Tie>>;
+            using Traits = detail::RowMemberTraits<Member>;
+            const MysqlField& field = fields[I];
+            if (!Traits::kNullable && field.type() == MysqlFieldType::NULL_TYPE) {
+                result = detail::rowMappingError(I, "'" + field.name() + "' is always NULL");
+                return false;
+            }
+            if (!Traits::accepts(field)) {
+                result = detail::rowMappingError(I, "'" + field.name() + "' cannot be mapped to " +
+                                                    Traits::kName);
+                return false;
+            }
+            return true;
+        }()) && ...));
+    }(std::make_index_sequence<expected_count>{});
+    return result;
+}
+
+/**
+ * @brief 将一个text protocol行包直接解码到对象成员
+ * @details 每列按编译期展开的成员类型解码，不构造中间字符串
+ */
+template<MysqlRowMappable T>
+std::expected<void, MysqlError> mysqlDecodeTextRow(const char* payload, size_t len, T& out)
+{
+    auto members = detail::tieRow(out);
+    size_t pos = 0;
+    std::expected<void, MysqlError> result;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (void)(((result = detail::decodeTextColumn(payload, len, pos, I, std::get<I>(members))).has_value() && ...));
+    }(std::make_index_sequence<kMysqlRowColumnCount<T>>{});
+    return result;
+}
+
+/**
+ * @brief 将行直接收集为std::vector<T>的接收器
+ */
+template<MysqlRowMappable T>
+class MysqlRowCollector final : public MysqlRowSink
+{
+public:
+    std::expected<void, MysqlError> onColumns(std::span<const MysqlField> fields) override
+    {
+        return mysqlCheckColumns<T>(fields);
+    }
+
+    std::expected<void, MysqlError> onRow(const char* payload, size_t len) override
+    {
+        auto decoded = mysqlDecodeTextRow(payload, len, m_rows.emplace_back());
+        if (!decoded) {
+            m_rows.pop_back();
+        }
+        return decoded;
+    }
+
+    void reserve(size_t n) { m_rows.reserve(n); }
+    std::vector<T>& rows() { return m_rows; }
+
+private:
+    std::vector<T> m_rows;
+};
+
+} // namespace galay::mysql
+
+#endif // GALAY_MYSQL_ROW_MAPPER_H
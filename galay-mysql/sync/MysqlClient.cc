@@ -1,11 +1,13 @@
 #include "MysqlClient.h"
+#include "galay-mysql/base/MysqlResolver.h"
+#include "galay-mysql/protocol/MysqlResultDecoder.h"
 
 #include <algorithm>
 #include <arpa/inet.h>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
-#include <fcntl.h>
-#include <netdb.h>
+#include <limits>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <poll.h>
@@ -41,6 +43,23 @@ inline MysqlError makeSysError(MysqlErrorType type, const std::string& prefix)
     return MysqlError(type, prefix + ": " + std::string(strerror(errno)));
 }
 
+bool fillSockaddr(const MysqlResolvedAddress& address, uint16_t port,
+                  struct sockaddr_storage& storage, socklen_t& length)
+{
+    if (address.family == AF_INET6) {
+        auto* addr = reinterpret_cast<struct sockaddr_in6*>(&storage);
+        addr->sin6_family = AF_INET6;
+        addr->sin6_port = htons(port);
+        length = sizeof(struct sockaddr_in6);
+        return ::inet_pton(AF_INET6, address.ip.c_str(), &addr->sin6_addr) == 1;
+    }
+    auto* addr = reinterpret_cast<struct sockaddr_in*>(&storage);
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    length = sizeof(struct sockaddr_in);
+    return ::inet_pton(AF_INET, address.ip.c_str(), &addr->sin_addr) == 1;
+}
+
 } // namespace
 
 MysqlClient::MysqlClient()
@@ -63,6 +82,9 @@ MysqlClient::MysqlClient(MysqlClient&& other) noexcept
     , m_parser(std::move(other.m_parser))
     , m_encoder(std::move(other.m_encoder))
     , m_server_capabilities(other.m_server_capabilities)
+    , m_connection_id(other.m_connection_id)
+    , m_send_timeout(other.m_send_timeout)
+    , m_recv_timeout(other.m_recv_timeout)
 {
     other.m_socket_fd = -1;
     other.m_connected = false;
@@ -81,6 +103,9 @@ MysqlClient& MysqlClient::operator=(MysqlClient&& other) noexcept
         m_parser = std::move(other.m_parser);
         m_encoder = std::move(other.m_encoder);
         m_server_capabilities = other.m_server_capabilities;
+        m_connection_id = other.m_connection_id;
+        m_send_timeout = other.m_send_timeout;
+        m_recv_timeout = other.m_recv_timeout;
 
         other.m_socket_fd = -1;
         other.m_connected = false;
@@ -89,79 +114,116 @@ MysqlClient& MysqlClient::operator=(MysqlClient&& other) noexcept
     return *this;
 }
 
-MysqlVoidResult MysqlClient::connectSocket(const std::string& host, uint16_t port, uint32_t timeout_ms)
+MysqlVoidResult MysqlClient::connectSocket(const MysqlConfig& config)
 {
     closeSocket();
 
-    m_socket_fd = ::socket(AF_INET, SOCK_STREAM, 0);
-    if (m_socket_fd < 0) {
-        return std::unexpected(makeSysError(MYSQL_ERROR_CONNECTION, "Failed to create socket"));
-    }
-
-    const int original_flags = fcntl(m_socket_fd, F_GETFL, 0);
-    if (original_flags < 0) {
-        closeSocket();
-        return std::unexpected(makeSysError(MYSQL_ERROR_CONNECTION, "Failed to get socket flags"));
-    }
-
-    if (fcntl(m_socket_fd, F_SETFL, original_flags | O_NONBLOCK) < 0) {
-        closeSocket();
-        return std::unexpected(makeSysError(MYSQL_ERROR_CONNECTION, "Failed to set non-block socket"));
-    }
-
-    struct sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-
-    if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) <= 0) {
-        struct addrinfo hints{};
-        hints.ai_family = AF_INET;
-        hints.ai_socktype = SOCK_STREAM;
-
-        struct addrinfo* result = nullptr;
-        const int ret = ::getaddrinfo(host.c_str(), nullptr, &hints, &result);
-        if (ret != 0 || result == nullptr) {
-            closeSocket();
-            return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION, "Failed to resolve host: " + host));
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(config.connect_timeout_ms);
+    const auto resolver = MysqlResolver::shared();
+    auto resolved = resolver->resolve(config.host);
+    if (!resolved) {
+        return std::unexpected(resolved.error());
+    }
+    const auto& addresses = resolved.value();
+
+    // Happy Eyeballs（RFC 8305）：按解析顺序依次发起非阻塞连接，相邻尝试间隔connect_attempt_delay_ms，
+    // 某次尝试失败时立即开始下一个，先完成的连接胜出，其余关闭
+    std::vector<struct pollfd> pending;
+    auto closePending = [&pending]() {
+        for (const auto& pfd : pending) {
+            ::close(pfd.fd);
+        }
+        pending.clear();
+    };
+    std::string last_error;
+    int winner = -1;
+    size_t next = 0;
+    auto next_start = Clock::now();
+    const auto attempt_delay = std::chrono::milliseconds(config.connect_attempt_delay_ms);
+
+    while (winner < 0) {
+        const auto now = Clock::now();
+        if (next < addresses.size() && (pending.empty() || now >= next_start)) {
+            const auto& address = addresses[next++];
+            next_start = now + attempt_delay;
+
+            struct sockaddr_storage storage{};
+            socklen_t storage_len = 0;
+            if (!fillSockaddr(address, config.port, storage, storage_len)) {
+                last_error = "Invalid address: " + address.ip;
+                continue;
+            }
+            const int fd = ::socket(address.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                last_error = "Failed to create socket: " + std::string(strerror(errno));
+                continue;
+            }
+            const int ret = ::connect(fd, reinterpret_cast<struct sockaddr*>(&storage), storage_len);
+            if (ret == 0) {
+                winner = fd;
+                break;
+            }
+            if (errno != EINPROGRESS) {
+                last_error = "Connect " + address.ip + " failed: " + std::string(strerror(errno));
+                ::close(fd);
+                continue;
+            }
+            pending.push_back(pollfd{fd, POLLOUT, 0});
+            continue;
         }
 
-        addr.sin_addr = reinterpret_cast<struct sockaddr_in*>(result->ai_addr)->sin_addr;
-        ::freeaddrinfo(result);
-    }
-
-    int ret = ::connect(m_socket_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
-    if (ret < 0 && errno != EINPROGRESS) {
-        closeSocket();
-        return std::unexpected(makeSysError(MYSQL_ERROR_CONNECTION, "Connect failed"));
-    }
-
-    if (ret < 0) {
-        struct pollfd pfd{};
-        pfd.fd = m_socket_fd;
-        pfd.events = POLLOUT;
-        const int poll_ret = ::poll(&pfd, 1, static_cast<int>(timeout_ms));
-        if (poll_ret <= 0) {
-            closeSocket();
+        if (pending.empty()) {
+            // 所有地址都已失败，解析结果可能已过时（如故障转移后DNS已切换），下次连接重新解析
+            resolver->invalidate(config.host);
+            return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION,
+                                              last_error.empty() ? "Connect failed" : last_error));
+        }
+        if (now >= deadline) {
+            closePending();
             return std::unexpected(MysqlError(MYSQL_ERROR_TIMEOUT, "Connection timed out"));
         }
 
-        int sock_error = 0;
-        socklen_t sock_error_len = sizeof(sock_error);
-        if (::getsockopt(m_socket_fd, SOL_SOCKET, SO_ERROR, &sock_error, &sock_error_len) < 0) {
-            closeSocket();
-            return std::unexpected(makeSysError(MYSQL_ERROR_CONNECTION, "getsockopt failed"));
+        auto wait_until = deadline;
+        if (next < addresses.size()) {
+            wait_until = std::min(wait_until, next_start);
         }
-        if (sock_error != 0) {
-            closeSocket();
-            return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION,
-                                              "Connect failed: " + std::string(strerror(sock_error))));
+        const auto wait_ms = std::chrono::ceil<std::chrono::milliseconds>(wait_until - now).count();
+        const int poll_ret = ::poll(pending.data(), pending.size(), static_cast<int>(std::max<int64_t>(wait_ms, 0)));
+        if (poll_ret < 0 && errno != EINTR) {
+            closePending();
+            return std::unexpected(makeSysError(MYSQL_ERROR_CONNECTION, "poll failed"));
+        }
+        if (poll_ret <= 0) {
+            continue;
         }
-    }
 
-    if (fcntl(m_socket_fd, F_SETFL, original_flags) < 0) {
-        closeSocket();
-        return std::unexpected(makeSysError(MYSQL_ERROR_CONNECTION, "Failed to restore socket flags"));
+        for (size_t i = 0; i < pending.size();) {
+            if (pending[i].revents == 0) {
+                ++i;
+                continue;
+            }
+            const int fd = pending[i].fd;
+            int sock_error = 0;
+            socklen_t sock_error_len = sizeof(sock_error);
+            if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &sock_error, &sock_error_len) < 0) {
+                sock_error = errno;
+            }
+            pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+            if (sock_error == 0) {
+                winner = fd;
+                break;
+            }
+            last_error = "Connect failed: " + std::string(strerror(sock_error));
+            ::close(fd);
+            next_start = Clock::now();
+        }
     }
+    closePending();
+    // 套接字保持非阻塞，收发经poll等待，超时由每条命令的截止时间控制；握手同样受connect_timeout_ms限制
+    m_socket_fd = winner;
+    m_send_deadline = deadline;
+    m_recv_deadline = deadline;
 
     const int nodelay = 1;
     (void)::setsockopt(m_socket_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
@@ -185,7 +247,7 @@ void MysqlClient::closeSocket() noexcept
 
 MysqlVoidResult MysqlClient::connect(const MysqlConfig& config)
 {
-    auto conn_result = connectSocket(config.host, config.port, config.connect_timeout_ms);
+    auto conn_result = connectSocket(config);
     if (!conn_result) {
         return std::unexpected(conn_result.error());
     }
@@ -213,6 +275,7 @@ MysqlVoidResult MysqlClient::connect(const MysqlConfig& config)
         return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse handshake"));
     }
     m_server_capabilities = hs->capability_flags;
+    m_connection_id = hs->connection_id;
 
     protocol::HandshakeResponse41 resp;
     resp.capability_flags = protocol::CLIENT_PROTOCOL_41
@@ -222,18 +285,29 @@ MysqlVoidResult MysqlClient::connect(const MysqlConfig& config)
         | protocol::CLIENT_MULTI_STATEMENTS
         | protocol::CLIENT_MULTI_RESULTS
         | protocol::CLIENT_PS_MULTI_RESULTS
-        | protocol::CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA;
+        | protocol::CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA
+        | protocol::CLIENT_SESSION_TRACK;
 
     if (!config.database.empty()) {
         resp.capability_flags |= protocol::CLIENT_CONNECT_WITH_DB;
     }
+    if (config.allow_local_infile) {
+        resp.capability_flags |= protocol::CLIENT_LOCAL_FILES;
+    }
+    if (!config.connect_attributes.empty()) {
+        resp.capability_flags |= protocol::CLIENT_CONNECT_ATTRS;
+    }
 
     resp.capability_flags &= hs->capability_flags;
     m_server_capabilities = resp.capability_flags;
-    resp.character_set = protocol::CHARSET_UTF8MB4_GENERAL_CI;
+    const auto collation = protocol::collationIdForCharset(config.charset);
+    resp.character_set = collation.value_or(protocol::CHARSET_UTF8MB4_GENERAL_CI);
     resp.username = config.username;
     resp.database = config.database;
     resp.auth_plugin_name = hs->auth_plugin_name;
+    if (resp.capability_flags & protocol::CLIENT_CONNECT_ATTRS) {
+        resp.connect_attributes = protocol::buildConnectAttributes(config);
+    }
 
     if (hs->auth_plugin_name == "mysql_native_password") {
         resp.auth_response = protocol::AuthPlugin::nativePasswordAuth(config.password, hs->auth_plugin_data);
@@ -244,6 +318,19 @@ MysqlVoidResult MysqlClient::connect(const MysqlConfig& config)
         resp.auth_plugin_name = "mysql_native_password";
     }
 
+    // 会话变量与初始化语句在认证成功后合并为一条请求
+    const std::string init_sql = protocol::buildSessionInitSql(config, collation.has_value());
+    auto init_session = [&]() -> MysqlVoidResult {
+        if (init_sql.empty()) {
+            return {};
+        }
+        auto init_result = queryMulti(init_sql);
+        if (!init_result) {
+            return std::unexpected(init_result.error());
+        }
+        return {};
+    };
+
     auto auth_packet = m_encoder.encodeHandshakeResponse(resp, static_cast<uint8_t>(seq_id + 1));
     auto send_result = sendAll(auth_packet);
     if (!send_result) {
@@ -263,7 +350,7 @@ MysqlVoidResult MysqlClient::connect(const MysqlConfig& config)
 
     const uint8_t first_byte = static_cast<uint8_t>(auth_payload[0]);
     if (first_byte == 0x00) {
-        return {};
+        return init_session();
     }
 
     if (first_byte == 0xFF) {
@@ -283,7 +370,7 @@ MysqlVoidResult MysqlClient::connect(const MysqlConfig& config)
             auto& [ok_seq, ok_payload] = ok_result.value();
             (void)ok_seq;
             if (!ok_payload.empty() && static_cast<uint8_t>(ok_payload[0]) == 0x00) {
-                return {};
+                return init_session();
             }
             if (!ok_payload.empty() && static_cast<uint8_t>(ok_payload[0]) == 0xFF) {
                 auto err = m_parser.parseErr(ok_payload.data(), ok_payload.size(), m_server_capabilities);
@@ -292,7 +379,7 @@ MysqlVoidResult MysqlClient::connect(const MysqlConfig& config)
                 }
                 return std::unexpected(MysqlError(MYSQL_ERROR_AUTH, "Authentication failed"));
             }
-            return {};
+            return init_session();
         }
         return std::unexpected(MysqlError(MYSQL_ERROR_AUTH, "Full auth not supported"));
     }
@@ -307,60 +394,74 @@ MysqlVoidResult MysqlClient::connect(const std::string& host, uint16_t port,
     return connect(MysqlConfig::create(host, port, user, password, database));
 }
 
-MysqlVoidResult MysqlClient::sendAll(std::string_view data)
+void MysqlClient::setTimeouts(std::chrono::milliseconds send, std::chrono::milliseconds recv)
 {
-    if (!m_connected) {
-        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Not connected"));
+    m_send_timeout = send;
+    m_recv_timeout = recv;
+}
+
+std::optional<MysqlClient::Clock::time_point> MysqlClient::deadlineFor(std::chrono::milliseconds timeout) const
+{
+    if (timeout < std::chrono::milliseconds(0)) {
+        return std::nullopt;
     }
+    return Clock::now() + timeout;
+}
 
-    size_t total_sent = 0;
-    while (total_sent < data.size()) {
-        const ssize_t n = ::send(m_socket_fd,
-                                 data.data() + total_sent,
-                                 data.size() - total_sent,
-                                 0);
-        if (n < 0) {
+void MysqlClient::startCommand()
+{
+    m_send_deadline = deadlineFor(m_send_timeout);
+    m_recv_deadline = deadlineFor(m_recv_timeout);
+}
+
+std::expected<short, MysqlError> MysqlClient::waitReady(short events, std::optional<Clock::time_point> deadline)
+{
+    while (true) {
+        int timeout_ms = -1;
+        if (deadline.has_value()) {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(*deadline - Clock::now()).count();
+            if (left <= 0) {
+                // 请求或响应停在中途，连接无法再回到响应边界
+                closeSocket();
+                return std::unexpected(MysqlError(MYSQL_ERROR_TIMEOUT,
+                                                  (events & POLLIN) ? "Recv timed out" : "Send timed out"));
+            }
+            timeout_ms = static_cast<int>(std::min<int64_t>(left, std::numeric_limits<int>::max()));
+        }
+
+        struct pollfd pfd{};
+        pfd.fd = m_socket_fd;
+        pfd.events = events;
+        const int ret = ::poll(&pfd, 1, timeout_ms);
+        if (ret < 0) {
             if (errno == EINTR) {
                 continue;
             }
-            m_connected = false;
-            return std::unexpected(makeSysError(MYSQL_ERROR_SEND, "Send failed"));
+            auto error = makeSysError(MYSQL_ERROR_CONNECTION, "poll failed");
+            closeSocket();
+            return std::unexpected(std::move(error));
         }
-        if (n == 0) {
-            m_connected = false;
-            return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED,
-                                              "Connection closed during send"));
+        if (ret > 0) {
+            return pfd.revents;
         }
-        total_sent += static_cast<size_t>(n);
     }
-
-    return {};
 }
 
-MysqlVoidResult MysqlClient::sendAllv(std::span<const struct iovec> iovecs)
+std::expected<bool, MysqlError> MysqlClient::flushPending(PendingSend& pending)
 {
-    if (!m_connected) {
-        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Not connected"));
-    }
-    if (iovecs.empty()) {
-        return {};
-    }
-
-    size_t iov_index = 0;
-    size_t iov_offset = 0;
-
 #ifdef IOV_MAX
     static constexpr int kMaxWritevIov = IOV_MAX > 0 ? IOV_MAX : 1024;
 #else
     static constexpr int kMaxWritevIov = 1024;
 #endif
 
-    while (iov_index < iovecs.size()) {
+    const auto iovecs = pending.iovecs;
+    while (pending.index < iovecs.size()) {
         struct iovec window[kMaxWritevIov];
         int window_count = 0;
 
-        size_t cursor = iov_index;
-        size_t cursor_offset = iov_offset;
+        size_t cursor = pending.index;
+        size_t cursor_offset = pending.offset;
         while (cursor < iovecs.size() && window_count < kMaxWritevIov) {
             const auto& src = iovecs[cursor];
             if (src.iov_len == 0) {
@@ -384,6 +485,7 @@ MysqlVoidResult MysqlClient::sendAllv(std::span<const struct iovec> iovecs)
         }
 
         if (window_count == 0) {
+            pending.index = iovecs.size();
             break;
         }
 
@@ -392,6 +494,9 @@ MysqlVoidResult MysqlClient::sendAllv(std::span<const struct iovec> iovecs)
             if (errno == EINTR) {
                 continue;
             }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return false;
+            }
             m_connected = false;
             return std::unexpected(makeSysError(MYSQL_ERROR_SEND, "Writev failed"));
         }
@@ -402,27 +507,57 @@ MysqlVoidResult MysqlClient::sendAllv(std::span<const struct iovec> iovecs)
         }
 
         size_t sent = static_cast<size_t>(n);
-        while (sent > 0 && iov_index < iovecs.size()) {
-            const size_t cur_len = iovecs[iov_index].iov_len;
+        while (sent > 0 && pending.index < iovecs.size()) {
+            const size_t cur_len = iovecs[pending.index].iov_len;
             if (cur_len == 0) {
-                ++iov_index;
-                iov_offset = 0;
+                ++pending.index;
+                pending.offset = 0;
                 continue;
             }
 
-            const size_t remaining = cur_len - iov_offset;
+            const size_t remaining = cur_len - pending.offset;
             if (sent < remaining) {
-                iov_offset += sent;
+                pending.offset += sent;
                 sent = 0;
             } else {
                 sent -= remaining;
-                ++iov_index;
-                iov_offset = 0;
+                ++pending.index;
+                pending.offset = 0;
             }
         }
     }
 
-    return {};
+    return true;
+}
+
+MysqlVoidResult MysqlClient::sendAll(std::string_view data)
+{
+    struct iovec iov{};
+    iov.iov_base = const_cast<char*>(data.data());
+    iov.iov_len = data.size();
+    return sendAllv(std::span<const struct iovec>(&iov, 1));
+}
+
+MysqlVoidResult MysqlClient::sendAllv(std::span<const struct iovec> iovecs)
+{
+    if (!m_connected) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Not connected"));
+    }
+
+    PendingSend pending{iovecs};
+    while (true) {
+        auto flushed = flushPending(pending);
+        if (!flushed) {
+            return std::unexpected(flushed.error());
+        }
+        if (flushed.value()) {
+            return {};
+        }
+        auto ready = waitReady(POLLOUT, m_send_deadline);
+        if (!ready) {
+            return std::unexpected(ready.error());
+        }
+    }
 }
 
 MysqlVoidResult MysqlClient::recvIntoRingBuffer()
@@ -441,10 +576,32 @@ MysqlVoidResult MysqlClient::recvIntoRingBuffer()
     ssize_t n = -1;
     while (true) {
         n = ::readv(m_socket_fd, write_iovecs, static_cast<int>(write_count));
-        if (n < 0 && errno == EINTR) {
+        if (n >= 0) {
+            break;
+        }
+        if (errno == EINTR) {
             continue;
         }
-        break;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            break;
+        }
+
+        // 等待响应期间，batch()剩余的请求在套接字可写时继续写出
+        const bool sending = m_pending_send != nullptr && !m_pending_send->done();
+        auto deadline = m_recv_deadline;
+        if (sending && m_send_deadline.has_value()) {
+            deadline = deadline.has_value() ? std::min(*deadline, *m_send_deadline) : m_send_deadline;
+        }
+        auto ready = waitReady(sending ? (POLLIN | POLLOUT) : POLLIN, deadline);
+        if (!ready) {
+            return std::unexpected(ready.error());
+        }
+        if (sending && (ready.value() & POLLOUT)) {
+            auto flushed = flushPending(*m_pending_send);
+            if (!flushed) {
+                return std::unexpected(flushed.error());
+            }
+        }
     }
 
     if (n < 0) {
@@ -512,6 +669,7 @@ std::expected<MysqlClient::Packet, MysqlError> MysqlClient::recvPacket()
 
 MysqlResult MysqlClient::query(const std::string& sql)
 {
+    startCommand();
     auto cmd = m_encoder.encodeQuery(sql, 0);
     auto send_result = sendAll(cmd);
     if (!send_result) {
@@ -540,19 +698,39 @@ MysqlBatchResult MysqlClient::batch(std::span<const protocol::MysqlCommandView>
         iovecs.push_back(iov);
     }
 
-    auto send_result = sendAllv(std::span<const struct iovec>(iovecs.data(), iovecs.size()));
-    if (!send_result) {
-        return std::unexpected(send_result.error());
+    if (!m_connected) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_CONNECTION_CLOSED, "Not connected"));
     }
 
+    // 先写出套接字能接收的部分，其余在接收响应的同时写出：
+    // 结果较大时服务端会因发送缓冲写满而停止读取请求，先写完再读会使两端互相等待
+    startCommand();
+    PendingSend pending{std::span<const struct iovec>(iovecs.data(), iovecs.size())};
+    auto flushed = flushPending(pending);
+    if (!flushed) {
+        return std::unexpected(flushed.error());
+    }
+    m_pending_send = &pending;
+
     results.reserve(commands.size());
-    for (size_t i = 0; i < commands.size(); ++i) {
-        auto one = receiveResultSet();
+    std::vector<MysqlResultSet> following;
+    for (const auto& cmd : commands) {
+        following.clear();
+        auto one = receiveResultSet(cmd.kind == protocol::MysqlCommandKind::StmtExecute, &following);
         if (!one) {
+            m_pending_send = nullptr;
+            if (!pending.done()) {
+                // 请求只写出了一部分，连接无法继续使用
+                closeSocket();
+            }
             return std::unexpected(one.error());
         }
         results.push_back(std::move(one.value()));
+        for (auto& rs : following) {
+            results.push_back(std::move(rs));
+        }
     }
+    m_pending_send = nullptr;
 
     return results;
 }
@@ -577,139 +755,143 @@ MysqlBatchResult MysqlClient::pipeline(std::span<const std::string_view> sqls)
     return batch(builder.commands());
 }
 
-MysqlResult MysqlClient::receiveResultSet()
+MysqlBatchResult MysqlClient::queryMulti(const std::string& sql)
 {
-    auto pkt_result = recvPacket();
-    if (!pkt_result) {
-        return std::unexpected(pkt_result.error());
+    startCommand();
+    auto cmd = m_encoder.encodeQuery(sql, 0);
+    auto send_result = sendAll(cmd);
+    if (!send_result) {
+        return std::unexpected(send_result.error());
     }
 
-    auto& [seq_id, payload] = pkt_result.value();
-    (void)seq_id;
-
-    if (payload.empty()) {
-        return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Empty server payload"));
+    std::vector<MysqlResultSet> results(1);
+    auto first = receiveResultSet(false, &results);
+    if (!first) {
+        return std::unexpected(first.error());
     }
+    results.front() = std::move(first.value());
+    return results;
+}
 
-    const uint8_t first_byte = static_cast<uint8_t>(payload[0]);
-
-    if (first_byte == 0xFF) {
-        auto err = m_parser.parseErr(payload.data(), payload.size(), m_server_capabilities);
-        if (err) {
-            return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-        }
-        return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Query error"));
+MysqlResult MysqlClient::loadLocalInfile(const std::string& sql, MysqlLocalInfileSource source)
+{
+    if (!(m_server_capabilities & protocol::CLIENT_LOCAL_FILES)) {
+        return std::unexpected(MysqlError(MYSQL_ERROR_INVALID_PARAM,
+                                          "LOCAL INFILE is disabled, set MysqlConfig::allow_local_infile"));
     }
-
-    if (first_byte == 0x00) {
-        auto ok = m_parser.parseOk(payload.data(), payload.size(), m_server_capabilities);
-        if (!ok) {
-            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse OK packet"));
-        }
-
-        MysqlResultSet rs;
-        rs.setAffectedRows(ok->affected_rows);
-        rs.setLastInsertId(ok->last_insert_id);
-        rs.setWarnings(ok->warnings);
-        rs.setStatusFlags(ok->status_flags);
-        rs.setInfo(ok->info);
-        return rs;
+    startCommand();
+    auto cmd = m_encoder.encodeQuery(sql, 0);
+    auto send_result = sendAll(cmd);
+    if (!send_result) {
+        return std::unexpected(send_result.error());
     }
+    return receiveResultSet(false, nullptr, &source);
+}
 
-    size_t int_consumed = 0;
-    auto col_count_result = protocol::readLenEncInt(payload.data(), payload.size(), int_consumed);
-    if (!col_count_result) {
-        return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column count"));
+MysqlVoidResult MysqlClient::sendLocalInfile(MysqlLocalInfileSource* source, uint8_t sequence_id,
+                                             std::optional<MysqlError>& source_error)
+{
+    if (source == nullptr) {
+        source_error = MysqlError(MYSQL_ERROR_PROTOCOL, "LOCAL INFILE request requires loadLocalInfile()");
     }
 
-    const uint64_t col_count = col_count_result.value();
-    MysqlResultSet rs;
-
-    for (uint64_t i = 0; i < col_count; ++i) {
-        auto col_pkt = recvPacket();
-        if (!col_pkt) {
-            return std::unexpected(col_pkt.error());
+    // 数据直接读进包体，头部在读完后回填；0字节的包结束传输
+    const size_t capacity = source != nullptr ? source->chunkBytes() : 0;
+    std::string packet(protocol::MYSQL_PACKET_HEADER_SIZE + capacity, '\0');
+    while (true) {
+        size_t length = 0;
+        if (!source_error.has_value()) {
+            auto n = source->read(packet.data() + protocol::MYSQL_PACKET_HEADER_SIZE, capacity);
+            if (n) {
+                length = std::min(n.value(), capacity);
+            } else {
+                source_error = std::move(n.error());
+            }
         }
-
-        auto& [cseq, cpayload] = col_pkt.value();
-        (void)cseq;
-        auto col = m_parser.parseColumnDefinition(cpayload.data(), cpayload.size());
-        if (!col) {
-            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse column definition"));
+        packet[0] = static_cast<char>(length & 0xFF);
+        packet[1] = static_cast<char>((length >> 8) & 0xFF);
+        packet[2] = static_cast<char>((length >> 16) & 0xFF);
+        packet[3] = static_cast<char>(sequence_id++);
+        auto sent = sendAll(std::string_view(packet.data(), protocol::MYSQL_PACKET_HEADER_SIZE + length));
+        if (!sent) {
+            return sent;
         }
-
-        MysqlField field(col->name,
-                         static_cast<MysqlFieldType>(col->column_type),
-                         col->flags,
-                         col->column_length,
-                         col->decimals);
-        field.setCatalog(col->catalog);
-        field.setSchema(col->schema);
-        field.setTable(col->table);
-        field.setOrgTable(col->org_table);
-        field.setOrgName(col->org_name);
-        field.setCharacterSet(col->character_set);
-        rs.addField(std::move(field));
-    }
-
-    if (!(m_server_capabilities & protocol::CLIENT_DEPRECATE_EOF)) {
-        auto eof_pkt = recvPacket();
-        if (!eof_pkt) {
-            return std::unexpected(eof_pkt.error());
+        if (length == 0) {
+            return {};
         }
     }
+}
+
+MysqlResult MysqlClient::receiveResultSet(bool binary_rows,
+                                          std::vector<MysqlResultSet>* following,
+                                          MysqlLocalInfileSource* infile)
+{
+    protocol::MysqlResultDecoder decoder;
+    decoder.reset(m_server_capabilities,
+                  binary_rows ? protocol::MysqlRowFormat::Binary : protocol::MysqlRowFormat::Text);
+    std::optional<MysqlResultSet> first;
+    MysqlResultSet rs;
+    std::optional<MysqlError> infile_error;
 
     while (true) {
-        auto row_pkt = recvPacket();
-        if (!row_pkt) {
-            return std::unexpected(row_pkt.error());
+        struct iovec read_iovecs[2];
+        const size_t read_count = m_recv_ring_buffer.getReadIovecs(read_iovecs, 2);
+        auto linear = linearizeReadIovecs(std::span<const struct iovec>(read_iovecs, read_count), m_parse_scratch);
+
+        size_t consumed = 0;
+        auto event = decoder.feed(linear.data(), linear.size(), consumed);
+        if (!event) {
+            m_recv_ring_buffer.consume(consumed);
+            return std::unexpected(std::move(event.error()));
         }
-
-        auto& [rseq, rpayload] = row_pkt.value();
-        (void)rseq;
-
-        if (rpayload.empty()) {
-            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Empty row payload"));
+        if (event->type == protocol::MysqlResultEventType::NeedMore) {
+            auto recv_result = recvIntoRingBuffer();
+            if (!recv_result) {
+                return std::unexpected(recv_result.error());
+            }
+            continue;
         }
 
-        const uint8_t fb = static_cast<uint8_t>(rpayload[0]);
-        if (fb == 0xFE && rpayload.size() < 0xFFFFFF) {
-            if (m_server_capabilities & protocol::CLIENT_DEPRECATE_EOF) {
-                auto ok = m_parser.parseOk(rpayload.data(), rpayload.size(), m_server_capabilities);
-                if (ok) {
-                    rs.setWarnings(ok->warnings);
-                    rs.setStatusFlags(ok->status_flags);
-                }
-            } else {
-                auto eof = m_parser.parseEof(rpayload.data(), rpayload.size());
-                if (eof) {
-                    rs.setWarnings(eof->warnings);
-                    rs.setStatusFlags(eof->status_flags);
-                }
+        if (event->type == protocol::MysqlResultEventType::LocalInfile) {
+            // 无论是否提供数据源都要应答，连接才能回到响应边界
+            const auto sequence_id = static_cast<uint8_t>(event->sequence_id + 1);
+            m_recv_ring_buffer.consume(consumed);
+            auto sent = sendLocalInfile(infile, sequence_id, infile_error);
+            if (!sent) {
+                return std::unexpected(sent.error());
             }
-            break;
+            continue;
         }
 
-        if (fb == 0xFF) {
-            auto err = m_parser.parseErr(rpayload.data(), rpayload.size(), m_server_capabilities);
-            if (err) {
-                return std::unexpected(MysqlError(MYSQL_ERROR_SERVER, err->error_code, err->error_message));
-            }
-            return std::unexpected(MysqlError(MYSQL_ERROR_QUERY, "Error during row fetch"));
+        // 行数据直接从接收缓冲解码，处理完事件后再消费
+        auto done = decoder.apply(*event, rs);
+        m_recv_ring_buffer.consume(consumed);
+        if (!done) {
+            return std::unexpected(std::move(done.error()));
+        }
+        if (!done.value()) {
+            continue;
         }
 
-        auto row = m_parser.parseTextRow(rpayload.data(), rpayload.size(), col_count);
-        if (!row) {
-            return std::unexpected(MysqlError(MYSQL_ERROR_PROTOCOL, "Failed to parse text row"));
+        const bool more = event->moreResults();
+        if (!first.has_value()) {
+            first = std::move(rs);
+        } else if (following != nullptr) {
+            following->push_back(std::move(rs));
         }
-        rs.addRow(MysqlRow(std::move(row.value())));
+        if (!more) {
+            if (infile_error.has_value()) {
+                return std::unexpected(std::move(*infile_error));
+            }
+            return std::move(*first);
+        }
+        rs = MysqlResultSet{};
     }
-
-    return rs;
 }
 
 std::expected<MysqlClient::PrepareResult, MysqlError> MysqlClient::prepare(const std::string& sql)
 {
+    startCommand();
     auto cmd = m_encoder.encodeStmtPrepare(sql, 0);
     auto send_result = sendAll(cmd);
     if (!send_result) {
@@ -768,16 +950,59 @@ MysqlResult MysqlClient::stmtExecute(uint32_t stmt_id,
                                      const std::vector<std::optional<std::string>>& params,
                                      const std::vector<uint8_t>& param_types)
 {
+    startCommand();
     auto cmd = m_encoder.encodeStmtExecute(stmt_id, params, param_types, 0);
     auto send_result = sendAll(cmd);
     if (!send_result) {
         return std::unexpected(send_result.error());
     }
-    return receiveResultSet();
+    return receiveResultSet(true);
+}
+
+MysqlResult MysqlClient::stmtExecute(uint32_t stmt_id,
+                                     const std::vector<std::optional<std::string>>& params,
+                                     const std::vector<uint8_t>& param_types,
+                                     std::span<const uint16_t> long_data_params)
+{
+    startCommand();
+    std::string cmd;
+    m_encoder.encodeStmtExecuteInto(cmd, stmt_id, params, param_types, long_data_params, 0);
+    auto send_result = sendAll(cmd);
+    if (!send_result) {
+        return std::unexpected(send_result.error());
+    }
+    return receiveResultSet(true);
+}
+
+MysqlVoidResult MysqlClient::stmtSendLongData(uint32_t stmt_id, uint16_t param_id, MysqlLongDataSource source)
+{
+    startCommand();
+    // 数据直接读进包体，前缀在读完后回填；空数据源也发送一个包，使参数成为空串
+    const size_t capacity = std::min<size_t>(source.chunkBytes(), protocol::MYSQL_STMT_LONG_DATA_MAX_CHUNK);
+    std::string packet(protocol::MYSQL_STMT_LONG_DATA_PREFIX_SIZE + capacity, '\0');
+    for (size_t packets = 0;; ++packets) {
+        auto n = source.read(packet.data() + protocol::MYSQL_STMT_LONG_DATA_PREFIX_SIZE, capacity);
+        if (!n) {
+            return std::unexpected(std::move(n.error()));
+        }
+        const size_t length = std::min(n.value(), capacity);
+        if (length == 0 && packets > 0) {
+            return {};
+        }
+        protocol::MysqlEncoder::writeStmtSendLongDataPrefix(packet.data(), stmt_id, param_id, length, 0);
+        auto sent = sendAll(std::string_view(packet.data(), protocol::MYSQL_STMT_LONG_DATA_PREFIX_SIZE + length));
+        if (!sent) {
+            return sent;
+        }
+        if (length == 0) {
+            return {};
+        }
+    }
 }
 
 MysqlVoidResult MysqlClient::stmtClose(uint32_t stmt_id)
 {
+    startCommand();
     auto cmd = m_encoder.encodeStmtClose(stmt_id, 0);
     return sendAll(cmd);
 }
@@ -796,6 +1021,7 @@ MysqlVoidResult MysqlClient::commit() { return executeSimple("COMMIT"); }
 MysqlVoidResult MysqlClient::rollback() { return executeSimple("ROLLBACK"); }
 MysqlVoidResult MysqlClient::ping() { return executeSimple("SELECT 1"); }
 MysqlVoidResult MysqlClient::useDatabase(const std::string& database) { return executeSimple("USE " + database); }
+MysqlVoidResult MysqlClient::killQuery(uint32_t connection_id) { return executeSimple("KILL QUERY " + std::to_string(connection_id)); }
 
 void MysqlClient::close()
 {
@@ -804,6 +1030,7 @@ void MysqlClient::close()
         return;
     }
 
+    startCommand();
     auto quit = m_encoder.encodeQuit(0);
     (void)sendAll(quit);  // best effort
     closeSocket();
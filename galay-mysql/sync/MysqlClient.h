@@ -3,6 +3,7 @@
 
 #include "galay-mysql/base/MysqlConfig.h"
 #include "galay-mysql/base/MysqlError.h"
+#include "galay-mysql/base/MysqlLocalInfile.h"
 #include "galay-mysql/base/MysqlValue.h"
 #include "galay-mysql/protocol/Builder.h"
 #include "galay-mysql/protocol/MysqlAuth.h"
@@ -10,6 +11,7 @@
 
 #include <galay-kernel/common/Buffer.h>
 
+#include <chrono>
 #include <cstdint>
 #include <expected>
 #include <optional>
@@ -54,6 +56,19 @@ public:
     MysqlBatchResult batch(std::span<const protocol::MysqlCommandView> commands);
     MysqlBatchResult pipeline(std::span<const std::string_view> sqls);
 
+    /**
+     * @brief 执行多语句（或CALL存储过程）并返回全部结果集
+     * @details query()只返回第一个结果集，其余读完丢弃
+     */
+    MysqlBatchResult queryMulti(const std::string& sql);
+
+    /**
+     * @brief 执行LOAD DATA LOCAL INFILE，从source流式发送数据
+     * @details 需在MysqlConfig中开启allow_local_infile；服务端请求的文件名被忽略。
+     *          source出错时以空包提前结束传输，读完响应后返回该错误（已发送部分可能已写入）。
+     */
+    MysqlResult loadLocalInfile(const std::string& sql, MysqlLocalInfileSource source);
+
     // ======================== 预处理语句 ========================
 
     struct PrepareResult {
@@ -66,6 +81,21 @@ public:
     MysqlResult stmtExecute(uint32_t stmt_id,
                             const std::vector<std::optional<std::string>>& params,
                             const std::vector<uint8_t>& param_types = {});
+
+    /**
+     * @brief 执行预处理语句，long_data_params中的参数使用此前stmtSendLongData发送的数据
+     * @details params仍需覆盖全部参数，长数据参数所在位置的值被忽略
+     */
+    MysqlResult stmtExecute(uint32_t stmt_id,
+                            const std::vector<std::optional<std::string>>& params,
+                            const std::vector<uint8_t>& param_types,
+                            std::span<const uint16_t> long_data_params);
+
+    /**
+     * @brief 以COM_STMT_SEND_LONG_DATA逐块发送参数param_id的数据（服务端不回复，各块连续写出）
+     * @details 峰值内存为一个包缓冲；数据源出错时已发送的部分留在服务端，应stmtClose后重新prepare
+     */
+    MysqlVoidResult stmtSendLongData(uint32_t stmt_id, uint16_t param_id, MysqlLongDataSource source);
     MysqlVoidResult stmtClose(uint32_t stmt_id);
 
     // ======================== 事务 ========================
@@ -79,6 +109,27 @@ public:
     MysqlVoidResult ping();
     MysqlVoidResult useDatabase(const std::string& database);
 
+    /**
+     * @brief 服务端分配的连接ID（HandshakeV10中的thread id）
+     */
+    uint32_t connectionId() const { return m_connection_id; }
+
+    /**
+     * @brief 中断另一个连接上正在执行的语句
+     * @details 被中断的连接随后收到ERR 1317并停在响应边界上，可继续使用
+     */
+    MysqlVoidResult killQuery(uint32_t connection_id);
+
+    // ======================== 超时 ========================
+
+    /**
+     * @brief 设置命令超时，负值表示不限制（默认）
+     * @details 每条命令开始时计时：请求须在send内写完，响应须在recv内读完（从命令开始算起，而不是每次读取）。
+     *          超时返回MYSQL_ERROR_TIMEOUT并关闭连接，因为响应边界已无法确定；服务端上的语句可能仍在执行，
+     *          需要时从另一条连接killQuery()。握手阶段使用MysqlConfig::connect_timeout_ms。
+     */
+    void setTimeouts(std::chrono::milliseconds send, std::chrono::milliseconds recv);
+
     // ======================== 连接管理 ========================
 
     void close();
@@ -86,12 +137,43 @@ public:
 
 private:
     using Packet = std::pair<uint8_t, std::string>;
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 尚未写完的请求，发送进度记录在index/offset中
+     */
+    struct PendingSend
+    {
+        std::span<const struct iovec> iovecs;
+        size_t index = 0;
+        size_t offset = 0;
+
+        bool done() const { return index >= iovecs.size(); }
+    };
 
     static constexpr size_t kRecvBufferCapacity = 256 * 1024;
 
-    MysqlVoidResult connectSocket(const std::string& host, uint16_t port, uint32_t timeout_ms);
+    MysqlVoidResult connectSocket(const MysqlConfig& config);
     void closeSocket() noexcept;
 
+    /**
+     * @brief 按超时设置为当前命令计算收发截止时间
+     */
+    void startCommand();
+    std::optional<Clock::time_point> deadlineFor(std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief 等待套接字就绪
+     * @return 就绪的事件；超过deadline时关闭连接并返回MYSQL_ERROR_TIMEOUT
+     */
+    std::expected<short, MysqlError> waitReady(short events, std::optional<Clock::time_point> deadline);
+
+    /**
+     * @brief 非阻塞地写出pending，直到写完或套接字写满
+     * @return 是否已写完
+     */
+    std::expected<bool, MysqlError> flushPending(PendingSend& pending);
+
     MysqlVoidResult sendAll(std::string_view data);
     MysqlVoidResult sendAllv(std::span<const struct iovec> iovecs);
 
@@ -99,7 +181,21 @@ private:
     std::expected<std::optional<Packet>, MysqlError> tryExtractPacket();
     std::expected<Packet, MysqlError> recvPacket();
 
-    MysqlResult receiveResultSet();
+    /**
+     * @brief 接收一条命令的响应
+     * @param following 非空时追加SERVER_MORE_RESULTS_EXISTS后续的结果集，否则读完丢弃
+     * @return 第一个结果集
+     */
+    MysqlResult receiveResultSet(bool binary_rows = false,
+                                 std::vector<MysqlResultSet>* following = nullptr,
+                                 MysqlLocalInfileSource* infile = nullptr);
+
+    /**
+     * @brief 应答LOCAL INFILE请求：逐块发送source数据并以空包结束；source为空时只发空包拒绝
+     * @return 传输错误；数据源错误写入source_error，传输仍正常结束
+     */
+    MysqlVoidResult sendLocalInfile(MysqlLocalInfileSource* source, uint8_t sequence_id,
+                                    std::optional<MysqlError>& source_error);
     MysqlVoidResult executeSimple(const std::string& sql);
 
     int m_socket_fd;
@@ -110,6 +206,14 @@ private:
     protocol::MysqlParser m_parser;
     protocol::MysqlEncoder m_encoder;
     uint32_t m_server_capabilities = 0;
+    uint32_t m_connection_id = 0;
+
+    std::chrono::milliseconds m_send_timeout{-1};
+    std::chrono::milliseconds m_recv_timeout{-1};
+    std::optional<Clock::time_point> m_send_deadline;
+    std::optional<Clock::time_point> m_recv_deadline;
+    // batch()写请求期间接收响应，套接字可写时由recvIntoRingBuffer()接着写出，两端缓冲写满也不会互相等待
+    PendingSend* m_pending_send = nullptr;
 };
 
 } // namespace galay::mysql
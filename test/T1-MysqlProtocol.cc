@@ -1,9 +1,13 @@
 #include <iostream>
 #include <cassert>
+#include <cmath>
 #include <cstring>
+#include "galay-mysql/base/MysqlGtid.h"
 #include "galay-mysql/protocol/Builder.h"
 #include "galay-mysql/protocol/MysqlProtocol.h"
 #include "galay-mysql/protocol/MysqlPacket.h"
+#include "galay-mysql/protocol/MysqlResultDecoder.h"
+#include "galay-mysql/protocol/MysqlRowMapper.h"
 
 using namespace galay::mysql::protocol;
 
@@ -151,6 +155,13 @@ void testEncoder()
     assert(static_cast<uint8_t>(query_pkt[4]) == static_cast<uint8_t>(CommandType::COM_QUERY));
     assert(query_pkt.substr(5) == "SELECT 1");
 
+    // encodeQueryInto覆盖旧内容并复用容量
+    std::string reused(256, 'x');
+    const auto* reused_data = reused.data();
+    encoder.encodeQueryInto(reused, "SELECT 1", 0);
+    assert(reused == query_pkt);
+    assert(reused.data() == reused_data);
+
     // COM_QUIT
     auto quit_pkt = encoder.encodeQuit(0);
     assert(quit_pkt.size() == 5);
@@ -211,6 +222,77 @@ void testCommandBuilder()
     std::cout << "  PASSED" << std::endl;
 }
 
+void testBulkInsertBuilder()
+{
+    std::cout << "Testing bulk insert builder..." << std::endl;
+
+    auto statementOf = [](const MysqlCommandView& view) {
+        assert(view.kind == MysqlCommandKind::Query);
+        const uint32_t packet_len = readUint24(view.encoded.data());
+        assert(packet_len + MYSQL_PACKET_HEADER_SIZE == view.encoded.size());
+        assert(static_cast<uint8_t>(view.encoded[4]) == static_cast<uint8_t>(CommandType::COM_QUERY));
+        return std::string(view.encoded.substr(5));
+    };
+
+    const std::string_view columns[] = {"id", "name", "score"};
+    {
+        MysqlBulkInsertBuilder bulk("app.scores", columns);
+        assert(bulk.addRow(1, "it's", 1.5));
+        assert(bulk.addRow(2u, std::string("a\\b\n"), std::optional<double>()));
+        assert(bulk.addRow(int64_t(-3), nullptr, true));
+        assert(!bulk.addRow(4, "missing"));
+        assert(!bulk.addRow(5, "nan", std::nan("")));
+        assert(bulk.pendingRows() == 3);
+        assert(bulk.commands().empty());
+        bulk.finish();
+
+        assert(bulk.readyChunks() == 1);
+        assert(bulk.chunkRows()[0] == 3);
+        assert(statementOf(bulk.commands()[0]) ==
+               "INSERT INTO `app`.`scores` (`id`,`name`,`score`) VALUES "
+               "(1,'it\\'s',1.5),(2,'a\\\\b\\n',NULL),(-3,NULL,1)");
+    }
+
+    {
+        const std::string_view one[] = {"v"};
+        MysqlBulkInsertBuilder bulk("t", one);
+        bulk.setNoBackslashEscapes(true);
+        bulk.beginRow();
+        bulk.value("a'b\\");
+        assert(bulk.endRow());
+        bulk.beginRow();
+        bulk.binary(std::string_view("\x01\xff", 2));
+        assert(bulk.endRow());
+        bulk.finish();
+        assert(statementOf(bulk.commands()[0]) == "INSERT INTO `t` (`v`) VALUES ('a''b\\'),(X'01FF')");
+    }
+
+    {
+        // 每条语句最多容纳两行，第三行触发封包并移到新语句
+        const std::string_view one[] = {"v"};
+        const size_t head = std::string_view("\x03INSERT INTO `t` (`v`) VALUES ").size();
+        MysqlBulkInsertBuilder bulk("t", one, head + std::string_view("(100),(101)").size());
+        for (int i = 100; i < 105; ++i) {
+            assert(bulk.addRow(i));
+        }
+        assert(bulk.readyChunks() == 2);
+        assert(bulk.pendingRows() == 1);
+        assert(statementOf(bulk.commands()[1]) == "INSERT INTO `t` (`v`) VALUES (102),(103)");
+
+        bulk.consume();
+        assert(bulk.readyChunks() == 0);
+        assert(bulk.addRow(105));
+        bulk.finish();
+        assert(bulk.chunkRows().size() == 1 && bulk.chunkRows()[0] == 2);
+        assert(statementOf(bulk.commands()[0]) == "INSERT INTO `t` (`v`) VALUES (104),(105)");
+
+        assert(!bulk.addRow("a row that can never fit into one statement"));
+        assert(bulk.pendingRows() == 0);
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
 void testOkPacketParse()
 {
     std::cout << "Testing OK packet parse..." << std::endl;
@@ -235,6 +317,150 @@ void testOkPacketParse()
     std::cout << "  PASSED" << std::endl;
 }
 
+void testSessionTrackOkParse()
+{
+    std::cout << "Testing session-tracked OK packet parse..." << std::endl;
+
+    MysqlParser parser;
+    const uint32_t caps = CLIENT_PROTOCOL_41 | CLIENT_SESSION_TRACK;
+    const std::string gtid = "3e11fa47-71ca-11e1-9e33-c80aa9429562:23";
+
+    std::string state;
+    {
+        std::string entry;
+        writeLenEncString(entry, "autocommit");
+        writeLenEncString(entry, "OFF");
+        state.push_back(static_cast<char>(SESSION_TRACK_SYSTEM_VARIABLES));
+        writeLenEncString(state, entry);
+    }
+    {
+        std::string entry(1, '\0');
+        writeLenEncString(entry, gtid);
+        state.push_back(static_cast<char>(SESSION_TRACK_GTIDS));
+        writeLenEncString(state, entry);
+    }
+
+    std::string payload;
+    payload.push_back(0x00);
+    writeLenEncInt(payload, 1);
+    writeLenEncInt(payload, 0);
+    writeUint16(payload, SERVER_STATUS_AUTOCOMMIT | SERVER_SESSION_STATE_CHANGED);
+    writeUint16(payload, 0);
+    writeLenEncString(payload, "Rows matched: 1");
+    writeLenEncString(payload, state);
+
+    auto ok = parser.parseOk(payload.data(), payload.size(), caps);
+    assert(ok.has_value());
+    assert(ok->info == "Rows matched: 1");
+    assert(ok->session_state.size() == 2);
+    assert(ok->session_state[0].name == "autocommit" && ok->session_state[0].value == "OFF");
+    assert(ok->gtids == gtid);
+
+    // 视图解析的字段指向payload本身
+    auto view = parser.parseOkView(payload.data(), payload.size(), caps);
+    assert(view.has_value());
+    assert(view->affected_rows == 1 && view->info == "Rows matched: 1" && view->gtids == gtid);
+    assert(view->info.data() >= payload.data() && view->info.data() < payload.data() + payload.size());
+    assert(view->gtids.data() >= payload.data() && view->gtids.data() < payload.data() + payload.size());
+    assert(view->session_state == state);
+
+    // 没有info也没有状态变更时整个尾部省略
+    std::string bare;
+    bare.push_back(0x00);
+    writeLenEncInt(bare, 0);
+    writeLenEncInt(bare, 0);
+    writeUint16(bare, SERVER_STATUS_AUTOCOMMIT);
+    writeUint16(bare, 0);
+    auto bare_ok = parser.parseOk(bare.data(), bare.size(), caps);
+    assert(bare_ok.has_value() && bare_ok->info.empty() && bare_ok->gtids.empty());
+
+    // 截断的状态块
+    auto truncated = parser.parseOk(payload.data(), payload.size() - 3, caps);
+    assert(!truncated.has_value());
+
+    // 解码器把GTID落到结果集
+    std::string packet;
+    writeUint24(packet, static_cast<uint32_t>(payload.size()));
+    packet.push_back(1);
+    packet.append(payload);
+    MysqlResultDecoder decoder;
+    decoder.reset(caps);
+    size_t consumed = 0;
+    auto event = decoder.feed(packet.data(), packet.size(), consumed);
+    assert(event.has_value() && event->type == MysqlResultEventType::Ok);
+    galay::mysql::MysqlResultSet rs;
+    auto done = decoder.apply(*event, rs);
+    assert(done.has_value() && *done);
+    assert(rs.gtids() == gtid && rs.info() == "Rows matched: 1");
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void testGtidSet()
+{
+    std::cout << "Testing GTID set..." << std::endl;
+
+    using galay::mysql::MysqlGtidSet;
+    const std::string a = "3E11FA47-71CA-11E1-9E33-C80AA9429562";
+    const std::string b = "4f11fa47-71ca-11e1-9e33-c80aa9429562";
+
+    auto executed = MysqlGtidSet::parse(a + ":1-5:7-9,\n" + b + ":1-3");
+    assert(executed.has_value());
+    assert(executed->toString() == "3e11fa47-71ca-11e1-9e33-c80aa9429562:1-5:7-9," + b + ":1-3");
+
+    auto written = MysqlGtidSet::parse(a + ":4");
+    assert(written.has_value() && executed->contains(*written));
+    assert(!executed->contains(*MysqlGtidSet::parse(a + ":6")));
+    assert(!executed->contains(*MysqlGtidSet::parse(a + ":5-7")));
+    assert(!executed->contains(*MysqlGtidSet::parse("5e11fa47-71ca-11e1-9e33-c80aa9429562:1")));
+    assert(executed->contains(MysqlGtidSet{}));
+
+    // 合并相邻区间
+    assert(executed->merge(a + ":6").has_value());
+    assert(executed->toString() == "3e11fa47-71ca-11e1-9e33-c80aa9429562:1-9," + b + ":1-3");
+    executed->add(b, 10);
+    executed->add(b, 4, 9);
+    assert(executed->toString() == "3e11fa47-71ca-11e1-9e33-c80aa9429562:1-9," + b + ":1-10");
+
+    // 带标签的GTID与源的大小写无关
+    auto tagged = MysqlGtidSet::parse(b + ":1-2:Blue:5");
+    assert(tagged.has_value());
+    assert(tagged->toString() == b + ":1-2," + b + ":blue:5");
+    assert(!executed->contains(*tagged));
+
+    // 非法输入不修改已有集合
+    const auto before = executed->toString();
+    assert(!executed->merge("not-a-uuid:1").has_value());
+    assert(!executed->merge(a + ":5-3").has_value());
+    assert(!executed->merge(a + ":0").has_value());
+    assert(executed->toString() == before);
+    assert(MysqlGtidSet::parse("").has_value() && MysqlGtidSet::parse("")->empty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void testSessionInitSql()
+{
+    std::cout << "Testing charset mapping and session init SQL..." << std::endl;
+
+    assert(collationIdForCharset("utf8mb4") == CHARSET_UTF8MB4_GENERAL_CI);
+    assert(collationIdForCharset("UTF8MB4_0900_AI_CI") == CHARSET_UTF8MB4_0900_AI_CI);
+    assert(collationIdForCharset("utf8mb3") == CHARSET_UTF8_GENERAL_CI);
+    assert(collationIdForCharset("latin1") == 8);
+    assert(collationIdForCharset("binary") == CHARSET_BINARY);
+    assert(!collationIdForCharset("koi8r").has_value());
+
+    galay::mysql::MysqlConfig config;
+    assert(buildSessionInitSql(config, true).empty());
+    assert(buildSessionInitSql(config, false) == "SET NAMES utf8mb4");
+
+    config.session_variables = {{"time_zone", "'+00:00'"}, {"autocommit", "1"}};
+    config.init_statements = {"SET @tenant = 7", ""};
+    assert(buildSessionInitSql(config, true) == "SET time_zone = '+00:00', autocommit = 1; SET @tenant = 7");
+
+    std::cout << "  PASSED" << std::endl;
+}
+
 void testErrPacketParse()
 {
     std::cout << "Testing ERR packet parse..." << std::endl;
@@ -258,6 +484,357 @@ void testErrPacketParse()
     std::cout << "  PASSED" << std::endl;
 }
 
+struct MappedUser
+{
+    int64_t id;
+    std::string name;
+    std::optional<int32_t> age;
+    MYSQL_FIELDS(id, name, age)
+};
+
+struct MappedScore
+{
+    uint32_t id;
+    double score;
+    bool active;
+};
+
+void testRowMapper()
+{
+    std::cout << "Testing row mapper..." << std::endl;
+
+    using galay::mysql::MysqlField;
+    using galay::mysql::MysqlFieldType;
+
+    static_assert(galay::mysql::kMysqlRowColumnCount<MappedUser> == 3);
+    static_assert(galay::mysql::kMysqlRowColumnCount<MappedScore> == 3);
+
+    std::vector<MysqlField> fields;
+    fields.emplace_back("id", MysqlFieldType::LONGLONG, 0, 20, 0);
+    fields.emplace_back("name", MysqlFieldType::VAR_STRING, 0, 255, 0);
+    fields.emplace_back("age", MysqlFieldType::LONG, 0, 11, 0);
+    assert(galay::mysql::mysqlCheckColumns<MappedUser>(fields).has_value());
+
+    // 描述符映射: id=42, name="alice", age=NULL
+    std::string row;
+    writeLenEncString(row, "42");
+    writeLenEncString(row, "alice");
+    row.push_back(static_cast<char>(0xFB));
+
+    MappedUser user{};
+    user.age = 7;
+    assert(galay::mysql::mysqlDecodeTextRow(row.data(), row.size(), user).has_value());
+    assert(user.id == 42);
+    assert(user.name == "alice");
+    assert(!user.age.has_value());
+
+    // 列数不匹配
+    fields.pop_back();
+    auto count_mismatch = galay::mysql::mysqlCheckColumns<MappedUser>(fields);
+    assert(!count_mismatch.has_value());
+    assert(count_mismatch.error().type() == galay::mysql::MYSQL_ERROR_ROW_MAPPING);
+
+    // 聚合体映射与类型校验
+    std::vector<MysqlField> score_fields;
+    score_fields.emplace_back("id", MysqlFieldType::LONG, 0, 11, 0);
+    score_fields.emplace_back("score", MysqlFieldType::NEWDECIMAL, 0, 10, 2);
+    score_fields.emplace_back("active", MysqlFieldType::TINY, 0, 1, 0);
+    assert(galay::mysql::mysqlCheckColumns<MappedScore>(score_fields).has_value());
+
+    score_fields[0] = MysqlField("id", MysqlFieldType::VAR_STRING, 0, 255, 0);
+    assert(!galay::mysql::mysqlCheckColumns<MappedScore>(score_fields).has_value());
+
+    std::string score_row;
+    writeLenEncString(score_row, "7");
+    writeLenEncString(score_row, "98.5");
+    writeLenEncString(score_row, "1");
+    MappedScore score{};
+    assert(galay::mysql::mysqlDecodeTextRow(score_row.data(), score_row.size(), score).has_value());
+    assert(score.id == 7);
+    assert(score.score == 98.5);
+    assert(score.active);
+
+    // 非optional成员遇到NULL、非法数字与截断包
+    std::string null_row;
+    null_row.push_back(static_cast<char>(0xFB));
+    writeLenEncString(null_row, "1.0");
+    writeLenEncString(null_row, "0");
+    assert(!galay::mysql::mysqlDecodeTextRow(null_row.data(), null_row.size(), score).has_value());
+
+    std::string bad_row;
+    writeLenEncString(bad_row, "12x");
+    writeLenEncString(bad_row, "1.0");
+    writeLenEncString(bad_row, "0");
+    assert(!galay::mysql::mysqlDecodeTextRow(bad_row.data(), bad_row.size(), score).has_value());
+
+    assert(!galay::mysql::mysqlDecodeTextRow(score_row.data(), score_row.size() - 1, score).has_value());
+
+    // 行收集器: 解码失败的行不会留在结果中
+    galay::mysql::MysqlRowCollector<MappedUser> collector;
+    fields.emplace_back("age", MysqlFieldType::LONG, 0, 11, 0);
+    assert(collector.onColumns(fields).has_value());
+    assert(collector.onRow(row.data(), row.size()).has_value());
+    assert(!collector.onRow(bad_row.data(), 1).has_value());
+    assert(collector.rows().size() == 1);
+    assert(collector.rows()[0].name == "alice");
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void testBinaryRowAndTypedParams()
+{
+    std::cout << "Testing binary row / typed stmt params..." << std::endl;
+    using galay::mysql::MysqlField;
+    using galay::mysql::MysqlFieldType;
+    using galay::mysql::UNSIGNED_FLAG;
+
+    std::vector<MysqlField> fields;
+    fields.emplace_back("id", MysqlFieldType::LONGLONG, 0, 20, 0);
+    fields.emplace_back("small", MysqlFieldType::SHORT, UNSIGNED_FLAG, 5, 0);
+    fields.emplace_back("name", MysqlFieldType::VAR_STRING, 0, 255, 0);
+    fields.emplace_back("ratio", MysqlFieldType::DOUBLE, 0, 22, 0);
+    fields.emplace_back("created", MysqlFieldType::DATETIME, 0, 19, 0);
+    fields.emplace_back("elapsed", MysqlFieldType::TIME, 0, 10, 0);
+    fields.emplace_back("missing", MysqlFieldType::LONG, 0, 11, 0);
+
+    std::string row;
+    row.push_back(0x00);
+    row.push_back(0x00);
+    row.push_back(static_cast<char>(1u << ((6 + 2) % 8)));  // missing为NULL（位偏移2）
+    writeUint64(row, static_cast<uint64_t>(-5));
+    writeUint16(row, 65535);
+    writeLenEncString(row, "bob");
+    const double ratio = 0.25;
+    row.append(reinterpret_cast<const char*>(&ratio), sizeof(ratio));
+    row.push_back(7);
+    writeUint16(row, 2024);
+    row.push_back(2);
+    row.push_back(29);
+    row.push_back(13);
+    row.push_back(5);
+    row.push_back(9);
+    row.push_back(8);
+    row.push_back(0x01);
+    writeUint32(row, 1);
+    row.push_back(2);
+    row.push_back(3);
+    row.push_back(4);
+
+    MysqlParser parser;
+    auto parsed = parser.parseBinaryRow(row.data(), row.size(), fields);
+    assert(parsed.has_value());
+    assert(parsed->size() == 7);
+    assert((*parsed)[0] == "-5");
+    assert((*parsed)[1] == "65535");
+    assert((*parsed)[2] == "bob");
+    assert((*parsed)[3] == "0.25");
+    assert((*parsed)[4] == "2024-02-29 13:05:09");
+    assert((*parsed)[5] == "-26:03:04");
+    assert(!(*parsed)[6].has_value());
+    assert(!parser.parseBinaryRow(row.data(), row.size() - 1, fields).has_value());
+
+    // 声明为LONGLONG的参数按8字节编码；无法转换的文本退回VAR_STRING
+    MysqlEncoder encoder;
+    const std::vector<std::optional<std::string>> params = {std::string("42"), std::string("abc")};
+    const std::vector<uint8_t> types = {
+        static_cast<uint8_t>(MysqlFieldType::LONGLONG),
+        static_cast<uint8_t>(MysqlFieldType::LONGLONG),
+    };
+    const std::string packet = encoder.encodeStmtExecute(1, params, types, 0);
+    const char* payload = packet.data() + MYSQL_PACKET_HEADER_SIZE;
+    const size_t types_pos = 10 + 1 + 1;
+    assert(static_cast<uint8_t>(payload[types_pos]) == static_cast<uint8_t>(MysqlFieldType::LONGLONG));
+    assert(static_cast<uint8_t>(payload[types_pos + 2]) == static_cast<uint8_t>(MysqlFieldType::VAR_STRING));
+    assert(readUint64(payload + types_pos + 4) == 42);
+    assert(payload[types_pos + 12] == 3);
+    assert(std::string_view(payload + types_pos + 13, 3) == "abc");
+
+    std::string reused = "stale";
+    encoder.encodeStmtExecuteInto(reused, 1, params, types, 0);
+    assert(reused == packet);
+
+    // COM_STMT_SEND_LONG_DATA：cmd + stmt_id + param_id + 数据，不带长度前缀
+    const std::string long_pkt = encoder.encodeStmtSendLongData(7, 1, "chunk", 0);
+    assert(long_pkt.size() == MYSQL_STMT_LONG_DATA_PREFIX_SIZE + 5);
+    assert(readUint24(long_pkt.data()) == 7 + 5);
+    assert(static_cast<uint8_t>(long_pkt[4]) == static_cast<uint8_t>(CommandType::COM_STMT_SEND_LONG_DATA));
+    assert(readUint32(long_pkt.data() + 5) == 7);
+    assert(readUint16(long_pkt.data() + 9) == 1);
+    assert(long_pkt.substr(MYSQL_STMT_LONG_DATA_PREFIX_SIZE) == "chunk");
+
+    // 长数据参数：不置NULL位、不写值，未指定类型时为BLOB
+    const std::vector<std::optional<std::string>> long_params = {std::string("42"), std::nullopt};
+    const uint16_t long_ids[] = {1};
+    std::string with_long;
+    encoder.encodeStmtExecuteInto(with_long, 1, long_params, std::span<const uint8_t>(types.data(), 1), long_ids, 0);
+    const char* long_payload = with_long.data() + MYSQL_PACKET_HEADER_SIZE;
+    assert(long_payload[10] == 0);
+    assert(static_cast<uint8_t>(long_payload[types_pos + 2]) == static_cast<uint8_t>(MysqlFieldType::BLOB));
+    assert(with_long.size() == MYSQL_PACKET_HEADER_SIZE + types_pos + 4 + 8);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void testTextRowInto()
+{
+    std::cout << "Testing text row parse into reused storage..." << std::endl;
+
+    MysqlParser parser;
+    std::string row;
+    row.push_back(1);
+    row.append("7");
+    row.push_back(static_cast<char>(0xFB));
+    row.push_back(2);
+    row.append("ok");
+
+    std::vector<std::optional<std::string>> values = {std::string(64, 'a'), std::string("b"), std::nullopt, std::string("extra")};
+    const auto* first_data = values[0]->data();
+    assert(parser.parseTextRowInto(row.data(), row.size(), 3, values).has_value());
+    assert(values.size() == 3);
+    assert(values[0] == "7" && values[0]->data() == first_data);
+    assert(!values[1].has_value());
+    assert(values[2] == "ok");
+    assert(!parser.parseTextRowInto(row.data(), row.size() - 1, 3, values).has_value());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+namespace
+{
+
+using galay::mysql::MysqlFieldType;
+using galay::mysql::MysqlResultSet;
+
+std::string wrapTestPacket(uint8_t seq, std::string_view payload)
+{
+    std::string out;
+    writeUint24(out, static_cast<uint32_t>(payload.size()));
+    out.push_back(static_cast<char>(seq));
+    out.append(payload);
+    return out;
+}
+
+std::string columnPayload(std::string_view name)
+{
+    std::string col;
+    writeLenEncString(col, "def");
+    writeLenEncString(col, "db");
+    writeLenEncString(col, "t");
+    writeLenEncString(col, "t");
+    writeLenEncString(col, name);
+    writeLenEncString(col, name);
+    col.push_back(0x0c);
+    writeUint16(col, 45);
+    writeUint32(col, 255);
+    col.push_back(static_cast<char>(MysqlFieldType::VAR_STRING));
+    writeUint16(col, 0);
+    col.push_back(0);
+    col.append(2, '\0');
+    return col;
+}
+
+// 把整段响应逐事件喂给解码器，每次只给到当前位置为止的全部字节
+std::expected<MysqlResultSet, galay::mysql::MysqlError>
+decodeAll(const std::string& wire, uint32_t caps, size_t* events = nullptr)
+{
+    MysqlResultDecoder decoder;
+    decoder.reset(caps);
+    MysqlResultSet rs;
+    size_t pos = 0;
+    size_t count = 0;
+    while (true) {
+        size_t consumed = 0;
+        auto event = decoder.feed(wire.data() + pos, wire.size() - pos, consumed);
+        if (!event) {
+            return std::unexpected(event.error());
+        }
+        assert(event->type != MysqlResultEventType::NeedMore);
+        ++count;
+        auto done = decoder.apply(*event, rs);
+        pos += consumed;
+        if (!done) {
+            return std::unexpected(done.error());
+        }
+        if (*done) {
+            break;
+        }
+    }
+    assert(pos == wire.size());
+    assert(decoder.atBoundary());
+    if (events != nullptr) {
+        *events = count;
+    }
+    return rs;
+}
+
+} // namespace
+
+void testResultDecoder()
+{
+    std::cout << "Testing result decoder..." << std::endl;
+
+    std::string row1;
+    writeLenEncString(row1, "a");
+    std::string row2;
+    row2.push_back(static_cast<char>(0xFB));
+
+    // 经典EOF模式：头 + 列 + EOF + 行 + EOF
+    std::string eof_wire;
+    eof_wire += wrapTestPacket(1, std::string_view("\x01", 1));
+    eof_wire += wrapTestPacket(2, columnPayload("v"));
+    eof_wire += wrapTestPacket(3, std::string_view("\xFE\x00\x00\x02\x00", 5));
+    eof_wire += wrapTestPacket(4, row1);
+    eof_wire += wrapTestPacket(5, row2);
+    eof_wire += wrapTestPacket(6, std::string_view("\xFE\x01\x00\x22\x00", 5));
+    size_t events = 0;
+    auto rs = decodeAll(eof_wire, CLIENT_PROTOCOL_41, &events);
+    assert(rs.has_value());
+    assert(events == 6);
+    assert(rs->fieldCount() == 1 && rs->field(0).name() == "v");
+    assert(rs->rowCount() == 2 && rs->row(0).getString(0) == "a" && rs->row(1).isNull(0));
+    assert(rs->warnings() == 1 && rs->statusFlags() == 0x22);
+
+    // DEPRECATE_EOF：无列EOF，结尾为0xFE开头的OK包；ColumnsEnd不占字节
+    std::string ok_wire;
+    ok_wire += wrapTestPacket(1, std::string_view("\x01", 1));
+    ok_wire += wrapTestPacket(2, columnPayload("v"));
+    ok_wire += wrapTestPacket(3, row1);
+    ok_wire += wrapTestPacket(4, std::string_view("\xFE\x00\x00\x0A\x00\x00\x00", 7));
+    rs = decodeAll(ok_wire, CLIENT_PROTOCOL_41 | CLIENT_DEPRECATE_EOF, &events);
+    assert(rs.has_value());
+    assert(events == 5);
+    assert(rs->rowCount() == 1 && (rs->statusFlags() & SERVER_MORE_RESULTS_EXISTS) != 0);
+
+    // 无结果集的OK
+    rs = decodeAll(wrapTestPacket(1, std::string_view("\x00\x03\x07\x02\x00\x00\x00", 7)), CLIENT_PROTOCOL_41);
+    assert(rs.has_value() && rs->affectedRows() == 3 && rs->lastInsertId() == 7 && !rs->hasResultSet());
+
+    // 半个包返回NeedMore且不消费；ERR包给出服务端错误并指向整包
+    MysqlResultDecoder decoder;
+    decoder.reset(CLIENT_PROTOCOL_41);
+    size_t consumed = 99;
+    auto partial = decoder.feed(eof_wire.data(), 3, consumed);
+    assert(partial.has_value() && partial->type == MysqlResultEventType::NeedMore && consumed == 0);
+
+    std::string err_payload("\xFF\x7A\x04#42S02no table", 17);
+    const std::string err_wire = wrapTestPacket(1, err_payload);
+    auto err = decoder.feed(err_wire.data(), err_wire.size(), consumed);
+    assert(!err.has_value());
+    assert(err.error().type() == galay::mysql::MYSQL_ERROR_SERVER);
+    assert(consumed == err_wire.size());
+
+    // LOCAL INFILE请求：给出文件名与序列号，解码器仍停在响应边界等待OK/ERR
+    const std::string infile_wire = wrapTestPacket(1, std::string_view("\xFB" "f.csv", 6));
+    decoder.reset(CLIENT_PROTOCOL_41);
+    auto infile = decoder.feed(infile_wire.data(), infile_wire.size(), consumed);
+    assert(infile.has_value() && infile->type == MysqlResultEventType::LocalInfile);
+    assert(infile->payload == "f.csv" && infile->sequence_id == 1 && decoder.atBoundary());
+    MysqlResultSet ignored;
+    assert(!decoder.apply(*infile, ignored).has_value());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
 int main()
 {
     std::cout << "=== T1: MySQL Protocol Tests ===" << std::endl;
@@ -268,8 +845,16 @@ int main()
     testPacketHeader();
     testEncoder();
     testCommandBuilder();
+    testBulkInsertBuilder();
     testOkPacketParse();
+    testSessionTrackOkParse();
+    testGtidSet();
+    testSessionInitSql();
     testErrPacketParse();
+    testRowMapper();
+    testBinaryRowAndTypedParams();
+    testTextRowInto();
+    testResultDecoder();
 
     std::cout << "\nAll protocol tests PASSED!" << std::endl;
     return 0;
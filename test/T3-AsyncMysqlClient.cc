@@ -34,6 +34,13 @@ struct AsyncTestState {
         else { result_var = std::move(_r->value()); } \
     }
 
+struct GalayTestRow {
+    int32_t id;
+    std::optional<std::string> name;
+    std::optional<int32_t> value;
+    MYSQL_FIELDS(id, name, value)
+};
+
 Coroutine testAsyncMysql(IOScheduler* scheduler, AsyncTestState* state, mysql_test::MysqlTestConfig db_cfg)
 {
     std::cout << "Testing asynchronous MySQL operations..." << std::endl;
@@ -119,6 +126,29 @@ Coroutine testAsyncMysql(IOScheduler* scheduler, AsyncTestState* state, mysql_te
         }
     }
 
+    // QUERY AS
+    std::cout << "Testing queryAs..." << std::endl;
+    {
+        auto r = co_await client.queryAs<GalayTestRow>("SELECT id, name, value FROM galay_test");
+        if (!r) {
+            state->fail("queryAs failed: " + r.error().message());
+            co_return;
+        }
+        if (!r->has_value() || r->value().empty()) {
+            state->fail("queryAs returned no rows");
+            co_return;
+        }
+        const auto& first = r->value().front();
+        std::cout << "  Rows: " << r->value().size()
+                  << ", first: " << first.id << " " << first.name.value_or("NULL") << std::endl;
+
+        auto mismatch = co_await client.queryAs<GalayTestRow>("SELECT id FROM galay_test");
+        if (mismatch || mismatch.error().type() != MYSQL_ERROR_ROW_MAPPING) {
+            state->fail("queryAs should reject column count mismatch");
+            co_return;
+        }
+    }
+
     // PIPELINE
     std::cout << "Testing PIPELINE..." << std::endl;
     {
@@ -0,0 +1,1855 @@
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <galay-kernel/kernel/Runtime.h>
+#include "galay-mysql/async/AsyncMysqlClient.h"
+#include "galay-mysql/async/MysqlConnectionPool.h"
+#include "galay-mysql/async/MysqlBufferProvider.h"
+#include "galay-mysql/async/MysqlReconnectingClient.h"
+#include "galay-mysql/async/MysqlRouter.h"
+#include "galay-mysql/async/MysqlTransaction.h"
+#include "galay-mysql/base/MysqlCancellation.h"
+#include "galay-mysql/base/MysqlGtid.h"
+#include "galay-mysql/base/MysqlResolver.h"
+#include "galay-mysql/sync/MysqlClient.h"
+#include "galay-mysql/mock/MysqlMockServer.h"
+
+using namespace galay::kernel;
+using namespace galay::mysql;
+using namespace galay::mysql::mock;
+
+#define MOCK_EXPECT(cond, msg) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << "  FAILED: " << msg << " (" #cond ")" << std::endl; \
+            return false; \
+        } \
+    } while (0)
+
+namespace
+{
+
+const std::string kSourceUuid = "3e11fa47-71ca-11e1-9e33-c80aa9429562";
+constexpr std::string_view kGtidUpdate = "UPDATE users SET name = 'bob' WHERE id = 1";
+
+void scriptUsers(MysqlMockServer& server)
+{
+    server.script("SELECT id, name FROM users",
+                  MysqlMockResult::resultSet(
+                      {{"id", MysqlFieldType::LONGLONG}, {"name", MysqlFieldType::VAR_STRING}},
+                      {{"1", "alice"}, {"2", std::nullopt}}));
+    server.script("INSERT INTO users (name) VALUES ('carol')", MysqlMockResult::ok(1, 3));
+    server.script(std::string(kGtidUpdate), MysqlMockResult::ok(1, 0, "Rows matched: 1").withGtid(kSourceUuid + ":7"));
+    server.script("SELECT payload FROM blobs",
+                  MysqlMockResult::resultSet({{"payload", MysqlFieldType::BLOB}}, {{std::string(200000, 'x')}}));
+    server.script("SELECT * FROM missing", MysqlMockResult::error(1146, "Table 'test.missing' doesn't exist", "42S02"));
+    server.script("CALL report()",
+                  MysqlMockResult::multi({
+                      MysqlMockResult::resultSet({{"id", MysqlFieldType::LONGLONG}}, {{"1"}, {"2"}}),
+                      MysqlMockResult::resultSet({{"name"}, {"total"}}, {{"alice", "7"}}),
+                      MysqlMockResult::ok(0, 0),
+                  }));
+}
+
+constexpr std::string_view kDocInsert = "INSERT INTO docs (name, body) VALUES (?, ?)";
+
+uint64_t fnv1a(std::string_view data)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (char c : data) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 回显参数：name、body字节数与body摘要（NULL时长度为-1）
+MysqlMockServer::QueryHandler docEchoHandler()
+{
+    return [](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (request.sql != kDocInsert || request.params.size() != 2) {
+            return std::nullopt;
+        }
+        const auto& body = request.params[1];
+        return MysqlMockResult::resultSet(
+            {{"name"}, {"bytes", MysqlFieldType::LONGLONG}, {"digest"}},
+            {{request.params[0],
+              body ? std::to_string(body->size()) : "-1",
+              body ? std::to_string(fnv1a(*body)) : "0"}});
+    };
+}
+
+bool testSyncClient(MysqlMockServer& server)
+{
+    std::cout << "Testing sync client against mock server..." << std::endl;
+    MysqlClient session;
+    auto connected = session.connect(server.clientConfig("test"));
+    MOCK_EXPECT(connected, "connect: " << (connected ? "" : connected.error().message()));
+
+    auto users = session.query("SELECT id, name FROM users");
+    MOCK_EXPECT(users, "scripted select");
+    MOCK_EXPECT(users->fieldCount() == 2 && users->rowCount() == 2, "scripted select shape");
+    MOCK_EXPECT(users->row(0).getString(1) == "alice", "scripted select value");
+    MOCK_EXPECT(users->row(1).isNull(1), "scripted select NULL");
+
+    auto inserted = session.query("INSERT INTO users (name) VALUES ('carol')");
+    MOCK_EXPECT(inserted && inserted->affectedRows() == 1 && inserted->lastInsertId() == 3, "scripted insert");
+
+    auto missing = session.query("SELECT * FROM missing");
+    MOCK_EXPECT(!missing && missing.error().serverErrno() == 1146, "scripted error");
+
+    auto literal = session.query("SELECT 42");
+    MOCK_EXPECT(literal && literal->rowCount() == 1 && literal->row(0).getString(0) == "42", "builtin literal");
+
+    MOCK_EXPECT(session.beginTransaction() && session.commit(), "builtin transaction");
+    MOCK_EXPECT(session.ping(), "ping");
+
+    const std::string_view sqls[] = {"SELECT 1", "SELECT 2", "SELECT 3"};
+    auto pipeline = session.pipeline(sqls);
+    MOCK_EXPECT(pipeline && pipeline->size() == 3, "pipeline");
+    MOCK_EXPECT((*pipeline)[2].row(0).getString(0) == "3", "pipeline order");
+
+    auto prepared = session.prepare("INSERT INTO users (name) VALUES (?)");
+    MOCK_EXPECT(prepared && prepared->num_params == 1, "prepare");
+    auto executed = session.stmtExecute(prepared->statement_id, {std::string("dave")});
+    MOCK_EXPECT(executed, "stmt execute");
+    MOCK_EXPECT(session.stmtClose(prepared->statement_id), "stmt close");
+
+    auto select_stmt = session.prepare("SELECT id, name FROM users");
+    MOCK_EXPECT(select_stmt && select_stmt->num_columns == 2, "prepare select");
+    auto binary_rows = session.stmtExecute(select_stmt->statement_id, {});
+    MOCK_EXPECT(binary_rows && binary_rows->rowCount() == 2, "binary result set");
+    MOCK_EXPECT(binary_rows->row(0).getString(0) == "1" && binary_rows->row(0).getString(1) == "alice",
+                "binary row values");
+    MOCK_EXPECT(binary_rows->row(1).isNull(1), "binary row NULL");
+
+    session.close();
+
+    MysqlClient denied;
+    auto bad = server.clientConfig("test");
+    bad.password = "wrong";
+    auto rejected = denied.connect(bad);
+    MOCK_EXPECT(!rejected, "wrong password must be rejected");
+
+    std::cout << "  sync client OK" << std::endl;
+    return true;
+}
+
+bool testCachingSha2()
+{
+    std::cout << "Testing caching_sha2_password fast auth..." << std::endl;
+    MysqlMockServerConfig config;
+    config.auth_plugin = "caching_sha2_password";
+    MysqlMockServer server(config);
+    MOCK_EXPECT(server.start(), "start sha2 server");
+
+    MysqlClient session;
+    auto connected = session.connect(server.clientConfig());
+    MOCK_EXPECT(connected, "sha2 connect");
+    MOCK_EXPECT(session.query("SELECT 1"), "sha2 query");
+    session.close();
+    server.stop();
+    std::cout << "  caching_sha2 OK" << std::endl;
+    return true;
+}
+
+bool testHandlerAndDelay(MysqlMockServer& server)
+{
+    std::cout << "Testing query handler and delayed responses..." << std::endl;
+    std::atomic<int> handled{0};
+    server.setHandler([&handled](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (request.sql.starts_with("SELECT name FROM echo")) {
+            handled.fetch_add(1, std::memory_order_relaxed);
+            std::string value = request.params.empty() || !request.params[0] ? "none" : *request.params[0];
+            return MysqlMockResult::resultSet({{"name"}}, {{value}});
+        }
+        return std::nullopt;
+    });
+
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(server.clientConfig()), "connect");
+    auto echoed = session.query("SELECT name FROM echo");
+    MOCK_EXPECT(echoed && echoed->row(0).getString(0) == "none", "handler result");
+    MOCK_EXPECT(handled.load() == 1, "handler invoked");
+
+    const auto started = std::chrono::steady_clock::now();
+    auto slept = session.query("SELECT SLEEP(0.2)");
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    MOCK_EXPECT(slept && slept->rowCount() == 1, "sleep result");
+    MOCK_EXPECT(elapsed >= std::chrono::milliseconds(190), "sleep delay honoured");
+
+    session.close();
+    server.setHandler(nullptr);
+    std::cout << "  handler/delay OK" << std::endl;
+    return true;
+}
+
+bool testSessionInit(MysqlMockServer& server)
+{
+    std::cout << "Testing session init batch..." << std::endl;
+    std::vector<std::string> seen;
+    std::mutex seen_mutex;
+    server.setHandler([&](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (request.sql.starts_with("SET ")) {
+            std::lock_guard<std::mutex> lock(seen_mutex);
+            seen.emplace_back(request.sql);
+            if (request.sql.find("@broken") != std::string::npos) {
+                return MysqlMockResult::error(1193, "Unknown system variable 'broken'");
+            }
+            return MysqlMockResult::multi({MysqlMockResult::ok(), MysqlMockResult::ok(), MysqlMockResult::ok()});
+        }
+        return std::nullopt;
+    });
+
+    // 收录的字符集走握手，不产生初始化请求
+    MysqlClient plain;
+    MOCK_EXPECT(plain.connect(server.clientConfig()), "plain connect");
+    plain.close();
+    MOCK_EXPECT(seen.empty(), "mapped charset needs no init request");
+
+    auto config = server.clientConfig();
+    config.charset = "koi8r";
+    config.session_variables = {{"time_zone", "'+00:00'"}, {"sql_mode", "'TRADITIONAL'"}};
+    config.init_statements = {"SET @app = 'svc'"};
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(config), "connect with session init");
+    MOCK_EXPECT(seen.size() == 1
+                && seen[0] == "SET NAMES koi8r; SET time_zone = '+00:00', sql_mode = 'TRADITIONAL'; SET @app = 'svc'",
+                "session init sent as one request");
+    auto after = session.query("SELECT 1");
+    MOCK_EXPECT(after && after->row(0).getString(0) == "1", "connection usable after init");
+    session.close();
+
+    config.init_statements = {"SET @broken = 1"};
+    MysqlClient broken;
+    auto failed = broken.connect(config);
+    MOCK_EXPECT(!failed && failed.error().serverErrno() == 1193, "init error fails connect");
+    broken.close();
+
+    server.setHandler(nullptr);
+    std::cout << "  session init OK" << std::endl;
+    return true;
+}
+
+bool testConnectAttributes(MysqlMockServer& server)
+{
+    std::cout << "Testing connection attributes..." << std::endl;
+    server.setHandler([](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (request.sql != "SELECT program_name, client_name") {
+            return std::nullopt;
+        }
+        std::string program = "none";
+        std::string client = "none";
+        for (const auto& [key, value] : request.connect_attributes) {
+            if (key == "program_name") program = value;
+            if (key == "_client_name") client = value;
+        }
+        return MysqlMockResult::resultSet({{"program_name"}, {"client_name"}}, {{program, client}});
+    });
+
+    MysqlClient plain;
+    MOCK_EXPECT(plain.connect(server.clientConfig()), "plain connect");
+    auto none = plain.query("SELECT program_name, client_name");
+    MOCK_EXPECT(none && none->row(0).getString(1) == "none", "no attributes by default");
+    plain.close();
+
+    auto config = server.clientConfig();
+    config.connect_attributes = {{"program_name", "t8"}};
+    MysqlClient tagged;
+    MOCK_EXPECT(tagged.connect(config), "tagged connect");
+    auto attrs = tagged.query("SELECT program_name, client_name");
+    MOCK_EXPECT(attrs && attrs->row(0).getString(0) == "t8" && attrs->row(0).getString(1) == "galay-mysql",
+                "attributes sent in handshake");
+    tagged.close();
+
+    server.setHandler(nullptr);
+    std::cout << "  connection attributes OK" << std::endl;
+    return true;
+}
+
+bool testResolver(MysqlMockServer& server)
+{
+    std::cout << "Testing resolver and dual-stack connect..." << std::endl;
+    MOCK_EXPECT(MysqlResolver::literalFamily("127.0.0.1") == AF_INET, "IPv4 literal");
+    MOCK_EXPECT(MysqlResolver::literalFamily("::1") == AF_INET6 && MysqlResolver::literalFamily("[::1]") == AF_INET6,
+                "IPv6 literal");
+    MOCK_EXPECT(!MysqlResolver::literalFamily("localhost").has_value(), "hostname is not a literal");
+
+    auto resolver = MysqlResolver::create();
+    MOCK_EXPECT(!resolver->cached("localhost").has_value(), "empty cache");
+    auto resolved = resolver->resolve("localhost");
+    MOCK_EXPECT(resolved && !resolved->empty(), "resolve localhost");
+    auto hit = resolver->cached("localhost");
+    MOCK_EXPECT(hit.has_value() && hit->has_value() && **hit == *resolved, "cached until ttl");
+    resolver->invalidate("localhost");
+    MOCK_EXPECT(!resolver->cached("localhost").has_value(), "invalidate");
+
+    // 同一主机名的并发解析合并为一次，回调都拿到结果
+    std::atomic<int> callbacks{0};
+    for (int i = 0; i < 2; ++i) {
+        resolver->resolveAsync("localhost", [&callbacks](MysqlResolver::Result result) {
+            if (result && !result->empty()) {
+                callbacks.fetch_add(1);
+            }
+        });
+    }
+    for (int i = 0; i < 500 && callbacks.load() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    MOCK_EXPECT(callbacks.load() == 2, "async resolve callbacks");
+
+    auto by_name = server.clientConfig();
+    by_name.host = "localhost";
+    MysqlClient named;
+    auto connected = named.connect(by_name);
+    MOCK_EXPECT(connected, "connect by hostname: " << (connected ? "" : connected.error().message()));
+    named.close();
+
+    MysqlMockServerConfig v6_config;
+    v6_config.host = "::1";
+    MysqlMockServer v6_server(v6_config);
+    if (!v6_server.start()) {
+        std::cout << "  IPv6 loopback unavailable, skipping IPv6 connect" << std::endl;
+    } else {
+        for (const char* host : {"::1", "[::1]"}) {
+            auto config = v6_server.clientConfig();
+            config.host = host;
+            MysqlClient client;
+            auto v6 = client.connect(config);
+            MOCK_EXPECT(v6, "IPv6 connect " << host << ": " << (v6 ? "" : v6.error().message()));
+            auto one = client.query("SELECT 1");
+            MOCK_EXPECT(one && one->row(0).getString(0) == "1", "IPv6 query");
+            client.close();
+        }
+        v6_server.stop();
+    }
+
+    std::cout << "  resolver OK" << std::endl;
+    return true;
+}
+
+bool testMultiResults(MysqlMockServer& server)
+{
+    std::cout << "Testing multi-result responses..." << std::endl;
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(server.clientConfig("test")), "connect");
+
+    auto all = session.queryMulti("CALL report()");
+    MOCK_EXPECT(all && all->size() == 3, "queryMulti returns every result set");
+    MOCK_EXPECT((*all)[0].rowCount() == 2 && (*all)[1].row(0).getString(0) == "alice"
+                && !(*all)[2].hasResultSet(), "queryMulti order");
+    MOCK_EXPECT(!((*all)[2].statusFlags() & 0x0008), "last result clears MORE_RESULTS");
+
+    auto first = session.query("CALL report()");
+    MOCK_EXPECT(first && first->rowCount() == 2, "query returns first result set");
+    auto after = session.query("SELECT 5");
+    MOCK_EXPECT(after && after->row(0).getString(0) == "5", "connection in sync after drain");
+
+    const std::string_view sqls[] = {"CALL report()", "SELECT 6"};
+    auto pipeline = session.pipeline(sqls);
+    MOCK_EXPECT(pipeline && pipeline->size() == 4, "pipeline flattens trailing result sets");
+    MOCK_EXPECT((*pipeline)[3].row(0).getString(0) == "6", "pipeline order after multi");
+
+    session.close();
+    std::cout << "  multi-result OK" << std::endl;
+    return true;
+}
+
+bool testBulkInsert(MysqlMockServer& server)
+{
+    std::cout << "Testing bulk insert chunks..." << std::endl;
+    // 服务端按VALUES元组个数回报affected rows
+    server.setHandler([](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (!request.sql.starts_with("INSERT INTO `bulk`")) {
+            return std::nullopt;
+        }
+        uint64_t rows = 0;
+        for (size_t pos = request.sql.find(" VALUES "); pos != std::string_view::npos;
+             pos = request.sql.find("),(", pos + 1)) {
+            ++rows;
+        }
+        return MysqlMockResult::ok(rows);
+    });
+
+    const std::string_view columns[] = {"id", "note"};
+    protocol::MysqlBulkInsertBuilder bulk("bulk", columns, 512);
+    for (int i = 0; i < 100; ++i) {
+        MOCK_EXPECT(bulk.addRow(i, i % 7 == 0 ? std::optional<std::string>() : std::string("n'") + std::to_string(i)),
+                    "add row");
+    }
+    bulk.finish();
+    MOCK_EXPECT(bulk.readyChunks() > 1, "rows split across chunks");
+
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(server.clientConfig()), "connect");
+    auto results = session.batch(bulk.commands());
+    MOCK_EXPECT(results && results->size() == bulk.readyChunks(), "one result per chunk");
+    uint64_t total = 0;
+    for (size_t i = 0; i < results->size(); ++i) {
+        MOCK_EXPECT((*results)[i].affectedRows() == bulk.chunkRows()[i], "per-chunk affected rows");
+        total += (*results)[i].affectedRows();
+    }
+    MOCK_EXPECT(total == 100, "all rows inserted");
+
+    session.close();
+    server.setHandler(nullptr);
+    std::cout << "  bulk insert OK (" << bulk.readyChunks() << " chunks)" << std::endl;
+    return true;
+}
+
+bool testLocalInfile(MysqlMockServer& server)
+{
+    std::cout << "Testing LOAD DATA LOCAL INFILE..." << std::endl;
+    const std::string sql = "LOAD DATA LOCAL INFILE 'rows.csv' INTO TABLE events";
+    {
+        MysqlClient session;
+        MOCK_EXPECT(session.connect(server.clientConfig()), "connect");
+        auto refused = session.loadLocalInfile(sql, MysqlLocalInfileSource::fromMemory("a\n"));
+        MOCK_EXPECT(!refused && refused.error().type() == MYSQL_ERROR_INVALID_PARAM, "opt-in required");
+        auto forbidden = session.query(sql);
+        MOCK_EXPECT(!forbidden && forbidden.error().serverErrno() == 1148, "server refuses without CLIENT_LOCAL_FILES");
+        session.close();
+    }
+
+    auto config = server.clientConfig();
+    config.allow_local_infile = true;
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(config), "connect with local infile");
+
+    // 4字节一块：行跨包，最后一行没有换行符
+    auto memory = session.loadLocalInfile(sql, MysqlLocalInfileSource::fromMemory("a,1\nb,2\nc,3", 4));
+    MOCK_EXPECT(memory && memory->affectedRows() == 3, "memory source rows");
+    MOCK_EXPECT(memory->info().starts_with("Records: 3"), "infile info");
+
+    const std::string path = "/tmp/galay-mysql-t8-" + std::to_string(::getpid()) + ".csv";
+    {
+        std::ofstream file(path);
+        for (int i = 0; i < 20000; ++i) file << i << ",value-" << i << "\n";
+    }
+    auto from_file = session.loadLocalInfile(sql, MysqlLocalInfileSource::fromFile(path, 64 * 1024));
+    std::remove(path.c_str());
+    MOCK_EXPECT(from_file && from_file->affectedRows() == 20000, "file source rows");
+
+    auto missing = session.loadLocalInfile(sql, MysqlLocalInfileSource::fromFile(path));
+    MOCK_EXPECT(!missing && missing.error().type() == MYSQL_ERROR_INVALID_PARAM, "missing file reported");
+
+    // 普通query()收到请求时以空包拒绝，连接仍可用
+    auto declined = session.query(sql);
+    MOCK_EXPECT(!declined && declined.error().type() == MYSQL_ERROR_PROTOCOL, "query() declines infile request");
+    auto after = session.query("SELECT 9");
+    MOCK_EXPECT(after && after->row(0).getString(0) == "9", "connection usable after infile");
+
+    session.close();
+    std::cout << "  local infile OK" << std::endl;
+    return true;
+}
+
+bool testLongData(MysqlMockServer& server)
+{
+    std::cout << "Testing COM_STMT_SEND_LONG_DATA..." << std::endl;
+    server.setHandler(docEchoHandler());
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(server.clientConfig()), "connect");
+    auto stmt = session.prepare(std::string(kDocInsert));
+    MOCK_EXPECT(stmt && stmt->num_params == 2, "prepare");
+
+    // 分段的3MB文档，按256KB一包发送
+    std::string doc(3 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < doc.size(); ++i) doc[i] = static_cast<char>('a' + i % 23);
+    const std::string_view doc_view(doc);
+    const std::string_view parts[] = {doc_view.substr(0, 1000), doc_view.substr(1000, 2000000), doc_view.substr(2001000)};
+    MOCK_EXPECT(session.stmtSendLongData(stmt->statement_id, 1, MysqlLongDataSource::fromChunks(parts)),
+                "send long data");
+
+    const std::vector<std::optional<std::string>> params{std::string("manual"), std::nullopt};
+    const uint16_t long_data[] = {1};
+    auto r = session.stmtExecute(stmt->statement_id, params, {}, long_data);
+    MOCK_EXPECT(r && r->rowCount() == 1, "execute with long data");
+    MOCK_EXPECT(r->row(0).getString(0) == "manual", "inline parameter kept");
+    MOCK_EXPECT(r->row(0).getString(1) == std::to_string(doc.size()), "long data length");
+    MOCK_EXPECT(r->row(0).getString(2) == std::to_string(fnv1a(doc)), "long data content");
+
+    // 执行后服务端清空长数据，普通执行重新使用包内的值
+    auto plain = session.stmtExecute(stmt->statement_id, params);
+    MOCK_EXPECT(plain && plain->row(0).getString(1) == "-1", "long data cleared after execute");
+
+    // 空数据源仍发送一个包：参数为空串而不是NULL
+    MOCK_EXPECT(session.stmtSendLongData(stmt->statement_id, 1, MysqlLongDataSource::fromMemory("")), "empty long data");
+    auto empty = session.stmtExecute(stmt->statement_id, params, {}, long_data);
+    MOCK_EXPECT(empty && empty->row(0).getString(1) == "0", "empty long data is empty string");
+
+    MOCK_EXPECT(session.stmtClose(stmt->statement_id), "close");
+    session.close();
+    server.setHandler(nullptr);
+    std::cout << "  long data OK" << std::endl;
+    return true;
+}
+
+bool testSessionGtid(MysqlMockServer& server)
+{
+    std::cout << "Testing session-tracked GTID..." << std::endl;
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(server.clientConfig()), "connect");
+    auto w = session.query(std::string(kGtidUpdate));
+    MOCK_EXPECT(w && w->affectedRows() == 1, "update");
+    MOCK_EXPECT(w->info() == "Rows matched: 1", "info survives session tracking");
+    MOCK_EXPECT(w->gtids() == kSourceUuid + ":7", "gtid captured from OK packet");
+
+    MysqlGtidSet written;
+    MOCK_EXPECT(written.merge(w->gtids()), "merge gtid");
+    auto r = session.query("SELECT id, name FROM users");
+    MOCK_EXPECT(r && r->rowCount() == 2 && r->gtids().empty(), "reads carry no gtid");
+    MOCK_EXPECT(MysqlGtidSet::parse(kSourceUuid + ":1-7")->contains(written), "written set contained");
+    session.close();
+    std::cout << "  session gtid OK" << std::endl;
+    return true;
+}
+
+bool testLegacyCapabilities()
+{
+    std::cout << "Testing capabilities the server does not advertise..." << std::endl;
+    MysqlMockServerConfig server_config;
+    server_config.disabled_capabilities =
+        protocol::CLIENT_SESSION_TRACK | protocol::CLIENT_LOCAL_FILES | protocol::CLIENT_CONNECT_ATTRS;
+    MysqlMockServer legacy(server_config);
+    legacy.script(std::string(kGtidUpdate), MysqlMockResult::ok(1, 0, "Rows matched: 1").withGtid(kSourceUuid + ":7"));
+    legacy.setHandler([](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (request.sql != "SELECT attribute_count") {
+            return std::nullopt;
+        }
+        return MysqlMockResult::resultSet({{"n"}}, {{std::to_string(request.connect_attributes.size())}});
+    });
+    MOCK_EXPECT(legacy.start(), "legacy start");
+
+    // 客户端请求的可选能力必须与服务端通告的取交集，否则OK包按会话跟踪格式解析会读错info
+    auto config = legacy.clientConfig();
+    config.allow_local_infile = true;
+    config.connect_attributes = {{"program_name", "t8"}};
+    MysqlClient session;
+    MOCK_EXPECT(session.connect(config), "legacy connect");
+    auto w = session.query(std::string(kGtidUpdate));
+    MOCK_EXPECT(w && w->affectedRows() == 1 && w->info() == "Rows matched: 1", "plain OK info parsed");
+    MOCK_EXPECT(w->gtids().empty(), "no gtid without session tracking");
+    auto attrs = session.query("SELECT attribute_count");
+    MOCK_EXPECT(attrs && attrs->row(0).getString(0) == "0", "connect attributes not sent");
+    auto infile = session.loadLocalInfile("LOAD DATA LOCAL INFILE 'rows.csv' INTO TABLE events",
+                                          MysqlLocalInfileSource::fromMemory("a\n"));
+    MOCK_EXPECT(!infile && infile.error().type() == MYSQL_ERROR_INVALID_PARAM, "local infile not negotiated");
+    auto after = session.query("SELECT 5");
+    MOCK_EXPECT(after && after->row(0).getString(0) == "5", "connection usable");
+    session.close();
+    legacy.stop();
+    std::cout << "  legacy capabilities OK" << std::endl;
+    return true;
+}
+
+bool testKillQuery(MysqlMockServer& server)
+{
+    std::cout << "Testing KILL QUERY from a side connection..." << std::endl;
+    MysqlClient victim;
+    MysqlClient side;
+    MOCK_EXPECT(victim.connect(server.clientConfig()) && side.connect(server.clientConfig()), "connect");
+    MOCK_EXPECT(victim.connectionId() != 0 && victim.connectionId() != side.connectionId(), "connection ids");
+
+    const auto started = std::chrono::steady_clock::now();
+    std::thread killer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        (void)side.killQuery(victim.connectionId());
+    });
+    auto slept = victim.query("SELECT SLEEP(5)");
+    killer.join();
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    MOCK_EXPECT(!slept && slept.error().serverErrno() == 1317, "interrupted statement returns 1317");
+    MOCK_EXPECT(elapsed < std::chrono::seconds(2), "kill interrupts before the statement finishes");
+
+    auto after = victim.query("SELECT 7");
+    MOCK_EXPECT(after && after->row(0).getString(0) == "7", "connection reusable after kill");
+
+    victim.close();
+    side.close();
+    std::cout << "  kill query OK" << std::endl;
+    return true;
+}
+
+bool testSyncTimeouts(MysqlMockServer& server)
+{
+    std::cout << "Testing sync timeouts and interleaved batch..." << std::endl;
+    const std::string wide(200, 'w');
+    server.setHandler([&wide](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (!request.sql.starts_with("SELECT wide")) {
+            return std::nullopt;
+        }
+        std::vector<MysqlMockResult::Row> rows(2000, MysqlMockResult::Row{wide});
+        return MysqlMockResult::resultSet({{"payload"}}, std::move(rows));
+    });
+
+    MysqlClient slow;
+    MOCK_EXPECT(slow.connect(server.clientConfig()), "connect");
+    slow.setTimeouts(std::chrono::milliseconds(-1), std::chrono::milliseconds(100));
+    MOCK_EXPECT(slow.query("SELECT 1"), "query within timeout");
+    const auto started = std::chrono::steady_clock::now();
+    auto timed_out = slow.query("SELECT SLEEP(2)");
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    MOCK_EXPECT(!timed_out && timed_out.error().type() == MYSQL_ERROR_TIMEOUT, "recv timeout");
+    MOCK_EXPECT(elapsed < std::chrono::milliseconds(1000), "timeout fires before the response");
+    MOCK_EXPECT(!slow.isConnected(), "connection closed after timeout");
+
+    // 请求与结果都远大于套接字缓冲：边写请求边读结果，不会互相等待
+    MysqlClient bulk;
+    MOCK_EXPECT(bulk.connect(server.clientConfig()), "bulk connect");
+    bulk.setTimeouts(std::chrono::seconds(10), std::chrono::seconds(10));
+    const std::string padding(64 * 1024, 'p');
+    std::vector<std::string> sqls;
+    for (int i = 0; i < 64; ++i) {
+        sqls.push_back("SELECT wide /* " + padding + " */");
+    }
+    const std::vector<std::string_view> views(sqls.begin(), sqls.end());
+    auto results = bulk.pipeline(views);
+    MOCK_EXPECT(results && results->size() == sqls.size(), "interleaved pipeline");
+    MOCK_EXPECT(results->back().rowCount() == 2000 && results->back().row(1999).getString(0) == wide,
+                "interleaved pipeline rows");
+    MOCK_EXPECT(bulk.query("SELECT 7") && bulk.isConnected(), "connection usable after pipeline");
+    bulk.close();
+
+    server.setHandler(nullptr);
+    std::cout << "  sync timeouts OK" << std::endl;
+    return true;
+}
+
+bool testCancellationToken()
+{
+    std::cout << "Testing cancellation token..." << std::endl;
+    MysqlCancellationToken token;
+    int fired = 0;
+    const uint64_t kept = token.subscribe([&fired]() { ++fired; });
+    const uint64_t dropped = token.subscribe([&fired]() { fired += 100; });
+    MOCK_EXPECT(kept != 0 && dropped != 0 && kept != dropped, "subscription ids");
+    token.unsubscribe(dropped);
+
+    MysqlCancellationToken copy = token;
+    MOCK_EXPECT(copy.cancel() && !token.cancel(), "cancel fires once across copies");
+    MOCK_EXPECT(token.isCancelled() && fired == 1, "only live callbacks run");
+    MOCK_EXPECT(token.subscribe([&fired]() { ++fired; }) == 0 && fired == 2, "late subscriber runs immediately");
+
+    std::cout << "  cancellation token OK" << std::endl;
+    return true;
+}
+
+bool testAdaptiveBuffer()
+{
+    std::cout << "Testing adaptive buffer provider..." << std::endl;
+    MysqlAdaptiveBufferConfig config;
+    config.max_capacity = 1 << 20;
+    config.shrink_after = std::chrono::milliseconds(0);
+    MysqlAdaptiveBufferProvider buffer(config);
+    MOCK_EXPECT(buffer.usesInlineStorage(), "starts inline");
+
+    // 包头声明100000字节负载，写窗口应一次扩到能容纳整个包
+    const size_t payload_len = 100000;
+    const char header[4] = {static_cast<char>(payload_len & 0xFF),
+                            static_cast<char>((payload_len >> 8) & 0xFF),
+                            static_cast<char>((payload_len >> 16) & 0xFF), 0};
+    struct iovec iov[2];
+    MOCK_EXPECT(buffer.getWriteIovecs(iov, 2) >= 1, "inline window");
+    std::memcpy(iov[0].iov_base, header, sizeof(header));
+    buffer.produce(sizeof(header));
+
+    size_t written = sizeof(header);
+    while (written < payload_len + sizeof(header)) {
+        const size_t count = buffer.getWriteIovecs(iov, 2);
+        MOCK_EXPECT(count > 0, "window after grow");
+        const size_t chunk = std::min(iov[0].iov_len, payload_len + sizeof(header) - written);
+        std::memset(iov[0].iov_base, 'x', chunk);
+        buffer.produce(chunk);
+        written += chunk;
+    }
+    MOCK_EXPECT(!buffer.usesInlineStorage() && buffer.capacity() >= payload_len + sizeof(header), "grown to packet");
+    MOCK_EXPECT(buffer.getReadIovecs(iov, 2) == 1 && iov[0].iov_len == written, "contiguous after grow");
+    MOCK_EXPECT(std::memcmp(iov[0].iov_base, header, sizeof(header)) == 0, "header preserved across grow");
+
+    buffer.consume(written);
+    MOCK_EXPECT(buffer.usesInlineStorage() && buffer.capacity() == MysqlAdaptiveBufferProvider::kInlineCapacity,
+                "shrinks back when idle");
+
+    MysqlAdaptiveBufferConfig capped;
+    capped.max_capacity = 8192;
+    MysqlAdaptiveBufferProvider small(capped);
+    small.getWriteIovecs(iov, 2);
+    std::memcpy(iov[0].iov_base, header, sizeof(header));
+    small.produce(sizeof(header));
+    MOCK_EXPECT(small.getWriteIovecs(iov, 2) > 0 && small.capacity() == 8192, "grow capped at max");
+
+    std::cout << "  adaptive buffer OK" << std::endl;
+    return true;
+}
+
+bool testLinearBuffer()
+{
+    std::cout << "Testing linear buffer provider..." << std::endl;
+    MysqlLinearBufferProvider buffer(8000);
+    MOCK_EXPECT(buffer.capacity() == 8192 && reinterpret_cast<uintptr_t>(buffer.data()) % 4096 == 0,
+                "page aligned storage");
+
+    struct iovec iov[2];
+    MOCK_EXPECT(buffer.getWriteIovecs(iov, 2) == 1 && iov[0].iov_len == 8192, "single write window");
+    std::memset(iov[0].iov_base, 'a', 7000);
+    buffer.produce(7000);
+    buffer.consume(6990);
+
+    // 尾部不足1/4，前移剩余的10字节后仍为单段窗口
+    MOCK_EXPECT(buffer.getWriteIovecs(iov, 2) == 1 && iov[0].iov_len == 8192 - 10, "compacted write window");
+    std::memset(iov[0].iov_base, 'b', 100);
+    buffer.produce(100);
+    MOCK_EXPECT(buffer.getReadIovecs(iov, 2) == 1 && iov[0].iov_len == 110, "single read window");
+    const char* readable = static_cast<const char*>(iov[0].iov_base);
+    MOCK_EXPECT(readable == buffer.data() && readable[9] == 'a' && readable[10] == 'b', "data preserved");
+
+    buffer.consume(110);
+    MOCK_EXPECT(buffer.size() == 0 && buffer.getWriteIovecs(iov, 2) == 1 && iov[0].iov_len == 8192, "reset on drain");
+    std::cout << "  linear buffer OK" << std::endl;
+    return true;
+}
+
+bool testSlabBuffer()
+{
+    std::cout << "Testing slab buffer provider..." << std::endl;
+    MysqlBufferSlabPoolConfig config;
+    config.chunk_size = 4000;
+    auto pool = std::make_shared<MysqlBufferSlabPool>(config);
+    MOCK_EXPECT(pool->chunkSize() == 4032, "chunk rounded to cache line");
+
+    MysqlSlabBufferProvider first(pool);
+    MysqlSlabBufferProvider second(pool);
+    MOCK_EXPECT(!first.leased() && pool->leasedChunks() == 0, "idle provider holds no chunk");
+
+    struct iovec iov[2];
+    MOCK_EXPECT(first.getWriteIovecs(iov, 2) == 1 && iov[0].iov_len == pool->chunkSize(), "lease on first recv");
+    MOCK_EXPECT(reinterpret_cast<uintptr_t>(iov[0].iov_base) % 64 == 0, "chunk cache-line aligned");
+    std::memset(iov[0].iov_base, 'x', 100);
+    first.produce(100);
+    second.getWriteIovecs(iov, 2);
+    MOCK_EXPECT(pool->leasedChunks() == 2 && pool->totalChunks() >= 128, "two chunks leased from one slab");
+
+    first.consume(60);
+    MOCK_EXPECT(first.leased() && first.size() == 40, "partial consume keeps chunk");
+    first.consume(40);
+    second.clear();
+    MOCK_EXPECT(!first.leased() && !second.leased() && pool->leasedChunks() == 0, "drained providers return chunks");
+
+    std::cout << "  slab buffer OK" << std::endl;
+    return true;
+}
+
+bool testResultSetReuse()
+{
+    std::cout << "Testing result set storage reuse..." << std::endl;
+    MysqlResultSet rs;
+    rs.addField(MysqlField("v", MysqlFieldType::VAR_STRING, 0, 255, 0));
+    rs.appendRow().values().emplace_back(std::string(100, 'x'));
+    const auto* data = rs.row(0).values()[0]->data();
+
+    rs.clear();
+    MOCK_EXPECT(rs.rowCount() == 0 && rs.fieldCount() == 0 && rs.reusableRows() == 1, "clear keeps spare row");
+    auto& row = rs.appendRow();
+    MOCK_EXPECT(rs.reusableRows() == 0 && row.values().size() == 1, "appendRow takes spare row");
+    MOCK_EXPECT(row.values()[0]->data() == data, "spare row keeps string capacity");
+
+    std::cout << "  result set reuse OK" << std::endl;
+    return true;
+}
+
+struct AsyncTestState {
+    std::atomic<bool> done{false};
+    std::atomic<bool> ok{true};
+    std::string error;
+
+    void fail(std::string msg) {
+        error = std::move(msg);
+        ok.store(false, std::memory_order_relaxed);
+        done.store(true, std::memory_order_release);
+    }
+
+    void pass() {
+        done.store(true, std::memory_order_release);
+    }
+};
+
+/**
+ * @brief 在独立的Runtime上运行一个异步用例
+ * @details spawn(scheduler, state)返回用例协程；限定时间内未结束或未通过都算失败，Runtime在返回前停止
+ */
+template<typename Spawn>
+bool runFlow(std::string_view name, Spawn&& spawn, std::chrono::seconds timeout = std::chrono::seconds(10))
+{
+    Runtime runtime;
+    runtime.start();
+    auto* scheduler = runtime.getNextIOScheduler();
+    MOCK_EXPECT(scheduler != nullptr, "scheduler");
+    AsyncTestState state;
+    scheduler->spawn(spawn(scheduler, &state));
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!state.done.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    runtime.stop();
+
+    MOCK_EXPECT(state.done.load(std::memory_order_acquire), name << " test timeout");
+    MOCK_EXPECT(state.ok.load(std::memory_order_relaxed), name << ": " << state.error);
+    return true;
+}
+
+struct MockUserRow {
+    int64_t id;
+    std::optional<std::string> name;
+    MYSQL_FIELDS(id, name)
+};
+
+Coroutine testAsyncDeadline(IOScheduler* scheduler, AsyncTestState* state, MysqlConfig config)
+{
+    auto client = AsyncMysqlClientBuilder().scheduler(scheduler).build();
+    auto side = AsyncMysqlClientBuilder().scheduler(scheduler).build();
+    {
+        auto a = co_await client.connect(config);
+        auto b = co_await side.connect(config);
+        if (!a || !b) {
+            state->fail("async deadline connect failed");
+            co_return;
+        }
+    }
+    {
+        auto sleeping = client.query("SELECT SLEEP(5)");
+        sleeping.timeout(std::chrono::milliseconds(100));
+        auto r = co_await sleeping;
+        if (r || r.error().type() != MYSQL_ERROR_TIMEOUT || !client.hasPendingResponse()) {
+            state->fail("async deadline should time out with a pending response");
+            co_return;
+        }
+        auto refused = co_await client.query("SELECT 1");
+        if (refused || refused.error().type() != MYSQL_ERROR_CONNECTION) {
+            state->fail("commands must be refused while a response is pending");
+            co_return;
+        }
+        auto killed = co_await side.killQuery(client.connectionId());
+        auto draining = client.drain();
+        draining.timeout(std::chrono::seconds(2));
+        auto drained = co_await draining;
+        if (!killed || !drained || !client.isReusable()) {
+            state->fail("async kill + drain failed");
+            co_return;
+        }
+        auto again = co_await client.query("SELECT 8");
+        if (!again || !again->has_value() || (*again)->row(0).getString(0) != "8") {
+            state->fail("async connection not reusable after drain");
+            co_return;
+        }
+    }
+    co_await side.close();
+    co_await client.close();
+    state->pass();
+}
+
+Coroutine testAsyncPoolRecover(IOScheduler* scheduler, AsyncTestState* state, MysqlConfig config)
+{
+    MysqlConnectionPoolConfig pool_config;
+    pool_config.mysql_config = config;
+    pool_config.max_connections = 1;
+    pool_config.recover_timeout = std::chrono::seconds(2);
+    MysqlConnectionPool pool(scheduler, pool_config);
+
+    auto acquired = co_await pool.acquire();
+    if (!acquired || !acquired->has_value()) {
+        state->fail("pool recover acquire failed");
+        co_return;
+    }
+    AsyncMysqlClient* client = acquired->value();
+    const uint32_t connection_id = client->connectionId();
+    auto sleeping = client->query("SELECT SLEEP(5)");
+    sleeping.timeout(std::chrono::milliseconds(100));
+    auto r = co_await sleeping;
+    if (r || !client->isDrainable()) {
+        state->fail("pool recover query should time out with a pending response");
+        co_return;
+    }
+    // 池已满：恢复用临时旁路连接KILL，排空后同一条连接交给等待者
+    const auto started = std::chrono::steady_clock::now();
+    pool.release(client);
+    auto again = co_await pool.acquire();
+    if (!again || !again->has_value() || again->value()->connectionId() != connection_id
+        || std::chrono::steady_clock::now() - started > std::chrono::seconds(2)) {
+        state->fail("timed-out connection should come back from acquire()");
+        co_return;
+    }
+    client = again->value();
+    auto after = co_await client->query("SELECT 11");
+    if (!after || !after->has_value() || (*after)->row(0).getString(0) != "11"
+        || pool.size() != 1 || pool.health().consecutive_failures != 0) {
+        state->fail("recovered connection should be usable and not count as a failure");
+        co_return;
+    }
+    pool.release(client);
+    state->pass();
+}
+
+Coroutine testAsyncCancel(IOScheduler* scheduler, AsyncTestState* state, MysqlConfig config)
+{
+    MysqlConnectionPoolConfig pool_config;
+    pool_config.mysql_config = config;
+    pool_config.max_connections = 2;
+    MysqlConnectionPool pool(scheduler, pool_config);
+
+    auto acquired = co_await pool.acquire();
+    if (!acquired || !acquired->has_value()) {
+        state->fail("async cancel acquire failed");
+        co_return;
+    }
+    AsyncMysqlClient* client = acquired->value();
+    {
+        // 发送前取消：不产生任何IO
+        MysqlCancellationToken token;
+        token.cancel();
+        auto aw = client->query("SELECT 1");
+        aw.cancelOn(token);
+        auto r = co_await aw;
+        if (r || r.error().type() != MYSQL_ERROR_CANCELLED) {
+            state->fail("cancel before send should return MYSQL_ERROR_CANCELLED");
+            co_return;
+        }
+    }
+    {
+        // 执行中取消：池的取消钩子借另一条连接KILL QUERY，命令以CANCELLED结束
+        MysqlCancellationToken token;
+        std::thread canceller([token]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            token.cancel();
+        });
+        const auto started = std::chrono::steady_clock::now();
+        auto aw = client->query("SELECT SLEEP(5)");
+        aw.cancelOn(token);
+        auto r = co_await aw;
+        canceller.join();
+        if (r || r.error().type() != MYSQL_ERROR_CANCELLED
+            || std::chrono::steady_clock::now() - started > std::chrono::seconds(2)) {
+            state->fail("in-flight cancel should interrupt the statement");
+            co_return;
+        }
+    }
+    {
+        auto r = co_await client->query("SELECT 9");
+        if (!r || !r->has_value() || (*r)->row(0).getString(0) != "9" || !client->isReusable()) {
+            state->fail("connection not reusable after cancel");
+            co_return;
+        }
+    }
+    {
+        // 完成后才到达的取消：不得KILL复用同一连接的下一条语句
+        MysqlCancellationToken token;
+        auto aw = client->query("SELECT 10");
+        aw.cancelOn(token);
+        auto first = co_await aw;
+        if (!first || !first->has_value() || client->inflightGeneration() != 0) {
+            state->fail("cancellable query should complete and clear its generation");
+            co_return;
+        }
+        std::thread canceller([token]() mutable { token.cancel(); });
+        canceller.join();
+        auto next = co_await client->query("SELECT SLEEP(0.3)");
+        if (!next || !next->has_value() || (*next)->rowCount() != 1) {
+            state->fail("late cancel must not kill the next query on the reused connection");
+            co_return;
+        }
+    }
+    // 等旁路KILL协程把借用的连接还回池中，再析构连接池
+    for (int i = 0; i < 100 && pool.idleCount() == 0; ++i) {
+        co_await client->query("SELECT 1");
+    }
+    pool.release(client);
+    state->pass();
+}
+
+Coroutine testAsyncClient(IOScheduler* scheduler, AsyncTestState* state, MysqlConfig config)
+{
+    auto client = AsyncMysqlClientBuilder().scheduler(scheduler).maxBufferSize(1 << 20).build();
+    {
+        auto cr = co_await client.connect(config);
+        if (!cr || !cr->has_value()) {
+            state->fail("async connect failed");
+            co_return;
+        }
+    }
+    {
+        auto r = co_await client.query("SELECT id, name FROM users");
+        if (!r || !r->has_value() || (*r)->rowCount() != 2) {
+            state->fail("async scripted select failed");
+            co_return;
+        }
+    }
+    {
+        // 归还的结果集作为下一次查询的行存储
+        auto r = co_await client.query("SELECT id, name FROM users");
+        if (!r || !r->has_value() || (*r)->rowCount() != 2) {
+            state->fail("async select before recycle failed");
+            co_return;
+        }
+        client.recycle(std::move(**r));
+        auto again = co_await client.query("SELECT id, name FROM users");
+        if (!again || !again->has_value() || (*again)->rowCount() != 2
+            || (*again)->row(0).getInt64(0) != 1 || !(*again)->row(1).isNull(1)) {
+            state->fail("async select after recycle failed");
+            co_return;
+        }
+    }
+    {
+        auto r = co_await client.queryAs<MockUserRow>("SELECT id, name FROM users");
+        if (!r || !r->has_value() || (*r)->size() != 2 || (**r)[0].id != 1 || (**r)[1].name.has_value()) {
+            state->fail("async queryAs failed");
+            co_return;
+        }
+    }
+    {
+        // 单行超过内联区，依赖按包头扩容
+        auto r = co_await client.query("SELECT payload FROM blobs");
+        if (!r || !r->has_value() || (*r)->rowCount() != 1 || (*r)->row(0).getString(0).size() != 200000) {
+            state->fail("async large row failed");
+            co_return;
+        }
+    }
+    {
+        auto r = co_await client.query("SELECT * FROM missing");
+        if (r) {
+            state->fail("async scripted error expected");
+            co_return;
+        }
+    }
+    {
+        auto first = co_await client.query("CALL report()");
+        if (!first || !first->has_value() || (*first)->rowCount() != 2) {
+            state->fail("async query on multi-result failed");
+            co_return;
+        }
+        auto all = co_await client.queryMulti("CALL report()");
+        if (!all || !all->has_value() || (*all)->size() != 3 || (**all)[1].row(0).getString(1) != "7") {
+            state->fail("async queryMulti failed");
+            co_return;
+        }
+    }
+    {
+        // LOCAL INFILE：生成器逐行产生数据，小块强制拆成多个包
+        auto infile_config = config;
+        infile_config.allow_local_infile = true;
+        auto loader = AsyncMysqlClientBuilder().scheduler(scheduler).build();
+        auto cr = co_await loader.connect(infile_config);
+        if (!cr || !cr->has_value()) {
+            state->fail("async infile connect failed");
+            co_return;
+        }
+        int next = 0;
+        auto r = co_await loader.loadLocalInfile("LOAD DATA LOCAL INFILE 'gen.csv' INTO TABLE events",
+            MysqlLocalInfileSource::fromGenerator([&next]() -> std::optional<std::string> {
+                if (next == 500) return std::nullopt;
+                return std::to_string(next++) + ",row\n";
+            }, 1000));
+        if (!r || !r->has_value() || (*r)->affectedRows() != 500) {
+            state->fail("async loadLocalInfile failed");
+            co_return;
+        }
+        auto after = co_await loader.query("SELECT 1");
+        if (!after || !after->has_value() || (*after)->row(0).getString(0) != "1") {
+            state->fail("async connection unusable after loadLocalInfile");
+            co_return;
+        }
+        co_await loader.close();
+    }
+    {
+        // 长数据：1MB按64KB一包连续写出，随后执行
+        auto stmt = co_await client.prepare(kDocInsert);
+        if (!stmt || !stmt->has_value()) {
+            state->fail("async prepare docs failed");
+            co_return;
+        }
+        const uint32_t stmt_id = (*stmt)->statement_id;
+        const std::string doc(1 << 20, 'd');
+        auto sent = co_await client.stmtSendLongData(stmt_id, 1, MysqlLongDataSource::fromMemory(doc, 64 * 1024));
+        if (!sent || !sent->has_value()) {
+            state->fail("async stmtSendLongData failed");
+            co_return;
+        }
+        const std::optional<std::string_view> params[] = {std::string_view("async"), std::nullopt};
+        const uint16_t long_data[] = {1};
+        auto r = co_await client.stmtExecute(stmt_id, params, {}, long_data);
+        if (!r || !r->has_value() || (*r)->row(0).getString(1) != std::to_string(doc.size())
+            || (*r)->row(0).getString(2) != std::to_string(fnv1a(doc))) {
+            state->fail("async execute with long data failed");
+            co_return;
+        }
+    }
+    co_await client.close();
+    state->pass();
+}
+
+bool testRouterClassify()
+{
+    std::cout << "Testing router statement classification..." << std::endl;
+    const auto replica = MysqlRouteTarget::Replica;
+    const auto primary = MysqlRouteTarget::Primary;
+    MOCK_EXPECT(MysqlRouter::classify("SELECT 1") == replica, "plain select");
+    MOCK_EXPECT(MysqlRouter::classify("  /* c */ select * from t") == replica, "leading comment");
+    MOCK_EXPECT(MysqlRouter::classify("(SELECT a FROM t) UNION (SELECT b FROM u)") == replica, "parenthesized union");
+    MOCK_EXPECT(MysqlRouter::classify("WITH c AS (SELECT 1) SELECT * FROM c") == replica, "cte select");
+    MOCK_EXPECT(MysqlRouter::classify("SELECT 'FOR UPDATE' AS s, `lock` FROM t") == replica, "quoted words ignored");
+    MOCK_EXPECT(MysqlRouter::classify("SELECT REPLACE(a, 'x', 'y'), INSERT(a, 1, 1, 'z') FROM t") == replica,
+                "string functions named like keywords");
+
+    MOCK_EXPECT(MysqlRouter::classify("SELECT * FROM t WHERE id = 1 FOR UPDATE") == primary, "for update");
+    MOCK_EXPECT(MysqlRouter::classify("SELECT * FROM t LOCK IN SHARE MODE") == primary, "lock in share mode");
+    MOCK_EXPECT(MysqlRouter::classify("SELECT a INTO @x FROM t") == primary, "select into");
+    MOCK_EXPECT(MysqlRouter::classify("SELECT LAST_INSERT_ID()") == primary, "session function");
+    MOCK_EXPECT(MysqlRouter::classify("select get_lock ('k', 1)") == primary, "lock function");
+    MOCK_EXPECT(MysqlRouter::classify("WITH c AS (SELECT 1) DELETE FROM t") == primary, "cte delete");
+    MOCK_EXPECT(MysqlRouter::classify("INSERT INTO t VALUES (1)") == primary, "insert");
+    MOCK_EXPECT(MysqlRouter::classify("BEGIN") == primary, "transaction");
+    MOCK_EXPECT(MysqlRouter::classify("SHOW TABLES") == primary, "show");
+    MOCK_EXPECT(MysqlRouter::classify("") == primary, "empty");
+    std::cout << "  classification OK" << std::endl;
+    return true;
+}
+
+Coroutine testAsyncRouterFlow(IOScheduler* scheduler, AsyncTestState* state, MysqlMockServer* replica_server,
+                              MysqlConfig primary, MysqlConfig replica, MysqlConfig unreachable)
+{
+    MysqlRouterConfig config;
+    config.primary.mysql_config = primary;
+    for (const auto& node : {replica, replica, unreachable}) {
+        MysqlConnectionPoolConfig pool_config;
+        pool_config.mysql_config = node;
+        pool_config.max_connections = 2;
+        config.replicas.push_back(std::move(pool_config));
+    }
+    config.replica_down_cooldown = std::chrono::seconds(30);
+    config.replica_gtid_refresh_interval = std::chrono::milliseconds(0);
+    MysqlRouter router(scheduler, config);
+
+    const std::string_view read = "SELECT id, name FROM users";
+    {
+        // 事务语句固定在主库，整个事务使用同一个借出的连接
+        auto tx = co_await router.acquire("BEGIN");
+        if (!tx || !tx->has_value() || !(*tx)->isPrimary()) {
+            state->fail("router should send BEGIN to the primary");
+            co_return;
+        }
+        auto& conn = tx->value();
+        auto begin = co_await conn->beginTransaction();
+        auto r = co_await conn->query(read);
+        auto commit = co_await conn->commit();
+        if (!begin || !r || !r->has_value() || (*r)->row(0).getString(1) != "alice" || !commit) {
+            state->fail("pinned transaction failed");
+            co_return;
+        }
+        router.release(conn);
+    }
+    {
+        auto locked = co_await router.acquire("SELECT id FROM users WHERE id = 1 FOR UPDATE");
+        if (!locked || !locked->has_value() || !(*locked)->isPrimary()) {
+            state->fail("locking read should go to the primary");
+            co_return;
+        }
+        router.release(locked->value());
+    }
+    {
+        // 两个从库各借出一条后，得分最低的是尚未探测的不可达从库：获取失败并被标记为down
+        auto a = co_await router.acquire(read);
+        auto b = co_await router.acquire(read);
+        if (!a || !a->has_value() || !b || !b->has_value()
+            || (*a)->isPrimary() || (*b)->isPrimary() || (*a)->node == (*b)->node || (*a)->node == 3 || (*b)->node == 3) {
+            state->fail("reads should spread over the reachable replicas");
+            co_return;
+        }
+        auto r = co_await (**a)->query(read);
+        if (!r || !r->has_value() || (*r)->row(0).getString(1) != "replica") {
+            state->fail("read should be served by a replica");
+            co_return;
+        }
+        auto c = co_await router.acquire(read);
+        if (c || !router.stats(3).down) {
+            state->fail("unreachable replica should fail and be marked down");
+            co_return;
+        }
+        auto d = co_await router.acquire(read);
+        if (!d || !d->has_value() || (*d)->node == 3 || (*d)->isPrimary()) {
+            state->fail("down replica should be skipped");
+            co_return;
+        }
+        router.release(a->value());
+        router.release(b->value());
+        router.release(d->value());
+    }
+    if (router.stats(1).in_flight != 0 || router.stats(2).in_flight != 0 || router.stats(3).in_flight != 0
+        || router.stats(0).routed != 2 || router.stats(1).latency_ewma_us <= 0.0) {
+        state->fail("router stats mismatch");
+        co_return;
+    }
+
+    // 读己之写：从库快照未包含写入的GTID前读取留在主库，快照追上后才回到从库
+    MysqlGtidSet written;
+    {
+        auto w = co_await router.acquire(kGtidUpdate);
+        if (!w || !w->has_value() || !(*w)->isPrimary()) {
+            state->fail("write should go to the primary");
+            co_return;
+        }
+        auto r = co_await (**w)->query(kGtidUpdate);
+        router.release(w->value());
+        if (!r || !r->has_value() || !written.merge((*r)->gtids()) || written.empty()) {
+            state->fail("write should report its gtid");
+            co_return;
+        }
+    }
+    // 每次路由后用一次往返等待后台刷新
+    const auto refreshed = MysqlGtidSet::parse(kSourceUuid + ":1-6").value();
+    bool on_replica = false;
+    for (size_t i = 0; i < 200 && !router.executedGtids(1).contains(refreshed); ++i) {
+        auto x = co_await router.acquire(read, written);
+        if (!x || !x->has_value()) {
+            state->fail("gtid-gated acquire failed");
+            co_return;
+        }
+        on_replica = on_replica || !(*x)->isPrimary();
+        co_await (**x)->query("SELECT 1");
+        router.release(x->value());
+    }
+    if (on_replica || router.stats(1).gtid_lagging == 0 || router.executedGtids(1).contains(written)) {
+        state->fail("lagging replica should not serve the read");
+        co_return;
+    }
+    replica_server->script("SELECT @@GLOBAL.gtid_executed",
+                           MysqlMockResult::resultSet({{"@@GLOBAL.gtid_executed"}}, {{kSourceUuid + ":1-7"}}));
+    for (size_t i = 0; i < 200 && !on_replica; ++i) {
+        auto x = co_await router.acquire(read, written);
+        if (!x || !x->has_value()) {
+            state->fail("gtid-gated acquire failed");
+            co_return;
+        }
+        on_replica = !(*x)->isPrimary();
+        auto r = co_await (**x)->query(read);
+        router.release(x->value());
+        if (on_replica && (!r || !r->has_value() || (*r)->row(0).getString(1) != "replica")) {
+            state->fail("caught-up replica should serve the read");
+            co_return;
+        }
+    }
+    if (!on_replica || !router.executedGtids(1).contains(written)) {
+        state->fail("read should return to a replica once the gtid is applied");
+        co_return;
+    }
+    state->pass();
+}
+
+bool testAsyncRouter(MysqlMockServer& server)
+{
+    std::cout << "Testing read/write router..." << std::endl;
+    MysqlMockServer replica;
+    MOCK_EXPECT(replica.start(), "replica start");
+    replica.script("SELECT id, name FROM users",
+                   MysqlMockResult::resultSet({{"id", MysqlFieldType::LONGLONG}, {"name"}}, {{"9", "replica"}}));
+    replica.script("SELECT @@GLOBAL.gtid_executed",
+                   MysqlMockResult::resultSet({{"@@GLOBAL.gtid_executed"}}, {{kSourceUuid + ":1-6"}}));
+    MysqlMockServer stopped;
+    MOCK_EXPECT(stopped.start(), "stopped start");
+    const auto unreachable = stopped.clientConfig();
+    stopped.stop();
+
+    const bool passed = runFlow("router", [&](IOScheduler* scheduler, AsyncTestState* state) {
+        return testAsyncRouterFlow(scheduler, state, &replica, server.clientConfig(), replica.clientConfig(),
+                                   unreachable);
+    });
+    replica.stop();
+    if (!passed) {
+        return false;
+    }
+    std::cout << "  router OK" << std::endl;
+    return true;
+}
+
+Coroutine testAsyncHedgeFlow(IOScheduler* scheduler, AsyncTestState* state, MysqlConfig primary, MysqlConfig slow,
+                             MysqlConfig fast, std::atomic<int>* slow_kills)
+{
+    MysqlRouterConfig config;
+    config.primary.mysql_config = primary;
+    for (const auto& node : {slow, fast}) {
+        MysqlConnectionPoolConfig pool_config;
+        pool_config.mysql_config = node;
+        pool_config.max_connections = 2;
+        config.replicas.push_back(std::move(pool_config));
+    }
+    config.hedge.max_delay = std::chrono::milliseconds(20);
+    config.hedge.budget_ratio = 1.0;
+    MysqlRouter router(scheduler, config);
+
+    {
+        auto rejected = co_await router.hedgedQuery("SELECT * FROM users FOR UPDATE");
+        if (rejected || rejected.error().type() != MYSQL_ERROR_INVALID_PARAM) {
+            state->fail("hedged query should reject locking reads");
+            co_return;
+        }
+    }
+    {
+        // 首个请求落在慢从库（轮转起点为第一个从库），20ms后对冲到快从库并取其结果
+        const auto started = std::chrono::steady_clock::now();
+        auto r = co_await router.hedgedQuery("SELECT name FROM users WHERE id = 1");
+        const auto elapsed = std::chrono::steady_clock::now() - started;
+        if (!r || !r->has_value() || (*r)->row(0).getString(0) != "fast") {
+            state->fail("hedged query should return the fast replica's answer");
+            co_return;
+        }
+        if (elapsed > std::chrono::seconds(1)) {
+            state->fail("hedged query should not wait for the slow replica");
+            co_return;
+        }
+        const auto stats = router.hedgeStats();
+        if (stats.queries != 1 || stats.hedged != 1 || stats.hedge_wins != 1) {
+            state->fail("hedge stats mismatch");
+            co_return;
+        }
+    }
+    {
+        // 宽限期后仍在执行的落后请求被KILL QUERY（借用同池的第二条连接）并排空，两条连接都回到慢从库的连接池
+        auto& slow_pool = router.replica(0);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+        while ((router.stats(1).in_flight > 0 || slow_pool.idleCount() < 2)
+               && std::chrono::steady_clock::now() < deadline) {
+            co_await galay::kernel::sleep(std::chrono::milliseconds(10));
+        }
+        if (router.stats(1).in_flight != 0 || slow_pool.size() != 2 || slow_pool.idleCount() != 2) {
+            state->fail("cancelled hedge loser should return a reusable connection");
+            co_return;
+        }
+    }
+    {
+        // 宽限期内自然结束的落后请求：读完响应后归还连接，不产生KILL
+        config.hedge.loser_grace = std::chrono::milliseconds(300);
+        MysqlRouter graceful(scheduler, config);
+        const int kills_before = slow_kills->load();
+        auto r = co_await graceful.hedgedQuery("SELECT name FROM users WHERE id = 2");
+        if (!r || !r->has_value() || (*r)->row(0).getString(0) != "fast") {
+            state->fail("hedged query should return the fast replica's answer");
+            co_return;
+        }
+        co_await galay::kernel::sleep(std::chrono::milliseconds(500));
+        if (slow_kills->load() != kills_before || graceful.stats(1).in_flight != 0
+            || graceful.replica(0).idleCount() != 1) {
+            state->fail("hedge loser finishing within the grace period must not be killed");
+            co_return;
+        }
+    }
+    state->pass();
+}
+
+bool testAsyncHedge(MysqlMockServer& server)
+{
+    std::cout << "Testing hedged replica reads..." << std::endl;
+    MysqlMockServer slow;
+    MysqlMockServer fast;
+    MOCK_EXPECT(slow.start() && fast.start(), "replica start");
+    slow.script("SELECT name FROM users WHERE id = 1",
+                MysqlMockResult::resultSet({{"name"}}, {{"slow"}}).withDelay(std::chrono::seconds(5)));
+    fast.script("SELECT name FROM users WHERE id = 1", MysqlMockResult::resultSet({{"name"}}, {{"fast"}}));
+    slow.script("SELECT name FROM users WHERE id = 2",
+                MysqlMockResult::resultSet({{"name"}}, {{"slow"}}).withDelay(std::chrono::milliseconds(80)));
+    fast.script("SELECT name FROM users WHERE id = 2", MysqlMockResult::resultSet({{"name"}}, {{"fast"}}));
+    std::atomic<int> slow_kills{0};
+    slow.setHandler([&slow_kills](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        if (request.sql.starts_with("KILL")) {
+            ++slow_kills;
+        }
+        return std::nullopt;
+    });
+
+    const bool passed = runFlow("hedge", [&](IOScheduler* scheduler, AsyncTestState* state) {
+        return testAsyncHedgeFlow(scheduler, state, server.clientConfig(), slow.clientConfig(),
+                                  fast.clientConfig(), &slow_kills);
+    });
+    slow.stop();
+    fast.stop();
+    if (!passed) {
+        return false;
+    }
+    std::cout << "  hedged reads OK" << std::endl;
+    return true;
+}
+
+// 按收到的顺序记录语句；COMMIT请求第一次返回死锁，热点行的锁等待总是超时
+struct TransactionLog {
+    std::mutex mutex;
+    std::vector<std::string> statements;
+    int commits = 0;
+
+    std::vector<std::string> snapshot()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return statements;
+    }
+};
+
+constexpr std::string_view kTxBegin = "BEGIN; SELECT stock FROM items WHERE id = 7 FOR UPDATE";
+constexpr std::string_view kTxCommit =
+    "UPDATE items SET stock = stock - 1 WHERE id = 7; INSERT INTO orders (item_id) VALUES (7); COMMIT";
+constexpr std::string_view kTxHot = "SELECT v FROM hot WHERE id = 1 FOR UPDATE";
+
+MysqlMockServer::QueryHandler transactionHandler(TransactionLog* log)
+{
+    return [log](const MysqlMockRequest& request) -> std::optional<MysqlMockResult> {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        log->statements.emplace_back(request.sql);
+        if (request.sql == kTxBegin) {
+            return MysqlMockResult::multi({MysqlMockResult::ok(),
+                                           MysqlMockResult::resultSet({{"stock", MysqlFieldType::LONGLONG}}, {{"3"}})});
+        }
+        if (request.sql == kTxCommit) {
+            if (log->commits++ == 0) {
+                return MysqlMockResult::multi({MysqlMockResult::error(
+                    1213, "Deadlock found when trying to get lock; try restarting transaction", "40001")});
+            }
+            return MysqlMockResult::multi({MysqlMockResult::ok(1), MysqlMockResult::ok(1, 42), MysqlMockResult::ok()});
+        }
+        if (request.sql.ends_with(kTxHot)) {
+            std::vector<MysqlMockResult> parts(request.sql.starts_with("ROLLBACK") ? 2 : 1, MysqlMockResult::ok());
+            parts.push_back(MysqlMockResult::error(1205, "Lock wait timeout exceeded; try restarting transaction"));
+            return MysqlMockResult::multi(std::move(parts));
+        }
+        return std::nullopt;
+    };
+}
+
+Coroutine testAsyncTransactionFlow(IOScheduler* scheduler, AsyncTestState* state, TransactionLog* log,
+                                   MysqlConfig config)
+{
+    MysqlConnectionPoolConfig pool_config;
+    pool_config.mysql_config = config;
+    pool_config.max_connections = 1;
+    MysqlConnectionPool pool(scheduler, pool_config);
+
+    {
+        // 死锁：BEGIN与首条语句、写入与COMMIT各一次往返，重试时不再单独发送ROLLBACK
+        MysqlTransaction tx(pool);
+        std::optional<MysqlTransaction::Result> written;
+        while (co_await tx.next()) {
+            auto stock = co_await tx.begin("SELECT stock FROM items WHERE id = 7 FOR UPDATE");
+            if (!stock || stock->value().size() != 1 || stock->value()[0].row(0).getString(0) != "3") {
+                continue;
+            }
+            const std::array<std::string_view, 2> writes{"UPDATE items SET stock = stock - 1 WHERE id = 7",
+                                                         "INSERT INTO orders (item_id) VALUES (7)"};
+            written = co_await tx.commit(writes);
+        }
+        if (!tx.committed() || tx.attempts() != 2 || tx.error().has_value()) {
+            state->fail("deadlocked transaction should commit on the second attempt");
+            co_return;
+        }
+        if (!written || !*written || (*written)->value().size() != 2 || (*written)->value()[1].lastInsertId() != 42) {
+            state->fail("commit should return the trailing writes' results");
+            co_return;
+        }
+        const auto sent = log->snapshot();
+        const std::vector<std::string> expected{std::string(kTxBegin), std::string(kTxCommit),
+                                                std::string(kTxBegin), std::string(kTxCommit)};
+        if (sent != expected) {
+            state->fail("deadlock retry should take two round trips per attempt");
+            co_return;
+        }
+    }
+    {
+        // 锁等待超时：下一次BEGIN带上ROLLBACK，次数用尽后回滚并返回最后的错误
+        MysqlTransactionConfig tx_config;
+        tx_config.max_attempts = 2;
+        tx_config.base_backoff = std::chrono::milliseconds(1);
+        MysqlTransaction tx(pool, tx_config);
+        size_t bodies = 0;
+        while (co_await tx.next()) {
+            ++bodies;
+            auto hot = co_await tx.begin(kTxHot);
+            if (!hot) {
+                auto blocked = co_await tx.query("UPDATE hot SET v = v + 1 WHERE id = 1");
+                if (blocked || blocked.error().serverErrno() != 1205) {
+                    state->fail("statements after a failure must not be sent");
+                    co_return;
+                }
+                continue;
+            }
+            co_await tx.commit();
+        }
+        const auto sent = log->snapshot();
+        if (bodies != 2 || tx.committed() || !tx.error() || tx.error()->serverErrno() != 1205
+            || sent.size() != 7 || sent[4] != "BEGIN; " + std::string(kTxHot)
+            || sent[5] != "ROLLBACK; BEGIN; " + std::string(kTxHot) || sent[6] != "ROLLBACK") {
+            state->fail("lock wait timeout should retry once, then roll back");
+            co_return;
+        }
+    }
+    {
+        // 事务体未提交即结束：回滚，没有错误
+        MysqlTransaction tx(pool);
+        while (co_await tx.next()) {
+            co_await tx.begin();
+        }
+        const auto sent = log->snapshot();
+        if (tx.committed() || tx.error() || sent.size() != 9 || sent[7] != "BEGIN" || sent[8] != "ROLLBACK") {
+            state->fail("abandoned transaction should roll back");
+            co_return;
+        }
+    }
+    if (pool.size() != 1 || pool.idleCount() != 1) {
+        state->fail("transaction connection should return to the pool");
+        co_return;
+    }
+    state->pass();
+}
+
+bool testAsyncTransaction()
+{
+    std::cout << "Testing transaction helper..." << std::endl;
+    MysqlMockServer server;
+    MOCK_EXPECT(server.start(), "server start");
+    TransactionLog log;
+    server.setHandler(transactionHandler(&log));
+
+    const bool passed = runFlow("transaction", [&](IOScheduler* scheduler, AsyncTestState* state) {
+        return testAsyncTransactionFlow(scheduler, state, &log, server.clientConfig());
+    });
+    server.stop();
+    if (!passed) {
+        return false;
+    }
+    std::cout << "  transaction helper OK" << std::endl;
+    return true;
+}
+
+struct BreakerWaiter {
+    bool done = false;
+    std::optional<MysqlErrorType> error;
+};
+
+Coroutine acquireInto(MysqlConnectionPool* pool, BreakerWaiter* out)
+{
+    auto acquired = co_await pool->acquire();
+    if (acquired && acquired->has_value()) {
+        pool->release(acquired->value());
+    } else if (!acquired) {
+        out->error = acquired.error().type();
+    }
+    out->done = true;
+}
+
+Coroutine testAsyncBreakerFlow(IOScheduler* scheduler, AsyncTestState* state, MysqlConfig live, MysqlConfig dead)
+{
+    {
+        // 不可达端点：连续两次建连失败后熔断，之后快速失败且不再占用连接名额
+        MysqlConnectionPoolConfig config;
+        config.mysql_config = dead;
+        config.max_connections = 2;
+        config.breaker.failure_threshold = 2;
+        config.breaker.backoff = std::chrono::seconds(30);
+        MysqlConnectionPool pool(scheduler, config);
+        for (int i = 0; i < 2; ++i) {
+            auto a = co_await pool.acquire();
+            if (a || a.error().type() == MYSQL_ERROR_UNAVAILABLE) {
+                state->fail("dead endpoint should fail to connect");
+                co_return;
+            }
+        }
+        auto health = pool.health();
+        auto fast = co_await pool.acquire();
+        if (health.state != MysqlEndpointState::Ejected || health.ejections != 1
+            || fast || fast.error().type() != MYSQL_ERROR_UNAVAILABLE) {
+            state->fail("dead endpoint should be ejected and fail fast");
+            co_return;
+        }
+    }
+
+    MysqlConnectionPoolConfig config;
+    config.mysql_config = live;
+    config.max_connections = 1;
+    config.breaker.failure_threshold = 2;
+    config.breaker.backoff = std::chrono::milliseconds(20);
+    config.breaker.latency_outlier_factor = 4.0;
+    config.breaker.latency_outlier_floor = std::chrono::milliseconds(0);
+    MysqlConnectionPool pool(scheduler, config);
+    auto side = AsyncMysqlClientBuilder().scheduler(scheduler).build();
+    if (auto c = co_await side.connect(live); !c || !c->has_value()) {
+        state->fail("side connect failed");
+        co_return;
+    }
+
+    auto held = co_await pool.acquire();
+    if (!held || !held->has_value()) {
+        state->fail("live endpoint acquire failed");
+        co_return;
+    }
+    // 服务端错误不计入端点故障；离群延迟计入
+    pool.recordFailure(MysqlError(MYSQL_ERROR_SERVER, 1146, "Table doesn't exist"));
+    for (int i = 0; i < 3; ++i) pool.recordSuccess(std::chrono::microseconds(100));
+    pool.recordSuccess(std::chrono::milliseconds(50));
+    if (pool.health().consecutive_failures != 1 || pool.health().state != MysqlEndpointState::Healthy) {
+        state->fail("latency outlier should count as one failure");
+        co_return;
+    }
+
+    // 池已满时的等待者在熔断时立即失败
+    BreakerWaiter waiter;
+    scheduler->spawn(acquireInto(&pool, &waiter));
+    pool.recordFailure(MysqlError(MYSQL_ERROR_TIMEOUT, "Command timeout"));
+    for (int i = 0; i < 100 && !waiter.done; ++i) {
+        co_await side.query("SELECT 1");
+    }
+    if (!waiter.done || waiter.error != MYSQL_ERROR_UNAVAILABLE || pool.health().state != MysqlEndpointState::Ejected) {
+        state->fail("waiter should be failed fast when the endpoint is ejected");
+        co_return;
+    }
+    pool.release(held->value());
+
+    // 退避结束后的第一次获取作为探测，成功后恢复
+    bool recovered = false;
+    bool rejected = false;
+    for (int i = 0; i < 5000 && !recovered; ++i) {
+        auto probe = co_await pool.acquire();
+        if (probe && probe->has_value()) {
+            recovered = true;
+            pool.release(probe->value());
+        } else if (!probe && probe.error().type() == MYSQL_ERROR_UNAVAILABLE) {
+            rejected = true;
+            co_await side.query("SELECT 1");
+        } else {
+            state->fail("probe acquire failed");
+            co_return;
+        }
+    }
+    const auto health = pool.health();
+    if (!recovered || !rejected || health.state != MysqlEndpointState::Healthy
+        || health.consecutive_failures != 0 || health.ejections != 1) {
+        state->fail("endpoint should recover after a successful probe");
+        co_return;
+    }
+
+    // 探测拿到的空闲连接已被服务端断开：PING失败，端点再次熔断而不是被空闲连接“探测成功”
+    auto stale = co_await pool.acquire();
+    if (!stale || !stale->has_value()) {
+        state->fail("acquire before stale probe failed");
+        co_return;
+    }
+    for (int i = 0; i < 2; ++i) pool.recordFailure(MysqlError(MYSQL_ERROR_TIMEOUT, "Command timeout"));
+    const std::string kill_sql = "KILL CONNECTION " + std::to_string(stale->value()->connectionId());
+    auto killed = co_await side.query(kill_sql);
+    pool.release(stale->value());
+    bool probe_failed = false;
+    for (int i = 0; i < 5000 && killed && !probe_failed; ++i) {
+        auto probe = co_await pool.acquire();
+        if (probe && probe->has_value()) {
+            state->fail("probe on a dead idle connection must not succeed");
+            co_return;
+        }
+        probe_failed = probe.error().type() != MYSQL_ERROR_UNAVAILABLE;
+        if (!probe_failed) {
+            co_await side.query("SELECT 1");
+        }
+    }
+    if (!probe_failed || pool.health().state != MysqlEndpointState::Ejected || pool.health().ejections != 3) {
+        state->fail("failed probe should eject the endpoint again");
+        co_return;
+    }
+    co_await side.close();
+    state->pass();
+}
+
+Coroutine testAsyncReconnectFlow(IOScheduler* scheduler, AsyncTestState* state, MysqlConfig config)
+{
+    auto side = AsyncMysqlClientBuilder().scheduler(scheduler).build();
+    if (!co_await side.connect(config)) {
+        state->fail("reconnect side connect failed");
+        co_return;
+    }
+    // 按主机名连接：首次经解析线程解析，之后的重连命中解析缓存
+    MysqlConfig named = config;
+    named.host = "localhost";
+    MysqlReconnectingClient db(scheduler, named);
+    const auto connectionId = [](const MysqlResultSet& rs) { return rs.row(0).getString(0); };
+    const auto killCurrent = [&]() { return side.query("KILL " + std::to_string(db.client()->connectionId())); };
+
+    // 只读查询执行中断开：重连后重试，调用方只看到结果
+    auto first = co_await db.query("SELECT CONNECTION_ID()");
+    if (!first || !first->has_value() || !co_await killCurrent()) {
+        state->fail("reconnect setup failed");
+        co_return;
+    }
+    co_await galay::kernel::sleep(std::chrono::milliseconds(50));
+    auto retried = co_await db.query("SELECT CONNECTION_ID()");
+    if (!retried || !retried->has_value() || connectionId(**retried) == connectionId(**first)
+        || db.reconnects() != 1) {
+        state->fail("idempotent read should be retried on a new connection");
+        co_return;
+    }
+
+    // 预处理语句在新连接上重新prepare，逻辑ID不变
+    auto stmt = co_await db.prepare("SELECT CONNECTION_ID()");
+    if (!stmt || !stmt->has_value() || !co_await killCurrent()) {
+        state->fail("reconnect prepare failed");
+        co_return;
+    }
+    co_await galay::kernel::sleep(std::chrono::milliseconds(50));
+    auto executed = co_await db.execute(**stmt, std::span<const std::optional<std::string>>());
+    if (!executed || !executed->has_value() || db.reconnects() != 2) {
+        state->fail("statement should be re-prepared after reconnect");
+        co_return;
+    }
+
+    // 写语句执行中断开不重试，下一条命令前重连
+    if (!co_await killCurrent()) {
+        state->fail("reconnect kill failed");
+        co_return;
+    }
+    co_await galay::kernel::sleep(std::chrono::milliseconds(50));
+    auto write = co_await db.query("INSERT INTO audit VALUES (1)");
+    if (write || db.reconnects() != 2) {
+        state->fail("non-idempotent write must not be retried");
+        co_return;
+    }
+    auto after = co_await db.query("SELECT 1");
+    if (!after || !after->has_value() || db.reconnects() != 3) {
+        state->fail("next command should reconnect");
+        co_return;
+    }
+
+    // 事务中的语句超时：连接被替换前COMMIT必须报告事务丢失，而不是在新连接上“提交”空事务
+    MysqlReconnectingClient txn(scheduler, config, {}, AsyncMysqlConfig::withRecvTimeout(std::chrono::milliseconds(100)));
+    auto begun = co_await txn.query("BEGIN");
+    auto slow = co_await txn.query("SELECT SLEEP(5)");
+    if (!begun || slow || slow.error().type() != MYSQL_ERROR_TIMEOUT) {
+        state->fail("statement inside the transaction should time out");
+        co_return;
+    }
+    auto commit = co_await txn.query("COMMIT");
+    if (commit || commit.error().type() != MYSQL_ERROR_TRANSACTION) {
+        state->fail("COMMIT after a lost transaction must fail with MYSQL_ERROR_TRANSACTION");
+        co_return;
+    }
+    auto fresh = co_await txn.query("SELECT 3");
+    if (!fresh || !fresh->has_value() || txn.reconnects() != 1) {
+        state->fail("command after the reported loss should run on a new connection");
+        co_return;
+    }
+    co_await side.close();
+    state->pass();
+}
+
+bool testAsyncReconnect(MysqlMockServer& server)
+{
+    std::cout << "Testing auto-reconnect and connection attributes..." << std::endl;
+    if (!runFlow("reconnect", [&](IOScheduler* scheduler, AsyncTestState* state) {
+            return testAsyncReconnectFlow(scheduler, state, server.clientConfig());
+        })) {
+        return false;
+    }
+    std::cout << "  auto-reconnect OK" << std::endl;
+    return true;
+}
+
+bool testAsyncBreaker(MysqlMockServer& server)
+{
+    std::cout << "Testing pool circuit breaker..." << std::endl;
+    MysqlMockServer stopped;
+    MOCK_EXPECT(stopped.start(), "stopped start");
+    const auto dead = stopped.clientConfig();
+    stopped.stop();
+
+    if (!runFlow("breaker", [&](IOScheduler* scheduler, AsyncTestState* state) {
+            return testAsyncBreakerFlow(scheduler, state, server.clientConfig(), dead);
+        })) {
+        return false;
+    }
+    std::cout << "  circuit breaker OK" << std::endl;
+    return true;
+}
+
+bool testAsyncClientRuntime(MysqlMockServer& server)
+{
+    std::cout << "Testing async client against mock server..." << std::endl;
+    server.setHandler(docEchoHandler());
+    auto async_config = server.clientConfig("test");
+    async_config.session_variables = {{"time_zone", "'+00:00'"}};
+    async_config.init_statements = {"SET @app = 'svc'"};
+    const auto config = server.clientConfig();
+    const bool passed =
+        runFlow("async", [&](IOScheduler* scheduler, AsyncTestState* state) {
+            return testAsyncClient(scheduler, state, async_config);
+        })
+        && runFlow("async deadline", [&](IOScheduler* scheduler, AsyncTestState* state) {
+            return testAsyncDeadline(scheduler, state, config);
+        })
+        && runFlow("async cancel", [&](IOScheduler* scheduler, AsyncTestState* state) {
+            return testAsyncCancel(scheduler, state, config);
+        })
+        && runFlow("async pool recover", [&](IOScheduler* scheduler, AsyncTestState* state) {
+            return testAsyncPoolRecover(scheduler, state, config);
+        });
+    server.setHandler(nullptr);
+    if (!passed) {
+        return false;
+    }
+    std::cout << "  async client OK" << std::endl;
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    std::cout << "=== T8: Mock Server Tests ===" << std::endl;
+
+    MysqlMockServer server;
+    auto started = server.start();
+    if (!started) {
+        std::cerr << "Mock server start failed: " << started.error().message() << std::endl;
+        return 1;
+    }
+    std::cout << "Mock server listening on 127.0.0.1:" << server.port() << std::endl;
+    scriptUsers(server);
+
+    bool ok = testSyncClient(server)
+        && testCachingSha2()
+        && testHandlerAndDelay(server)
+        && testSessionInit(server)
+        && testConnectAttributes(server)
+        && testResolver(server)
+        && testMultiResults(server)
+        && testBulkInsert(server)
+        && testLocalInfile(server)
+        && testLongData(server)
+        && testSessionGtid(server)
+        && testLegacyCapabilities()
+        && testKillQuery(server)
+        && testSyncTimeouts(server)
+        && testCancellationToken()
+        && testAdaptiveBuffer()
+        && testLinearBuffer()
+        && testSlabBuffer()
+        && testResultSetReuse()
+        && testAsyncClientRuntime(server)
+        && testRouterClassify()
+        && testAsyncRouter(server)
+        && testAsyncHedge(server)
+        && testAsyncBreaker(server)
+        && testAsyncTransaction()
+        && testAsyncReconnect(server);
+
+    server.stop();
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "All mock server tests passed." << std::endl;
+    return 0;
+}